@@ -59,6 +59,8 @@ namespace Core {
     
     void Engine::init() {
 
+        this->jobSystem = std::shared_ptr<JobSystem>(new JobSystem(JobSystem::getDefaultWorkerCount()));
+
         // TODO: make this configurable so that it is not hard-coded to use OpenGL
         std::shared_ptr<GraphicsGL> graphicsSystem(new GraphicsGL(GraphicsGL::GLVersion::Three));
         this->graphics = std::static_pointer_cast<Graphics>(graphicsSystem);
@@ -184,6 +186,23 @@ namespace Core {
         return this->animationManager;
     }
 
+    TransformHierarchy& Engine::getTransformHierarchy() {
+        return this->transformHierarchy;
+    }
+
+    WeakPointer<JobSystem> Engine::getJobSystem() {
+        errorIfShuttingDown();
+        return this->jobSystem;
+    }
+
+    /*
+     * Set the number of worker threads used for CPU work split into jobs. Zero runs every job
+     * on the main thread, which keeps results deterministic. Must not be called from inside a job.
+     */
+    void Engine::setJobWorkerCount(UInt32 workerCount) {
+        this->jobSystem->setWorkerCount(workerCount);
+    }
+
     void Engine::safeReleaseObject(WeakPointer<CoreObject> object) {
         if(!Engine::isShuttingDown()) {
             Engine::instance()->objectManager.removeReference(object);
@@ -6,6 +6,8 @@
 #include "util/PersistentWeakPointer.h"
 #include "base/CoreObjectReferenceManager.h"
 #include "scene/Object3D.h"
+#include "scene/TransformHierarchy.h"
+#include "util/JobSystem.h"
 #include "asset/ModelLoader.h"
 #include "geometry/Vector4.h"
 #include "image/TextureAttr.h"
@@ -58,6 +60,9 @@ namespace Core {
 
         WeakPointer<Graphics> getGraphicsSystem();
         WeakPointer<AnimationManager> getAnimationManager();
+        TransformHierarchy& getTransformHierarchy();
+        WeakPointer<JobSystem> getJobSystem();
+        void setJobWorkerCount(UInt32 workerCount);
 
         static void safeReleaseObject(WeakPointer<CoreObject> object);
         void addOwner(WeakPointer<CoreObject> object);
@@ -163,10 +168,13 @@ namespace Core {
         static Bool _shuttingDown;
         static void errorIfShuttingDown();
 
+        // declared ahead of [objectManager] so it outlives the transforms of the objects it releases
+        TransformHierarchy transformHierarchy;
         CoreObjectReferenceManager objectManager;
 
         std::shared_ptr<AnimationManager> animationManager;
         std::shared_ptr<Graphics> graphics;
+        std::shared_ptr<JobSystem> jobSystem;
 
         PersistentWeakPointer<Scene> activeScene;
         PersistentWeakPointer<ImageLoader> imageLoader;
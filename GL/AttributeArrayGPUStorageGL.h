@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string.h>
+#include <cstdint>
 #include <new>
 
 #include "../geometry/AttributeArrayGPUStorage.h"
@@ -51,6 +52,13 @@ namespace Core {
             glBindBuffer(GL_ARRAY_BUFFER, 0);
         }
 
+        void sendToShader(UInt32 location, UInt32 componentCount, UInt32 stride, UInt32 offset) override {
+            glBindBuffer(GL_ARRAY_BUFFER, this->bufferID);
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, componentCount, this->type, this->normalize, stride, (void*)(uintptr_t)offset);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
          void disable(UInt32 location) override {
             glDisableVertexAttribArray(location);
         }
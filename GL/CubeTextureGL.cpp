@@ -47,9 +47,12 @@ namespace Core {
     }
 
     void CubeTextureGL::updateMipMaps() {
-        glBindTexture(GL_TEXTURE_CUBE_MAP, this->getTextureID());
+        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
+
+        graphicsGL->bindTexture(GL_TEXTURE_CUBE_MAP, this->getTextureID());
         glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+        graphicsGL->bindTexture(GL_TEXTURE_CUBE_MAP, 0);
     }
 
     void CubeTextureGL::setupTexture(UInt32 width, UInt32 height, Byte* front, Byte* back, Byte* top, Byte* bottom, Byte* left, Byte* right) {
@@ -63,7 +66,8 @@ namespace Core {
         if (!tex) {
             throw AllocationException("CubeTexture::createCubeTexture -> Unable to generate texture");
         }
-        glBindTexture(GL_TEXTURE_CUBE_MAP, tex);
+        graphicsGL->invalidateTextureBinding(tex);
+        graphicsGL->bindTexture(GL_TEXTURE_CUBE_MAP, tex);
 
         GLvoid * frontPixels = front != nullptr ? front : (GLvoid*)0;
         GLvoid * backPixels = back != nullptr ? back : (GLvoid*)0;
@@ -135,7 +139,7 @@ namespace Core {
             glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
         }
 
-        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+        graphicsGL->bindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
         this->textureId = (Int32)tex;
     }
@@ -20,9 +20,29 @@ namespace Core {
 
     GraphicsGL::GraphicsGL(GLVersion version) : glVersion(version) {
         this->renderStyle = RenderStyle::Fill;
+        this->stateChangeCount = 0;
+        this->redundantStateChangeCount = 0;
+        this->locationQueryCount = 0;
+        this->locationTableLookupCount = 0;
+        this->instanceTransformBuffer = 0;
+        this->instanceTransformBufferSize = 0;
+        this->maxFragmentTextureUnits = 16;
+        this->invalidateStateCache();
     }
 
     GraphicsGL::~GraphicsGL() {
+        if (this->instanceTransformBuffer != 0) {
+            glDeleteBuffers(1, &this->instanceTransformBuffer);
+        }
+        for (auto& entry : this->meshVertexArrays) {
+            for (MeshVertexArray& vertexArray : entry.second) {
+#ifdef __APPLE__
+                glDeleteVertexArraysAPPLE(1, &vertexArray.vertexArrayID);
+#else
+                glDeleteVertexArrays(1, &vertexArray.vertexArrayID);
+#endif
+            }
+        }
     }
 
     void GraphicsGL::init() {
@@ -35,6 +55,14 @@ namespace Core {
 
         UInt32 maxGL = 0;
         const char* versionStr = (const char*)glGetString(GL_VERSION);
+
+        // shaders never bind more units than the state cache tracks
+        GLint maxTextureUnits = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxTextureUnits);
+        if (maxTextureUnits > 0) {
+            this->maxFragmentTextureUnits = (UInt32)maxTextureUnits < MaxTextureUnits ? (UInt32)maxTextureUnits : MaxTextureUnits;
+        }
+
         this->defaultRenderTarget = this->createDefaultRenderTarget();
         this->currentRenderTarget = this->defaultRenderTarget;
         this->shaderDirectory.init();
@@ -45,6 +73,7 @@ namespace Core {
         }
         
         glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+        this->invalidateStateCache();
     }
 
     WeakPointer<Renderer> GraphicsGL::getRenderer() {
@@ -56,12 +85,17 @@ namespace Core {
             this->saveState();
             this->setupRenderState();
         }
+        // the state may have been changed outside of the engine since the last frame
+        this->invalidateStateCache();
     }
 
     void GraphicsGL::postRender() {
+        // leave no mesh vertex array bound for code outside the engine
+        this->bindVertexArray(0);
         if (!this->sharedRenderState) {
             this->restoreState();
         }
+        this->invalidateStateCache();
     }
 
     WeakPointer<Texture2D> GraphicsGL::createTexture2D(const TextureAttributes& attributes) {
@@ -108,6 +142,7 @@ namespace Core {
         if (shaderPtr == nullptr) {
             throw AllocationException("GraphicsGL::addShader -> Could not allocate new shader.");
         }
+        shaderPtr->graphics = this;
         std::shared_ptr<ShaderGL> spShaderGL(shaderPtr);
         this->addCoreObjectReference(spShaderGL, CoreObjectReferenceManager::OwnerType::Single);
         std::shared_ptr<Shader> spShader = std::static_pointer_cast<Shader>(spShaderGL);
@@ -115,7 +150,10 @@ namespace Core {
     }
 
     void GraphicsGL::activateShader(WeakPointer<Shader> shader) {
-        glUseProgram(shader->getProgram());
+        GLuint program = shader->getProgram();
+        if (this->updateCachedState(this->_cacheProgram, program)) {
+            glUseProgram(program);
+        }
     }
 
     std::shared_ptr<AttributeArrayGPUStorage> GraphicsGL::createGPUStorage(UInt32 size, UInt32 componentCount, AttributeType type, Bool normalize) {
@@ -139,28 +177,191 @@ namespace Core {
     }
 
     void GraphicsGL::drawBoundVertexBuffer(UInt32 vertexCount) {
-        glPolygonMode(GL_FRONT_AND_BACK, getGLRenderStyle(this->renderStyle));
+        GLenum polygonMode = getGLRenderStyle(this->renderStyle);
+        if (this->updateCachedState(this->_cachePolygonMode, polygonMode)) glPolygonMode(GL_FRONT_AND_BACK, polygonMode);
         glDrawArrays(GL_TRIANGLES, 0, vertexCount);
     }
 
     void GraphicsGL::drawBoundVertexBuffer(UInt32 vertexCount, WeakPointer<IndexBuffer> indices) {
-        glPolygonMode(GL_FRONT_AND_BACK, getGLRenderStyle(this->renderStyle));
+        GLenum polygonMode = getGLRenderStyle(this->renderStyle);
+        if (this->updateCachedState(this->_cachePolygonMode, polygonMode)) glPolygonMode(GL_FRONT_AND_BACK, polygonMode);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices->getBufferID());
         glDrawElements(GL_TRIANGLES, vertexCount, GL_UNSIGNED_INT, (void*)(0));
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
+    void GraphicsGL::drawBoundVertexBufferInstanced(UInt32 vertexCount, UInt32 instanceCount) {
+        GLenum polygonMode = getGLRenderStyle(this->renderStyle);
+        if (this->updateCachedState(this->_cachePolygonMode, polygonMode)) glPolygonMode(GL_FRONT_AND_BACK, polygonMode);
+#ifdef __APPLE__
+        glDrawArraysInstancedARB(GL_TRIANGLES, 0, vertexCount, instanceCount);
+#else
+        glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, instanceCount);
+#endif
+    }
+
+    void GraphicsGL::drawBoundVertexBufferInstanced(UInt32 vertexCount, WeakPointer<IndexBuffer> indices, UInt32 instanceCount) {
+        GLenum polygonMode = getGLRenderStyle(this->renderStyle);
+        if (this->updateCachedState(this->_cachePolygonMode, polygonMode)) glPolygonMode(GL_FRONT_AND_BACK, polygonMode);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices->getBufferID());
+#ifdef __APPLE__
+        glDrawElementsInstancedARB(GL_TRIANGLES, vertexCount, GL_UNSIGNED_INT, (void*)(0), instanceCount);
+#else
+        glDrawElementsInstanced(GL_TRIANGLES, vertexCount, GL_UNSIGNED_INT, (void*)(0), instanceCount);
+#endif
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    /*
+    * Uploads [instanceCount] packed instance transforms (see Graphics::InstanceTransformSize) and binds them
+    * as per-instance attributes: a mat4 occupies the four locations starting at [modelMatrixLocation] and a
+    * mat3 the three starting at [modelInverseTransposeMatrixLocation]. Either location may be -1.
+    */
+    void GraphicsGL::bindInstanceTransforms(const Real* transforms, UInt32 instanceCount,
+                                            Int32 modelMatrixLocation, Int32 modelInverseTransposeMatrixLocation) {
+        if (this->instanceTransformBuffer == 0) {
+            glGenBuffers(1, &this->instanceTransformBuffer);
+        }
+
+        const GLsizei stride = InstanceTransformSize * sizeof(Real);
+        UInt32 size = instanceCount * stride;
+        if (size > this->instanceTransformBufferSize) {
+            this->instanceTransformBufferSize = size;
+        }
+
+        // orphaning the previous storage keeps the upload from waiting on draws that still read it
+        glBindBuffer(GL_ARRAY_BUFFER, this->instanceTransformBuffer);
+        glBufferData(GL_ARRAY_BUFFER, this->instanceTransformBufferSize, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, transforms);
+
+        if (modelMatrixLocation >= 0) {
+            for (UInt32 c = 0; c < 4; c++) {
+                GLuint location = modelMatrixLocation + c;
+                glEnableVertexAttribArray(location);
+                glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(Real) * c * 4));
+#ifdef __APPLE__
+                glVertexAttribDivisorARB(location, 1);
+#else
+                glVertexAttribDivisor(location, 1);
+#endif
+            }
+        }
+        if (modelInverseTransposeMatrixLocation >= 0) {
+            for (UInt32 c = 0; c < 3; c++) {
+                GLuint location = modelInverseTransposeMatrixLocation + c;
+                glEnableVertexAttribArray(location);
+                glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(Real) * (16 + c * 3)));
+#ifdef __APPLE__
+                glVertexAttribDivisorARB(location, 1);
+#else
+                glVertexAttribDivisor(location, 1);
+#endif
+            }
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void GraphicsGL::unbindInstanceTransforms(Int32 modelMatrixLocation, Int32 modelInverseTransposeMatrixLocation) {
+        if (modelMatrixLocation >= 0) {
+            for (UInt32 c = 0; c < 4; c++) {
+#ifdef __APPLE__
+                glVertexAttribDivisorARB(modelMatrixLocation + c, 0);
+#else
+                glVertexAttribDivisor(modelMatrixLocation + c, 0);
+#endif
+                glDisableVertexAttribArray(modelMatrixLocation + c);
+            }
+        }
+        if (modelInverseTransposeMatrixLocation >= 0) {
+            for (UInt32 c = 0; c < 3; c++) {
+#ifdef __APPLE__
+                glVertexAttribDivisorARB(modelInverseTransposeMatrixLocation + c, 0);
+#else
+                glVertexAttribDivisor(modelInverseTransposeMatrixLocation + c, 0);
+#endif
+                glDisableVertexAttribArray(modelInverseTransposeMatrixLocation + c);
+            }
+        }
+    }
+
+    /*
+     * Binds the vertex array object that holds the attribute setup of mesh [meshID] for shader [shaderID],
+     * creating an empty one on first use. Object IDs are never reused, so unlike GL program names they
+     * cannot alias a stale entry. The binding is left in place after the draw; attributes that vary per
+     * draw (bones, instance transforms) are re-specified and disabled again by the caller each time.
+     */
+    Bool GraphicsGL::activateVertexArray(UInt64 meshID, UInt64 shaderID) {
+        std::vector<MeshVertexArray>& vertexArrays = this->meshVertexArrays[meshID];
+        for (MeshVertexArray& vertexArray : vertexArrays) {
+            if (vertexArray.shaderID == shaderID) {
+                this->bindVertexArray(vertexArray.vertexArrayID);
+                return true;
+            }
+        }
+
+        MeshVertexArray vertexArray;
+        vertexArray.shaderID = shaderID;
+#ifdef __APPLE__
+        glGenVertexArraysAPPLE(1, &vertexArray.vertexArrayID);
+#else
+        glGenVertexArrays(1, &vertexArray.vertexArrayID);
+#endif
+        vertexArrays.push_back(vertexArray);
+        this->bindVertexArray(vertexArray.vertexArrayID);
+        return false;
+    }
+
+    /*
+     * Deletes the vertex array objects of mesh [meshID], to be called when the mesh is destroyed or
+     * its attribute layout or buffers change.
+     */
+    void GraphicsGL::releaseVertexArrays(UInt64 meshID) {
+        auto result = this->meshVertexArrays.find(meshID);
+        if (result == this->meshVertexArrays.end()) return;
+
+        for (MeshVertexArray& vertexArray : result->second) {
+            // deleting the bound vertex array reverts the binding to zero
+            if (this->_cacheVertexArray == vertexArray.vertexArrayID) this->_cacheVertexArray = 0;
+#ifdef __APPLE__
+            glDeleteVertexArraysAPPLE(1, &vertexArray.vertexArrayID);
+#else
+            glDeleteVertexArrays(1, &vertexArray.vertexArrayID);
+#endif
+        }
+        this->meshVertexArrays.erase(result);
+    }
+
+    void GraphicsGL::bindVertexArray(GLuint vertexArrayID) {
+        if (this->updateCachedState(this->_cacheVertexArray, vertexArrayID)) {
+#ifdef __APPLE__
+            glBindVertexArrayAPPLE(vertexArrayID);
+#else
+            glBindVertexArray(vertexArrayID);
+#endif
+        }
+    }
+
     ShaderManager& GraphicsGL::getShaderManager() {
         return this->shaderDirectory;
     }
 
+    UInt32 GraphicsGL::getMaxFragmentTextureUnits() const {
+        return this->maxFragmentTextureUnits;
+    }
+
     void GraphicsGL::setBlendingEnabled(Bool enabled) {
+        if (!this->updateCachedState(this->_cacheBlendEnabled, enabled)) return;
         if (enabled) glEnable(GL_BLEND);
         else glDisable(GL_BLEND);
     }
 
     void GraphicsGL::setBlendingFunction(RenderState::BlendingMethod source, RenderState::BlendingMethod dest) {
-        glBlendFunc(getGLBlendProperty(source), getGLBlendProperty(dest));
+        GLenum glSource = getGLBlendProperty(source);
+        GLenum glDest = getGLBlendProperty(dest);
+        Int64 function[] = {glSource, glDest};
+        if (this->updateCachedState(this->_cacheBlendFunction, function, 2)) {
+            glBlendFunc(glSource, glDest);
+        }
     }
 
     WeakPointer<RenderTarget2D> GraphicsGL::createRenderTarget2D(Bool hasColor, Bool hasDepth, Bool enableStencilBuffer,
@@ -198,6 +399,7 @@ namespace Core {
     }
 
     void GraphicsGL::setColorWriteEnabled(Bool enabled) {
+        if (!this->updateCachedState(this->_cacheColorMask, enabled)) return;
         if (enabled) {
             glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
         }
@@ -216,9 +418,9 @@ namespace Core {
         if (depthBuffer) mask |= GL_DEPTH_BUFFER_BIT;
         if (stencilBuffer) mask |= GL_STENCIL_BUFFER_BIT;
 
-        if (colorBuffer) glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-        if (depthBuffer) glDepthMask(GL_TRUE);
-        if (stencilBuffer) glStencilMask(0xFF);
+        if (colorBuffer) this->setColorWriteEnabled(true);
+        if (depthBuffer) this->setDepthWriteEnabled(true);
+        if (stencilBuffer) this->setStencilWriteMask(0xFF);
 
         glClear(mask);
     }
@@ -251,16 +453,8 @@ namespace Core {
             throw InvalidArgumentException("GraphicsGL::activateRenderTarget -> Render target is not a valid OpenGL render target.");
         }
 
-        if (this->currentRenderTarget.isValid()) {
-
-            // prevent activating the currently active target.
-            RenderTarget * currentTarget = this->currentRenderTarget.get();
-            RenderTargetGL * currentRenderTargetGL = dynamic_cast<RenderTargetGL *>(currentTarget);
-
-            if (currentRenderTargetGL != nullptr && currentRenderTargetGL->getFBOID() == renderTargetGL->getFBOID())return true;
-        }
-
-        glBindFramebuffer(GL_FRAMEBUFFER, renderTargetGL->getFBOID());
+        // re-activating the currently bound target is filtered out by the state cache.
+        this->bindFramebuffer(GL_FRAMEBUFFER, renderTargetGL->getFBOID());
         this->currentRenderTarget = target;
 
         //GetCurrentBufferBits();
@@ -324,7 +518,10 @@ namespace Core {
     }
 
     void GraphicsGL::setViewport(UInt32 hOffset, UInt32 vOffset, UInt32 viewPortWidth, UInt32 viewPortHeight) {
-        glViewport(hOffset, vOffset, viewPortWidth, viewPortHeight);
+        Int64 viewport[] = {hOffset, vOffset, viewPortWidth, viewPortHeight};
+        if (this->updateCachedState(this->_cacheViewport, viewport, 4)) {
+            glViewport(hOffset, vOffset, viewPortWidth, viewPortHeight);
+        }
         this->_viewport.set(hOffset, vOffset, viewPortWidth, viewPortHeight);
     }
 
@@ -333,6 +530,7 @@ namespace Core {
     }
 
     void GraphicsGL::setDepthWriteEnabled(Bool enabled) {
+        if (!this->updateCachedState(this->_cacheDepthMask, enabled)) return;
         if (enabled) {
             glDepthMask(GL_TRUE);
         }
@@ -342,15 +540,18 @@ namespace Core {
     }
 
     void GraphicsGL::setDepthTestEnabled(Bool enabled) {
+        if (!this->updateCachedState(this->_cacheDepthTestEnabled, enabled)) return;
         if (enabled) glEnable(GL_DEPTH_TEST);
         else glDisable (GL_DEPTH_TEST);
     }
 
     void GraphicsGL::setDepthFunction(RenderState::DepthFunction function) {
-        glDepthFunc(getGLDepthFunction(function));
+        GLint glFunction = getGLDepthFunction(function);
+        if (this->updateCachedState(this->_cacheDepthFunction, glFunction)) glDepthFunc(glFunction);
     }
 
     void GraphicsGL::setStencilTestEnabled(Bool enabled) {
+        if (!this->updateCachedState(this->_cacheStencilTestEnabled, enabled)) return;
         if (enabled) {
             glEnable(GL_STENCIL_TEST);
         }
@@ -360,18 +561,29 @@ namespace Core {
     }
 
     void GraphicsGL::setStencilWriteMask(UInt32 mask) {
-        glStencilMask((GLuint)mask);
+        if (this->updateCachedState(this->_cacheStencilWriteMask, mask)) glStencilMask((GLuint)mask);
     }
 
     void GraphicsGL::setStencilFunction(RenderState::StencilFunction function, Int16 value, UInt16 mask) {
-        glStencilFunc(getGLStencilFunction(function), (GLint)value, (GLuint)mask);
+        GLenum glFunction = getGLStencilFunction(function);
+        Int64 stencilFunction[] = {glFunction, value, mask};
+        if (this->updateCachedState(this->_cacheStencilFunction, stencilFunction, 3)) {
+            glStencilFunc(glFunction, (GLint)value, (GLuint)mask);
+        }
     }
 
     void GraphicsGL::setStencilOperation(RenderState::StencilAction sFail, RenderState::StencilAction dpFail, RenderState::StencilAction dpPass) {
-        glStencilOp(getGLStencilAction(sFail), getGLStencilAction(dpFail), getGLStencilAction(dpPass));
+        GLenum glSFail = getGLStencilAction(sFail);
+        GLenum glDpFail = getGLStencilAction(dpFail);
+        GLenum glDpPass = getGLStencilAction(dpPass);
+        Int64 stencilOperation[] = {glSFail, glDpFail, glDpPass};
+        if (this->updateCachedState(this->_cacheStencilOperation, stencilOperation, 3)) {
+            glStencilOp(glSFail, glDpFail, glDpPass);
+        }
     }
 
     void GraphicsGL::setFaceCullingEnabled(Bool enabled) {
+        if (!this->updateCachedState(this->_cacheCullFaceEnabled, enabled)) return;
         if (enabled) {
             glEnable(GL_CULL_FACE);
         }
@@ -381,6 +593,7 @@ namespace Core {
     }
 
     void GraphicsGL::setCullFace(RenderState::CullFace face) {
+        if (!this->updateCachedState(this->_cacheCullFace, (Int64)face)) return;
         switch(face) {
             case RenderState::CullFace::Front:
                 glCullFace(GL_FRONT);
@@ -395,6 +608,161 @@ namespace Core {
         glLineWidth(size);
     }
 
+    /*
+     * Bind [textureID] to [target] on texture unit [unit]. The other texture target on that unit is not
+     * touched, callers that switch a unit between 2D and cube textures should unbind the old one.
+     */
+    void GraphicsGL::bindTexture(UInt32 unit, GLenum target, GLuint textureID) {
+        if (unit >= MaxTextureUnits) {
+            throw InvalidArgumentException("GraphicsGL::bindTexture() -> 'unit' is too high.");
+        }
+        Int64* cachedTexture = target == GL_TEXTURE_CUBE_MAP ? &this->_cacheTextureCube[unit] : &this->_cacheTexture2D[unit];
+        if (!this->updateCachedState(*cachedTexture, textureID)) return;
+        this->setActiveTextureUnit(unit);
+        glBindTexture(target, textureID);
+    }
+
+    /*
+     * Bind [textureID] to [target] on the active texture unit, e.g. for uploading texture data.
+     */
+    void GraphicsGL::bindTexture(GLenum target, GLuint textureID) {
+        UInt32 unit = this->_cacheActiveTextureUnit == UnknownState ? 0 : (UInt32)this->_cacheActiveTextureUnit;
+        this->bindTexture(unit, target, textureID);
+    }
+
+    void GraphicsGL::bindFramebuffer(GLenum target, GLuint fboID) {
+        Bool drawChanged = false;
+        Bool readChanged = false;
+        if (target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER) {
+            drawChanged = this->_cacheDrawFramebuffer != fboID;
+            this->_cacheDrawFramebuffer = fboID;
+        }
+        if (target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER) {
+            readChanged = this->_cacheReadFramebuffer != fboID;
+            this->_cacheReadFramebuffer = fboID;
+        }
+        if (!drawChanged && !readChanged) {
+            this->redundantStateChangeCount++;
+            return;
+        }
+        this->stateChangeCount++;
+        if (drawChanged && readChanged) glBindFramebuffer(target, fboID);
+        else glBindFramebuffer(drawChanged ? GL_DRAW_FRAMEBUFFER : GL_READ_FRAMEBUFFER, fboID);
+    }
+
+    /*
+     * GL object names are recycled after deletion, so a newly generated texture or FBO may share its
+     * name with one the cache still believes to be bound. Creators must forget such bindings first.
+     */
+    void GraphicsGL::invalidateTextureBinding(GLuint textureID) {
+        for (UInt32 i = 0; i < MaxTextureUnits; i++) {
+            if (this->_cacheTexture2D[i] == textureID) this->_cacheTexture2D[i] = UnknownState;
+            if (this->_cacheTextureCube[i] == textureID) this->_cacheTextureCube[i] = UnknownState;
+        }
+    }
+
+    void GraphicsGL::invalidateFramebufferBinding(GLuint fboID) {
+        if (this->_cacheDrawFramebuffer == fboID) this->_cacheDrawFramebuffer = UnknownState;
+        if (this->_cacheReadFramebuffer == fboID) this->_cacheReadFramebuffer = UnknownState;
+    }
+
+    /*
+     * Forget all cached state, to be called whenever GL state may have been changed behind the engine's back.
+     */
+    void GraphicsGL::invalidateStateCache() {
+        this->_cacheProgram = UnknownState;
+        this->_cacheActiveTextureUnit = UnknownState;
+        for (UInt32 i = 0; i < MaxTextureUnits; i++) {
+            this->_cacheTexture2D[i] = UnknownState;
+            this->_cacheTextureCube[i] = UnknownState;
+        }
+        this->_cacheDrawFramebuffer = UnknownState;
+        this->_cacheReadFramebuffer = UnknownState;
+        for (UInt32 i = 0; i < 4; i++) this->_cacheViewport[i] = UnknownState;
+        this->_cacheColorMask = UnknownState;
+        this->_cacheBlendEnabled = UnknownState;
+        this->_cacheBlendFunction[0] = this->_cacheBlendFunction[1] = UnknownState;
+        this->_cacheDepthMask = UnknownState;
+        this->_cacheDepthTestEnabled = UnknownState;
+        this->_cacheDepthFunction = UnknownState;
+        this->_cacheCullFaceEnabled = UnknownState;
+        this->_cacheCullFace = UnknownState;
+        this->_cacheStencilTestEnabled = UnknownState;
+        this->_cacheStencilWriteMask = UnknownState;
+        for (UInt32 i = 0; i < 3; i++) {
+            this->_cacheStencilFunction[i] = UnknownState;
+            this->_cacheStencilOperation[i] = UnknownState;
+        }
+        this->_cachePolygonMode = UnknownState;
+        this->_cacheVertexArray = UnknownState;
+    }
+
+    /*
+     * Number of state changes that were passed on to the driver since the last reset.
+     */
+    UInt32 GraphicsGL::getStateChangeCount() const {
+        return this->stateChangeCount;
+    }
+
+    /*
+     * Number of state changes that were skipped because they matched the cached state.
+     */
+    UInt32 GraphicsGL::getRedundantStateChangeCount() const {
+        return this->redundantStateChangeCount;
+    }
+
+    void GraphicsGL::resetStateChangeCounters() {
+        this->stateChangeCount = 0;
+        this->redundantStateChangeCount = 0;
+    }
+
+    /*
+     * Number of uniform & attribute locations looked up by name with glGetUniformLocation() or glGetAttribLocation()
+     * since the last reset, not counting the ones made to build the location tables at link time.
+     */
+    UInt32 GraphicsGL::getLocationQueryCount() const {
+        return this->locationQueryCount;
+    }
+
+    /*
+     * Number of standard uniform & attribute locations read from a shader's location table since the last reset.
+     * Each of these used to be a glGetUniformLocation() or glGetAttribLocation() call on a name built for the
+     * lookup, so the sum of the two counts is what the same frame would have cost before.
+     */
+    UInt32 GraphicsGL::getLocationTableLookupCount() const {
+        return this->locationTableLookupCount;
+    }
+
+    void GraphicsGL::resetLocationLookupCounters() {
+        this->locationQueryCount = 0;
+        this->locationTableLookupCount = 0;
+    }
+
+    void GraphicsGL::setActiveTextureUnit(UInt32 unit) {
+        if (this->updateCachedState(this->_cacheActiveTextureUnit, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    Bool GraphicsGL::updateCachedState(Int64& cached, Int64 value) {
+        if (cached == value) {
+            this->redundantStateChangeCount++;
+            return false;
+        }
+        cached = value;
+        this->stateChangeCount++;
+        return true;
+    }
+
+    Bool GraphicsGL::updateCachedState(Int64* cached, const Int64* values, UInt32 count) {
+        Bool changed = false;
+        for (UInt32 i = 0; i < count; i++) {
+            if (cached[i] != values[i]) changed = true;
+            cached[i] = values[i];
+        }
+        if (changed) this->stateChangeCount++;
+        else this->redundantStateChangeCount++;
+        return changed;
+    }
+
     void GraphicsGL::saveState() {
         glGetIntegerv(GL_FRONT_FACE, &this->_stateFrontFace);
         glGetBooleanv(GL_CULL_FACE, &this->_stateCullFaceEnabled);
@@ -431,8 +799,8 @@ namespace Core {
         GLint destID = (dynamic_cast<RenderTargetGL *>(destination.get()))->getFBOID();
         Vector2u size = destination->getSize();
 
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, srcID);
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, destID);
+        this->bindFramebuffer(GL_READ_FRAMEBUFFER, srcID);
+        this->bindFramebuffer(GL_DRAW_FRAMEBUFFER, destID);
         if (includeColor && cubeFace >= 0) {
             glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, getGLCubeTarget((CubeTextureSide)cubeFace), destination->getColorTexture()->getTextureID(), 0);
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "../util/PersistentWeakPointer.h"
@@ -26,6 +27,7 @@ namespace Core {
 
     class GraphicsGL final : public Graphics {
         friend class Engine;
+        friend class ShaderGL;
 
     public:
         enum class GLVersion {
@@ -53,8 +55,16 @@ namespace Core {
 
         void drawBoundVertexBuffer(UInt32 vertexCount) override;
         void drawBoundVertexBuffer(UInt32 vertexCount, WeakPointer<IndexBuffer> indices) override;
+        void drawBoundVertexBufferInstanced(UInt32 vertexCount, UInt32 instanceCount) override;
+        void drawBoundVertexBufferInstanced(UInt32 vertexCount, WeakPointer<IndexBuffer> indices, UInt32 instanceCount) override;
+        void bindInstanceTransforms(const Real* transforms, UInt32 instanceCount,
+                                    Int32 modelMatrixLocation, Int32 modelInverseTransposeMatrixLocation) override;
+        void unbindInstanceTransforms(Int32 modelMatrixLocation, Int32 modelInverseTransposeMatrixLocation) override;
+        Bool activateVertexArray(UInt64 meshID, UInt64 shaderID) override;
+        void releaseVertexArrays(UInt64 meshID) override;
 
         ShaderManager& getShaderManager() override;
+        UInt32 getMaxFragmentTextureUnits() const override;
 
         void setBlendingEnabled(Bool enabled) override;
         void setBlendingFunction(RenderState::BlendingMethod source, RenderState::BlendingMethod dest) override;
@@ -93,6 +103,19 @@ namespace Core {
 
         void setRenderLineSize(Real size);
 
+        void bindTexture(UInt32 unit, GLenum target, GLuint textureID);
+        void bindTexture(GLenum target, GLuint textureID);
+        void bindFramebuffer(GLenum target, GLuint fboID);
+        void invalidateTextureBinding(GLuint textureID);
+        void invalidateFramebufferBinding(GLuint fboID);
+        void invalidateStateCache();
+        UInt32 getStateChangeCount() const;
+        UInt32 getRedundantStateChangeCount() const;
+        void resetStateChangeCounters();
+        UInt32 getLocationQueryCount() const;
+        UInt32 getLocationTableLookupCount() const;
+        void resetLocationLookupCounters();
+
         void saveState() override;
         void restoreState() override;
 
@@ -120,9 +143,14 @@ namespace Core {
         std::shared_ptr<RenderTarget2DGL> createDefaultRenderTarget();
         WeakPointer<Shader> addShader(ShaderGL* shaderPtr);
         void setupRenderState();
+        void setActiveTextureUnit(UInt32 unit);
+        void bindVertexArray(GLuint vertexArrayID);
+        Bool updateCachedState(Int64& cached, Int64 value);
+        Bool updateCachedState(Int64* cached, const Int64* values, UInt32 count);
 
         GLVersion glVersion;
         std::shared_ptr<RendererGL> renderer;
+        UInt32 maxFragmentTextureUnits;
         
         PersistentWeakPointer<RenderTarget2DGL> defaultRenderTarget;
         PersistentWeakPointer<RenderTarget> currentRenderTarget;
@@ -140,5 +168,48 @@ namespace Core {
         GLfloat _stateLineWidth;
         GLboolean _stateLineSmoothEnabled;
         GLint _statePolygonMode[2];
+
+        // shadow copy of the driver state, used to filter out redundant GL calls. a value of
+        // UnknownState forces the next request for that state to be issued.
+        static const UInt32 MaxTextureUnits = 32;
+        static const Int64 UnknownState = -1;
+        Int64 _cacheProgram;
+        Int64 _cacheActiveTextureUnit;
+        Int64 _cacheTexture2D[MaxTextureUnits];
+        Int64 _cacheTextureCube[MaxTextureUnits];
+        Int64 _cacheDrawFramebuffer;
+        Int64 _cacheReadFramebuffer;
+        Int64 _cacheViewport[4];
+        Int64 _cacheColorMask;
+        Int64 _cacheBlendEnabled;
+        Int64 _cacheBlendFunction[2];
+        Int64 _cacheDepthMask;
+        Int64 _cacheDepthTestEnabled;
+        Int64 _cacheDepthFunction;
+        Int64 _cacheCullFaceEnabled;
+        Int64 _cacheCullFace;
+        Int64 _cacheStencilTestEnabled;
+        Int64 _cacheStencilWriteMask;
+        Int64 _cacheStencilFunction[3];
+        Int64 _cacheStencilOperation[3];
+        Int64 _cachePolygonMode;
+        Int64 _cacheVertexArray;
+        UInt32 stateChangeCount;
+        UInt32 redundantStateChangeCount;
+        // uniform & attribute location lookups made through the shaders, see getLocationQueryCount()
+        UInt32 locationQueryCount;
+        UInt32 locationTableLookupCount;
+
+        // streaming buffer shared by all instanced draws, re-specified on every upload
+        GLuint instanceTransformBuffer;
+        UInt32 instanceTransformBufferSize;
+
+        // vertex array objects, keyed by mesh object ID and then by shader object ID
+        class MeshVertexArray {
+        public:
+            UInt64 shaderID;
+            GLuint vertexArrayID;
+        };
+        std::unordered_map<UInt64, std::vector<MeshVertexArray>> meshVertexArrays;
     };
 }
\ No newline at end of file
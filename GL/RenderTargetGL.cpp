@@ -1,4 +1,6 @@
 #include "RenderTargetGL.h"
+#include "GraphicsGL.h"
+#include "../Engine.h"
 
 namespace Core {
 
@@ -46,7 +48,10 @@ namespace Core {
             throw RenderTargetException("RenderTargetGL::initFramebuffer -> Unable to create frame buffer object.");
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, this->fboID);
+        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
+        graphicsGL->invalidateFramebufferBinding(this->fboID);
+        graphicsGL->bindFramebuffer(GL_FRAMEBUFFER, this->fboID);
         
     }
 
@@ -72,7 +77,9 @@ namespace Core {
             throw RenderTargetException("RenderTargetCubeGL::init -> Framebuffer is incomplete!.");
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
+        graphicsGL->bindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
     void RenderTargetGL::initDepthStencilBufferCombo(UInt32 sizeX, UInt32 sizeY) {
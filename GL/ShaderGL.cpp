@@ -5,6 +5,7 @@
 
 #include "../common/debug.h"
 #include "../util/String.h"
+#include "GraphicsGL.h"
 
 namespace Core {
 
@@ -42,50 +43,59 @@ namespace Core {
     }
 
     Int32 ShaderGL::getUniformLocation(const std::string &var) const {
+        this->graphics->locationQueryCount++;
         return (Int32)glGetUniformLocation(this->glProgram, var.c_str());
     }
 
     Int32 ShaderGL::getAttributeLocation(const std::string &var) const {
+        this->graphics->locationQueryCount++;
         return (Int32)glGetAttribLocation(this->glProgram, var.c_str());
     }
 
     Int32 ShaderGL::getUniformLocation(const char var[]) const {
+        this->graphics->locationQueryCount++;
         return (Int32)glGetUniformLocation(this->glProgram, var);
     }
 
     Int32 ShaderGL::getAttributeLocation(const char var[]) const {
+        this->graphics->locationQueryCount++;
         return (Int32)glGetAttribLocation(this->glProgram, var);
     }
 
     Int32 ShaderGL::getUniformLocation(StandardUniform uniform) const {
-        return this->getUniformLocation(StandardUniforms::getUniformName(uniform));
+        return this->getUniformLocation(uniform, 0);
     }
 
+    /*
+     * Standard uniform locations come from the table built at link time, element 0 of a
+     * non-array uniform is the uniform itself.
+     */
     Int32 ShaderGL::getUniformLocation(StandardUniform uniform, UInt32 index) const {
-        return this->getUniformLocation(StandardUniforms::getUniformName(uniform) + "[" + std::to_string(index) + "]");
+        UInt32 uniformIndex = (UInt32)uniform;
+        this->graphics->locationTableLookupCount++;
+        if (uniformIndex >= (UInt32)StandardUniform::_Count || index >= this->uniformLocationCounts[uniformIndex]) return -1;
+        return this->uniformLocations[this->uniformLocationOffsets[uniformIndex] + index];
     }
 
     Int32 ShaderGL::getAttributeLocation(StandardAttribute attribute) const {
-        return this->getAttributeLocation(StandardAttributes::getAttributeName(attribute));
+        return this->getAttributeLocation(attribute, 0);
     }
 
     Int32 ShaderGL::getAttributeLocation(StandardAttribute attribute, UInt32 index) const {
-        return this->getAttributeLocation(StandardAttributes::getAttributeName(attribute) + "[" + std::to_string(index) + "]");
+        UInt32 attributeIndex = (UInt32)attribute;
+        this->graphics->locationTableLookupCount++;
+        if (attributeIndex >= (UInt32)StandardAttribute::_Count || index >= this->attributeLocationCounts[attributeIndex]) return -1;
+        return this->attributeLocations[this->attributeLocationOffsets[attributeIndex] + index];
     }
 
 
     void ShaderGL::setTexture2D(UInt32 slot, UInt32 textureID) {
-        static UInt32 slots[] = {GL_TEXTURE0, GL_TEXTURE1, GL_TEXTURE2, GL_TEXTURE3, GL_TEXTURE4, GL_TEXTURE5,
-                                 GL_TEXTURE6, GL_TEXTURE7, GL_TEXTURE8, GL_TEXTURE9, GL_TEXTURE10, GL_TEXTURE11,
-                                 GL_TEXTURE12, GL_TEXTURE13, GL_TEXTURE14, GL_TEXTURE15, GL_TEXTURE16, GL_TEXTURE17,
-                                 GL_TEXTURE18, GL_TEXTURE19};
-        if (slot >= 20) {
+        if (slot >= 32) {
             std::cerr << "slot: " << slot << std::endl;
             throw Shader::ShaderVariableException("ShaderGL::setTexture2D() value for [slot] is too high.");
         }
-        glActiveTexture(slots[slot]);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        this->graphics->bindTexture(slot, GL_TEXTURE_CUBE_MAP, 0);
+        this->graphics->bindTexture(slot, GL_TEXTURE_2D, textureID);
     }
 
     void ShaderGL::setTexture2D(UInt32 samplerSlot, UInt32 uniformLocation, UInt32 textureID) {
@@ -94,17 +104,12 @@ namespace Core {
     }
 
     void ShaderGL::setTextureCube(UInt32 slot, UInt32 textureID) {
-        static UInt32 slots[] = {GL_TEXTURE0, GL_TEXTURE1, GL_TEXTURE2, GL_TEXTURE3, GL_TEXTURE4, GL_TEXTURE5,
-                                 GL_TEXTURE6, GL_TEXTURE7, GL_TEXTURE8, GL_TEXTURE9, GL_TEXTURE10, GL_TEXTURE11,
-                                 GL_TEXTURE12, GL_TEXTURE13, GL_TEXTURE14, GL_TEXTURE15};
-
-        if (slot >= 16) {
+        if (slot >= 32) {
             std::cerr << "slot: " << slot << std::endl;
             throw Shader::ShaderVariableException("ShaderGL::setTextureCube() value for [slot] is too high.");
         }
-        glActiveTexture(slots[slot]);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+        this->graphics->bindTexture(slot, GL_TEXTURE_2D, 0);
+        this->graphics->bindTexture(slot, GL_TEXTURE_CUBE_MAP, textureID);
     }
 
     void ShaderGL::setTextureCube(UInt32 samplerSlot, UInt32 uniformLocation, UInt32 textureID) {
@@ -132,6 +137,22 @@ namespace Core {
         glUniformMatrix4fv(location, 1, GL_FALSE, matrix.getConstData());
     }
 
+    void ShaderGL::setUniform1iv(UInt32 location, UInt32 count, const Int32 *vals) {
+        glUniform1iv(location, count, vals);
+    }
+
+    void ShaderGL::setUniform1fv(UInt32 location, UInt32 count, const Real *vals) {
+        glUniform1fv(location, count, vals);
+    }
+
+    void ShaderGL::setUniform4fv(UInt32 location, UInt32 count, const Real *vals) {
+        glUniform4fv(location, count, vals);
+    }
+
+    void ShaderGL::setUniformMatrix4v(UInt32 location, UInt32 count, const Real *data) {
+        glUniformMatrix4fv(location, count, GL_FALSE, data);
+    }
+
     std::string ShaderGL::shaderTypeString(ShaderType shaderType) {
         switch (shaderType) {
             case ShaderType::Vertex:
@@ -260,6 +281,7 @@ namespace Core {
 
         this->ready = true;
         this->glProgram = program;
+        this->buildLocationTables();
     exit:
         if (vtxShader) glDeleteShader(vtxShader);
         if (geoShader) glDeleteShader(geoShader);
@@ -267,6 +289,85 @@ namespace Core {
         return program;
     }
 
+    /*
+     * Introspect the active uniforms & attributes of the linked program and record the locations of
+     * the standard ones (and of every element for arrays), so later lookups are plain array reads.
+     */
+    void ShaderGL::buildLocationTables() {
+        const UInt32 uniformCount = (UInt32)StandardUniform::_Count;
+        const UInt32 attributeCount = (UInt32)StandardAttribute::_Count;
+        std::vector<std::vector<Int32>> uniformElements(uniformCount);
+        std::vector<std::vector<Int32>> attributeElements(attributeCount);
+
+        GLint activeCount = 0;
+        GLint maxNameLength = 0;
+        glGetProgramiv(this->glProgram, GL_ACTIVE_UNIFORMS, &activeCount);
+        glGetProgramiv(this->glProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+        std::vector<GLchar> nameBuffer(maxNameLength + 1);
+        for (GLint i = 0; i < activeCount; i++) {
+            GLsizei nameLength = 0;
+            GLint size = 0;
+            GLenum type;
+            glGetActiveUniform(this->glProgram, i, (GLsizei)nameBuffer.size(), &nameLength, &size, &type, nameBuffer.data());
+            std::string name(nameBuffer.data(), nameLength);
+            Bool isArray = name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0;
+            if (isArray) name.resize(name.size() - 3);
+
+            StandardUniform uniform = StandardUniforms::getUniformForName(name);
+            if (uniform == StandardUniform::_None) continue;
+            std::vector<Int32>& elements = uniformElements[(UInt32)uniform];
+            if (!isArray) {
+                elements.push_back(glGetUniformLocation(this->glProgram, name.c_str()));
+                continue;
+            }
+            for (GLint e = 0; e < size; e++) {
+                std::string elementName = name + "[" + std::to_string(e) + "]";
+                elements.push_back(glGetUniformLocation(this->glProgram, elementName.c_str()));
+            }
+        }
+
+        activeCount = 0;
+        maxNameLength = 0;
+        glGetProgramiv(this->glProgram, GL_ACTIVE_ATTRIBUTES, &activeCount);
+        glGetProgramiv(this->glProgram, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxNameLength);
+        nameBuffer.resize(maxNameLength + 1);
+        for (GLint i = 0; i < activeCount; i++) {
+            GLsizei nameLength = 0;
+            GLint size = 0;
+            GLenum type;
+            glGetActiveAttrib(this->glProgram, i, (GLsizei)nameBuffer.size(), &nameLength, &size, &type, nameBuffer.data());
+            std::string name(nameBuffer.data(), nameLength);
+            Bool isArray = name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0;
+            if (isArray) name.resize(name.size() - 3);
+
+            StandardAttribute attribute = StandardAttributes::getAttributeForName(name);
+            if (attribute == StandardAttribute::_None) continue;
+            std::vector<Int32>& elements = attributeElements[(UInt32)attribute];
+            if (!isArray) {
+                elements.push_back(glGetAttribLocation(this->glProgram, name.c_str()));
+                continue;
+            }
+            for (GLint e = 0; e < size; e++) {
+                std::string elementName = name + "[" + std::to_string(e) + "]";
+                elements.push_back(glGetAttribLocation(this->glProgram, elementName.c_str()));
+            }
+        }
+
+        this->uniformLocations.clear();
+        for (UInt32 u = 0; u < uniformCount; u++) {
+            this->uniformLocationOffsets[u] = (UInt32)this->uniformLocations.size();
+            this->uniformLocationCounts[u] = (UInt32)uniformElements[u].size();
+            this->uniformLocations.insert(this->uniformLocations.end(), uniformElements[u].begin(), uniformElements[u].end());
+        }
+
+        this->attributeLocations.clear();
+        for (UInt32 a = 0; a < attributeCount; a++) {
+            this->attributeLocationOffsets[a] = (UInt32)this->attributeLocations.size();
+            this->attributeLocationCounts[a] = (UInt32)attributeElements[a].size();
+            this->attributeLocations.insert(this->attributeLocations.end(), attributeElements[a].begin(), attributeElements[a].end());
+        }
+    }
+
     GLenum ShaderGL::convertShaderType(ShaderType shaderType) {
         switch (shaderType) {
             case ShaderType::Vertex:
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "../common/gl.h"
 #include "../common/types.h"
@@ -38,6 +39,10 @@ namespace Core {
         void setUniform4f(UInt32 location, Real x, Real y, Real z, Real w) override;
         void setUniformMatrix4(UInt32 location, const Real* data) override;
         void setUniformMatrix4(UInt32 location, const Matrix4x4& data) override;
+        void setUniform1iv(UInt32 location, UInt32 count, const Int32* vals) override;
+        void setUniform1fv(UInt32 location, UInt32 count, const Real* vals) override;
+        void setUniform4fv(UInt32 location, UInt32 count, const Real* vals) override;
+        void setUniformMatrix4v(UInt32 location, UInt32 count, const Real* data) override;
 
     protected:
         ShaderGL();
@@ -53,7 +58,20 @@ namespace Core {
         UInt32 createProgram(const std::string& vertex, const std::string& fragment) override;
         UInt32 createProgram(const std::string& vertex, const std::string& geometry, const std::string& fragment) override;
         UInt32 createProgramInternal(const std::string& vertex, const std::string& fragment, const std::string* geometry = nullptr);
+        void buildLocationTables();
 
         GLuint glProgram;
+
+        // locations of the active standard uniforms & attributes, gathered once at link time. the locations
+        // of element i of StandardUniform u are at uniformLocations[uniformLocationOffsets[u] + i].
+        std::vector<Int32> uniformLocations;
+        UInt32 uniformLocationOffsets[(UInt32)StandardUniform::_Count] = {};
+        UInt32 uniformLocationCounts[(UInt32)StandardUniform::_Count] = {};
+        std::vector<Int32> attributeLocations;
+        UInt32 attributeLocationOffsets[(UInt32)StandardAttribute::_Count] = {};
+        UInt32 attributeLocationCounts[(UInt32)StandardAttribute::_Count] = {};
+
+        // texture binds go through the owning graphics system's state cache
+        GraphicsGL* graphics = nullptr;
     };
 }
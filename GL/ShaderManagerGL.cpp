@@ -16,6 +16,8 @@ const std::string ALBEDO_UV = _an(Core::StandardAttribute::AlbedoUV);
 const std::string NORMAL_UV = _an(Core::StandardAttribute::NormalUV);
 const std::string BONE_INDEX = _an(Core::StandardAttribute::BoneIndex);
 const std::string BONE_WEIGHT = _an(Core::StandardAttribute::BoneWeight);
+const std::string INSTANCE_MODEL_MATRIX = _an(Core::StandardAttribute::InstanceModelMatrix);
+const std::string INSTANCE_MODEL_INVERSE_TRANSPOSE_MATRIX = _an(Core::StandardAttribute::InstanceModelInverseTransposeMatrix);
 
 const std::string MODEL_MATRIX = _un(Core::StandardUniform::ModelMatrix);
 const std::string MODEL_INVERSE_TRANSPOSE_MATRIX = _un(Core::StandardUniform::ModelInverseTransposeMatrix);
@@ -24,10 +26,13 @@ const std::string PROJECTION_MATRIX = _un(Core::StandardUniform::ProjectionMatri
 const std::string CAMERA_POSITION = _un(Core::StandardUniform::CameraPosition);
 const std::string TEXTURE0 = _un(Core::StandardUniform::Texture0);
 const std::string DEPTH_TEXTURE = _un(Core::StandardUniform::DepthTexture);
-const std::string BONES = _un(Core::StandardUniform::Bones);
+const std::string SKINNING_PALETTE = _un(Core::StandardUniform::SkinningPalette);
+const std::string SKINNING_ROOT_INVERSE_MATRIX = _un(Core::StandardUniform::SkinningRootInverseMatrix);
 const std::string SKINNING_ENABLED = _un(Core::StandardUniform::SkinningEnabled);
+const std::string SKINNING_MODE = _un(Core::StandardUniform::SkinningMode);
+const std::string INSTANCING_ENABLED = _un(Core::StandardUniform::InstancingEnabled);
 
-const std::string MAX_BONES = std::to_string(Core::Constants::MaxBones);
+const std::string SKINNING_PALETTE_BONES_PER_ROW = std::to_string(Core::Constants::SkinningPaletteBonesPerRow);
 const std::string MAX_CASCADES = std::to_string(Core::Constants::MaxDirectionalCascades);
 const std::string MAX_LIGHTS = std::to_string(Core::Constants::MaxShaderLights);
 const std::string MAX_POINT_LIGHTS = std::to_string(Core::Constants::MaxShaderPointLights);
@@ -62,6 +67,12 @@ const std::string AMBIENT_LIGHT_COUNT = _un(Core::StandardUniform::AmbientLightC
 const std::string AMBIENT_IBL_LIGHT_COUNT = _un(Core::StandardUniform::AmbientIBLLightCount);
 const std::string POINT_LIGHT_COUNT = _un(Core::StandardUniform::PointLightCount);
 const std::string DIRECTIONAL_LIGHT_COUNT = _un(Core::StandardUniform::DirectionalLightCount);
+const std::string LIGHT_CLUSTER_GRID = _un(Core::StandardUniform::LightClusterGrid);
+const std::string LIGHT_CLUSTER_LIGHT_INDICES = _un(Core::StandardUniform::LightClusterLightIndices);
+const std::string LIGHT_CLUSTER_LIGHT_DATA = _un(Core::StandardUniform::LightClusterLightData);
+const std::string LIGHT_CLUSTER_DIMENSIONS = _un(Core::StandardUniform::LightClusterDimensions);
+const std::string LIGHT_CLUSTER_DEPTH_PARAMS = _un(Core::StandardUniform::LightClusterDepthParams);
+const std::string LIGHT_CLUSTER_ENABLED = _un(Core::StandardUniform::LightClusterEnabled);
 const std::string MAX_IBL_LOD_LEVELS = std::to_string(Core::Constants::MaxIBLLODLevels);
 
 const std::string POSITION_DEF = "in vec4 " + POSITION + ";\n";
@@ -74,6 +85,8 @@ const std::string ALBEDO_UV_DEF = "in vec2 " + ALBEDO_UV + ";\n";
 const std::string NORMAL_UV_DEF = "in vec2 " + NORMAL_UV + ";\n";
 const std::string BONE_INDEX_DEF = "in ivec4 " + BONE_INDEX + ";\n";
 const std::string BONE_WEIGHT_DEF = "in vec4 " + BONE_WEIGHT + ";\n";
+const std::string INSTANCE_MODEL_MATRIX_DEF = "in mat4 " + INSTANCE_MODEL_MATRIX + ";\n";
+const std::string INSTANCE_MODEL_INVERSE_TRANSPOSE_MATRIX_DEF = "in mat3 " + INSTANCE_MODEL_INVERSE_TRANSPOSE_MATRIX + ";\n";
 
 const std::string MODEL_MATRIX_DEF = "uniform mat4 " + MODEL_MATRIX + ";\n";
 const std::string MODEL_INVERSE_TRANSPOSE_MATRIX_DEF = "uniform mat4 " + MODEL_INVERSE_TRANSPOSE_MATRIX + ";\n";
@@ -82,8 +95,11 @@ const std::string PROJECTION_MATRIX_DEF = "uniform mat4 " + PROJECTION_MATRIX +
 const std::string CAMERA_POSITION_DEF = "uniform vec4 " + CAMERA_POSITION + ";\n";
 const std::string TEXTURE0_DEF = "uniform sampler2D " + TEXTURE0 + ";\n";
 const std::string DEPTH_TEXTURE_DEF = "uniform sampler2D " + DEPTH_TEXTURE + ";\n";
-const std::string BONES_DEF = "uniform mat4 " + BONES + "[" + MAX_BONES + "];\n";
+const std::string SKINNING_PALETTE_DEF = "uniform sampler2D " + SKINNING_PALETTE + ";\n";
+const std::string SKINNING_ROOT_INVERSE_MATRIX_DEF = "uniform mat4 " + SKINNING_ROOT_INVERSE_MATRIX + ";\n";
 const std::string SKINNING_ENABLED_DEF = "uniform int " + SKINNING_ENABLED + ";\n";
+const std::string SKINNING_MODE_DEF = "uniform int " + SKINNING_MODE + ";\n";
+const std::string INSTANCING_ENABLED_DEF = "uniform int " + INSTANCING_ENABLED + ";\n";
 
 // ------------------------------------
 // Single-pass lighting definitions
@@ -135,10 +151,13 @@ const std::string DIRECTIONAL_LIGHT_DEF = "unfirm int " + DIRECTIONAL_LIGHT_COUN
 const std::string AMBIENTL_LIGHT_DEF = "unfirm int " + AMBIENT_LIGHT_COUNT + ";\n";
 const std::string AMBIENTL_IBL_LIGHT_DEF = "unfirm int " + AMBIENT_IBL_LIGHT_COUNT + ";\n";
 const std::string LIGHT_COUNT_DEF = "uniform int " + LIGHT_COUNT + ";\n";
+// Number of light slots whose samplers are declared and used, MAX_LIGHTS unless the including shader defines it
+// as less. Every slot takes several texture units, so this keeps the shader within the driver's sampler limit.
+const std::string MULTI_LIGHT_COUNT_DEF = "#ifndef MULTI_LIGHT_COUNT\n#define MULTI_LIGHT_COUNT " + MAX_LIGHTS + "\n#endif\n";
 // Single-pass ambient IBL light parameters
-const std::string LIGHT_IRRADIANCE_MAP_DEF = "uniform samplerCube " + LIGHT_IRRADIANCE_MAP + "[" + MAX_LIGHTS + "];\n";
-const std::string LIGHT_SPECULAR_IBL_PREFILTERED_MAP_DEF = "uniform samplerCube " + LIGHT_SPECULAR_IBL_PREFILTERED_MAP + "[" + MAX_LIGHTS + "];\n";
-const std::string LIGHT_SPECULAR_IBL_BRDF_MAP_DEF = "uniform sampler2D " + LIGHT_SPECULAR_IBL_BRDF_MAP + "[" + MAX_LIGHTS + "];\n";
+const std::string LIGHT_IRRADIANCE_MAP_DEF = "uniform samplerCube " + LIGHT_IRRADIANCE_MAP + "[MULTI_LIGHT_COUNT];\n";
+const std::string LIGHT_SPECULAR_IBL_PREFILTERED_MAP_DEF = "uniform samplerCube " + LIGHT_SPECULAR_IBL_PREFILTERED_MAP + "[MULTI_LIGHT_COUNT];\n";
+const std::string LIGHT_SPECULAR_IBL_BRDF_MAP_DEF = "uniform sampler2D " + LIGHT_SPECULAR_IBL_BRDF_MAP + "[MULTI_LIGHT_COUNT];\n";
 // Common multi-pass light parameters
 const std::string LIGHT_COLOR_DEF = "uniform vec4 " + LIGHT_COLOR + "[" + MAX_LIGHTS + "];\n";
 const std::string LIGHT_INTENSITY_DEF = "uniform float " + LIGHT_INTENSITY + "[" + MAX_LIGHTS + "];\n";
@@ -154,7 +173,7 @@ const std::string LIGHT_ANGULAR_SHADOW_BIAS_DEF ="uniform float " + LIGHT_ANGULA
 const std::string LIGHT_POSITION_DEF = "uniform vec4 " + LIGHT_POSITION + "[" + MAX_LIGHTS + "];\n";
 const std::string LIGHT_ATTENUATION_DEF = "uniform float " + LIGHT_ATTENUATION + "[" + MAX_LIGHTS + "];\n";;
 const std::string LIGHT_RANGE_DEF = "uniform float " + LIGHT_RANGE + "[" + MAX_LIGHTS + "];\n";
-const std::string LIGHT_SHADOW_CUBE_MAP_DEF = "uniform samplerCube " + LIGHT_SHADOW_CUBE_MAP + "[" + MAX_LIGHTS + "];\n";
+const std::string LIGHT_SHADOW_CUBE_MAP_DEF = "uniform samplerCube " + LIGHT_SHADOW_CUBE_MAP + "[MULTI_LIGHT_COUNT];\n";
 const std::string LIGHT_NEAR_PLANE_DEF = "uniform float " + LIGHT_NEAR_PLANE + "[" + MAX_LIGHTS + "];\n";
 // Multi-pass directional light parameters
 const std::string LIGHT_DIRECTION_DEF = "uniform vec4 " + LIGHT_DIRECTION + "[" + MAX_LIGHTS + "];\n";
@@ -162,14 +181,21 @@ const std::string LIGHT_VIEW_PROJECTION_DEF = "uniform mat4 " + LIGHT_VIEW_PROJE
 const std::string LIGHT_CASCADE_COUNT_DEF = "uniform int " + LIGHT_CASCADE_COUNT + "[" + MAX_CASCADES_LIGHTS + "];\n";
 
 #ifdef MANUAL_2D_SHADOWS
-const std::string LIGHT_SHADOW_MAP_DEF = "uniform sampler2D " + LIGHT_SHADOW_MAP + "[" + MAX_CASCADES_LIGHTS + "];\n";
+const std::string LIGHT_SHADOW_MAP_DEF = "uniform sampler2D " + LIGHT_SHADOW_MAP + "[" + MAX_CASCADES + " * MULTI_LIGHT_COUNT];\n";
 #else
-const std::string LIGHT_SHADOW_MAP_DEF = "uniform sampler2DShadow " + LIGHT_SHADOW_MAP + "[" + MAX_CASCADES_LIGHTS + "];\n";
+const std::string LIGHT_SHADOW_MAP_DEF = "uniform sampler2DShadow " + LIGHT_SHADOW_MAP + "[" + MAX_CASCADES + " * MULTI_LIGHT_COUNT];\n";
 #endif
 const std::string LIGHT_CASCADE_END_DEF = "uniform float " + LIGHT_CASCADE_END + "[" + MAX_CASCADES_LIGHTS + "];\n";
 const std::string LIGHT_SHADOW_MAP_ASPECT_DEF = "uniform float " + LIGHT_SHADOW_MAP_ASPECT + "[" + MAX_CASCADES_LIGHTS + "];\n";
 const std::string MAX_CASCADES_DEF = "const int MAX_CASCADES =" + MAX_CASCADES + ";\n";
 
+// Entry points into the lighting functions; [litColorBlinnPhong<N>] and [litColorPhysical<N>] are
+// the per-light versions generated by including "Lighting" & "PhysicalLighting" with lightIndex=N.
+const std::string LIT_COLOR_BLINN_PHONG_SIG = "vec4 litColorBlinnPhong(in vec4 albedo, in vec4 worldPos, in vec3 worldNormal, in vec4 cameraPos)";
+const std::string LIT_COLOR_BLINN_PHONG_ARGS = "albedo, worldPos, worldNormal, cameraPos";
+const std::string LIT_COLOR_PHYSICAL_SIG = "vec4 litColorPhysical(in vec4 albedo, in vec4 worldPos, in vec3 worldNormal, in vec4 cameraPos, in float metallic, in float roughness, in float ao)";
+const std::string LIT_COLOR_PHYSICAL_ARGS = "albedo, worldPos, worldNormal, cameraPos, metallic, roughness, ao";
+
 namespace Core {
 
     const std::string ShaderManagerGL::BaseString("");
@@ -202,6 +228,8 @@ namespace Core {
         this->setShaderSource(ShaderType::Vertex, "LightingMulti", ShaderManagerGL::Lighting_Multi_vertex);
         this->setShaderSource(ShaderType::Fragment, "LightingMulti", ShaderManagerGL::Lighting_Multi_fragment);
 
+        this->setShaderSource(ShaderType::Fragment, "LightingCommon", ShaderManagerGL::Lighting_Common_fragment);
+
         this->setShaderSource(ShaderType::Vertex, "Lighting", ShaderManagerGL::Lighting_vertex);
         this->setShaderSource(ShaderType::Fragment, "Lighting", ShaderManagerGL::Lighting_fragment);
 
@@ -210,18 +238,47 @@ namespace Core {
         this->setShaderSource(ShaderType::Vertex, "PhysicalCommon", ShaderManagerGL::PhysicalCommon_vertex);
         this->setShaderSource(ShaderType::Fragment, "PhysicalCommon", ShaderManagerGL::PhysicalCommon_fragment);
 
+        this->setShaderSource(ShaderType::Fragment, "PhysicalLightingCommon", ShaderManagerGL::Physical_Lighting_Common_fragment);
+
         this->setShaderSource(ShaderType::Vertex, "PhysicalLightingSingle", ShaderManagerGL::Physical_Lighting_Single_vertex);
         this->setShaderSource(ShaderType::Fragment, "PhysicalLightingSingle", ShaderManagerGL::Physical_Lighting_Single_fragment);
 
         this->setShaderSource(ShaderType::Vertex, "PhysicalLightingMulti", ShaderManagerGL::Physical_Lighting_Multi_vertex);
         this->setShaderSource(ShaderType::Fragment, "PhysicalLightingMulti", ShaderManagerGL::Physical_Lighting_Multi_fragment);
 
+        this->setShaderSource(ShaderType::Fragment, "LightingClustered", ShaderManagerGL::Lighting_Clustered_fragment);
+
+        this->setShaderSource(ShaderType::Vertex, "PhysicalLightingClustered", ShaderManagerGL::Physical_Lighting_Clustered_vertex);
+        this->setShaderSource(ShaderType::Fragment, "PhysicalLightingClustered", ShaderManagerGL::Physical_Lighting_Clustered_fragment);
+
         this->setShaderSource(ShaderType::Vertex, "PhysicalLighting", ShaderManagerGL::Physical_Lighting_vertex);
         this->setShaderSource(ShaderType::Fragment, "PhysicalLighting", ShaderManagerGL::Physical_Lighting_fragment);
 
         this->setShaderSource(ShaderType::Vertex, "StandardPhysical", ShaderManagerGL::StandardPhysical_vertex);
         this->setShaderSource(ShaderType::Fragment, "StandardPhysical", ShaderManagerGL::StandardPhysical_fragment);
 
+        this->setShaderSource(ShaderType::Vertex, "StandardPhysicalMultiLight", ShaderManagerGL::StandardPhysicalMultiLight_vertex);
+        this->setShaderSource(ShaderType::Fragment, "StandardPhysicalMultiLight", ShaderManagerGL::StandardPhysicalMultiLight_fragment);
+
+        // "StandardPhysicalMultiLight<N>" only has samplers for N lights, see StandardPhysicalMultiLightMaterial::build()
+        for (UInt32 i = 1; i <= Constants::MaxShaderLights; i++) {
+            std::string multiLightSource =
+                "#version 330\n"
+                "precision highp float;\n"
+                "#define MULTI_LIGHT_COUNT " + std::to_string(i) + "\n"
+                "#include \"PhysicalLightingMulti\" \n"
+                "#include \"StandardPhysicalBody\" \n";
+            std::string name = "StandardPhysicalMultiLight" + std::to_string(i);
+            this->setShaderSource(ShaderType::Vertex, name, multiLightSource);
+            this->setShaderSource(ShaderType::Fragment, name, multiLightSource);
+        }
+
+        this->setShaderSource(ShaderType::Vertex, "StandardPhysicalClustered", ShaderManagerGL::StandardPhysicalClustered_vertex);
+        this->setShaderSource(ShaderType::Fragment, "StandardPhysicalClustered", ShaderManagerGL::StandardPhysicalClustered_fragment);
+
+        this->setShaderSource(ShaderType::Vertex, "StandardPhysicalBody", ShaderManagerGL::StandardPhysical_Body_vertex);
+        this->setShaderSource(ShaderType::Fragment, "StandardPhysicalBody", ShaderManagerGL::StandardPhysical_Body_fragment);
+
         this->setShaderSource(ShaderType::Vertex, "AmbientPhysical", ShaderManagerGL::AmbientPhysical_vertex);
         this->setShaderSource(ShaderType::Fragment, "AmbientPhysical", ShaderManagerGL::AmbientPhysical_fragment);
 
@@ -243,6 +300,9 @@ namespace Core {
         this->setShaderSource(ShaderType::Vertex, "VertexSkinning", ShaderManagerGL::VertexSkinning_vertex);
         this->setShaderSource(ShaderType::Fragment, "VertexSkinning", ShaderManagerGL::VertexSkinning_fragment);
 
+        this->setShaderSource(ShaderType::Vertex, "VertexInstancing", ShaderManagerGL::VertexInstancing_vertex);
+        this->setShaderSource(ShaderType::Fragment, "VertexInstancing", ShaderManagerGL::VertexInstancing_fragment);
+
         this->setShaderSource(ShaderType::Vertex, "Depth", ShaderManagerGL::Depth_vertex);
         this->setShaderSource(ShaderType::Fragment, "Depth", ShaderManagerGL::Depth_fragment);
 
@@ -466,7 +526,8 @@ namespace Core {
             "out float _core_viewSpacePosZ[" + MAX_LIGHTS + "];\n";
 
         this->Lighting_Header_Multi_fragment =
-            MAX_CASCADES_DEF
+            MULTI_LIGHT_COUNT_DEF
+            + MAX_CASCADES_DEF
             + MAX_LIGHTS_DEF
             + LIGHT_COUNT_DEF
             + LIGHT_CASCADE_COUNT_DEF
@@ -536,37 +597,85 @@ namespace Core {
 
         this->Lighting_Single_fragment =
             "#include \"LightingHeaderSingle\" \n"
-            "#include \"Lighting\" \n";
+            "#include \"LightingCommon\" \n"
+            "#include \"Lighting(lightIndex=0)\" \n"
+            + LIT_COLOR_BLINN_PHONG_SIG + " {\n"
+            "    return litColorBlinnPhong0(" + LIT_COLOR_BLINN_PHONG_ARGS + ");\n"
+            "}\n";
 
         this->Lighting_Multi_vertex =
             "#include \"LightingHeaderMulti\" \n"
             "#include \"Lighting\" \n";
 
+        // the multi-light variants instantiate the per-light lighting functions once for each of the
+        // [MULTI_LIGHT_COUNT] slots and accumulate the first [LIGHT_COUNT] of them in a single pass. slots
+        // beyond [MULTI_LIGHT_COUNT] are compiled out so their samplers don't count against the driver's limit.
+        std::string multiLightIncludes;
+        std::string multiLightBlinnPhong;
+        std::string multiLightPhysical;
+        for (UInt32 i = 0; i < Constants::MaxShaderLights; i++) {
+            std::string index = std::to_string(i);
+            std::string slotGuard = "#if MULTI_LIGHT_COUNT > " + index + "\n";
+            multiLightIncludes += slotGuard + "#include \"Lighting(lightIndex=" + index + ")\" \n#endif\n";
+            multiLightBlinnPhong += slotGuard +
+                "    if (" + LIGHT_COUNT + " > " + index + ") { \n"
+                "        lightColor = litColorBlinnPhong" + index + "(" + LIT_COLOR_BLINN_PHONG_ARGS + "); \n"
+                "        color = vec4(color.rgb + lightColor.rgb, min(color.a + lightColor.a, 1.0)); \n"
+                "    } \n"
+                "#endif\n";
+            multiLightPhysical += slotGuard +
+                "    if (" + LIGHT_COUNT + " > " + index + ") { \n"
+                "        lightColor = litColorPhysical" + index + "(" + LIT_COLOR_PHYSICAL_ARGS + "); \n"
+                "        color = vec4(color.rgb + lightColor.rgb, min(color.a + lightColor.a, 1.0)); \n"
+                "    } \n"
+                "#endif\n";
+        }
+
+        std::string multiLightBlinnPhongSum =
+            LIT_COLOR_BLINN_PHONG_SIG + " {\n"
+            "    vec4 color = vec4(0.0, 0.0, 0.0, 0.0); \n"
+            "    vec4 lightColor; \n"
+            + multiLightBlinnPhong +
+            "    return color; \n"
+            "}\n";
+
+        std::string multiLightPhysicalSum =
+            LIT_COLOR_PHYSICAL_SIG + " {\n"
+            "    vec4 color = vec4(0.0, 0.0, 0.0, 0.0); \n"
+            "    vec4 lightColor; \n"
+            + multiLightPhysical +
+            "    return color; \n"
+            "}\n";
+
         this->Lighting_Multi_fragment =
             "#include \"LightingHeaderMulti\" \n"
-            "#include \"Lighting\" \n";
+            "#include \"LightingCommon\" \n"
+            + multiLightIncludes
+            + multiLightBlinnPhongSum;
 
         this->Lighting_vertex = 
-            "#define TRANSFER_LIGHTING(localPos, clipSpacePos, viewSpacePos) "
+            "#define TRANSFER_LIGHTING_WORLD(worldPos, clipSpacePos, viewSpacePos) "
             "for (int l = 0 ; l < " + MAX_CASCADES + " * " + LIGHT_COUNT + "; l++) { "
-            "    _core_lightSpacePos[l] = " + LIGHT_VIEW_PROJECTION + "[l] * " + MODEL_MATRIX + " * (localPos); "
+            "    _core_lightSpacePos[l] = " + LIGHT_VIEW_PROJECTION + "[l] * (worldPos); "
             "}"
             "for (int i = 0 ; i < " + LIGHT_COUNT + "; i++) { "
             "_core_viewSpacePosZ[i] = abs(viewSpacePos.z);"
-            "}";
+            "}\n"
+            "#define TRANSFER_LIGHTING(localPos, clipSpacePos, viewSpacePos) "
+            "TRANSFER_LIGHTING_WORLD(" + MODEL_MATRIX + " * (localPos), clipSpacePos, viewSpacePos)";
 
-        this->Lighting_Dir_Cascade_fragment = "vec3 calcDirShadowFactorCoordsSingleIndex@cascadeIndex(vec2 uv, float fragDepth, float angularBias) { \n"
+        this->Lighting_Dir_Cascade_fragment = "vec3 calcDirShadowFactorCoordsSingleIndex@lightIndex_@cascadeIndex(vec2 uv, float fragDepth, float angularBias) { \n"
             "   return vec3(uv.xy, fragDepth - angularBias - " + LIGHT_CONSTANT_SHADOW_BIAS + "[@lightIndex]); \n"
             "} \n"
 
-            "float calcDirShadowFactor@cascadeIndex(float angularBias, vec4 fragPos)\n"
+            "float calcDirShadowFactor@lightIndex_@cascadeIndex(float angularBias, vec4 fragPos)\n"
             "{ \n"
             "    int offset = @lightIndex * " + MAX_CASCADES + " + @cascadeIndex;\n"
             "    vec4 lightSpacePos = _core_lightSpacePos[offset]; \n"
             "    vec3 projCoords = lightSpacePos.xyz / lightSpacePos.w; \n"
             "    vec3 uvCoords = (projCoords * 0.5) + vec3(0.5, 0.5, 0.5); \n"
             "    float px = 1.0 / " + LIGHT_SHADOW_MAP_SIZE + "[@lightIndex]; \n"
-            "    float py =  " + LIGHT_SHADOW_MAP_ASPECT + "[@cascadeIndex] / " + LIGHT_SHADOW_MAP_SIZE + "[@lightIndex]; \n"
+            "    float py =  " + LIGHT_SHADOW_MAP_ASPECT + "[@lightIndex * " + MAX_CASCADES + " + @cascadeIndex] / " + LIGHT_SHADOW_MAP_SIZE + "[@lightIndex]; \n"
 
             "    float shadowFactor = 0.0; \n"
             "    vec2 uv = uvCoords.xy; \n"
@@ -580,10 +689,10 @@ namespace Core {
             "            for (int x = -" + LIGHT_SHADOW_SOFTNESS + "[@lightIndex]; x <= " + LIGHT_SHADOW_SOFTNESS + "[@lightIndex] ; x++) { \n"
             "                vec2 coords2D = vec2(uv.x + x * px, uv.y + y * py); \n"
 #ifdef MANUAL_2D_SHADOWS
-            "                float shadowDepth = clamp(texture(" + LIGHT_SHADOW_MAP + "[@cascadeIndex], coords2D).r, 0.0, 1.0); \n"
+            "                float shadowDepth = clamp(texture(" + LIGHT_SHADOW_MAP + "[@lightIndex * " + MAX_CASCADES + " + @cascadeIndex], coords2D).r, 0.0, 1.0); \n"
 #else
-            "                vec3 coords = calcDirShadowFactorCoordsSingleIndex@cascadeIndex(coords2D, z, angularBias); \n"
-            "                float shadowDepth = clamp(texture(" + LIGHT_SHADOW_MAP + "[@cascadeIndex], coords), 0.0, 1.0); \n"
+            "                vec3 coords = calcDirShadowFactorCoordsSingleIndex@lightIndex_@cascadeIndex(coords2D, z, angularBias); \n"
+            "                float shadowDepth = clamp(texture(" + LIGHT_SHADOW_MAP + "[@lightIndex * " + MAX_CASCADES + " + @cascadeIndex], coords), 0.0, 1.0); \n"
 #endif
             "                shadowFactor += (1.0-shadowDepth); \n"
             "            } \n"
@@ -593,10 +702,10 @@ namespace Core {
             "    } \n"
             "    else { \n"
 #ifdef MANUAL_2D_SHADOWS
-            "        float shadowDepth = clamp(texture(" + LIGHT_SHADOW_MAP + "[@cascadeIndex], uv).r, 0.0, 1.0); \n"
+            "        float shadowDepth = clamp(texture(" + LIGHT_SHADOW_MAP + "[@lightIndex * " + MAX_CASCADES + " + @cascadeIndex], uv).r, 0.0, 1.0); \n"
 #else
-            "        vec3 coords = calcDirShadowFactorCoordsSingleIndex@cascadeIndex(uv, z, angularBias); \n"
-            "        float shadowDepth = clamp(texture(" + LIGHT_SHADOW_MAP + "[@cascadeIndex], coords), 0.0, 1.0); \n"
+            "        vec3 coords = calcDirShadowFactorCoordsSingleIndex@lightIndex_@cascadeIndex(uv, z, angularBias); \n"
+            "        float shadowDepth = clamp(texture(" + LIGHT_SHADOW_MAP + "[@lightIndex * " + MAX_CASCADES + " + @cascadeIndex], coords), 0.0, 1.0); \n"
 #endif
             "        shadowFactor += (1.0-shadowDepth); \n"
             "    } \n"
@@ -604,10 +713,7 @@ namespace Core {
             "    return shadowFactor; \n"
             "} \n";
 
-        this->Lighting_fragment =
-            "#include \"LightingDirCascade(lightIndex=@lightIndex,cascadeIndex=0)\"\n"
-            "#include \"LightingDirCascade(lightIndex=@lightIndex,cascadeIndex=1)\"\n"
-            "#include \"LightingDirCascade(lightIndex=@lightIndex,cascadeIndex=2)\"\n"
+        this->Lighting_Common_fragment =
             "const float PI = 3.14159265359;\n"
             "const int AMBIENT_LIGHT = 0;\n"
             "const int AMBIENT_IBL_LIGHT = 1;\n"
@@ -616,7 +722,28 @@ namespace Core {
             "const int SPOT_LIGHT = 4;\n"
             "const int PLANAR_LIGHT = 5;\n"
 
-            "vec4 getDirLightColor(vec4 worldPos, float bias) { \n"
+            "vec3 calcMappedNormal(vec3 mappedNormal, vec3 normal, vec3 tangent) \n"
+            "{ \n"
+            "    normal = normalize(normal); \n "
+            "    tangent = normalize(tangent); \n "
+            "    tangent = normalize(tangent - dot(tangent, normal) * normal); \n "
+            "    vec3 biTangent = cross(tangent, normal); \n "
+            "    vec3 bumpMapNormal = mappedNormal; \n "
+            "    bumpMapNormal = 2.0 * bumpMapNormal - vec3(1.0, 1.0, 1.0); \n "
+            "    vec3 newNormal; \n "
+            "    mat3 tbn = mat3(tangent, biTangent, normal); \n "
+
+            "    newNormal = tbn * bumpMapNormal; \n "
+            "    newNormal = normalize(newNormal); \n "
+            "    return newNormal; \n "
+            "} \n ";
+
+        this->Lighting_fragment =
+            "#include \"LightingDirCascade(lightIndex=@lightIndex,cascadeIndex=0)\"\n"
+            "#include \"LightingDirCascade(lightIndex=@lightIndex,cascadeIndex=1)\"\n"
+            "#include \"LightingDirCascade(lightIndex=@lightIndex,cascadeIndex=2)\"\n"
+
+            "vec4 getDirLightColor@lightIndex(vec4 worldPos, float bias) { \n"
             "    float shadowFactor = 0.0;\n"
             "    vec3 lightColor = " + LIGHT_COLOR + "[@lightIndex].rgb; \n"
            /* "    for (int i = 0 ; i < " + LIGHT_CASCADE_COUNT + "[@lightIndex]; i++) { \n"
@@ -632,18 +759,18 @@ namespace Core {
             "      int offset1 = @lightIndex * " + MAX_CASCADES + " + 1;\n"
             "      int offset2 = @lightIndex * " + MAX_CASCADES + " + 2;\n"
             "      if (_core_viewSpacePosZ[@lightIndex] <= " + LIGHT_CASCADE_END + "[offset0]) { \n"
-            "          shadowFactor = calcDirShadowFactor0(bias, worldPos); \n"
+            "          shadowFactor = calcDirShadowFactor@lightIndex_0(bias, worldPos); \n"
             "      } else if (_core_viewSpacePosZ[@lightIndex] <= " + LIGHT_CASCADE_END + "[offset1]) { \n"
-            "          shadowFactor = calcDirShadowFactor1(bias, worldPos); \n"
+            "          shadowFactor = calcDirShadowFactor@lightIndex_1(bias, worldPos); \n"
             "      } else if (_core_viewSpacePosZ[@lightIndex] <= " + LIGHT_CASCADE_END + "[offset2]) { \n"
-            "          shadowFactor = calcDirShadowFactor2(bias, worldPos); \n"
+            "          shadowFactor = calcDirShadowFactor@lightIndex_2(bias, worldPos); \n"
             "      } \n"
             "    } \n"
 
             "    return vec4((1.0 - shadowFactor) * lightColor * " + LIGHT_INTENSITY + "[@lightIndex], 1.0);\n"    
             "} \n"
 
-            "float getPointLightShadowFactor(vec3 lightLocalPos, float bias) { \n"
+            "float getPointLightShadowFactor@lightIndex(vec3 lightLocalPos, float bias) { \n"
              "   vec4 shadowDepthVec = texture(" + LIGHT_SHADOW_CUBE_MAP + "[@lightIndex], lightLocalPos);\n"
             //"    vec4 shadowDepthVec = vec4(1000.0, 0.0, 0.0, 0.0); \n"
             "    float shadowDepth = shadowDepthVec.r;\n"
@@ -654,7 +781,7 @@ namespace Core {
             "    return shadowFactor;\n"
             "} \n"
 
-            "vec4 getPointLightColor(vec3 lightLocalPos, float bias) { \n"
+            "vec4 getPointLightColor@lightIndex(vec3 lightLocalPos, float bias) { \n"
             "    float pxToWorld = 1.0 / " + LIGHT_SHADOW_MAP_SIZE + "[@lightIndex] * 0.2; \n"
             "    float near = " + LIGHT_NEAR_PLANE + "[@lightIndex]; \n"
 
@@ -679,35 +806,35 @@ namespace Core {
             
             "    float shadowFactor = 0.0; \n"
             "    if (" + LIGHT_SHADOW_SOFTNESS + "[@lightIndex] == 2 || " + LIGHT_SHADOW_SOFTNESS + "[@lightIndex] == 1) { \n"
-            "        shadowFactor += getPointLightShadowFactor(lightLocalPos, bias); \n"
+            "        shadowFactor += getPointLightShadowFactor@lightIndex(lightLocalPos, bias); \n"
             "        for (int i = 1; i <= " + LIGHT_SHADOW_SOFTNESS + "[@lightIndex]; i++) { \n"
-            "            shadowFactor += getPointLightShadowFactor(lightLocalPos + right * i, bias); \n"
-            "            shadowFactor += getPointLightShadowFactor(lightLocalPos + up * i, bias); \n"
-            "            shadowFactor += getPointLightShadowFactor(lightLocalPos - right * i, bias); \n"
-            "            shadowFactor += getPointLightShadowFactor(lightLocalPos - up * i, bias); \n"
-            "            shadowFactor += getPointLightShadowFactor(lightLocalPos + right * i + up * i, bias); \n"
-            "            shadowFactor += getPointLightShadowFactor(lightLocalPos + right * i - up * i, bias); \n"
-            "            shadowFactor += getPointLightShadowFactor(lightLocalPos - right * i + up * i, bias); \n"
-            "            shadowFactor += getPointLightShadowFactor(lightLocalPos - right * i - up * i, bias); \n"
+            "            shadowFactor += getPointLightShadowFactor@lightIndex(lightLocalPos + right * i, bias); \n"
+            "            shadowFactor += getPointLightShadowFactor@lightIndex(lightLocalPos + up * i, bias); \n"
+            "            shadowFactor += getPointLightShadowFactor@lightIndex(lightLocalPos - right * i, bias); \n"
+            "            shadowFactor += getPointLightShadowFactor@lightIndex(lightLocalPos - up * i, bias); \n"
+            "            shadowFactor += getPointLightShadowFactor@lightIndex(lightLocalPos + right * i + up * i, bias); \n"
+            "            shadowFactor += getPointLightShadowFactor@lightIndex(lightLocalPos + right * i - up * i, bias); \n"
+            "            shadowFactor += getPointLightShadowFactor@lightIndex(lightLocalPos - right * i + up * i, bias); \n"
+            "            shadowFactor += getPointLightShadowFactor@lightIndex(lightLocalPos - right * i - up * i, bias); \n"
             "        } \n "
             "        if (" + LIGHT_SHADOW_SOFTNESS + "[@lightIndex] == 2) shadowFactor /= 17.0; \n"
             "        else shadowFactor /= 9.0; \n"
             "    } \n"
             "    else { \n"
-            "        shadowFactor += getPointLightShadowFactor(lightLocalPos, bias); \n"
+            "        shadowFactor += getPointLightShadowFactor@lightIndex(lightLocalPos, bias); \n"
             "    } \n"       
            
             "   return vec4(" + LIGHT_COLOR + "[@lightIndex].rgb * shadowFactor * " + LIGHT_INTENSITY + "[@lightIndex], 1.0);\n"
             "}\n"
 
-            "void getDirLightParameters(in vec3 worldNormal, in vec3 toViewer, out vec3 toLight, out vec3 halfwayVec, out float NdotL, out float bias) { \n"
+            "void getDirLightParameters@lightIndex(in vec3 worldNormal, in vec3 toViewer, out vec3 toLight, out vec3 halfwayVec, out float NdotL, out float bias) { \n"
             "    toLight = vec3(-" + LIGHT_DIRECTION + "[@lightIndex]);\n"
             "    NdotL = max(cos(acos(dot(toLight, worldNormal)) * 1.1), 0.0); \n"  
             "    halfwayVec = normalize(toViewer + toLight); \n"
             "    bias = (1.0 - NdotL) * " + LIGHT_ANGULAR_SHADOW_BIAS + "[@lightIndex];"
             "} \n"
 
-            "void getPointLightParameters(in vec4 worldPos, in vec3 worldNormal, in vec3 toViewer, out vec3 lightLocalPos, out vec3 toLight, out vec3 halfwayVec, out float NdotL, out float bias, out float attenuation) { \n"
+            "void getPointLightParameters@lightIndex(in vec4 worldPos, in vec3 worldNormal, in vec3 toViewer, out vec3 lightLocalPos, out vec3 toLight, out vec3 halfwayVec, out float NdotL, out float bias, out float attenuation) { \n"
             "    lightLocalPos = vec3(" + LIGHT_MATRIX + "[@lightIndex] * worldPos);\n"
             "    toLight = vec3(" + LIGHT_POSITION + "[@lightIndex] - worldPos);\n"
             "    float distance = length(toLight); \n"
@@ -718,7 +845,7 @@ namespace Core {
             "    bias = (1.0 - NdotL) * " + LIGHT_ANGULAR_SHADOW_BIAS + "[@lightIndex] + " + LIGHT_CONSTANT_SHADOW_BIAS + "[@lightIndex];\n"
             "} \n"
 
-            "vec4 litColorBlinnPhong(in vec4 albedo, in vec4 worldPos, in vec3 worldNormal, in vec4 cameraPos) {\n"
+            "vec4 litColorBlinnPhong@lightIndex(in vec4 albedo, in vec4 worldPos, in vec3 worldNormal, in vec4 cameraPos) {\n"
             "    if (" + LIGHT_ENABLED + "[@lightIndex] != 0) {\n"
             "        if (" + LIGHT_TYPE + "[@lightIndex] == AMBIENT_LIGHT) {\n"
             "            return vec4(albedo.rgb * " + LIGHT_COLOR + "[@lightIndex].rgb * " + LIGHT_INTENSITY + "[@lightIndex], albedo.a);\n"
@@ -729,36 +856,20 @@ namespace Core {
             "            float NdotL, bias, attenuation; \n"
             "            vec3 toViewer = vec3(cameraPos - worldPos); \n"
             "            if (" + LIGHT_TYPE + "[@lightIndex] == DIRECTIONAL_LIGHT) {\n"
-            "                getDirLightParameters(worldNormal, toViewer, toLight, halfwayVec, NdotL, bias); \n"
-            "                vec4 lightColor = getDirLightColor(worldPos, bias); \n"
+            "                getDirLightParameters@lightIndex(worldNormal, toViewer, toLight, halfwayVec, NdotL, bias); \n"
+            "                vec4 lightColor = getDirLightColor@lightIndex(worldPos, bias); \n"
             "                radiance = lightColor.rgb; \n"
             "            }\n"
             "            else if (" + LIGHT_TYPE + "[@lightIndex] == POINT_LIGHT) {\n"
-            "                getPointLightParameters(worldPos, worldNormal, toViewer, lightLocalPos, toLight, halfwayVec, NdotL, bias, attenuation); \n"
-            "                vec4 lightColor = getPointLightColor(lightLocalPos, bias);\n"
+            "                getPointLightParameters@lightIndex(worldPos, worldNormal, toViewer, lightLocalPos, toLight, halfwayVec, NdotL, bias, attenuation); \n"
+            "                vec4 lightColor = getPointLightColor@lightIndex(lightLocalPos, bias);\n"
             "                radiance = lightColor.rgb * attenuation; \n"
             "            }\n"
             "            return vec4(radiance * albedo.rgb * NdotL, albedo.a);\n"
             "        }\n"
             "    }\n"
             "    return albedo;\n"
-            "}\n"
-
-            "vec3 calcMappedNormal(vec3 mappedNormal, vec3 normal, vec3 tangent) \n"
-            "{ \n"
-            "    normal = normalize(normal); \n "
-            "    tangent = normalize(tangent); \n "
-            "    tangent = normalize(tangent - dot(tangent, normal) * normal); \n "
-            "    vec3 biTangent = cross(tangent, normal); \n "
-            "    vec3 bumpMapNormal = mappedNormal; \n "
-            "    bumpMapNormal = 2.0 * bumpMapNormal - vec3(1.0, 1.0, 1.0); \n "
-            "    vec3 newNormal; \n "
-            "    mat3 tbn = mat3(tangent, biTangent, normal); \n "
-
-            "    newNormal = tbn * bumpMapNormal; \n "
-            "    newNormal = normalize(newNormal); \n "
-            "    return newNormal; \n "
-            "} \n ";
+            "}\n";
 
         this->PhysicalCommon_vertex =
             "\n";
@@ -785,22 +896,120 @@ namespace Core {
 
         this->Physical_Lighting_Single_fragment =
             "#include \"LightingHeaderSingle\" \n"
+            "#include \"LightingCommon\" \n"
             "#include \"Lighting(lightIndex=0)\" \n"
-            "#include \"PhysicalLighting(lightIndex=0)\" \n";
+            "#include \"PhysicalLightingCommon\" \n"
+            "#include \"PhysicalLighting(lightIndex=0)\" \n"
+            + LIT_COLOR_BLINN_PHONG_SIG + " {\n"
+            "    return litColorBlinnPhong0(" + LIT_COLOR_BLINN_PHONG_ARGS + ");\n"
+            "}\n"
+            + LIT_COLOR_PHYSICAL_SIG + " {\n"
+            "    return litColorPhysical0(" + LIT_COLOR_PHYSICAL_ARGS + ");\n"
+            "}\n";
 
         this->Physical_Lighting_Multi_vertex =
             "#include \"LightingHeaderMulti\" \n"
             "#include \"Lighting\" \n";
 
+        std::string multiLightPhysicalIncludes;
+        for (UInt32 i = 0; i < Constants::MaxShaderLights; i++) {
+            std::string index = std::to_string(i);
+            multiLightPhysicalIncludes += "#if MULTI_LIGHT_COUNT > " + index + "\n#include \"PhysicalLighting(lightIndex=" + index + ")\" \n#endif\n";
+        }
+
         this->Physical_Lighting_Multi_fragment =
             "#include \"LightingHeaderMulti\" \n"
-            "#include \"Lighting(lightIndex=@lightIndex)\" \n"
-            "#include \"PhysicalLighting(lightIndex=@lightIndex)\" \n";
+            "#include \"LightingCommon\" \n"
+            + multiLightIncludes +
+            "#include \"PhysicalLightingCommon\" \n"
+            + multiLightPhysicalIncludes
+            + multiLightBlinnPhongSum
+            + multiLightPhysicalSum;
+
+        // Shades the unshadowed point lights binned by LightClusterGrid. The fragment's cluster is found from its
+        // screen-space tile and logarithmic view depth, then only the lights listed for that cluster are evaluated.
+        this->Lighting_Clustered_fragment =
+            PROJECTION_MATRIX_DEF
+            + VIEW_MATRIX_DEF +
+            "uniform sampler2D " + LIGHT_CLUSTER_GRID + ";\n"
+            "uniform sampler2D " + LIGHT_CLUSTER_LIGHT_INDICES + ";\n"
+            "uniform sampler2D " + LIGHT_CLUSTER_LIGHT_DATA + ";\n"
+            "uniform vec4 " + LIGHT_CLUSTER_DIMENSIONS + ";\n"
+            "uniform vec4 " + LIGHT_CLUSTER_DEPTH_PARAMS + ";\n"
+            "uniform int " + LIGHT_CLUSTER_ENABLED + ";\n"
+
+            "vec3 litColorPhysicalClustered(in vec4 albedo, in vec4 worldPos, in vec3 worldNormal, in vec4 cameraPos, in float metallic, in float roughness) {\n"
+            "    if (" + LIGHT_CLUSTER_ENABLED + " == 0) return vec3(0.0); \n"
+            "    vec4 viewPos = " + VIEW_MATRIX + " * worldPos; \n"
+            "    vec4 clipPos = " + PROJECTION_MATRIX + " * viewPos; \n"
+            "    vec2 screenPos = clamp((clipPos.xy / clipPos.w) * 0.5 + 0.5, 0.0, 0.9999); \n"
+            "    ivec2 tile = ivec2(screenPos * " + LIGHT_CLUSTER_DIMENSIONS + ".xy); \n"
+            "    int slice = int(floor(log(-viewPos.z) * " + LIGHT_CLUSTER_DEPTH_PARAMS + ".x + " + LIGHT_CLUSTER_DEPTH_PARAMS + ".y)); \n"
+            "    if (slice < 0 || slice >= int(" + LIGHT_CLUSTER_DIMENSIONS + ".z)) return vec3(0.0); \n"
+
+            "    int tilesX = int(" + LIGHT_CLUSTER_DIMENSIONS + ".x); \n"
+            "    int indexWidth = int(" + LIGHT_CLUSTER_DIMENSIONS + ".w); \n"
+            "    vec2 cluster = texelFetch(" + LIGHT_CLUSTER_GRID + ", ivec2(tile.y * tilesX + tile.x, slice), 0).xy; \n"
+            "    int offset = int(cluster.x); \n"
+            "    int count = int(cluster.y); \n"
+
+            "    vec3 V = normalize(vec3(cameraPos - worldPos)); \n"
+            "    vec3 F0 = mix(vec3(0.04), albedo.rgb, metallic); \n"
+            "    vec3 Lo = vec3(0.0); \n"
+            "    for (int i = 0; i < count; i++) { \n"
+            "        int index = offset + i; \n"
+            "        int lightIndex = int(texelFetch(" + LIGHT_CLUSTER_LIGHT_INDICES + ", ivec2(index % indexWidth, index / indexWidth), 0).r); \n"
+            "        vec4 positionRadius = texelFetch(" + LIGHT_CLUSTER_LIGHT_DATA + ", ivec2(lightIndex, 0), 0); \n"
+            "        vec3 lightColor = texelFetch(" + LIGHT_CLUSTER_LIGHT_DATA + ", ivec2(lightIndex, 1), 0).rgb; \n"
+
+            "        vec3 toLight = positionRadius.xyz - worldPos.xyz; \n"
+            "        float distance = length(toLight); \n"
+            "        if (distance >= positionRadius.w) continue; \n"
+            "        toLight = toLight / distance; \n"
+            "        vec3 halfwayVec = normalize(V + toLight); \n"
+            "        float NdotL = max(dot(worldNormal, toLight), 0.0); \n"
+
+            // same falloff as the regular point lights, windowed so it reaches zero at the light's radius
+            "        float window = clamp(1.0 - pow(distance / positionRadius.w, 4.0), 0.0, 1.0); \n"
+            "        float attenuation = clamp(positionRadius.w / (distance * distance), 0.0, 1.0) * window * window; \n"
+            "        vec3 radiance = lightColor * attenuation; \n"
+
+            "        float NDF = distributionGGX(worldNormal, halfwayVec, roughness); \n"
+            "        float G = geometrySmith(worldNormal, V, toLight, roughness); \n"
+            "        vec3 F = fresnelSchlick(max(dot(halfwayVec, V), 0.0), F0); \n"
+            "        vec3 kD = (vec3(1.0) - F) * (1.0 - metallic); \n"
+            "        vec3 specular = (NDF * G * F) / max(4.0 * max(dot(worldNormal, V), 0.0) * NdotL, 0.001); \n"
+            "        Lo += (kD * albedo.rgb / PI + specular) * radiance * NdotL; \n"
+            "    } \n"
+            "    return Lo; \n"
+            "}\n";
+
+        this->Physical_Lighting_Clustered_vertex =
+            "#include \"LightingHeaderSingle\" \n"
+            "#include \"Lighting\" \n";
+
+        this->Physical_Lighting_Clustered_fragment =
+            "#include \"LightingHeaderSingle\" \n"
+            "#include \"LightingCommon\" \n"
+            "#include \"Lighting(lightIndex=0)\" \n"
+            "#include \"PhysicalLightingCommon\" \n"
+            "#include \"PhysicalLighting(lightIndex=0)\" \n"
+            "#include \"LightingClustered\" \n"
+            + LIT_COLOR_BLINN_PHONG_SIG + " {\n"
+            "    return litColorBlinnPhong0(" + LIT_COLOR_BLINN_PHONG_ARGS + ");\n"
+            "}\n"
+            // a pass may carry only the clustered lights, in which case the regular light slot is disabled
+            + LIT_COLOR_PHYSICAL_SIG + " {\n"
+            "    vec4 color = vec4(0.0, 0.0, 0.0, albedo.a); \n"
+            "    if (" + LIGHT_ENABLED + "[0] != 0) color = litColorPhysical0(" + LIT_COLOR_PHYSICAL_ARGS + ");\n"
+            "    color.rgb += litColorPhysicalClustered(albedo, worldPos, worldNormal, cameraPos, metallic, roughness);\n"
+            "    return color;\n"
+            "}\n";
 
         this->Physical_Lighting_vertex =
             "\n";
 
-        this->Physical_Lighting_fragment =
+        this->Physical_Lighting_Common_fragment =
             "#include \"PhysicalCommon\" \n"
             "const float MAX_REFLECTION_LOD = " + MAX_IBL_LOD_LEVELS + "; \n"
             "float distributionGGX(vec3 N, vec3 H, float roughness) { \n"
@@ -880,9 +1089,10 @@ namespace Core {
                 
             "    vec3 sampleVec = tangent * H.x + bitangent * H.y + N * H.z; \n"
             "    return normalize(sampleVec); \n"
-            "} \n"
+            "} \n";
 
-            "vec4 litColorPhysical(in vec4 albedo, in vec4 worldPos, in vec3 worldNormal, in vec4 cameraPos, in float metallic, in float roughness, in float ao) {\n"
+        this->Physical_Lighting_fragment =
+            "vec4 litColorPhysical@lightIndex(in vec4 albedo, in vec4 worldPos, in vec3 worldNormal, in vec4 cameraPos, in float metallic, in float roughness, in float ao) {\n"
             "    if (" + LIGHT_ENABLED + "[@lightIndex] != 0) {\n"
             "        vec3 V = normalize(vec3(cameraPos - worldPos)); \n "
             "        vec3 F0 = vec3(0.04); \n "
@@ -913,13 +1123,13 @@ namespace Core {
             "            vec3 lightLocalPos, toLight, halfwayVec, radiance; \n"
             "            float NdotL, bias, attenuation; \n"  
             "            if (" + LIGHT_TYPE + "[@lightIndex] == DIRECTIONAL_LIGHT) {\n"
-            "                getDirLightParameters(worldNormal, V, toLight, halfwayVec, NdotL, bias); \n"
-            "                vec4 lightColor = getDirLightColor(worldPos, bias); \n"
+            "                getDirLightParameters@lightIndex(worldNormal, V, toLight, halfwayVec, NdotL, bias); \n"
+            "                vec4 lightColor = getDirLightColor@lightIndex(worldPos, bias); \n"
             "                radiance = lightColor.rgb; \n"
             "            }\n"
             "            else if (" + LIGHT_TYPE + "[@lightIndex] == POINT_LIGHT) {\n"
-            "                getPointLightParameters(worldPos, worldNormal, V, lightLocalPos, toLight, halfwayVec, NdotL, bias, attenuation); \n"
-            "                vec4 lightColor = getPointLightColor(lightLocalPos, bias);\n"
+            "                getPointLightParameters@lightIndex(worldPos, worldNormal, V, lightLocalPos, toLight, halfwayVec, NdotL, bias, attenuation); \n"
+            "                vec4 lightColor = getPointLightColor@lightIndex(lightLocalPos, bias);\n"
             "                radiance = lightColor.rgb * attenuation; \n"
             "            }\n"
 
@@ -950,7 +1160,23 @@ namespace Core {
             "#version 330\n"
             "precision highp float;\n"
             "#include \"PhysicalLightingSingle\" \n"
+            "#include \"StandardPhysicalBody\" \n";
+
+        this->StandardPhysicalMultiLight_vertex =  
+            "#version 330\n"
+            "precision highp float;\n"
+            "#include \"PhysicalLightingMulti\" \n"
+            "#include \"StandardPhysicalBody\" \n";
+
+        this->StandardPhysicalClustered_vertex =  
+            "#version 330\n"
+            "precision highp float;\n"
+            "#include \"PhysicalLightingClustered\" \n"
+            "#include \"StandardPhysicalBody\" \n";
+
+        this->StandardPhysical_Body_vertex =
             "#include \"VertexSkinning\" \n"
+            "#include \"VertexInstancing\" \n"
             + POSITION_DEF
             + TANGENT_DEF
             + COLOR_DEF
@@ -959,9 +1185,7 @@ namespace Core {
             + ALBEDO_UV_DEF
             + NORMAL_UV_DEF
             + PROJECTION_MATRIX_DEF
-            + VIEW_MATRIX_DEF
-            + MODEL_MATRIX_DEF
-            + MODEL_INVERSE_TRANSPOSE_MATRIX_DEF +
+            + VIEW_MATRIX_DEF +
             "out vec4 vColor;\n"
             "out vec3 vNormal;\n"
             "out vec3 vTangent;\n"
@@ -974,25 +1198,41 @@ namespace Core {
             "    vec4 localNormal = " + NORMAL + "; \n"
             "    vec4 localFaceNormal = " + FACE_NORMAL + "; \n"
             "    calculateSkinnedPositionAndNormals(localPos, localNormal, localFaceNormal); \n"
-            "    vWorldPos = " +  MODEL_MATRIX + " * localPos;\n"
+            "    mat4 modelInverseTransposeMatrix = getModelInverseTransposeMatrix();\n"
+            "    vWorldPos = getModelMatrix() * localPos;\n"
             "    vec4 viewSpacePos = " + VIEW_MATRIX + " * vWorldPos;\n"
             "    gl_Position = " + PROJECTION_MATRIX + " * " + VIEW_MATRIX + " * vWorldPos;\n"
             "    vAlbedoUV = " + ALBEDO_UV + ";\n"
             "    vNormalUV = " + NORMAL_UV + ";\n"
             "    vColor = " + COLOR + ";\n"
             "    vec4 eNormal = localNormal;\n"
-            "    vNormal = vec3(" + MODEL_INVERSE_TRANSPOSE_MATRIX + " * eNormal);\n"
+            "    vNormal = vec3(modelInverseTransposeMatrix * eNormal);\n"
             "    vec4 eTangent = " + TANGENT + ";\n"
-            "    vTangent = vec3(" + MODEL_INVERSE_TRANSPOSE_MATRIX + " * eTangent);\n"
-            "    vFaceNormal = vec3(" + MODEL_INVERSE_TRANSPOSE_MATRIX + " * localFaceNormal);\n"
-            "    TRANSFER_LIGHTING(localPos, gl_Position, viewSpacePos) \n"
+            "    vTangent = vec3(modelInverseTransposeMatrix * eTangent);\n"
+            "    vFaceNormal = vec3(modelInverseTransposeMatrix * localFaceNormal);\n"
+            "    TRANSFER_LIGHTING_WORLD(vWorldPos, gl_Position, viewSpacePos) \n"
             "}\n";
 
         this->StandardPhysical_fragment =   
             "#version 330\n"
             "precision highp float;\n"
             "#include \"PhysicalLightingSingle\"\n"
-            + CAMERA_POSITION_DEF +
+            "#include \"StandardPhysicalBody\" \n";
+
+        this->StandardPhysicalMultiLight_fragment =   
+            "#version 330\n"
+            "precision highp float;\n"
+            "#include \"PhysicalLightingMulti\"\n"
+            "#include \"StandardPhysicalBody\" \n";
+
+        this->StandardPhysicalClustered_fragment =   
+            "#version 330\n"
+            "precision highp float;\n"
+            "#include \"PhysicalLightingClustered\"\n"
+            "#include \"StandardPhysicalBody\" \n";
+
+        this->StandardPhysical_Body_fragment =
+            CAMERA_POSITION_DEF +
             "uniform int enabledMap; \n"
             "uniform vec4 albedo; \n"
             "uniform sampler2D albedoMap; \n"
@@ -1395,17 +1635,70 @@ namespace Core {
             "} \n";
 
 
+        // bone transforms are shared by every mesh bound to the same skeleton, so they are moved into the space
+        // of the mesh's root with SKINNING_ROOT_INVERSE_MATRIX. SKINNING_MODE selects between blending bone matrices
+        // (SkinningMode::Linear) and blending dual quaternions (SkinningMode::DualQuaternion).
         std::string BONE_TRANSFORM_DEF = 
-            "    mat4 boneTransform = " + BONES + "[" + BONE_INDEX + ".x] * " + BONE_WEIGHT + ".x;\n"
-            "    boneTransform += " + BONES + "[" + BONE_INDEX + ".y] * " + BONE_WEIGHT + ".y;\n"
-            "    boneTransform += " + BONES + "[" + BONE_INDEX + ".z] * " + BONE_WEIGHT + ".z; \n"
-            "    boneTransform += " + BONES + "[" + BONE_INDEX + ".w] * " + BONE_WEIGHT + ".w; \n";
+            "    mat4 boneTransform = getSkinningTransform(); \n";
         this->VertexSkinning_vertex =  
             SKINNING_ENABLED_DEF
-            + BONES_DEF 
+            + SKINNING_MODE_DEF
+            + SKINNING_PALETTE_DEF
+            + SKINNING_ROOT_INVERSE_MATRIX_DEF
             + BONE_WEIGHT_DEF
             + BONE_INDEX_DEF +
 
+            // in linear mode each bone matrix occupies four consecutive texels (one per column) of the skinning palette
+            "mat4 getBoneMatrix(int bone) {\n"
+            "    ivec2 texel = ivec2((bone % " + SKINNING_PALETTE_BONES_PER_ROW + ") * 4, bone / " + SKINNING_PALETTE_BONES_PER_ROW + "); \n"
+            "    return mat4(texelFetch(" + SKINNING_PALETTE + ", texel, 0), texelFetch(" + SKINNING_PALETTE + ", texel + ivec2(1, 0), 0), \n"
+            "                texelFetch(" + SKINNING_PALETTE + ", texel + ivec2(2, 0), 0), texelFetch(" + SKINNING_PALETTE + ", texel + ivec2(3, 0), 0)); \n"
+            "}\n"
+
+            "mat4 getLinearSkinningTransform() {\n"
+            "    mat4 boneTransform = getBoneMatrix(" + BONE_INDEX + ".x) * " + BONE_WEIGHT + ".x;\n"
+            "    boneTransform += getBoneMatrix(" + BONE_INDEX + ".y) * " + BONE_WEIGHT + ".y;\n"
+            "    boneTransform += getBoneMatrix(" + BONE_INDEX + ".z) * " + BONE_WEIGHT + ".z; \n"
+            "    boneTransform += getBoneMatrix(" + BONE_INDEX + ".w) * " + BONE_WEIGHT + ".w; \n"
+            "    return boneTransform; \n"
+            "}\n"
+
+            // in dual quaternion mode each bone occupies two texels: the rotation quaternion, then the dual quaternion.
+            // quaternions on the opposite hemisphere from the first bone are negated so the blend takes the short way around.
+            "void addBoneDualQuaternion(int bone, float weight, vec4 pivot, inout vec4 realPart, inout vec4 dualPart) {\n"
+            "    ivec2 texel = ivec2((bone % " + SKINNING_PALETTE_BONES_PER_ROW + ") * 2, bone / " + SKINNING_PALETTE_BONES_PER_ROW + "); \n"
+            "    vec4 boneReal = texelFetch(" + SKINNING_PALETTE + ", texel, 0); \n"
+            "    vec4 boneDual = texelFetch(" + SKINNING_PALETTE + ", texel + ivec2(1, 0), 0); \n"
+            "    if (dot(pivot, boneReal) < 0.0) weight = -weight; \n"
+            "    realPart += boneReal * weight; \n"
+            "    dualPart += boneDual * weight; \n"
+            "}\n"
+
+            "mat4 getDualQuaternionSkinningTransform() {\n"
+            "    ivec2 pivotTexel = ivec2((" + BONE_INDEX + ".x % " + SKINNING_PALETTE_BONES_PER_ROW + ") * 2, " + BONE_INDEX + ".x / " + SKINNING_PALETTE_BONES_PER_ROW + "); \n"
+            "    vec4 pivot = texelFetch(" + SKINNING_PALETTE + ", pivotTexel, 0); \n"
+            "    vec4 realPart = vec4(0.0); \n"
+            "    vec4 dualPart = vec4(0.0); \n"
+            "    addBoneDualQuaternion(" + BONE_INDEX + ".x, " + BONE_WEIGHT + ".x, pivot, realPart, dualPart); \n"
+            "    addBoneDualQuaternion(" + BONE_INDEX + ".y, " + BONE_WEIGHT + ".y, pivot, realPart, dualPart); \n"
+            "    addBoneDualQuaternion(" + BONE_INDEX + ".z, " + BONE_WEIGHT + ".z, pivot, realPart, dualPart); \n"
+            "    addBoneDualQuaternion(" + BONE_INDEX + ".w, " + BONE_WEIGHT + ".w, pivot, realPart, dualPart); \n"
+            "    float invLength = 1.0 / length(realPart); \n"
+            "    realPart *= invLength; \n"
+            "    dualPart *= invLength; \n"
+            "    vec3 t = 2.0 * (realPart.w * dualPart.xyz - dualPart.w * realPart.xyz + cross(realPart.xyz, dualPart.xyz)); \n"
+            "    float x = realPart.x, y = realPart.y, z = realPart.z, w = realPart.w; \n"
+            "    return mat4(1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y + w * z), 2.0 * (x * z - w * y), 0.0, \n"
+            "                2.0 * (x * y - w * z), 1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z + w * x), 0.0, \n"
+            "                2.0 * (x * z + w * y), 2.0 * (y * z - w * x), 1.0 - 2.0 * (x * x + y * y), 0.0, \n"
+            "                t, 1.0); \n"
+            "}\n"
+
+            "mat4 getSkinningTransform() {\n"
+            "    if (" + SKINNING_MODE + " == 1) return " + SKINNING_ROOT_INVERSE_MATRIX + " * getDualQuaternionSkinningTransform(); \n"
+            "    return " + SKINNING_ROOT_INVERSE_MATRIX + " * getLinearSkinningTransform(); \n"
+            "}\n"
+
             "void calculateSkinnedPositionAndNormals(inout vec4 skinnedPosition, inout vec4 skinnedNormal, inout vec4 skinnedFaceNormal) {\n"
             "    if (" + SKINNING_ENABLED + " == 1) { \n"
             +        BONE_TRANSFORM_DEF +
@@ -1432,18 +1725,39 @@ namespace Core {
 
         this->VertexSkinning_fragment = "";
 
+        // per-instance transforms are read from instanced vertex attributes when INSTANCING_ENABLED is
+        // set, the inverse-transpose is passed as a mat3 to stay within 16 attribute locations.
+        this->VertexInstancing_vertex =
+            INSTANCING_ENABLED_DEF
+            + MODEL_MATRIX_DEF
+            + MODEL_INVERSE_TRANSPOSE_MATRIX_DEF
+            + INSTANCE_MODEL_MATRIX_DEF
+            + INSTANCE_MODEL_INVERSE_TRANSPOSE_MATRIX_DEF +
+
+            "mat4 getModelMatrix() {\n"
+            "    if (" + INSTANCING_ENABLED + " == 1) return " + INSTANCE_MODEL_MATRIX + ";\n"
+            "    return " + MODEL_MATRIX + ";\n"
+            "}\n"
+
+            "mat4 getModelInverseTransposeMatrix() {\n"
+            "    if (" + INSTANCING_ENABLED + " == 1) return mat4(" + INSTANCE_MODEL_INVERSE_TRANSPOSE_MATRIX + ");\n"
+            "    return " + MODEL_INVERSE_TRANSPOSE_MATRIX + ";\n"
+            "}\n";
+
+        this->VertexInstancing_fragment = "";
+
         this->Depth_vertex =
             "#version 330\n"
             "precision highp float;\n"
             "#include \"VertexSkinning\" \n"
+            "#include \"VertexInstancing\" \n"
             + POSITION_DEF
             + PROJECTION_MATRIX_DEF
-            + VIEW_MATRIX_DEF
-            + MODEL_MATRIX_DEF +
+            + VIEW_MATRIX_DEF +
             "void main() {\n"
             "    vec4 localPos = " + POSITION + "; \n"
             "    calculateSkinnedPosition(localPos); \n"
-            "    gl_Position = " + PROJECTION_MATRIX + " * " + VIEW_MATRIX + " * " +  MODEL_MATRIX + " * localPos;\n"
+            "    gl_Position = " + PROJECTION_MATRIX + " * " + VIEW_MATRIX + " * getModelMatrix() * localPos;\n"
             "}\n";
 
         this->Depth_fragment =   
@@ -1457,15 +1771,15 @@ namespace Core {
         this->Distance_vertex =
             "#version 330\n"
             "#include \"VertexSkinning\" \n"
+            "#include \"VertexInstancing\" \n"
             + POSITION_DEF 
             + PROJECTION_MATRIX_DEF
-            + VIEW_MATRIX_DEF
-            + MODEL_MATRIX_DEF +
+            + VIEW_MATRIX_DEF +
             "out vec4 vPos;\n"
             "void main() {\n"
             "    vec4 localPos = " + POSITION + "; \n"
             "    calculateSkinnedPosition(localPos); \n"
-            "    vPos = " + VIEW_MATRIX + " * " +  MODEL_MATRIX + " * localPos;\n"
+            "    vPos = " + VIEW_MATRIX + " * getModelMatrix() * localPos;\n"
             "    gl_Position = " + PROJECTION_MATRIX + " * vPos;\n"
             "}\n";
 
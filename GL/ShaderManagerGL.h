@@ -40,6 +40,8 @@ namespace Core {
         std::string Lighting_Multi_vertex;
         std::string Lighting_Multi_fragment;
 
+        std::string Lighting_Common_fragment;
+
         std::string Lighting_vertex;
         std::string Lighting_fragment;
 
@@ -48,6 +50,8 @@ namespace Core {
         std::string PhysicalCommon_vertex;
         std::string PhysicalCommon_fragment;
 
+        std::string Physical_Lighting_Common_fragment;
+
         std::string Physical_Lighting_vertex;
         std::string Physical_Lighting_fragment;
 
@@ -57,9 +61,23 @@ namespace Core {
         std::string Physical_Lighting_Multi_vertex;
         std::string Physical_Lighting_Multi_fragment;
 
+        std::string Lighting_Clustered_fragment;
+
+        std::string Physical_Lighting_Clustered_vertex;
+        std::string Physical_Lighting_Clustered_fragment;
+
         std::string StandardPhysical_vertex;
         std::string StandardPhysical_fragment;
 
+        std::string StandardPhysicalMultiLight_vertex;
+        std::string StandardPhysicalMultiLight_fragment;
+
+        std::string StandardPhysicalClustered_vertex;
+        std::string StandardPhysicalClustered_fragment;
+
+        std::string StandardPhysical_Body_vertex;
+        std::string StandardPhysical_Body_fragment;
+
         std::string AmbientPhysical_vertex;
         std::string AmbientPhysical_fragment;
 
@@ -81,6 +99,9 @@ namespace Core {
         std::string VertexSkinning_vertex;
         std::string VertexSkinning_fragment;
 
+        std::string VertexInstancing_vertex;
+        std::string VertexInstancing_fragment;
+
         std::string Depth_vertex;
         std::string Depth_fragment;
 
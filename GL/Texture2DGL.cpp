@@ -34,10 +34,25 @@ namespace Core {
         this->setupTexture(width, height, nullptr);
     }
 
+    void Texture2DGL::updateRegion(UInt32 x, UInt32 y, UInt32 width, UInt32 height, const Byte* data) {
+        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
+
+        GLenum pixelFormat = graphicsGL->getGLPixelFormat(attributes.Format);
+        GLenum pixelType = graphicsGL->getGLPixelType(attributes.Format);
+
+        graphicsGL->bindTexture(GL_TEXTURE_2D, this->getTextureID());
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, pixelFormat, pixelType, data);
+        graphicsGL->bindTexture(GL_TEXTURE_2D, 0);
+    }
+
     void Texture2DGL::updateMipMaps() {
-        glBindTexture(GL_TEXTURE_2D, this->getTextureID());
+        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
+
+        graphicsGL->bindTexture(GL_TEXTURE_2D, this->getTextureID());
         glGenerateMipmap(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        graphicsGL->bindTexture(GL_TEXTURE_2D, 0);
     }
 
 
@@ -52,7 +67,8 @@ namespace Core {
         if (!tex) {
             throw AllocationException("Texture2DGL::setupTexture -> Unable to generate texture");
         }
-        glBindTexture(GL_TEXTURE_2D, tex);
+        graphicsGL->invalidateTextureBinding(tex);
+        graphicsGL->bindTexture(GL_TEXTURE_2D, tex);
 
         GLenum textureFormat = graphicsGL->getGLTextureFormat(attributes.Format);
         GLenum pixelFormat = graphicsGL->getGLPixelFormat(attributes.Format);
@@ -122,7 +138,7 @@ namespace Core {
             glGenerateMipmap(GL_TEXTURE_2D);
         }
        
-        glBindTexture(GL_TEXTURE_2D, 0);
+        graphicsGL->bindTexture(GL_TEXTURE_2D, 0);
         this->textureId = (Int32)tex;
     }
     
@@ -19,6 +19,7 @@ namespace Core {
         void buildFromImage(WeakPointer<StandardImage> imageData) override;
         void buildFromImage(WeakPointer<HDRImage> imageData) override;
         void buildEmpty(UInt32 width, UInt32 height) override;
+        void updateRegion(UInt32 x, UInt32 y, UInt32 width, UInt32 height, const Byte* data) override;
         void updateMipMaps() override;
 
     protected:
@@ -68,8 +68,24 @@ namespace Core {
 
         virtual void drawBoundVertexBuffer(UInt32 vertexCount) = 0;
         virtual void drawBoundVertexBuffer(UInt32 vertexCount, WeakPointer<IndexBuffer> indices) = 0;
+        virtual void drawBoundVertexBufferInstanced(UInt32 vertexCount, UInt32 instanceCount) = 0;
+        virtual void drawBoundVertexBufferInstanced(UInt32 vertexCount, WeakPointer<IndexBuffer> indices, UInt32 instanceCount) = 0;
+
+        // each instance is packed as its model matrix (16 values, column-major) followed by the
+        // upper 3x3 of the model inverse-transpose matrix (9 values, column-major).
+        static const UInt32 InstanceTransformSize = 25;
+        virtual void bindInstanceTransforms(const Real* transforms, UInt32 instanceCount,
+                                            Int32 modelMatrixLocation, Int32 modelInverseTransposeMatrixLocation) = 0;
+        virtual void unbindInstanceTransforms(Int32 modelMatrixLocation, Int32 modelInverseTransposeMatrixLocation) = 0;
+
+        // vertex attribute setup is cached per (mesh, shader) pair. activateVertexArray() returns false when
+        // the pair had no cached setup yet, in which case the caller must send the mesh's attributes to the shader.
+        virtual Bool activateVertexArray(UInt64 meshID, UInt64 shaderID) = 0;
+        virtual void releaseVertexArrays(UInt64 meshID) = 0;
 
         virtual ShaderManager& getShaderManager() = 0;
+        // number of texture units a fragment shader can sample from
+        virtual UInt32 getMaxFragmentTextureUnits() const = 0;
 
         virtual void setBlendingEnabled(Bool enabled) = 0;
         virtual void setBlendingFunction(RenderState::BlendingMethod source, RenderState::BlendingMethod dest) = 0;
@@ -19,6 +19,8 @@ namespace Core {
 		if (ticksPerSecond <= 0)ticksPerSecond = 1;
 
 		keyFrames = nullptr;
+		bakedAnimation = nullptr;
+		keyFramesReleased = false;
 		this->durationTicks = durationTicks;
 		this->ticksPerSecond = ticksPerSecond;
 		this->startOffsetTicks = startOffsetTicks;
@@ -45,6 +47,11 @@ namespace Core {
 	 * This method destroys [channelNames] and [keyFrames] and invalidates their pointers
 	 */
 	void Animation::destroy() {
+		if (bakedAnimation != nullptr) {
+			delete bakedAnimation;
+			bakedAnimation = nullptr;
+		}
+
 		if (keyFrames != nullptr) {
 			delete[] keyFrames;
 			keyFrames = nullptr;
@@ -56,6 +63,7 @@ namespace Core {
 		}
 
 		channelCount = 0;
+		keyFramesReleased = false;
 	}
 
 	/*
@@ -122,6 +130,66 @@ namespace Core {
 		channelNames[index] = name;
 	}
 
+	/*
+	 * Build the baked, sampling-friendly copy of [keyFrames]. Changes made to the key frames afterwards
+	 * are not picked up until bake() is called again.
+	 */
+	void Animation::bake() {
+		if (keyFramesReleased) {
+			throw Exception("Animation::bake -> Key frames have been released by compress().");
+		}
+
+		BakedAnimation * baked = new(std::nothrow) BakedAnimation(keyFrames, channelCount);
+		if (baked == nullptr) {
+			throw AllocationException("Animation::bake -> Could not allocate baked animation.");
+		}
+
+		if (bakedAnimation != nullptr) delete bakedAnimation;
+		bakedAnimation = baked;
+	}
+
+	/*
+	 * Replace the baked copy of [keyFrames] with a compressed one built according to [settings], and return
+	 * the memory used before and after compression along with the largest errors it introduced. If requested
+	 * by [settings], the key frames are freed afterwards, leaving the compressed copy as the only one.
+	 */
+	AnimationCompressionReport Animation::compress(const AnimationCompressionSettings& settings) {
+		if (keyFramesReleased) {
+			throw Exception("Animation::compress -> Key frames have been released by a previous compress().");
+		}
+
+		AnimationCompressionReport report;
+		BakedAnimation * baked = new(std::nothrow) BakedAnimation(keyFrames, channelCount, settings, &report);
+		if (baked == nullptr) {
+			throw AllocationException("Animation::compress -> Could not allocate baked animation.");
+		}
+
+		if (bakedAnimation != nullptr) delete bakedAnimation;
+		bakedAnimation = baked;
+
+		if (settings.ReleaseKeyFrames) {
+			for (UInt32 i = 0; i < channelCount; i++) {
+				std::vector<TranslationKeyFrame>().swap(keyFrames[i].TranslationKeyFrames);
+				std::vector<ScaleKeyFrame>().swap(keyFrames[i].ScaleKeyFrames);
+				std::vector<RotationKeyFrame>().swap(keyFrames[i].RotationKeyFrames);
+			}
+			keyFramesReleased = true;
+		}
+
+		return report;
+	}
+
+	Bool Animation::isBaked() const {
+		return bakedAnimation != nullptr;
+	}
+
+	/*
+	 * Get the baked copy of this animation's key frames, or nullptr if bake() has not been called.
+	 */
+	const BakedAnimation * Animation::getBakedAnimation() const {
+		return bakedAnimation;
+	}
+
 	/*
 	 * Get the duration of this animation in ticks.
 	 */
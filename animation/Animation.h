@@ -16,6 +16,7 @@
 #include "../Engine.h"
 #include "../base/CoreObject.h"
 #include "KeyFrameSet.h"
+#include "BakedAnimation.h"
 #include "../geometry/Vector3.h"
 #include "../math/Quaternion.h"
 #include "../math/Matrix4x4.h"
@@ -48,6 +49,11 @@ namespace Core {
 		Real getStartOffset() const;
 		Real getEarlyEnd() const;
 
+		void bake();
+		AnimationCompressionReport compress(const AnimationCompressionSettings& settings);
+		Bool isBaked() const;
+		const BakedAnimation * getBakedAnimation() const;
+
 	private:
 
 		// A KeyFrameSet for each node in the target skeleton
@@ -61,6 +67,11 @@ namespace Core {
 		// is also the length of [channelNames]
 		UInt32 channelCount;
 
+		// immutable copy of [keyFrames] used for sampling, created by bake() or compress()
+		BakedAnimation * bakedAnimation;
+		// the contents of [keyFrames] have been freed by compress()
+		Bool keyFramesReleased;
+
 		// the duration of this animation in  device/clock independent ticks
 		Real durationTicks;
 		// map the ticks duration to actual time
@@ -14,6 +14,7 @@
 #include "../Engine.h"
 #include "../common/types.h"
 #include "AnimationPlayer.h"
+#include "BakedAnimation.h"
 
 namespace Core {
 
@@ -85,6 +86,8 @@ namespace Core {
 		// array of FrameState objects, one for each node in [target] and is indexed in the same way.
 		// E.g. The FrameState at index 5 corresponds to the SkeletonNode returned by target->GetNode(5);
 		FrameState * frameStates;
+		// channels of [sourceAnimation] sampled at [progress], when the animation has been baked
+		BakedAnimation::Pose bakedPose;
 
 		// duration of this instance in seconds
 		Real duration;
@@ -13,6 +13,8 @@
 #include "AnimationPlayer.h"
 #include "Skeleton.h"
 #include "Bone.h"
+#include "../render/Camera.h"
+#include "../scene/Object3D.h"
 #include "../util/Time.h"
 
 namespace Core {
@@ -21,6 +23,7 @@ namespace Core {
 	* Default constructor
 	*/
 	AnimationManager::AnimationManager() {
+		this->nextUpdatePhase = 0;
 	}
 
 	/*
@@ -76,13 +79,41 @@ namespace Core {
 
 	/*
 	 * Loop through each active AnimationPlayer and drive its playback.
+	 *
+	 * Blending operations are updated first on the calling thread, since they may trigger callbacks. Players
+	 * target different skeletons and are independent of each other, so sampling and blending their animations
+	 * is then split across the engine's job system. Finally the results are written to the skeletons' nodes,
+	 * again on the calling thread, so the transforms are up to date by the time this method returns.
+	 *
+	 * Players whose level of detail skips the current frame are left out of the last two steps entirely.
 	 */
 	void AnimationManager::update() {
+		Point3r cameraPosition;
+		Bool hasCamera = this->lodCamera.isValid();
+		if (hasCamera) {
+			cameraPosition = this->lodCamera->getOwner()->getTransform().getWorldPosition();
+		}
+
+		this->updatingPlayers.resize(0);
 		for (std::unordered_map<UInt64, std::shared_ptr<AnimationPlayer>>::iterator iter = this->activePlayers.begin(); iter != activePlayers.end(); ++iter) {
-			WeakPointer<AnimationPlayer> player = iter->second;
-			if (player.isValid()) {
-				player->update();
+			AnimationPlayer * player = iter->second.get();
+			if (player != nullptr) {
+				player->updateBlendingOperations();
+				player->updateLOD(hasCamera ? &cameraPosition : nullptr);
+				if (player->needsEvaluation()) this->updatingPlayers.push_back(player);
+			}
+		}
+
+		std::vector<AnimationPlayer *>& players = this->updatingPlayers;
+		WeakPointer<JobSystem> jobSystem = Engine::instance()->getJobSystem();
+		jobSystem->parallelFor("AnimationManager::update", (UInt32)players.size(), PlayerBatchSize, [&players](UInt32 start, UInt32 end) {
+			for (UInt32 i = start; i < end; i++) {
+				players[i]->evaluate();
 			}
+		});
+
+		for (AnimationPlayer * player : players) {
+			player->applyNodeTransforms();
 		}
 	}
 
@@ -113,6 +144,7 @@ namespace Core {
 				throw AllocationException( "AnimationManager::retrieveOrCreateAnimationPlayer -> Could not allocate new AnimationPlayer object.");
 			}
 
+			playerPtr->lodUpdatePhase = this->nextUpdatePhase++;
 			std::shared_ptr<AnimationPlayer> player(playerPtr);
 			// put the newly created AnimationPlayer in the list of active players.
 			this->activePlayers[target->getObjectID()] = player;
@@ -122,6 +154,14 @@ namespace Core {
 		return activePlayers[target->getObjectID()];
 	}
 
+	/*
+	 * Use the distance from [camera] to the root of each player's skeleton as the LOD metric of players that do not
+	 * supply their own. Without a camera those players stay at their first level of detail.
+	 */
+	void AnimationManager::setLODCamera(WeakPointer<Camera> camera) {
+		this->lodCamera = camera;
+	}
+
 	WeakPointer<AnimationInstance> AnimationManager::createAnimationInstance(WeakPointer<Skeleton> target, WeakPointer<Animation> animation) {
 
 		if (!target.isValid()) {
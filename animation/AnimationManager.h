@@ -16,6 +16,7 @@
 #include "../Engine.h"
 #include "../common/types.h"
 #include "../base/CoreObject.h"
+#include "../util/PersistentWeakPointer.h"
 
 namespace Core {
 
@@ -25,6 +26,7 @@ namespace Core {
 	class AnimationInstance;
 	class Animation;
 	class Skeleton;
+	class Camera;
 
 	class AnimationManager {
 
@@ -39,14 +41,24 @@ namespace Core {
 		WeakPointer<Animation> createAnimation(Real durationTicks, Real ticksPerSecond);
 		WeakPointer<AnimationPlayer> retrieveOrCreateAnimationPlayer(WeakPointer<Skeleton> target);
 		WeakPointer<AnimationInstance> createAnimationInstance(WeakPointer<Skeleton> target, WeakPointer<Animation> animation);
+		void setLODCamera(WeakPointer<Camera> camera);
 
 	private:
 
+		// number of players evaluated by each job in update()
+		static const UInt32 PlayerBatchSize = 2;
+
 		AnimationManager();
 
 		std::vector<std::shared_ptr<Animation>> animations;
 		// map object IDs of Skeleton objects to their assign animation player
 		std::unordered_map<UInt64, std::shared_ptr<AnimationPlayer>> activePlayers;
 		std::vector<std::shared_ptr<AnimationInstance>> instances;
+		// players being driven by the current call to update()
+		std::vector<AnimationPlayer *> updatingPlayers;
+		// the distance from this camera selects the level of detail of each player
+		PersistentWeakPointer<Camera> lodCamera;
+		// update phase assigned to the next player created, to stagger players with reduced update rates
+		UInt32 nextUpdatePhase;
 	};
 }
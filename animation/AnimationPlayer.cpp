@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "../Engine.h"
 #include "AnimationPlayer.h"
 #include "Bone.h"
@@ -13,6 +15,7 @@
 #include "AnimationManager.h"
 #include "CrossFadeBlendOp.h"
 #include "BlendOp.h"
+#include "KeyFrameSearch.h"
 #include "../common/types.h"
 #include "../common/debug.h"
 #include "../common/Constants.h"
@@ -20,6 +23,13 @@
 
 namespace Core {
 
+	AnimationLODLevel::AnimationLODLevel(): MinMetric(0), UpdateInterval(1), SkipDetailNodes(false) {
+	}
+
+	AnimationLODLevel::AnimationLODLevel(Real minMetric, UInt32 updateInterval, Bool skipDetailNodes):
+		MinMetric(minMetric), UpdateInterval(updateInterval), SkipDetailNodes(skipDetailNodes) {
+	}
+
 	/*
 	* Single constructor, which initializes member variables.
 	*/
@@ -30,6 +40,16 @@ namespace Core {
 		this->target = target;
 		this->animationCount = 0;
 		this->playingAnimationsCount = 0;
+		this->lodLevel = 0;
+		this->lodUpdateInterval = 1;
+		this->lodInterpolationEnabled = false;
+		this->lodUpdatePhase = 0;
+		this->lodFrameCount = 0;
+		this->framesSinceUpdate = 0;
+		this->pendingDeltaTime = 0;
+		this->hasUpdated = false;
+		this->updateThisFrame = true;
+		this->interpolateThisFrame = false;
 	}
 
 	/*
@@ -123,23 +143,161 @@ namespace Core {
 	void AnimationPlayer::update() {
 		// update current blending operation
 		this->updateBlendingOperations();
+		// decide whether this frame is sampled
+		this->updateLOD(nullptr);
+		if (this->needsEvaluation()) {
+			// sample active animations and drive their progress
+			this->evaluate();
+			// update the positions of all nodes in the target skeleton
+			this->applyNodeTransforms();
+		}
+	}
+
+	/*
+	 * Select the level of detail for this frame and decide whether it is one on which the animations are
+	 * sampled. The metric comes from the function passed to setLODMetric(), or else is the distance between
+	 * [cameraPosition] and the root of the target skeleton. Players at the same interval are spread over
+	 * its frames by [lodUpdatePhase] so their cost does not land on the same frame.
+	 *
+	 * This calls user code and reads the world transform of the skeleton, so it is called on the main thread.
+	 */
+	void AnimationPlayer::updateLOD(const Point3r * cameraPosition) {
+		this->pendingDeltaTime += Time::getDeltaTime();
+		this->lodFrameCount++;
+		this->framesSinceUpdate++;
+
+		this->lodLevel = 0;
+		this->lodUpdateInterval = 1;
+		if (this->lodLevels.size() > 0) {
+			Real metric = 0;
+			if (this->lodMetric) {
+				metric = this->lodMetric();
+			}
+			else if (cameraPosition != nullptr) {
+				Tree<Skeleton::SkeletonNode*>::TreeNode * rootNode = this->target->getRootNode();
+				if (rootNode != nullptr && rootNode->Data != nullptr && rootNode->Data->hasTarget()) {
+					const Matrix4x4& rootTransform = rootNode->Data->getFullTransform();
+					Vector3r offset(rootTransform.A3() - cameraPosition->x, rootTransform.B3() - cameraPosition->y,
+									rootTransform.C3() - cameraPosition->z);
+					metric = offset.magnitude();
+				}
+			}
+
+			for (UInt32 i = 0; i < this->lodLevels.size(); i++) {
+				if (metric >= this->lodLevels[i].MinMetric) this->lodLevel = i;
+			}
+			UInt32 interval = this->lodLevels[this->lodLevel].UpdateInterval;
+			this->lodUpdateInterval = interval > 0 ? interval : 1;
+		}
+
+		UInt32 interval = this->lodUpdateInterval;
+		this->updateThisFrame = !this->hasUpdated || interval == 1 || this->framesSinceUpdate >= interval ||
+								(this->lodFrameCount + this->lodUpdatePhase) % interval == 0;
+		this->interpolateThisFrame = this->lodInterpolationEnabled && interval > 1;
+	}
+
+	/*
+	 * True if evaluate() and applyNodeTransforms() have any work to do this frame.
+	 */
+	Bool AnimationPlayer::needsEvaluation() const {
+		return this->updateThisFrame || this->interpolateThisFrame;
+	}
+
+	/*
+	 * Calculate the blended transformation of each node of the target skeleton and advance the
+	 * progress of active animations. Only state owned by this player is written, so players for
+	 * different skeletons may be evaluated concurrently; the results are written to the skeleton
+	 * by applyNodeTransforms().
+	 *
+	 * On frames skipped by the level of detail the animations are neither sampled nor advanced; the time
+	 * that passes is added to their progress on the next sampled frame instead. With interpolation enabled
+	 * the nodes are moved from the pose sampled by the previous update towards the most recent one, which
+	 * trails the animation by one update interval in exchange for smooth motion.
+	 */
+	void AnimationPlayer::evaluate() {
+		if (!this->updateThisFrame) {
+			if (this->interpolateThisFrame) this->interpolateNodeTransforms();
+			return;
+		}
+
 		// validate animation weights
 		this->checkWeights();
-		// update the positions of all nodes in the target skeleton based on
+		// calculate the positions of all nodes in the target skeleton based on
 		// active animations
 		this->applyActiveAnimations();
 		// drive the progress of active animations
-		this->updateAnimationsProgress();
+		this->updateAnimationsProgress(this->pendingDeltaTime);
+		this->pendingDeltaTime = 0;
+		this->framesSinceUpdate = 0;
+		this->hasUpdated = true;
+
+		if (this->interpolateThisFrame) {
+			this->lodStartTransforms.swap(this->lodEndTransforms);
+			this->lodStartTransformsSet.swap(this->lodEndTransformsSet);
+			this->lodEndTransforms = this->nodeTransforms;
+			this->lodEndTransformsSet = this->nodeTransformsSet;
+			this->interpolateNodeTransforms();
+		}
+		else {
+			// the last pose is stale by the time interpolation is turned back on
+			this->lodEndTransformsSet.clear();
+		}
+	}
+
+	/*
+	 * Set [nodeTransforms] to the element-wise interpolation of the last two sampled poses, according to the
+	 * number of frames since the last update. The poses are at most one update interval apart, which keeps
+	 * the error of interpolating rotations this way small. Nodes missing from the older pose snap to the newer one.
+	 */
+	void AnimationPlayer::interpolateNodeTransforms() {
+		Real t = (Real)this->framesSinceUpdate / (Real)this->lodUpdateInterval;
+		if (t > 1) t = 1;
+
+		UInt32 nodeCount = (UInt32)this->lodEndTransformsSet.size();
+		UInt32 startCount = (UInt32)this->lodStartTransformsSet.size();
+		this->nodeTransforms.resize(nodeCount);
+		this->nodeTransformsSet = this->lodEndTransformsSet;
+		for (UInt32 node = 0; node < nodeCount; node++) {
+			if (!this->lodEndTransformsSet[node]) continue;
+			const Real * end = this->lodEndTransforms[node].getConstData();
+			Real * out = this->nodeTransforms[node].getData();
+			if (node < startCount && this->lodStartTransformsSet[node]) {
+				const Real * start = this->lodStartTransforms[node].getConstData();
+				for (UInt32 i = 0; i < 16; i++) {
+					out[i] = start[i] + (end[i] - start[i]) * t;
+				}
+			}
+			else {
+				for (UInt32 i = 0; i < 16; i++) {
+					out[i] = end[i];
+				}
+			}
+		}
 	}
 
 	/*
-	 * Update the positions of all nodes of the target Skeleton object based on the progress of all
+	 * Copy the node transformations calculated by the last call to evaluate() into the local
+	 * transforms of the targets of the skeleton's nodes.
+	 */
+	void AnimationPlayer::applyNodeTransforms() {
+		UInt32 nodeCount = (UInt32)this->nodeTransforms.size();
+		for (UInt32 node = 0; node < nodeCount; node++) {
+			if (!this->nodeTransformsSet[node]) continue;
+			Skeleton::SkeletonNode * targetNode = target->getNodeFromList(node);
+			if (targetNode->hasTarget()) {
+				targetNode->getLocalTransform().copy(this->nodeTransforms[node]);
+			}
+		}
+	}
+
+	/*
+	 * Calculate the positions of all nodes of the target Skeleton object based on the progress of all
 	 * active animations.
 	 *
 	 * This method loops through each node in the target skeleton [target], and for each node it calculates
 	 * the interpolated translation, rotation, and scale for that node for each active animation. It combines
 	 * those transformations based on the weight of each active animation stored in member [weights] and
-	 * applies the final transformation to the node.
+	 * stores the final transformation for the node in [nodeTransforms].
 	 */
 	void AnimationPlayer::applyActiveAnimations() {
 		Vector3r translation;
@@ -160,9 +318,42 @@ namespace Core {
 		// keep track of the number of playing animations seen as we loop through all registered animations
 		UInt32 playingAnimationsSeen = 0;
 
+		UInt32 nodeCount = target->getNodeCount();
+		this->nodeTransforms.resize(nodeCount);
+		this->nodeTransformsSet.assign(nodeCount, false);
+
+		Bool skipDetailNodes = this->lodLevels.size() > 0 && this->lodLevels[this->lodLevel].SkipDetailNodes &&
+							   this->detailNodes.size() == nodeCount;
+
+		// sample the channels of each contributing baked animation in one pass, ahead of the per-node loop. when detail
+		// nodes are skipped, so are the channels that only they read.
+		for (UInt32 i = 0; i < registeredAnimations.size(); i++) {
+			WeakPointer<AnimationInstance> instance = this->registeredAnimations[i];
+			if (instance.isValid() && instance->playing && this->animationWeights[i] > 0) {
+				const BakedAnimation * bakedAnimation = instance->sourceAnimation->getBakedAnimation();
+				if (bakedAnimation != nullptr) {
+					const std::vector<Bool> * channelMask = nullptr;
+					if (skipDetailNodes) {
+						UInt32 channelCount = bakedAnimation->getChannelCount();
+						this->sampledChannels.assign(channelCount, false);
+						for (UInt32 node = 0; node < nodeCount; node++) {
+							Int32 mappedChannel = instance->getChannelMappingForTargetNode(node);
+							if (!this->detailNodes[node] && mappedChannel >= 0 && (UInt32)mappedChannel < channelCount) {
+								this->sampledChannels[mappedChannel] = true;
+							}
+						}
+						channelMask = &this->sampledChannels;
+					}
+					bakedAnimation->sample(instance->progress, instance->duration, instance->startOffset, instance->bakedPose, channelMask);
+				}
+			}
+		}
+
 		// loop through each node in the target Skeleton object, and calculate the position based on
 		// weighted average of positions returned from each active animation
-		for (UInt32 node = 0; node < target->getNodeCount(); node++) {
+		for (UInt32 node = 0; node < nodeCount; node++) {
+			if (skipDetailNodes && this->detailNodes[node]) continue;
+
 			agScale.set(0, 0, 0);
 			agTranslation.set(0, 0, 0);
 			agRotation = Quaternion::Identity;
@@ -194,7 +385,18 @@ namespace Core {
 
 					// calculate the translation, rotation, and scale for this animation at the current node
 					if (mappedChannel >= 0) {
-						this->calculateInterpolatedValues(instance, mappedChannel, translation, rotation, scale);
+						const BakedAnimation * bakedAnimation = instance->sourceAnimation->getBakedAnimation();
+						if (bakedAnimation != nullptr && bakedAnimation->isChannelUsed(mappedChannel)) {
+							const BakedAnimation::Pose& pose = instance->bakedPose;
+							Real x, y, z, w;
+							pose.getTranslation(mappedChannel, translation.x, translation.y, translation.z);
+							pose.getScale(mappedChannel, scale.x, scale.y, scale.z);
+							pose.getRotation(mappedChannel, x, y, z, w);
+							rotation.set(x, y, z, w);
+						}
+						else {
+							this->calculateInterpolatedValues(instance, node, mappedChannel, translation, rotation, scale);
+						}
 					}
 
 					// if there is no channel in the current animation for this node, use the
@@ -267,12 +469,9 @@ namespace Core {
 					matrix.add(temp);
 				}
 
-				if (targetNode->hasTarget()) {
-					// get the local transform of the target of this node and apply
-					// [matrix], which contains the interpolated scale, rotation, and translation
-					Matrix4x4& localTransform = targetNode->getLocalTransform();
-					localTransform.copy(matrix);
-				}
+				// [matrix] contains the interpolated scale, rotation, and translation
+				this->nodeTransforms[node].copy(matrix);
+				this->nodeTransformsSet[node] = true;
 			}
 		}
 	}
@@ -282,8 +481,10 @@ namespace Core {
 	 * Then interpolate between those two key frames based on where the progress of [instance] lies between them, and store the
 	 * interpolated translation, rotation, and scale values in [translation], [rotation], and [scale].
 	 */
-	void AnimationPlayer::calculateInterpolatedValues(WeakPointer<AnimationInstance> instance, UInt32 channel, Vector3r& translation, Quaternion& rotation, Vector3r& scale) const
+	void AnimationPlayer::calculateInterpolatedValues(WeakPointer<AnimationInstance> instance, UInt32 node, UInt32 channel, Vector3r& translation, Quaternion& rotation, Vector3r& scale) const
 	{
+		AnimationInstance::FrameState * frameState = instance->getFrameState(node);
+
 		Animation * animationPtr = const_cast<Animation *>(instance->sourceAnimation.get());
 		KeyFrameSet * frameSet = animationPtr->getKeyFrameSet(channel);
 		if (frameSet == nullptr) {
@@ -294,35 +495,35 @@ namespace Core {
 		if (frameSet != nullptr && frameSet->Used) {
 			// for each of translation, scale, and rotation, find the two respective key frames between which
 			// instance->Progress lies, and interpolate between them based on instance->Progress.
-			this->calculateInterpolatedTranslation(instance, *frameSet, translation);
-			this->calculateInterpolatedScale(instance, *frameSet, scale);
-			this->calculateInterpolatedRotation(instance, *frameSet, rotation);
+			this->calculateInterpolatedTranslation(instance, *frameSet, frameState->TranslationKeyIndex, translation);
+			this->calculateInterpolatedScale(instance, *frameSet, frameState->ScaleKeyIndex, scale);
+			this->calculateInterpolatedRotation(instance, *frameSet, frameState->RotationKeyIndex, rotation);
 		}
 	}
 
 	/*
-	 * Drive the progress of each active animation.
+	 * Drive the progress of each active animation by [deltaTime] seconds.
 	 */
-	void AnimationPlayer::updateAnimationsProgress() {
+	void AnimationPlayer::updateAnimationsProgress(Real deltaTime) {
 
 		// loop through each registered animation and check if it is active. if it is,
 		// call UpdateAnimationInstanceProgress() and pass [instance] to it.
 		for (UInt32 i = 0; i < this->registeredAnimations.size(); i++) {
 			WeakPointer<AnimationInstance> instance = this->registeredAnimations[i];
 			if (instance.isValid() && instance->playing) {
-				this->updateAnimationInstanceProgress(instance);
+				this->updateAnimationInstanceProgress(instance, deltaTime);
 			}
 		}
 	}
 
 	/*
-	 * Drive the progress of [instance].
+	 * Drive the progress of [instance] by [deltaTime] seconds.
 	 */
-	void AnimationPlayer::updateAnimationInstanceProgress(WeakPointer<AnimationInstance> instance) const {
+	void AnimationPlayer::updateAnimationInstanceProgress(WeakPointer<AnimationInstance> instance, Real deltaTime) const {
 		// make sure the animation is active
 		if (instance->playing && !instance->paused) {
 			// update animation instance progress
-			instance->progress += Time::getDeltaTime() * instance->speedFactor;
+			instance->progress += deltaTime * instance->speedFactor;
 
 			Real effectiveEnd = (instance->duration > instance->earlyEnd) ? instance->earlyEnd : instance->duration;
 			Real effectiveStart = (instance->startOffset > 0) ? instance->startOffset : 0;
@@ -353,7 +554,7 @@ namespace Core {
 	 * Use the value of instance->progress to find the two closest translation key frames in [keyFrameSet]. Then interpolate between the translation
 	 * values in those two key frames based on where instance->progress lies between them, and store the result in [vector].
 	 */
-	void AnimationPlayer::calculateInterpolatedTranslation(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, Vector3r& vector) const {
+	void AnimationPlayer::calculateInterpolatedTranslation(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, UInt32& keyCursor, Vector3r& vector) const {
 		if (!instance.isValid()) {
 			throw InvalidReferenceException("AnimationPlayer::calculateInterpolatedTranslation -> 'instance' is invalid.");
 		}
@@ -365,7 +566,7 @@ namespace Core {
 
 		UInt32 previousIndex, nextIndex;
 		Real interFrameProgress;
-		Bool foundFrames = this->calculateInterpolation(instance, keyFrameSet, previousIndex, nextIndex, interFrameProgress, TransformationCompnent::Translation);
+		Bool foundFrames = this->calculateInterpolation(instance, keyFrameSet, keyCursor, previousIndex, nextIndex, interFrameProgress, TransformationCompnent::Translation);
 
 		// did we successfully find 2 frames between which to interpolate?
 		if (foundFrames) {
@@ -386,7 +587,7 @@ namespace Core {
 	 * Use the value of instance->progress to find the two closest scale key frames in [keyFrameSet]. Then interpolate between the scale
 	 * values in those two key frames based on where instance->progress lies between them, and store the result in [vector].
 	 */
-	void AnimationPlayer::calculateInterpolatedScale(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, Vector3r& vector) const {
+	void AnimationPlayer::calculateInterpolatedScale(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, UInt32& keyCursor, Vector3r& vector) const {
 		
 		if (!instance.isValid()) {
 			throw InvalidReferenceException("AnimationPlayer::calculateInterpolatedScale -> 'instance' is invalid.");
@@ -399,7 +600,7 @@ namespace Core {
 
 		UInt32 previousIndex, nextIndex;
 		Real interFrameProgress;
-		Bool foundFrames = calculateInterpolation(instance, keyFrameSet, previousIndex, nextIndex, interFrameProgress, TransformationCompnent::Scale);
+		Bool foundFrames = this->calculateInterpolation(instance, keyFrameSet, keyCursor, previousIndex, nextIndex, interFrameProgress, TransformationCompnent::Scale);
 
 		// did we successfully find 2 frames between which to interpolate?
 		if (foundFrames) {
@@ -420,7 +621,7 @@ namespace Core {
 	 * Use the value of instance->progress to find the two closest rotation key frames in [keyFrameSet]. Then interpolate between the rotation
 	 * values in those two key frames based on where instance->progress lies between them, and store the result in [rotation].
 	 */
-	void AnimationPlayer::calculateInterpolatedRotation(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, Quaternion& rotation) const {
+	void AnimationPlayer::calculateInterpolatedRotation(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, UInt32& keyCursor, Quaternion& rotation) const {
 		
 		if (!instance.isValid()) {
 			throw InvalidReferenceException("AnimationPlayer::calculateInterpolatedRotation -> 'instance' is invalid.");
@@ -433,7 +634,7 @@ namespace Core {
 
 		UInt32 previousIndex, nextIndex;
 		Real interFrameProgress;
-		Bool foundFrames = this->calculateInterpolation(instance, keyFrameSet, previousIndex, nextIndex, interFrameProgress, TransformationCompnent::Rotation);
+		Bool foundFrames = this->calculateInterpolation(instance, keyFrameSet, keyCursor, previousIndex, nextIndex, interFrameProgress, TransformationCompnent::Rotation);
 
 		// did we successfully find 2 frames between which to interpolate?
 		if (foundFrames) {
@@ -456,8 +657,11 @@ namespace Core {
 	 * This method uses the value of instance->progress to find the two closest key frames in [keyFrameSet], of the type specified by [component]
 	 * and then stores the indices of those key frames in [previousIndex] and [nextIndex]. Then it uses instance->progress to determine how far from [lastIndex]
 	 * to [nextIndex] the animation currently is, and stores that value in [interFrameProgress] (range: 0 to 1).
+	 *
+	 * The search starts from [keyCursor], the key frame found for this channel on the previous call, and [keyCursor] is updated with the result.
 	 */
-	Bool AnimationPlayer::calculateInterpolation(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, UInt32& previousIndex, UInt32& nextIndex, Real& interFrameProgress, TransformationCompnent component) const {
+	Bool AnimationPlayer::calculateInterpolation(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, UInt32& keyCursor, UInt32& previousIndex,
+												 UInt32& nextIndex, Real& interFrameProgress, TransformationCompnent component) const {
 		if (!instance.isValid()) {
 			throw InvalidReferenceException("AnimationPlayer::calculateInterpolation -> 'instance' is invalid.");
 		}
@@ -472,78 +676,60 @@ namespace Core {
 		else if (component == TransformationCompnent::Scale)frameCount = (UInt32)keyFrameSet.ScaleKeyFrames.size();
 		else return false;
 
-		// loop through each key frame
-		for (UInt32 f = 0; f < frameCount; f++) {
-
-			KeyFrame * previousFrame = nullptr;
-			KeyFrame * nextFrame = nullptr;
-
-			// get the correct time stamp for this frame, which depends on [component]
-			Real keyRealTime = this->getKeyFrameTime(component, f, keyFrameSet);
-
-			// if the RealTime value for this key frame is greater than [progress], then the previous key frame and the current key frame
-			// are the frames we want
-			if (keyRealTime > progress || f == frameCount - 1) {
-				previousIndex = 0;
-				if (f > 0)previousIndex = f - 1;
-				nextIndex = f;
-
-				// flag that indicates we need to interpolate from the last frame to the first frame
-				Bool overShoot = false;
-
-				// if f==frameCount-1 and keyRealTime <= progress, then we have reached the last frame and progress has moved
-				// beyond it. this means we need to interpolate between the last frame and the first frame (for smoothed animation looping).
-				if (f == frameCount - 1 && keyRealTime <= progress)
-				{
-					previousIndex = f;
-					nextIndex = 0;
-
-					// if the start offset for this animation is > 0, then we can't assume the
-					// next frame will be at index 0. in this case we must loop through each
-					// frame to find which one has a timestamp greater than StartOffset.
-					if (instance->startOffset > 0) {
-						for (UInt32 ff = 0; ff < frameCount; ff++) {
-							// get the correct time stamp for for frame [ff], which depends on [component]
-							Real nextKeyRealTime = this->getKeyFrameTime(component, ff, keyFrameSet);
-							if (nextKeyRealTime > instance->startOffset || ff == frameCount - 1) {
-								nextIndex = ff;
-							}
-						}
-					}
-					overShoot = true;
-				}
+		if (frameCount == 0) return false;
+
+		// find the first key frame with a time stamp greater than [progress], or the last frame if there is none.
+		// the previous key frame and that frame are the frames we want.
+		UInt32 f = this->findKeyFrame(component, keyFrameSet, frameCount, progress, keyCursor);
+		keyCursor = f;
+		Real keyRealTime = this->getKeyFrameTime(component, f, keyFrameSet);
+
+		previousIndex = 0;
+		if (f > 0)previousIndex = f - 1;
+		nextIndex = f;
+
+		// flag that indicates we need to interpolate from the last frame to the first frame
+		Bool overShoot = false;
+
+		// if f==frameCount-1 and keyRealTime <= progress, then we have reached the last frame and progress has moved
+		// beyond it. this means we need to interpolate between the last frame and the first frame (for smoothed animation looping).
+		if (f == frameCount - 1 && keyRealTime <= progress)
+		{
+			previousIndex = f;
+			nextIndex = 0;
+
+			// if the start offset for this animation is > 0, then we can't assume the
+			// next frame will be at index 0. in this case we look for the first frame
+			// that has a timestamp greater than StartOffset.
+			if (instance->startOffset > 0) {
+				nextIndex = this->findKeyFrame(component, keyFrameSet, frameCount, instance->startOffset, 0);
+			}
+			overShoot = true;
+		}
 
-				// get pointers to the previous frame and the next frame
-				if (component == TransformationCompnent::Translation) {
-					const TranslationKeyFrame& nextTranslationFrame = keyFrameSet.TranslationKeyFrames[nextIndex];
-					const TranslationKeyFrame& lastTranslationFrame = keyFrameSet.TranslationKeyFrames[previousIndex];
-					nextFrame = const_cast<TranslationKeyFrame *>(&nextTranslationFrame);
-					previousFrame = const_cast<TranslationKeyFrame *>(&lastTranslationFrame);
-				} else if (component == TransformationCompnent::Rotation) {
-					const RotationKeyFrame& nextRotationFrame = keyFrameSet.RotationKeyFrames[nextIndex];
-					const RotationKeyFrame& lastRotationFrame = keyFrameSet.RotationKeyFrames[previousIndex];
-					nextFrame = const_cast<RotationKeyFrame *>(&nextRotationFrame);
-					previousFrame = const_cast<RotationKeyFrame *>(&lastRotationFrame);
-				} else if (component == TransformationCompnent::Scale) {
-					const ScaleKeyFrame& nextScaleFrame = keyFrameSet.ScaleKeyFrames[nextIndex];
-					const ScaleKeyFrame& lastScaleFrame = keyFrameSet.ScaleKeyFrames[previousIndex];
-					nextFrame = const_cast<ScaleKeyFrame *>(&nextScaleFrame);
-					previousFrame = const_cast<ScaleKeyFrame *>(&lastScaleFrame);
-				}
+		// get the time stamps of the previous frame and the next frame
+		Real previousFrameTime = this->getKeyFrameTime(component, previousIndex, keyFrameSet);
+		Real nextFrameTime = this->getKeyFrameTime(component, nextIndex, keyFrameSet);
 
-				// calculate local progress between [previous] and [nextFrame]
-				Real interFrameTimeDelta = nextFrame->RealTime - previousFrame->RealTime;
-				if (overShoot)  interFrameTimeDelta = duration - previousFrame->RealTime;
+		// calculate local progress between [previous] and [nextFrame]
+		Real interFrameTimeDelta = nextFrameTime - previousFrameTime;
+		if (overShoot)  interFrameTimeDelta = duration - previousFrameTime;
 
-				Real interFrameElapsed = progress - previousFrame->RealTime;
-				interFrameProgress = 1;
-				if (interFrameTimeDelta > 0)interFrameProgress = interFrameElapsed / interFrameTimeDelta;
+		Real interFrameElapsed = progress - previousFrameTime;
+		interFrameProgress = 1;
+		if (interFrameTimeDelta > 0)interFrameProgress = interFrameElapsed / interFrameTimeDelta;
 
-				return true;
-			}
-		}
+		return true;
+	}
 
-		return false;
+	/*
+	 * Find the index of the first key frame of type [component] in [keyFrameSet] whose time stamp is greater than [time], or the
+	 * index of the last key frame if there is no such frame, starting from the result of the previous search in [cursor].
+	 */
+	UInt32 AnimationPlayer::findKeyFrame(TransformationCompnent component, const KeyFrameSet& keyFrameSet, UInt32 frameCount, Real time, UInt32 cursor) const {
+		return KeyFrameSearch::find([this, component, &keyFrameSet](UInt32 frame) {
+			return this->getKeyFrameTime(component, frame, keyFrameSet);
+		}, frameCount, time, cursor);
 	}
 
 	/*
@@ -885,4 +1071,52 @@ namespace Core {
 			instance->playBackMode = playbackMode;
 		}
 	}
+
+	/*
+	 * Set the levels of detail used by this player, which are sorted by ascending MinMetric. The level used each
+	 * frame is the last one whose MinMetric does not exceed the LOD metric. An empty list turns LOD off.
+	 */
+	void AnimationPlayer::setLODLevels(const std::vector<AnimationLODLevel>& levels) {
+		this->lodLevels = levels;
+		std::stable_sort(this->lodLevels.begin(), this->lodLevels.end(), [](const AnimationLODLevel& a, const AnimationLODLevel& b) {
+			return a.MinMetric < b.MinMetric;
+		});
+		this->lodLevel = 0;
+	}
+
+	/*
+	 * Replace the distance to the AnimationManager's LOD camera with [metric], e.g. the screen size of the
+	 * character. It is called once per frame on the main thread. Pass an empty function to restore the default.
+	 */
+	void AnimationPlayer::setLODMetric(std::function<Real()> metric) {
+		this->lodMetric = metric;
+	}
+
+	/*
+	 * Interpolate the pose on frames between sampled updates instead of holding the last one.
+	 */
+	void AnimationPlayer::setLODInterpolationEnabled(Bool enabled) {
+		this->lodInterpolationEnabled = enabled;
+	}
+
+	/*
+	 * Mark the skeleton nodes named in [nodeNames] (typically leaf bones such as fingers or facial bones) as detail
+	 * nodes, which are left at their last pose by levels with SkipDetailNodes set. Replaces any previous selection.
+	 */
+	void AnimationPlayer::setDetailNodes(const std::vector<std::string>& nodeNames) {
+		this->detailNodes.assign(this->target->getNodeCount(), false);
+		for (const std::string& name : nodeNames) {
+			Int32 nodeIndex = this->target->getNodeMapping(name);
+			if (nodeIndex >= 0 && (UInt32)nodeIndex < this->detailNodes.size()) {
+				this->detailNodes[nodeIndex] = true;
+			}
+		}
+	}
+
+	/*
+	 * Index into the levels passed to setLODLevels() used for the current frame.
+	 */
+	UInt32 AnimationPlayer::getLODLevel() const {
+		return this->lodLevel;
+	}
 }
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <functional>
 #include <vector>
 #include <queue>
 #include <unordered_map>
@@ -19,6 +20,7 @@
 #include "../base/CoreObject.h"
 #include "../geometry/Vector3.h"
 #include "../math/Quaternion.h"
+#include "../math/Matrix4x4.h"
 #include "KeyFrameSet.h"
 
 namespace Core {
@@ -41,6 +43,20 @@ namespace Core {
 		PingPong = 2
 	};
 
+	class AnimationLODLevel {
+	public:
+
+		// smallest LOD metric (by default the distance to the LOD camera) at which this level is used
+		Real MinMetric;
+		// animations are sampled every [UpdateInterval] frames
+		UInt32 UpdateInterval;
+		// leave the nodes passed to AnimationPlayer::setDetailNodes() at their last pose
+		Bool SkipDetailNodes;
+
+		AnimationLODLevel();
+		AnimationLODLevel(Real minMetric, UInt32 updateInterval, Bool skipDetailNodes);
+	};
+
 	class AnimationPlayer {
 
 		friend class Engine;
@@ -58,6 +74,11 @@ namespace Core {
 		void crossFade(WeakPointer<Animation> target, Real duration);
 		void crossFade(WeakPointer<Animation> target, Real duration, Bool queued);
 		void setPlaybackMode(WeakPointer<Animation> target, PlaybackMode playbackMode);
+		void setLODLevels(const std::vector<AnimationLODLevel>& levels);
+		void setLODMetric(std::function<Real()> metric);
+		void setLODInterpolationEnabled(Bool enabled);
+		void setDetailNodes(const std::vector<std::string>& nodeNames);
+		UInt32 getLODLevel() const;
 
 	private:
 
@@ -77,6 +98,38 @@ namespace Core {
 		std::vector<Bool> crossFadeTargets;
 		// number of animations currently playing
 		Int32 playingAnimationsCount;
+		// blended local transformation of each skeleton node, calculated by evaluate()
+		std::vector<Matrix4x4> nodeTransforms;
+		// flags that indicate which entries in [nodeTransforms] were calculated by the last call to evaluate()
+		std::vector<Bool> nodeTransformsSet;
+
+		// level of detail settings, sorted by ascending MinMetric. when empty every node is updated every frame.
+		std::vector<AnimationLODLevel> lodLevels;
+		// user-supplied LOD metric, used instead of the distance from the AnimationManager's LOD camera
+		std::function<Real()> lodMetric;
+		// index into [lodLevels] selected by the last call to updateLOD()
+		UInt32 lodLevel;
+		UInt32 lodUpdateInterval;
+		Bool lodInterpolationEnabled;
+		// flags for the nodes left alone by levels with SkipDetailNodes set, indexed like the skeleton's node list
+		std::vector<Bool> detailNodes;
+		// channels of a baked animation that are mapped to non-detail nodes, rebuilt for each instance sampled while skipping detail nodes
+		std::vector<Bool> sampledChannels;
+		// offsets the frames on which this player is updated from other players with the same interval
+		UInt32 lodUpdatePhase;
+		UInt32 lodFrameCount;
+		// frames since the last sampled update, and the time that has passed since then
+		UInt32 framesSinceUpdate;
+		Real pendingDeltaTime;
+		Bool hasUpdated;
+		// set by updateLOD(): whether the animations are sampled this frame, and whether [nodeTransforms] changes at all
+		Bool updateThisFrame;
+		Bool interpolateThisFrame;
+		// the two most recently sampled poses, between which [nodeTransforms] is interpolated when interpolation is enabled
+		std::vector<Matrix4x4> lodStartTransforms;
+		std::vector<Bool> lodStartTransformsSet;
+		std::vector<Matrix4x4> lodEndTransforms;
+		std::vector<Bool> lodEndTransformsSet;
 
 		AnimationPlayer(WeakPointer<Skeleton> target);
 
@@ -85,16 +138,23 @@ namespace Core {
 		void clearBlendOpQueue();
 
 		void update();
+		void updateLOD(const Point3r * cameraPosition);
+		Bool needsEvaluation() const;
+		void evaluate();
+		void interpolateNodeTransforms();
+		void applyNodeTransforms();
 		void updateBlendingOperations();
 		void checkWeights();
 		void applyActiveAnimations();
-		void updateAnimationsProgress();
-		void updateAnimationInstanceProgress(WeakPointer<AnimationInstance> instance) const;
-		void calculateInterpolatedValues(WeakPointer<AnimationInstance> instance, UInt32 channel, Vector3r& translation, Quaternion& rotation, Vector3r& scale) const;
-		void calculateInterpolatedTranslation(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, Vector3r& vector) const;
-		void calculateInterpolatedScale(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, Vector3r& vector) const;
-		void calculateInterpolatedRotation(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, Quaternion& rotation) const;
-		Bool calculateInterpolation(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, UInt32& lastIndex, UInt32& nextIndex, Real& interFrameProgress, TransformationCompnent component) const;
+		void updateAnimationsProgress(Real deltaTime);
+		void updateAnimationInstanceProgress(WeakPointer<AnimationInstance> instance, Real deltaTime) const;
+		void calculateInterpolatedValues(WeakPointer<AnimationInstance> instance, UInt32 node, UInt32 channel, Vector3r& translation, Quaternion& rotation, Vector3r& scale) const;
+		void calculateInterpolatedTranslation(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, UInt32& keyCursor, Vector3r& vector) const;
+		void calculateInterpolatedScale(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, UInt32& keyCursor, Vector3r& vector) const;
+		void calculateInterpolatedRotation(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, UInt32& keyCursor, Quaternion& rotation) const;
+		Bool calculateInterpolation(WeakPointer<AnimationInstance> instance, const KeyFrameSet& keyFrameSet, UInt32& keyCursor, UInt32& lastIndex, UInt32& nextIndex,
+									Real& interFrameProgress, TransformationCompnent component) const;
+		UInt32 findKeyFrame(TransformationCompnent component, const KeyFrameSet& keyFrameSet, UInt32 frameCount, Real time, UInt32 cursor) const;
 		Real getKeyFrameTime(TransformationCompnent transformationComponent, Int32 frameIndex, const KeyFrameSet& keyFrameSet) const;
 
 		void setSpeed(UInt32 animationIndex, Real speedFactor);
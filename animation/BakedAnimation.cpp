@@ -0,0 +1,624 @@
+#include <cmath>
+
+#include "BakedAnimation.h"
+#include "KeyFrameSet.h"
+#include "KeyFrameSearch.h"
+#include "../math/SIMD.h"
+#include "../common/Exception.h"
+
+namespace Core {
+
+	const UInt32 BakedAnimation::ChannelGroupSize;
+	const UInt32 BakedAnimation::TranslationComponent;
+	const UInt32 BakedAnimation::RotationComponent;
+	const UInt32 BakedAnimation::ScaleComponent;
+	const UInt32 BakedAnimation::ComponentCount;
+	const UInt32 BakedAnimation::MaxReducedSpan;
+	const UInt32 BakedAnimation::QuantizedRangeSteps;
+
+	/*
+	 * Per-lane kernels used by sampleGroup(). Each operand holds one component of ChannelGroupSize channels.
+	 */
+#if defined(CORE_SIMD_SSE)
+	static inline void lerpLanes(const Real * previous, const Real * next, const Real * t, Real * out) {
+		__m128 a = _mm_loadu_ps(previous);
+		__m128 b = _mm_loadu_ps(next);
+		_mm_storeu_ps(out, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_loadu_ps(t))));
+	}
+
+	static inline void nlerpLanes(Real (*previous)[BakedAnimation::ChannelGroupSize], Real (*next)[BakedAnimation::ChannelGroupSize],
+								  const Real * t, Real ** out) {
+		__m128 a[4], b[4];
+		__m128 dot = _mm_setzero_ps();
+		for (UInt32 c = 0; c < 4; c++) {
+			a[c] = _mm_loadu_ps(previous[c]);
+			b[c] = _mm_loadu_ps(next[c]);
+			dot = _mm_add_ps(dot, _mm_mul_ps(a[c], b[c]));
+		}
+
+		// take the shortest path by negating [next] wherever it lies in the opposite hemisphere of [previous]
+		__m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+		__m128 lanesT = _mm_loadu_ps(t);
+		__m128 lengthSquared = _mm_setzero_ps();
+		for (UInt32 c = 0; c < 4; c++) {
+			a[c] = _mm_add_ps(a[c], _mm_mul_ps(_mm_sub_ps(_mm_xor_ps(b[c], flip), a[c]), lanesT));
+			lengthSquared = _mm_add_ps(lengthSquared, _mm_mul_ps(a[c], a[c]));
+		}
+
+		__m128 length = _mm_sqrt_ps(lengthSquared);
+		for (UInt32 c = 0; c < 4; c++) {
+			_mm_storeu_ps(out[c], _mm_div_ps(a[c], length));
+		}
+	}
+#elif defined(CORE_SIMD_NEON)
+	static inline void lerpLanes(const Real * previous, const Real * next, const Real * t, Real * out) {
+		float32x4_t a = vld1q_f32(previous);
+		float32x4_t b = vld1q_f32(next);
+		vst1q_f32(out, vmlaq_f32(a, vsubq_f32(b, a), vld1q_f32(t)));
+	}
+
+	static inline void nlerpLanes(Real (*previous)[BakedAnimation::ChannelGroupSize], Real (*next)[BakedAnimation::ChannelGroupSize],
+								  const Real * t, Real ** out) {
+		float32x4_t a[4], b[4];
+		float32x4_t dot = vdupq_n_f32(0);
+		for (UInt32 c = 0; c < 4; c++) {
+			a[c] = vld1q_f32(previous[c]);
+			b[c] = vld1q_f32(next[c]);
+			dot = vmlaq_f32(dot, a[c], b[c]);
+		}
+
+		// take the shortest path by negating [next] wherever it lies in the opposite hemisphere of [previous]
+		uint32x4_t flip = vandq_u32(vcltq_f32(dot, vdupq_n_f32(0)), vdupq_n_u32(0x80000000));
+		float32x4_t lanesT = vld1q_f32(t);
+		float32x4_t lengthSquared = vdupq_n_f32(0);
+		for (UInt32 c = 0; c < 4; c++) {
+			float32x4_t flipped = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(b[c]), flip));
+			a[c] = vmlaq_f32(a[c], vsubq_f32(flipped, a[c]), lanesT);
+			lengthSquared = vmlaq_f32(lengthSquared, a[c], a[c]);
+		}
+
+		// reciprocal square root estimate refined with two Newton-Raphson steps
+		float32x4_t inverseLength = vrsqrteq_f32(lengthSquared);
+		inverseLength = vmulq_f32(inverseLength, vrsqrtsq_f32(vmulq_f32(lengthSquared, inverseLength), inverseLength));
+		inverseLength = vmulq_f32(inverseLength, vrsqrtsq_f32(vmulq_f32(lengthSquared, inverseLength), inverseLength));
+		for (UInt32 c = 0; c < 4; c++) {
+			vst1q_f32(out[c], vmulq_f32(a[c], inverseLength));
+		}
+	}
+#else
+	static inline void lerpLanes(const Real * previous, const Real * next, const Real * t, Real * out) {
+		for (UInt32 lane = 0; lane < BakedAnimation::ChannelGroupSize; lane++) {
+			out[lane] = previous[lane] + (next[lane] - previous[lane]) * t[lane];
+		}
+	}
+
+	static inline void nlerpLanes(Real (*previous)[BakedAnimation::ChannelGroupSize], Real (*next)[BakedAnimation::ChannelGroupSize],
+								  const Real * t, Real ** out) {
+		for (UInt32 lane = 0; lane < BakedAnimation::ChannelGroupSize; lane++) {
+			Real dot = 0;
+			for (UInt32 c = 0; c < 4; c++) dot += previous[c][lane] * next[c][lane];
+			Real sign = dot < 0 ? (Real)-1.0 : (Real)1.0;
+
+			Real result[4];
+			Real lengthSquared = 0;
+			for (UInt32 c = 0; c < 4; c++) {
+				result[c] = previous[c][lane] + (next[c][lane] * sign - previous[c][lane]) * t[lane];
+				lengthSquared += result[c] * result[c];
+			}
+
+			Real length = (Real)std::sqrt(lengthSquared);
+			for (UInt32 c = 0; c < 4; c++) out[c][lane] = result[c] / length;
+		}
+	}
+#endif
+
+	/*
+	 * Smallest-three quaternion encoding: the largest component is dropped (after flipping the sign of the quaternion so that
+	 * it is positive) and recovered from the unit length constraint. The other three lie within +/- 1 / sqrt(2) and are stored
+	 * with 15 bits each; the index of the dropped component takes the top bits of the first two words.
+	 */
+	static const Real SmallestThreeRange = (Real)0.70710678118654752;
+	static const Real SmallestThreeSteps = (Real)0x7FFF;
+
+	static void encodeRotation(const Real * rotation, UInt16 * packed) {
+		Real length = 0;
+		UInt32 largest = 0;
+		for (UInt32 c = 0; c < 4; c++) {
+			length += rotation[c] * rotation[c];
+			if (std::fabs(rotation[c]) > std::fabs(rotation[largest])) largest = c;
+		}
+		length = (Real)std::sqrt(length);
+		Real scale = (rotation[largest] < 0 ? (Real)-1.0 : (Real)1.0) / (length > 0 ? length : (Real)1.0);
+
+		UInt32 word = 0;
+		for (UInt32 c = 0; c < 4; c++) {
+			if (c == largest) continue;
+			Real value = rotation[c] * scale / SmallestThreeRange;
+			if (value < -1) value = -1;
+			if (value > 1) value = 1;
+			packed[word++] = (UInt16)((value * (Real)0.5 + (Real)0.5) * SmallestThreeSteps + (Real)0.5);
+		}
+		packed[0] |= (UInt16)((largest >> 1) << 15);
+		packed[1] |= (UInt16)((largest & 1) << 15);
+	}
+
+	static void decodeRotation(const UInt16 * packed, Real * rotation) {
+		UInt32 largest = ((packed[0] >> 15) << 1) | (packed[1] >> 15);
+		Real lengthSquared = 0;
+		UInt32 word = 0;
+		for (UInt32 c = 0; c < 4; c++) {
+			if (c == largest) continue;
+			Real value = ((Real)(packed[word++] & 0x7FFF) / SmallestThreeSteps * 2 - 1) * SmallestThreeRange;
+			rotation[c] = value;
+			lengthSquared += value * value;
+		}
+		rotation[largest] = lengthSquared < 1 ? (Real)std::sqrt(1 - lengthSquared) : 0;
+	}
+
+	BakedAnimation::Pose::Pose(): stride(0) {
+	}
+
+	/*
+	 * Make room for [channelCount] channels. The key frame cursors are only reset when the size changes.
+	 */
+	void BakedAnimation::Pose::resize(UInt32 channelCount) {
+		UInt32 newStride = (channelCount + ChannelGroupSize - 1) / ChannelGroupSize * ChannelGroupSize;
+		if (newStride == this->stride) return;
+		this->stride = newStride;
+		this->values.assign(ComponentCount * newStride, 0);
+		this->keyCursors.assign(3 * newStride, 0);
+	}
+
+	void BakedAnimation::Pose::getTranslation(UInt32 channel, Real& x, Real& y, Real& z) const {
+		const Real * values = this->values.data() + TranslationComponent * this->stride + channel;
+		x = values[0];
+		y = values[this->stride];
+		z = values[2 * this->stride];
+	}
+
+	void BakedAnimation::Pose::getRotation(UInt32 channel, Real& x, Real& y, Real& z, Real& w) const {
+		const Real * values = this->values.data() + RotationComponent * this->stride + channel;
+		x = values[0];
+		y = values[this->stride];
+		z = values[2 * this->stride];
+		w = values[3 * this->stride];
+	}
+
+	void BakedAnimation::Pose::getScale(UInt32 channel, Real& x, Real& y, Real& z) const {
+		const Real * values = this->values.data() + ScaleComponent * this->stride + channel;
+		x = values[0];
+		y = values[this->stride];
+		z = values[2 * this->stride];
+	}
+
+	AnimationCompressionSettings::AnimationCompressionSettings(): TranslationTolerance((Real)0.001), RotationTolerance((Real)0.001),
+																  ScaleTolerance((Real)0.001), QuantizeValues(true), ReleaseKeyFrames(true) {
+	}
+
+	AnimationCompressionReport::AnimationCompressionReport(): OriginalSize(0), CompressedSize(0), OriginalKeyCount(0), CompressedKeyCount(0),
+															  MaxTranslationError(0), MaxRotationError(0), MaxScaleError(0) {
+	}
+
+	/*
+	 * Copy the key frames of the [channelCount] KeyFrameSet objects in [keyFrameSets] into a single array. A channel is only
+	 * baked if its KeyFrameSet is in use and has at least one key frame of each type; the other channels are skipped by sample().
+	 */
+	BakedAnimation::BakedAnimation(const KeyFrameSet * keyFrameSets, UInt32 channelCount): channelCount(channelCount) {
+		this->build(keyFrameSets, nullptr, nullptr);
+	}
+
+	/*
+	 * Same as above, but compress the key frames according to [settings]. If [report] is not null, it receives the memory used
+	 * before and after compression and the largest errors measured at the time stamps of the original key frames.
+	 */
+	BakedAnimation::BakedAnimation(const KeyFrameSet * keyFrameSets, UInt32 channelCount, const AnimationCompressionSettings& settings,
+								   AnimationCompressionReport * report): channelCount(channelCount) {
+		this->build(keyFrameSets, &settings, report);
+	}
+
+	void BakedAnimation::build(const KeyFrameSet * keyFrameSets, const AnimationCompressionSettings * settings, AnimationCompressionReport * report) {
+		if (keyFrameSets == nullptr && channelCount > 0) {
+			throw NullPointerException("BakedAnimation::build -> 'keyFrameSets' is null.");
+		}
+
+		this->compressed = settings != nullptr;
+		this->quantized = this->compressed && settings->QuantizeValues;
+		this->tracks.resize(3 * channelCount);
+		this->channelUsed.resize(channelCount);
+		if (report != nullptr) *report = AnimationCompressionReport();
+
+		std::vector<Real> times;
+		std::vector<Real> values;
+		for (UInt32 channel = 0; channel < channelCount; channel++) {
+			const KeyFrameSet& keyFrameSet = keyFrameSets[channel];
+			UInt32 translationCount = (UInt32)keyFrameSet.TranslationKeyFrames.size();
+			UInt32 rotationCount = (UInt32)keyFrameSet.RotationKeyFrames.size();
+			UInt32 scaleCount = (UInt32)keyFrameSet.ScaleKeyFrames.size();
+			this->channelUsed[channel] = keyFrameSet.Used && translationCount > 0 && rotationCount > 0 && scaleCount > 0;
+
+			if (report != nullptr) {
+				report->OriginalSize += (UInt32)(sizeof(KeyFrameSet) + translationCount * sizeof(TranslationKeyFrame) +
+												 rotationCount * sizeof(RotationKeyFrame) + scaleCount * sizeof(ScaleKeyFrame));
+				report->OriginalKeyCount += translationCount + rotationCount + scaleCount;
+			}
+
+			for (UInt32 type = 0; type < 3; type++) {
+				Track& track = this->tracks[3 * channel + type];
+				track.keyCount = track.timeOffset = track.valueOffset = track.rangeOffset = 0;
+				if (!this->channelUsed[channel]) continue;
+
+				gatherTrack((TrackType)type, keyFrameSet, times, values);
+				this->addTrack((TrackType)type, channel, times, values, settings);
+			}
+		}
+
+		// drop the spare capacity left by the appends
+		std::vector<Real>(this->data).swap(this->data);
+		std::vector<UInt16>(this->quantizedData).swap(this->quantizedData);
+
+		if (report != nullptr) {
+			report->CompressedSize = this->getSize();
+			Real sampled[4];
+			for (UInt32 channel = 0; channel < channelCount; channel++) {
+				if (!this->channelUsed[channel]) continue;
+				for (UInt32 type = 0; type < 3; type++) {
+					report->CompressedKeyCount += this->tracks[3 * channel + type].keyCount;
+
+					gatherTrack((TrackType)type, keyFrameSets[channel], times, values);
+					UInt32 valueCount = type == Rotation ? 4 : 3;
+					Real maxError = 0;
+					for (UInt32 key = 0; key < times.size(); key++) {
+						this->sampleTrack((TrackType)type, channel, times[key], sampled);
+						Real error = measureError((TrackType)type, sampled, &values[key * valueCount]);
+						if (error > maxError) maxError = error;
+					}
+
+					Real& reportError = type == Translation ? report->MaxTranslationError : (type == Rotation ? report->MaxRotationError : report->MaxScaleError);
+					if (maxError > reportError) reportError = maxError;
+				}
+			}
+		}
+	}
+
+	/*
+	 * Append the track of type [type] for [channel], whose key frames are given by [times] and [values]. When [settings] is not null,
+	 * the keys that interpolation can reproduce within the channel's tolerance are dropped, and the values are quantized if requested.
+	 */
+	void BakedAnimation::addTrack(TrackType type, UInt32 channel, const std::vector<Real>& times, const std::vector<Real>& values,
+								  const AnimationCompressionSettings * settings) {
+		UInt32 valueCount = type == Rotation ? 4 : 3;
+		UInt32 keyCount = (UInt32)times.size();
+
+		std::vector<UInt32> keptKeys;
+		if (settings != nullptr) {
+			Real tolerance = type == Translation ? settings->TranslationTolerance : (type == Rotation ? settings->RotationTolerance : settings->ScaleTolerance);
+			if (channel < settings->ChannelToleranceScales.size()) tolerance *= settings->ChannelToleranceScales[channel];
+			reduceKeys(type, times, values, tolerance, keptKeys);
+		}
+		else {
+			keptKeys.resize(keyCount);
+			for (UInt32 key = 0; key < keyCount; key++) keptKeys[key] = key;
+		}
+
+		Track& track = this->tracks[3 * channel + type];
+		track.keyCount = (UInt32)keptKeys.size();
+		track.timeOffset = (UInt32)this->data.size();
+		for (UInt32 key : keptKeys) this->data.push_back(times[key]);
+
+		if (!this->quantized) {
+			track.valueOffset = (UInt32)this->data.size();
+			for (UInt32 key : keptKeys) {
+				for (UInt32 c = 0; c < valueCount; c++) this->data.push_back(values[key * valueCount + c]);
+			}
+		}
+		else if (type == Rotation) {
+			track.valueOffset = (UInt32)this->quantizedData.size();
+			for (UInt32 key : keptKeys) {
+				UInt16 packed[3];
+				encodeRotation(&values[key * valueCount], packed);
+				for (UInt32 c = 0; c < 3; c++) this->quantizedData.push_back(packed[c]);
+			}
+		}
+		else {
+			Real minimum[3], maximum[3];
+			for (UInt32 c = 0; c < 3; c++) minimum[c] = maximum[c] = values[keptKeys[0] * valueCount + c];
+			for (UInt32 key : keptKeys) {
+				for (UInt32 c = 0; c < 3; c++) {
+					Real value = values[key * valueCount + c];
+					if (value < minimum[c]) minimum[c] = value;
+					if (value > maximum[c]) maximum[c] = value;
+				}
+			}
+
+			track.rangeOffset = (UInt32)this->data.size();
+			for (UInt32 c = 0; c < 3; c++) this->data.push_back(minimum[c]);
+			for (UInt32 c = 0; c < 3; c++) this->data.push_back((maximum[c] - minimum[c]) / (Real)QuantizedRangeSteps);
+			const Real * step = &this->data[track.rangeOffset + 3];
+
+			track.valueOffset = (UInt32)this->quantizedData.size();
+			for (UInt32 key : keptKeys) {
+				for (UInt32 c = 0; c < 3; c++) {
+					Real steps = step[c] > 0 ? (values[key * valueCount + c] - minimum[c]) / step[c] : 0;
+					this->quantizedData.push_back((UInt16)(steps + (Real)0.5));
+				}
+			}
+		}
+	}
+
+	UInt32 BakedAnimation::getChannelCount() const {
+		return this->channelCount;
+	}
+
+	Bool BakedAnimation::isChannelUsed(UInt32 channel) const {
+		return this->channelUsed[channel];
+	}
+
+	Bool BakedAnimation::isCompressed() const {
+		return this->compressed;
+	}
+
+	/*
+	 * Size in bytes of the baked key frame data.
+	 */
+	UInt32 BakedAnimation::getSize() const {
+		return (UInt32)(this->data.size() * sizeof(Real) + this->quantizedData.size() * sizeof(UInt16) + this->tracks.size() * sizeof(Track));
+	}
+
+	/*
+	 * Sample every used channel at [time] and store the results in [pose]. [duration] and [startOffset] are used when [time]
+	 * lies beyond the last key frame of a track, in which case the track is interpolated back towards its first key frame
+	 * (or the first key frame after [startOffset]) to keep looping animations smooth, as AnimationPlayer does.
+	 * When [channelMask] is given, only the channels flagged in it are sampled and the values of the others are left undefined.
+	 */
+	void BakedAnimation::sample(Real time, Real duration, Real startOffset, Pose& pose, const std::vector<Bool> * channelMask) const {
+		pose.resize(this->channelCount);
+		for (UInt32 first = 0; first < this->channelCount; first += ChannelGroupSize) {
+			UInt32 count = this->channelCount - first < ChannelGroupSize ? this->channelCount - first : ChannelGroupSize;
+
+			// skip groups in which every channel is masked out
+			if (channelMask != nullptr) {
+				Bool anySampled = false;
+				for (UInt32 channel = first; channel < first + count; channel++) {
+					if ((*channelMask)[channel]) anySampled = true;
+				}
+				if (!anySampled) continue;
+			}
+
+			this->sampleGroup(Translation, first, count, time, duration, startOffset, pose, channelMask);
+			this->sampleGroup(Rotation, first, count, time, duration, startOffset, pose, channelMask);
+			this->sampleGroup(Scale, first, count, time, duration, startOffset, pose, channelMask);
+		}
+	}
+
+	/*
+	 * Sample the tracks of type [type] for channels [firstChannel, firstChannel + channelCount). The key frame search is done
+	 * per channel; the key values are then gathered so that each component of every channel is interpolated in one operation.
+	 * Rotations use normalized linear interpolation rather than slerp, which is close enough between adjacent key frames.
+	 */
+	void BakedAnimation::sampleGroup(TrackType type, UInt32 firstChannel, UInt32 channelCount, Real time, Real duration,
+									 Real startOffset, Pose& pose, const std::vector<Bool> * channelMask) const {
+		UInt32 valueCount = type == Rotation ? 4 : 3;
+		UInt32 firstComponent = type == Translation ? TranslationComponent : (type == Rotation ? RotationComponent : ScaleComponent);
+
+		Real previousValues[4][ChannelGroupSize];
+		Real nextValues[4][ChannelGroupSize];
+		Real t[ChannelGroupSize];
+
+		for (UInt32 lane = 0; lane < ChannelGroupSize; lane++) {
+			UInt32 channel = firstChannel + lane;
+
+			// unused and masked out lanes interpolate between identity values so they stay finite
+			if (lane >= channelCount || !this->channelUsed[channel] || (channelMask != nullptr && !(*channelMask)[channel])) {
+				for (UInt32 c = 0; c < 4; c++) {
+					previousValues[c][lane] = nextValues[c][lane] = (c == 3 || type == Scale) ? (Real)1.0 : (Real)0.0;
+				}
+				t[lane] = 0;
+				continue;
+			}
+
+			const Track& track = this->tracks[3 * channel + type];
+			const Real * times = this->data.data() + track.timeOffset;
+			UInt32 lastKey = track.keyCount - 1;
+
+			UInt32& cursor = pose.keyCursors[type * pose.stride + channel];
+			UInt32 key = findKey(times, track.keyCount, time, cursor);
+			cursor = key;
+
+			UInt32 previousKey = key > 0 ? key - 1 : 0;
+			UInt32 nextKey = key;
+			Real delta;
+			if (key == lastKey && times[key] <= time) {
+				// past the last key frame: interpolate towards the key frame the animation will loop back to
+				previousKey = key;
+				nextKey = startOffset > 0 ? findKey(times, track.keyCount, startOffset, 0) : 0;
+				delta = duration - times[previousKey];
+			}
+			else {
+				delta = times[nextKey] - times[previousKey];
+			}
+			t[lane] = delta > 0 ? (time - times[previousKey]) / delta : (Real)1.0;
+
+			Real previous[4], next[4];
+			this->readKey(type, track, previousKey, previous);
+			this->readKey(type, track, nextKey, next);
+			for (UInt32 c = 0; c < valueCount; c++) {
+				previousValues[c][lane] = previous[c];
+				nextValues[c][lane] = next[c];
+			}
+		}
+
+		Real * out[4];
+		for (UInt32 c = 0; c < valueCount; c++) {
+			out[c] = pose.values.data() + (firstComponent + c) * pose.stride + firstChannel;
+		}
+
+		if (type == Rotation) {
+			nlerpLanes(previousValues, nextValues, t, out);
+		}
+		else {
+			for (UInt32 c = 0; c < valueCount; c++) {
+				lerpLanes(previousValues[c], nextValues[c], t, out[c]);
+			}
+		}
+	}
+
+	/*
+	 * The index of the first of [keyCount] keys with a time stamp in [times] greater than [time], or the last key if there is
+	 * none, see KeyFrameSearch::find().
+	 */
+	UInt32 BakedAnimation::findKey(const Real * times, UInt32 keyCount, Real time, UInt32 cursor) {
+		return KeyFrameSearch::find([times](UInt32 key) {
+			return times[key];
+		}, keyCount, time, cursor);
+	}
+
+	/*
+	 * Copy the key frame times and values of type [type] in [keyFrameSet] into [times] and [values].
+	 */
+	void BakedAnimation::gatherTrack(TrackType type, const KeyFrameSet& keyFrameSet, std::vector<Real>& times, std::vector<Real>& values) {
+		times.clear();
+		values.clear();
+		if (type == Translation) {
+			for (const TranslationKeyFrame& keyFrame : keyFrameSet.TranslationKeyFrames) {
+				times.push_back(keyFrame.RealTime);
+				values.push_back(keyFrame.Translation.x);
+				values.push_back(keyFrame.Translation.y);
+				values.push_back(keyFrame.Translation.z);
+			}
+		}
+		else if (type == Rotation) {
+			for (const RotationKeyFrame& keyFrame : keyFrameSet.RotationKeyFrames) {
+				times.push_back(keyFrame.RealTime);
+				values.push_back(keyFrame.Rotation.x());
+				values.push_back(keyFrame.Rotation.y());
+				values.push_back(keyFrame.Rotation.z());
+				values.push_back(keyFrame.Rotation.w());
+			}
+		}
+		else {
+			for (const ScaleKeyFrame& keyFrame : keyFrameSet.ScaleKeyFrames) {
+				times.push_back(keyFrame.RealTime);
+				values.push_back(keyFrame.Scale.x);
+				values.push_back(keyFrame.Scale.y);
+				values.push_back(keyFrame.Scale.z);
+			}
+		}
+	}
+
+	/*
+	 * Decompress the value of key [key] in [track] into [value].
+	 */
+	void BakedAnimation::readKey(TrackType type, const Track& track, UInt32 key, Real * value) const {
+		UInt32 valueCount = type == Rotation ? 4 : 3;
+		if (!this->quantized) {
+			const Real * values = this->data.data() + track.valueOffset + key * valueCount;
+			for (UInt32 c = 0; c < valueCount; c++) value[c] = values[c];
+		}
+		else if (type == Rotation) {
+			decodeRotation(this->quantizedData.data() + track.valueOffset + key * 3, value);
+		}
+		else {
+			const UInt16 * packed = this->quantizedData.data() + track.valueOffset + key * 3;
+			const Real * range = this->data.data() + track.rangeOffset;
+			for (UInt32 c = 0; c < 3; c++) value[c] = range[c] + (Real)packed[c] * range[3 + c];
+		}
+	}
+
+	/*
+	 * Scalar sample of a single track at [time], which must not lie beyond the last key frame of the track.
+	 */
+	void BakedAnimation::sampleTrack(TrackType type, UInt32 channel, Real time, Real * value) const {
+		const Track& track = this->tracks[3 * channel + type];
+		const Real * times = this->data.data() + track.timeOffset;
+		UInt32 key = findKey(times, track.keyCount, time, 0);
+		UInt32 previousKey = key > 0 ? key - 1 : 0;
+		Real delta = times[key] - times[previousKey];
+		Real t = delta > 0 ? (time - times[previousKey]) / delta : (Real)1.0;
+		if (key == track.keyCount - 1 && times[key] <= time) {
+			previousKey = key;
+			t = 0;
+		}
+
+		Real previous[4], next[4];
+		this->readKey(type, track, previousKey, previous);
+		this->readKey(type, track, key, next);
+		interpolate(type, previous, next, t, value);
+	}
+
+	/*
+	 * Scalar version of the interpolation done by sampleGroup().
+	 */
+	void BakedAnimation::interpolate(TrackType type, const Real * previous, const Real * next, Real t, Real * value) {
+		if (type != Rotation) {
+			for (UInt32 c = 0; c < 3; c++) value[c] = previous[c] + (next[c] - previous[c]) * t;
+			return;
+		}
+
+		Real dot = 0;
+		for (UInt32 c = 0; c < 4; c++) dot += previous[c] * next[c];
+		Real sign = dot < 0 ? (Real)-1.0 : (Real)1.0;
+		Real lengthSquared = 0;
+		for (UInt32 c = 0; c < 4; c++) {
+			value[c] = previous[c] + (next[c] * sign - previous[c]) * t;
+			lengthSquared += value[c] * value[c];
+		}
+		Real length = (Real)std::sqrt(lengthSquared);
+		if (length > 0) {
+			for (UInt32 c = 0; c < 4; c++) value[c] /= length;
+		}
+	}
+
+	/*
+	 * The distance between two translations or scales, or the angle in radians between two rotations.
+	 */
+	Real BakedAnimation::measureError(TrackType type, const Real * a, const Real * b) {
+		if (type != Rotation) {
+			Real distanceSquared = 0;
+			for (UInt32 c = 0; c < 3; c++) distanceSquared += (a[c] - b[c]) * (a[c] - b[c]);
+			return (Real)std::sqrt(distanceSquared);
+		}
+
+		Real dot = 0, lengthSquaredA = 0, lengthSquaredB = 0;
+		for (UInt32 c = 0; c < 4; c++) {
+			dot += a[c] * b[c];
+			lengthSquaredA += a[c] * a[c];
+			lengthSquaredB += b[c] * b[c];
+		}
+		Real lengths = (Real)std::sqrt(lengthSquaredA * lengthSquaredB);
+		Real cosine = lengths > 0 ? (Real)std::fabs(dot) / lengths : (Real)1.0;
+		if (cosine > 1) cosine = 1;
+		return (Real)2.0 * (Real)std::acos(cosine);
+	}
+
+	/*
+	 * Select the keys of a track that have to be kept so that interpolating between them reproduces every original key within
+	 * [tolerance]. The first and last keys are always kept. Each kept key is followed by the furthest key (up to MaxReducedSpan
+	 * keys away) for which every key in between can be interpolated from the pair.
+	 */
+	void BakedAnimation::reduceKeys(TrackType type, const std::vector<Real>& times, const std::vector<Real>& values, Real tolerance,
+									std::vector<UInt32>& keptKeys) {
+		UInt32 keyCount = (UInt32)times.size();
+		UInt32 valueCount = type == Rotation ? 4 : 3;
+
+		keptKeys.clear();
+		keptKeys.push_back(0);
+		if (keyCount == 1) return;
+
+		Real interpolated[4];
+		UInt32 anchor = 0;
+		for (UInt32 candidate = 2; candidate < keyCount; candidate++) {
+			Bool fits = candidate - anchor <= MaxReducedSpan;
+			Real delta = times[candidate] - times[anchor];
+			for (UInt32 key = anchor + 1; key < candidate && fits; key++) {
+				Real t = delta > 0 ? (times[key] - times[anchor]) / delta : (Real)1.0;
+				interpolate(type, &values[anchor * valueCount], &values[candidate * valueCount], t, interpolated);
+				if (measureError(type, interpolated, &values[key * valueCount]) > tolerance) fits = false;
+			}
+			if (!fits) {
+				anchor = candidate - 1;
+				keptKeys.push_back(anchor);
+			}
+		}
+		keptKeys.push_back(keyCount - 1);
+	}
+}
@@ -0,0 +1,163 @@
+/*********************************************
+*
+* class: BakedAnimation
+*
+* An immutable, sampling-friendly copy of the key frames of an
+* Animation. The key times and values of every channel are packed
+* into a single array of Reals, and sampling evaluates groups of
+* channels at once. Optionally the copy is compressed: redundant
+* keys are dropped and the values are quantized to 16 bits.
+*
+***********************************************/
+
+#pragma once
+
+#include <vector>
+
+#include "../common/types.h"
+
+namespace Core {
+
+	// forward declarations
+	class KeyFrameSet;
+
+	class AnimationCompressionSettings {
+	public:
+
+		// maximum distance between a removed translation key and the value interpolated in its place
+		Real TranslationTolerance;
+		// maximum angle in radians between a removed rotation key and the value interpolated in its place
+		Real RotationTolerance;
+		// maximum distance between a removed scale key and the value interpolated in its place
+		Real ScaleTolerance;
+		// optional multiplier of the tolerances for each channel, e.g. to keep more keys for bones near the root
+		std::vector<Real> ChannelToleranceScales;
+		// store rotations as 48-bit smallest-three quaternions and translations and scales as 16-bit values
+		// within the range of their track
+		Bool QuantizeValues;
+		// free the key frames held by the Animation once it has been compressed
+		Bool ReleaseKeyFrames;
+
+		AnimationCompressionSettings();
+	};
+
+	class AnimationCompressionReport {
+	public:
+
+		// memory used by the key frames before compression, in bytes
+		UInt32 OriginalSize;
+		// memory used by the compressed animation, in bytes
+		UInt32 CompressedSize;
+		UInt32 OriginalKeyCount;
+		UInt32 CompressedKeyCount;
+		// largest differences measured between the compressed animation and the original key frames
+		Real MaxTranslationError;
+		Real MaxRotationError;
+		Real MaxScaleError;
+
+		AnimationCompressionReport();
+	};
+
+	class BakedAnimation {
+	public:
+
+		// number of channels evaluated together by sample()
+		static const UInt32 ChannelGroupSize = 4;
+
+		/*
+		 * The result of sampling every channel of a BakedAnimation at a single point in time, along with
+		 * the key frame cursors used to speed up the next call to sample(). Values are stored per component,
+		 * e.g. all translation x values first, then all translation y values, and so on.
+		 */
+		class Pose {
+		public:
+
+			friend class BakedAnimation;
+
+			Pose();
+
+			void getTranslation(UInt32 channel, Real& x, Real& y, Real& z) const;
+			void getRotation(UInt32 channel, Real& x, Real& y, Real& z, Real& w) const;
+			void getScale(UInt32 channel, Real& x, Real& y, Real& z) const;
+
+		private:
+
+			void resize(UInt32 channelCount);
+
+			// number of values stored per component, [channelCount] rounded up to a multiple of ChannelGroupSize
+			UInt32 stride;
+			std::vector<Real> values;
+			// one cursor per channel for each of translation, rotation, and scale
+			std::vector<UInt32> keyCursors;
+		};
+
+		BakedAnimation(const KeyFrameSet * keyFrameSets, UInt32 channelCount);
+		BakedAnimation(const KeyFrameSet * keyFrameSets, UInt32 channelCount, const AnimationCompressionSettings& settings,
+					   AnimationCompressionReport * report);
+
+		UInt32 getChannelCount() const;
+		Bool isChannelUsed(UInt32 channel) const;
+		Bool isCompressed() const;
+		UInt32 getSize() const;
+
+		void sample(Real time, Real duration, Real startOffset, Pose& pose, const std::vector<Bool> * channelMask = nullptr) const;
+
+	private:
+
+		enum TrackType {
+			Translation = 0,
+			Rotation = 1,
+			Scale = 2
+		};
+
+		// index of the first component of each track type in Pose::values
+		static const UInt32 TranslationComponent = 0;
+		static const UInt32 RotationComponent = 3;
+		static const UInt32 ScaleComponent = 7;
+		static const UInt32 ComponentCount = 10;
+
+		// keys further apart than this are never merged by key reduction, which bounds its cost
+		static const UInt32 MaxReducedSpan = 128;
+		// number of quantization steps in the range of a quantized translation or scale component
+		static const UInt32 QuantizedRangeSteps = 0xFFFF;
+
+		// location of the key frames of one track. [keyCount] times start at [timeOffset] in [data]. The values,
+		// 3 (translation, scale) or 4 (rotation) components per key, start at [valueOffset] in [data], or in
+		// [quantizedData] when compressed. Quantized translations and scales are stored relative to the range
+		// at [rangeOffset] in [data]: the minimum of each component, followed by the size of one quantization step.
+		class Track {
+		public:
+			UInt32 keyCount;
+			UInt32 timeOffset;
+			UInt32 valueOffset;
+			UInt32 rangeOffset;
+		};
+
+		void build(const KeyFrameSet * keyFrameSets, const AnimationCompressionSettings * settings, AnimationCompressionReport * report);
+		void addTrack(TrackType type, UInt32 channel, const std::vector<Real>& times, const std::vector<Real>& values,
+					  const AnimationCompressionSettings * settings);
+		void readKey(TrackType type, const Track& track, UInt32 key, Real * value) const;
+		void sampleTrack(TrackType type, UInt32 channel, Real time, Real * value) const;
+		void sampleGroup(TrackType type, UInt32 firstChannel, UInt32 channelCount, Real time, Real duration,
+						 Real startOffset, Pose& pose, const std::vector<Bool> * channelMask) const;
+		static UInt32 findKey(const Real * times, UInt32 keyCount, Real time, UInt32 cursor);
+		static void gatherTrack(TrackType type, const KeyFrameSet& keyFrameSet, std::vector<Real>& times, std::vector<Real>& values);
+		static void interpolate(TrackType type, const Real * previous, const Real * next, Real t, Real * value);
+		static Real measureError(TrackType type, const Real * a, const Real * b);
+		static void reduceKeys(TrackType type, const std::vector<Real>& times, const std::vector<Real>& values, Real tolerance,
+							   std::vector<UInt32>& keptKeys);
+
+		UInt32 channelCount;
+		// built with key reduction
+		Bool compressed;
+		// values are stored in [quantizedData]
+		Bool quantized;
+		// three tracks per channel: translation, rotation, and scale
+		std::vector<Track> tracks;
+		std::vector<Bool> channelUsed;
+		// times of every track, along with the values or quantization ranges
+		std::vector<Real> data;
+		// quantized values of every track when compressed, three per key
+		std::vector<UInt16> quantizedData;
+	};
+}
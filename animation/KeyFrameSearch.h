@@ -0,0 +1,63 @@
+/*********************************************
+*
+* class: KeyFrameSearch
+*
+* The key frame lookup shared by AnimationPlayer and
+* BakedAnimation, independent of how the key frame times
+* are stored.
+*
+***********************************************/
+
+#pragma once
+
+#include "../common/types.h"
+
+namespace Core {
+
+	class KeyFrameSearch {
+	public:
+
+		// number of frames find() walks forward from the cursor before falling back to a binary search
+		static const UInt32 MaxCursorSteps = 4;
+
+		/*
+		 * Find the index of the first of [frameCount] key frames whose time stamp, as returned by [frameTime] for a frame index, is
+		 * greater than [time], or the index of the last key frame if there is no such frame.
+		 *
+		 * During normal playback the result is the same as, or a few frames past, the result of the previous search, so the search
+		 * walks forward from [cursor] for up to [maxCursorSteps] frames. When the animation has looped or has been moved to a
+		 * distant position it falls back to a binary search.
+		 */
+		template <typename FrameTime>
+		static UInt32 find(FrameTime frameTime, UInt32 frameCount, Real time, UInt32 cursor, UInt32 maxCursorSteps = MaxCursorSteps) {
+			UInt32 lastFrame = frameCount - 1;
+			UInt32 low = 0;
+			UInt32 high = lastFrame;
+			if (cursor > lastFrame) cursor = lastFrame;
+
+			if (frameTime(cursor) <= time) {
+				// walk forward from the cursor
+				for (UInt32 step = 0; step < maxCursorSteps && cursor < lastFrame; step++) {
+					cursor++;
+					if (frameTime(cursor) > time) return cursor;
+				}
+				if (cursor == lastFrame) return lastFrame;
+				low = cursor + 1;
+			}
+			else {
+				// the cursor is past [time]; it is the answer if the frame before it is not
+				if (cursor == 0 || frameTime(cursor - 1) <= time) return cursor;
+				high = cursor - 1;
+			}
+
+			// binary search in [low, high] for the first frame with a time stamp greater than [time]; if none
+			// qualifies, [low] ends up at [high], which is the last frame or a frame known to qualify
+			while (low < high) {
+				UInt32 middle = low + (high - low) / 2;
+				if (frameTime(middle) > time) high = middle;
+				else low = middle + 1;
+			}
+			return low;
+		}
+	};
+}
@@ -1,14 +1,30 @@
+#include <cstring>
+
 #include "Skeleton.h"
 #include "Bone.h"
+#include "../Engine.h"
+#include "../Graphics.h"
+#include "../common/Constants.h"
+#include "../image/Texture2D.h"
+#include "../image/TextureAttr.h"
+#include "../math/Quaternion.h"
+#include "../scene/Transform.h"
 #include "../util/Tree.h"
 
 namespace Core {
+
+    const UInt32 Skeleton::SkinningModeCount;
+
     /*
     * Only constructor.
     */
     Skeleton::Skeleton(UInt32 boneCount) {
         this->boneCount = boneCount;
         this->bones = nullptr;
+        for (UInt32 i = 0; i < SkinningModeCount; i++) {
+            this->skinningPalettes[i].frame = 0;
+            this->skinningPalettes[i].valid = false;
+        }
     }
     /*
      * Destructor.
@@ -29,6 +45,15 @@ namespace Core {
         }
         this->boneNameMap.clear();
 
+        for (UInt32 i = 0; i < SkinningModeCount; i++) {
+            SkinningPalette& palette = this->skinningPalettes[i];
+            if (palette.texture.isValid()) {
+                Graphics::safeReleaseObject(palette.texture);
+                palette.texture = WeakPointer<Texture2D>::nullPtr();
+            }
+            palette.valid = false;
+        }
+
         // delete all SkeletonNode objects by traversing the node hierarchy and
         // using a visitor to invoke the callback below, which performsm the delete.
         this->skeleton.setTraversalCallback([](Tree<Skeleton::SkeletonNode *>::TreeNode * node) -> Bool {
@@ -193,6 +218,85 @@ namespace Core {
         }
     }
 
+    /*
+     * Compute the skinning transform of every bone (the world transform of its node times its offset matrix, relative to
+     * [reference]) and upload them to the palette texture for [mode]. This only happens once per [frameIndex], so every
+     * mesh bound to this skeleton shares the result across all of the passes in which it is drawn, and maps it into its
+     * own space with getSkinningPaletteReference(). Linear skinning stores each transform as a matrix in four texels,
+     * dual quaternion skinning as a rotation quaternion followed by a dual (translation) quaternion in two.
+     */
+    void Skeleton::updateSkinningPalette(SkinningMode mode, UInt32 frameIndex, const Transform& reference) {
+        SkinningPalette& palette = this->skinningPalettes[(UInt32)mode];
+        if (palette.valid && palette.frame == frameIndex) return;
+
+        static const UInt32 bonesPerRow = Constants::SkinningPaletteBonesPerRow;
+        UInt32 texelsPerBone = mode == SkinningMode::DualQuaternion ? 2 : 4;
+        UInt32 rowCount = (this->boneCount + bonesPerRow - 1) / bonesPerRow;
+        if (rowCount == 0) rowCount = 1;
+
+        if (!palette.texture.isValid()) {
+            TextureAttributes attributes;
+            attributes.FilterMode = TextureFilter::Point;
+            attributes.WrapMode = TextureWrap::Clamp;
+            attributes.MipLevels = 0;
+            attributes.Format = TextureFormat::RGBA32F;
+            palette.texture = Engine::instance()->createTexture2D(attributes);
+            palette.texture->buildEmpty(bonesPerRow * texelsPerBone, rowCount);
+            palette.data.assign(bonesPerRow * rowCount * texelsPerBone * 4, 0.0f);
+        }
+
+        palette.reference.copy(reference.getConstWorldMatrix());
+        const Matrix4x4& referenceInverse = reference.getConstInverseWorldMatrix();
+
+        Matrix4x4 nodeTransform;
+        Matrix4x4 boneTransform;
+        Vector3r translation;
+        Vector3r scale;
+        Quaternion rotation;
+        for (UInt32 i = 0; i < this->getNodeCount(); i++) {
+            SkeletonNode * node = this->nodeList[i];
+            if (node->BoneIndex < 0 || (UInt32)node->BoneIndex >= this->boneCount) continue;
+
+            Matrix4x4::multiply(referenceInverse, node->getFullTransform(), nodeTransform);
+            Matrix4x4::multiply(nodeTransform, this->bones[node->BoneIndex].OffsetMatrix, boneTransform);
+            Real * boneData = palette.data.data() + node->BoneIndex * texelsPerBone * 4;
+            if (mode == SkinningMode::DualQuaternion) {
+                boneTransform.decompose(translation, rotation, scale);
+                rotation.normalize();
+                Quaternion dual = Quaternion(translation, 0.0f) * rotation / 2.0f;
+                boneData[0] = rotation.x();
+                boneData[1] = rotation.y();
+                boneData[2] = rotation.z();
+                boneData[3] = rotation.w();
+                boneData[4] = dual.x();
+                boneData[5] = dual.y();
+                boneData[6] = dual.z();
+                boneData[7] = dual.w();
+            }
+            else {
+                memcpy(boneData, boneTransform.getConstData(), 16 * sizeof(Real));
+            }
+        }
+
+        palette.texture->updateRegion(0, 0, bonesPerRow * texelsPerBone, rowCount, (const Byte*)palette.data.data());
+        palette.frame = frameIndex;
+        palette.valid = true;
+    }
+
+    /*
+     * The texture updated by updateSkinningPalette() for [mode], which is invalid until it has been called at least once.
+     */
+    WeakPointer<Texture2D> Skeleton::getSkinningPaletteTexture(SkinningMode mode) {
+        return this->skinningPalettes[(UInt32)mode].texture;
+    }
+
+    /*
+     * World matrix of the transform that the palette for [mode] is relative to.
+     */
+    const Matrix4x4& Skeleton::getSkinningPaletteReference(SkinningMode mode) const {
+        return this->skinningPalettes[(UInt32)mode].reference;
+    }
+
     /*
      * Create a full (deep) clone of this Skeleton object.
      */
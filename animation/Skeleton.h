@@ -29,14 +29,17 @@
 #include "../base/CoreObject.h"
 #include "../geometry/Vector3.h"
 #include "../math/Matrix4x4.h"
+#include "SkinningMode.h"
 #include "../math/Quaternion.h"
 #include "../util/Tree.h"
+#include "../util/PersistentWeakPointer.h"
 
 namespace Core {
 
     //forward declarations
     class Bone;
     class Transform;
+    class Texture2D;
 
     class Skeleton : public CoreObject {
 
@@ -90,8 +93,27 @@ namespace Core {
 
         void overrideBonesFrom(WeakPointer<const Skeleton> skeleton, Bool takeOffset, Bool takeNode);
         void overrideBonesFrom(const Skeleton * skeleton, Bool takeOffset, Bool takeNode);
+
+        void updateSkinningPalette(SkinningMode mode, UInt32 frameIndex, const Transform& reference);
+        WeakPointer<Texture2D> getSkinningPaletteTexture(SkinningMode mode);
+        const Matrix4x4& getSkinningPaletteReference(SkinningMode mode) const;
     
     private:
+
+        // per-frame skinning data of every bone for one SkinningMode, packed as Constants::SkinningPaletteBonesPerRow
+        // bones per row of [texture]
+        class SkinningPalette {
+        public:
+            std::vector<Real> data;
+            PersistentWeakPointer<Texture2D> texture;
+            // world matrix of the transform relative to which the bone transforms were computed
+            Matrix4x4 reference;
+            // the frame for which [data] was last computed
+            UInt32 frame;
+            Bool valid;
+        };
+
+        static const UInt32 SkinningModeCount = 2;
         
         // number of bones in this skeleton
         UInt32 boneCount;
@@ -109,6 +131,9 @@ namespace Core {
         // contains transformation hierarchy structure
         Tree<SkeletonNode*> skeleton;
 
+        // indexed by SkinningMode
+        SkinningPalette skinningPalettes[SkinningModeCount];
+
         Skeleton(UInt32 boneCount);
 
         void destroy();
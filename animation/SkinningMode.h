@@ -0,0 +1,13 @@
+#pragma once
+
+namespace Core {
+
+    enum class SkinningMode {
+        // blend the bone matrices of each vertex
+        Linear = 0,
+        // blend rigid bone transforms stored as dual quaternions, which preserves volume around twisting joints
+        // but ignores any scale in the bone transforms
+        DualQuaternion = 1
+    };
+
+}
@@ -1195,7 +1195,8 @@ namespace Core {
             }
         }
 
-        return convertedAnimation;;
+        convertedAnimation->bake();
+        return convertedAnimation;
     }
 
     /*
@@ -1223,6 +1224,19 @@ namespace Core {
         return animation;
     }
 
+    /*
+     * Same as above, but compress the loaded animation according to [compressionSettings]. If [compressionReport]
+     * is not null, it receives the memory used by the animation before and after compression and the largest errors
+     * introduced by it.
+     */
+    WeakPointer<Animation> ModelLoader::loadAnimation(const std::string& filePath, Bool addLoopPadding, Bool preserveFBXPivots,
+                                                      const AnimationCompressionSettings& compressionSettings, AnimationCompressionReport * compressionReport) {
+        WeakPointer<Animation> animation = this->loadAnimation(filePath, addLoopPadding, preserveFBXPivots);
+        AnimationCompressionReport report = animation->compress(compressionSettings);
+        if (compressionReport != nullptr) *compressionReport = report;
+        return animation;
+    }
+
     void ModelLoader::traverseScene(const aiScene& scene, SceneTraverseOrder traverseOrder, std::function<Bool(const aiNode&)> callback) const {
         if (scene.mRootNode != nullptr) {
             const aiNode& sceneRef = (const aiNode&)(*(scene.mRootNode));
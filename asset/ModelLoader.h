@@ -31,6 +31,8 @@ namespace Core {
     class Skeleton;
     class VertexBoneMap;
     class Animation;
+    class AnimationCompressionSettings;
+    class AnimationCompressionReport;
 
     class ModelLoader {
     public:
@@ -47,6 +49,8 @@ namespace Core {
         WeakPointer<Object3D> loadModel(const std::string& filePath, Real importScale, UInt32 smoothingThreshold, 
                                         Bool castShadows, Bool receiveShadows, Bool preserveFBXPivots, Bool preferPhysicalMaterial);
         WeakPointer<Animation> loadAnimation(const std::string& filePath, Bool addLoopPadding, Bool preserveFBXPivots);
+        WeakPointer<Animation> loadAnimation(const std::string& filePath, Bool addLoopPadding, Bool preserveFBXPivots,
+                                             const AnimationCompressionSettings& compressionSettings, AnimationCompressionReport * compressionReport);
 
     private:
 
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+
+#include "../common/types.h"
+
+namespace Core {
+
+    namespace Bench {
+
+        /*
+         * Run [function] [runs] times and return the fastest run in milliseconds. [prepare] runs before each
+         * timed run, outside the measurement.
+         */
+        template <typename Prepare, typename Function>
+        RealDouble bestOf(UInt32 runs, Prepare prepare, Function function) {
+            RealDouble best = 0;
+            for (UInt32 i = 0; i < runs; i++) {
+                prepare();
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                function();
+                std::chrono::duration<RealDouble, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                if (i == 0 || elapsed.count() < best) best = elapsed.count();
+            }
+            return best;
+        }
+
+        template <typename Function>
+        RealDouble bestOf(UInt32 runs, Function function) {
+            return bestOf(runs, []() {}, function);
+        }
+
+    }
+
+}
@@ -0,0 +1,100 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Bench.h"
+#include "../common/debug.h"
+#include "../animation/KeyFrameSearch.h"
+#include "../animation/TranslationKeyFrame.h"
+
+/*
+ * Times key frame lookups on a 10k-key clip with the cursor walk AnimationPlayer uses, against a binary search on
+ * every lookup. Playback steps through the clip at 60 frames per second and loops; scrubbing jumps to random times,
+ * so the cursor never helps and the walk always falls back to a binary search.
+ */
+
+using namespace Core;
+
+namespace {
+
+    const UInt32 KeyCount = 10000;
+    const Real KeysPerSecond = 30.0f;
+    const Real FrameTime = 1.0f / 60.0f;
+    const UInt32 LookupCount = 200000;
+    const UInt32 Runs = 10;
+
+    class Result {
+    public:
+        RealDouble milliseconds;
+        // sum of the key indices found, to check that both searches agree
+        UInt64 checksum;
+        UInt64 timeReads;
+    };
+
+    template <typename FrameTime>
+    Result run(FrameTime frameTime, const std::vector<Real>& times, Bool useCursor) {
+        Result result;
+        result.checksum = 0;
+        result.milliseconds = Bench::bestOf(Runs, [&result]() {
+            result.checksum = 0;
+        }, [&]() {
+            UInt32 cursor = 0;
+            for (Real time : times) {
+                if (useCursor) cursor = KeyFrameSearch::find(frameTime, KeyCount, time, cursor);
+                else cursor = KeyFrameSearch::find(frameTime, KeyCount, time, 0, 0);
+                result.checksum += cursor;
+            }
+        });
+
+        result.timeReads = 0;
+        auto countedFrameTime = [&frameTime, &result](UInt32 frame) {
+            result.timeReads++;
+            return frameTime(frame);
+        };
+        UInt32 cursor = 0;
+        for (Real time : times) {
+            cursor = KeyFrameSearch::find(countedFrameTime, KeyCount, time, useCursor ? cursor : 0, useCursor ? KeyFrameSearch::MaxCursorSteps : 0);
+        }
+        return result;
+    }
+
+    void report(const char* name, const Result& cursorWalk, const Result& binarySearch, UInt32 lookupCount) {
+        Debug::PrintMessage("%s:", name);
+        Debug::PrintMessage("    cursor walk:   %7.2f ns per lookup, %5.2f key times read per lookup",
+            cursorWalk.milliseconds * 1e6 / lookupCount, (RealDouble)cursorWalk.timeReads / lookupCount);
+        Debug::PrintMessage("    binary search: %7.2f ns per lookup, %5.2f key times read per lookup",
+            binarySearch.milliseconds * 1e6 / lookupCount, (RealDouble)binarySearch.timeReads / lookupCount);
+        if (cursorWalk.checksum != binarySearch.checksum) Debug::PrintError("    the two searches found different key frames");
+    }
+
+}
+
+int main() {
+    std::vector<TranslationKeyFrame> keyFrames;
+    keyFrames.reserve(KeyCount);
+    for (UInt32 i = 0; i < KeyCount; i++) {
+        Real time = (Real)i / KeysPerSecond;
+        keyFrames.push_back(TranslationKeyFrame((Real)i / (KeyCount - 1), time, (Real)i, Vector3r((Real)i, 0.0f, 0.0f)));
+    }
+    Real duration = keyFrames.back().RealTime;
+
+    // read the times through the key frames, as AnimationPlayer::getKeyFrameTime() does
+    auto frameTime = [&keyFrames](UInt32 frame) {
+        return keyFrames[frame].RealTime;
+    };
+
+    std::vector<Real> playbackTimes(LookupCount);
+    for (UInt32 i = 0; i < LookupCount; i++) {
+        playbackTimes[i] = std::fmod((Real)i * FrameTime, duration);
+    }
+
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<Real> anyTime(0.0f, duration);
+    std::vector<Real> scrubTimes(LookupCount);
+    for (Real& time : scrubTimes) time = anyTime(random);
+
+    Debug::PrintMessage("%u keys over %.1f s, %u lookups, best of %u runs", KeyCount, duration, LookupCount, Runs);
+    report("playback", run(frameTime, playbackTimes, true), run(frameTime, playbackTimes, false), LookupCount);
+    report("scrubbing", run(frameTime, scrubTimes, true), run(frameTime, scrubTimes, false), LookupCount);
+    return 0;
+}
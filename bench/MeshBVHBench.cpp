@@ -0,0 +1,175 @@
+#include <limits>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "Bench.h"
+#include "../common/debug.h"
+#include "../math/Math.h"
+#include "../geometry/MeshBVH.h"
+#include "../geometry/Ray.h"
+
+/*
+ * Counts the triangles tested per ray when finding the closest hit on a generated terrain mesh, with MeshBVH and by
+ * testing every triangle, and times both. The two closest hits are compared for every ray.
+ */
+
+using namespace Core;
+
+namespace {
+
+    // vertices along each side of the terrain
+    const UInt32 GridSize = 257;
+    const UInt32 RayCount = 10000;
+    // the brute-force pass tests every triangle, so it only casts this fraction of the rays
+    const UInt32 BruteForceRayStride = 20;
+    const UInt32 Runs = 5;
+
+    /*
+     * Vertex positions laid out the way AttributeArray keeps them: each Point3rs refers to its own slice of one
+     * shared block of components.
+     */
+    class VertexPositions {
+    public:
+        VertexPositions(UInt32 count): count(count), storage(count * Point3rs::ComponentCount) {
+            this->positions = reinterpret_cast<Point3rs*>(::operator new(count * sizeof(Point3rs)));
+            for (UInt32 i = 0; i < count; i++) {
+                new (this->positions + i) Point3rs(this->storage.data() + i * Point3rs::ComponentCount);
+            }
+        }
+
+        ~VertexPositions() {
+            for (UInt32 i = 0; i < this->count; i++) this->positions[i].~Point3rs();
+            ::operator delete(this->positions);
+        }
+
+        VertexPositions(const VertexPositions&) = delete;
+        VertexPositions& operator=(const VertexPositions&) = delete;
+
+        Point3rs* getPositions() {
+            return this->positions;
+        }
+
+    private:
+        UInt32 count;
+        std::vector<Real> storage;
+        Point3rs* positions;
+    };
+
+    void buildTerrain(VertexPositions& vertices, std::vector<UInt32>& indices) {
+        Point3rs* positions = vertices.getPositions();
+        for (UInt32 z = 0; z < GridSize; z++) {
+            for (UInt32 x = 0; x < GridSize; x++) {
+                Real height = Math::sin((Real)x * 0.11f) * 4.0f + Math::cos((Real)z * 0.07f) * 6.0f;
+                positions[z * GridSize + x].set((Real)x, height, (Real)z);
+            }
+        }
+
+        // two triangles per cell, both facing up
+        for (UInt32 z = 0; z < GridSize - 1; z++) {
+            for (UInt32 x = 0; x < GridSize - 1; x++) {
+                UInt32 i = z * GridSize + x;
+                UInt32 cell[] = {i, i + 1, i + GridSize, i + 1, i + GridSize + 1, i + GridSize};
+                indices.insert(indices.end(), cell, cell + 6);
+            }
+        }
+    }
+
+    void buildRays(std::vector<Ray>& rays) {
+        std::mt19937 random(12345);
+        std::uniform_real_distribution<Real> position(0.0f, (Real)(GridSize - 1));
+        std::uniform_real_distribution<Real> slope(-1.0f, 1.0f);
+        for (UInt32 i = 0; i < RayCount; i++) {
+            Point3r origin(position(random), 20.0f, position(random));
+            Vector3r direction(slope(random), -1.0f, slope(random));
+            rays.push_back(Ray(origin, direction));
+        }
+    }
+
+    /*
+     * Möller-Trumbore test of [ray] against every triangle, hitting front faces only, as MeshBVH does.
+     */
+    Bool intersectAll(const Ray& ray, const Point3rs * vertices, const std::vector<UInt32>& indices, Real& closestT) {
+        Bool found = false;
+        for (UInt32 i = 0; i < indices.size(); i += 3) {
+            const Point3rs& p0 = vertices[indices[i]];
+            const Point3rs& p1 = vertices[indices[i + 1]];
+            const Point3rs& p2 = vertices[indices[i + 2]];
+            Vector3r edge1(p1.x - p0.x, p1.y - p0.y, p1.z - p0.z);
+            Vector3r edge2(p2.x - p0.x, p2.y - p0.y, p2.z - p0.z);
+            Vector3r p = ray.Direction.cross(edge2);
+            Real det = Vector3r::dot(edge1, p);
+            if (!(det < 0.0f)) continue;
+            Real inverseDet = 1.0f / det;
+
+            Vector3r s(ray.Origin.x - p0.x, ray.Origin.y - p0.y, ray.Origin.z - p0.z);
+            Real u = Vector3r::dot(s, p) * inverseDet;
+            if (u < 0.0f || u > 1.0f) continue;
+            Vector3r q = s.cross(edge1);
+            Real v = Vector3r::dot(ray.Direction, q) * inverseDet;
+            if (v < 0.0f || u + v > 1.0f) continue;
+            Real t = Vector3r::dot(edge2, q) * inverseDet;
+            if (t < 0.0f || t > closestT) continue;
+            closestT = t;
+            found = true;
+        }
+        return found;
+    }
+
+}
+
+int main() {
+    VertexPositions vertices(GridSize * GridSize);
+    std::vector<UInt32> indices;
+    buildTerrain(vertices, indices);
+    UInt32 triangleCount = (UInt32)indices.size() / 3;
+
+    std::vector<Ray> rays;
+    buildRays(rays);
+
+    MeshBVH bvh;
+    RealDouble buildTime = Bench::bestOf(1, [&]() {
+        bvh.build(vertices.getPositions(), indices.data(), triangleCount);
+    });
+
+    UInt64 bvhTests = 0;
+    UInt32 bvhHits = 0;
+    RealDouble bvhTime = Bench::bestOf(Runs, [&]() {
+        bvhTests = 0;
+        bvhHits = 0;
+    }, [&]() {
+        for (const Ray& ray : rays) {
+            Real maxT = std::numeric_limits<Real>::max();
+            Hit hit;
+            UInt32 tests = 0;
+            if (bvh.intersectClosest(ray, maxT, hit, &tests)) bvhHits++;
+            bvhTests += tests;
+        }
+    });
+
+    std::vector<Real> bruteForceT;
+    RealDouble bruteForceTime = Bench::bestOf(1, [&]() {
+        for (UInt32 i = 0; i < RayCount; i += BruteForceRayStride) {
+            Real closestT = std::numeric_limits<Real>::max();
+            intersectAll(rays[i], vertices.getPositions(), indices, closestT);
+            bruteForceT.push_back(closestT);
+        }
+    });
+    UInt32 bruteForceRayCount = (UInt32)bruteForceT.size();
+
+    UInt32 mismatches = 0;
+    for (UInt32 i = 0; i < bruteForceRayCount; i++) {
+        Real maxT = std::numeric_limits<Real>::max();
+        Hit hit;
+        bvh.intersectClosest(rays[i * BruteForceRayStride], maxT, hit);
+        if (Math::abs(bruteForceT[i] - maxT) > 1e-4f * Math::max(1.0f, maxT)) mismatches++;
+    }
+
+    Debug::PrintMessage("%u triangles, %u nodes, built in %.3f ms", triangleCount, bvh.getNodeCount(), buildTime);
+    Debug::PrintMessage("MeshBVH:     %10.1f triangle tests per ray, %8.3f us per ray, %u of %u rays hit",
+        (RealDouble)bvhTests / RayCount, bvhTime * 1000.0 / RayCount, bvhHits, RayCount);
+    Debug::PrintMessage("brute force: %10.1f triangle tests per ray, %8.3f us per ray, %u rays",
+        (RealDouble)triangleCount, bruteForceTime * 1000.0 / bruteForceRayCount, bruteForceRayCount);
+    Debug::PrintMessage("closest hits that differ: %u", mismatches);
+    return 0;
+}
@@ -13,7 +13,9 @@ namespace Core {
         static const UInt32 MaxIBLLODLevels = 6;
         static const UInt32 DefaultMaxMipLevels = 4;
         static const UInt32 MaxBonesPerVertex = 4;
-        static const UInt32 MaxBones = 128;
+        // bone matrices per row of a skeleton's skinning palette texture, four RGBA32F texels each
+        static const UInt32 SkinningPaletteBonesPerRow = 256;
+        static const UInt32 MaxRenderLayers = 16;
         #ifdef CORE_USE_PRIVATE_INCLUDES
         static constexpr UInt32 TempRenderTargetSize = 4096;
         #endif
@@ -11,6 +11,8 @@ namespace Core {
         virtual ~AttributeArrayGPUStorage() = 0;
         virtual Int32 getBufferID() const = 0;
         virtual void sendToShader(UInt32 location) = 0;
+        // for buffers holding several interleaved attributes; [stride] and [offset] are in bytes
+        virtual void sendToShader(UInt32 location, UInt32 componentCount, UInt32 stride, UInt32 offset) = 0;
         virtual void disable(UInt32 location) = 0;
         virtual void updateBufferData(void * data) = 0;
     };
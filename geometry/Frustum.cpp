@@ -0,0 +1,102 @@
+#include "Frustum.h"
+#include "../math/Math.h"
+
+namespace Core {
+
+    Frustum::Frustum() {
+    }
+
+    Frustum::Frustum(const Matrix4x4& viewProjection) {
+        this->setFromViewProjection(viewProjection);
+    }
+
+    void Frustum::setFromViewProjection(const Matrix4x4& projection, const Matrix4x4& view) {
+        Matrix4x4 viewProjection;
+        Matrix4x4::multiply(projection, view, viewProjection);
+        this->setFromViewProjection(viewProjection);
+    }
+
+    /*
+    * Extract the six clip planes (left, right, bottom, top, near, far) from a combined
+    * view-projection matrix (Gribb & Hartmann). Each plane is normalized and oriented
+    * so that points inside the frustum yield a non-negative signed distance.
+    */
+    void Frustum::setFromViewProjection(const Matrix4x4& viewProjection) {
+        const Real* m = viewProjection.getConstData();
+
+        // matrices are column-major, so row [r] is (m[r], m[4 + r], m[8 + r], m[12 + r])
+        for (UInt32 i = 0; i < PlaneCount; i++) {
+            UInt32 row = i / 2;
+            Real sign = (i % 2 == 0) ? 1.0f : -1.0f;
+            Real x = m[3] + sign * m[row];
+            Real y = m[7] + sign * m[4 + row];
+            Real z = m[11] + sign * m[8 + row];
+            Real w = m[15] + sign * m[12 + row];
+
+            Real mag = Math::squareRoot(x * x + y * y + z * z);
+            if (mag > 0.0f) {
+                x /= mag;
+                y /= mag;
+                z /= mag;
+                w /= mag;
+            }
+            this->planes[i].set(x, y, z, w);
+        }
+    }
+
+    const Vector4r& Frustum::getPlane(UInt32 index) const {
+        return this->planes[index];
+    }
+
+    /*
+    * Conservative box test: the box is rejected only if it lies entirely on the
+    * negative side of at least one plane (tested against the box's "positive vertex").
+    */
+    Bool Frustum::intersectsBox(const Box3& box) const {
+        const Vector3r& min = box.getMin();
+        const Vector3r& max = box.getMax();
+        for (UInt32 i = 0; i < PlaneCount; i++) {
+            const Vector4r& plane = this->planes[i];
+            Real px = plane.x >= 0.0f ? max.x : min.x;
+            Real py = plane.y >= 0.0f ? max.y : min.y;
+            Real pz = plane.z >= 0.0f ? max.z : min.z;
+            if (plane.x * px + plane.y * py + plane.z * pz + plane.w < 0.0f) return false;
+        }
+        return true;
+    }
+
+    Bool Frustum::intersectsBox(const Box3& localBox, const Matrix4x4& transform) const {
+        Box3 worldBox;
+        transformBox(localBox, transform, worldBox);
+        return this->intersectsBox(worldBox);
+    }
+
+    /*
+    * Compute the axis-aligned box that encloses [localBox] after it has been transformed
+    * by [transform]. Equivalent to transforming all eight corners, but done with the
+    * box's center and half-extents against the absolute values of the upper 3x3.
+    */
+    void Frustum::transformBox(const Box3& localBox, const Matrix4x4& transform, Box3& outBox) {
+        const Real* m = transform.getConstData();
+        const Vector3r& min = localBox.getMin();
+        const Vector3r& max = localBox.getMax();
+
+        Real cx = (min.x + max.x) * 0.5f;
+        Real cy = (min.y + max.y) * 0.5f;
+        Real cz = (min.z + max.z) * 0.5f;
+        Real ex = (max.x - min.x) * 0.5f;
+        Real ey = (max.y - min.y) * 0.5f;
+        Real ez = (max.z - min.z) * 0.5f;
+
+        Real wcx = m[0] * cx + m[4] * cy + m[8] * cz + m[12];
+        Real wcy = m[1] * cx + m[5] * cy + m[9] * cz + m[13];
+        Real wcz = m[2] * cx + m[6] * cy + m[10] * cz + m[14];
+
+        Real wex = Math::abs(m[0]) * ex + Math::abs(m[4]) * ey + Math::abs(m[8]) * ez;
+        Real wey = Math::abs(m[1]) * ex + Math::abs(m[5]) * ey + Math::abs(m[9]) * ez;
+        Real wez = Math::abs(m[2]) * ex + Math::abs(m[6]) * ey + Math::abs(m[10]) * ez;
+
+        outBox.setMin(wcx - wex, wcy - wey, wcz - wez);
+        outBox.setMax(wcx + wex, wcy + wey, wcz + wez);
+    }
+}
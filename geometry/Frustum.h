@@ -0,0 +1,28 @@
+#pragma once
+
+#include "../common/types.h"
+#include "../math/Matrix4x4.h"
+#include "Vector4.h"
+#include "Box3.h"
+
+namespace Core {
+
+    class Frustum {
+    public:
+        static const UInt32 PlaneCount = 6;
+
+        Frustum();
+        Frustum(const Matrix4x4& viewProjection);
+
+        void setFromViewProjection(const Matrix4x4& viewProjection);
+        void setFromViewProjection(const Matrix4x4& projection, const Matrix4x4& view);
+        const Vector4r& getPlane(UInt32 index) const;
+
+        Bool intersectsBox(const Box3& box) const;
+        Bool intersectsBox(const Box3& localBox, const Matrix4x4& transform) const;
+        static void transformBox(const Box3& localBox, const Matrix4x4& transform, Box3& outBox);
+
+    private:
+        Vector4r planes[PlaneCount];
+    };
+}
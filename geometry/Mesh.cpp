@@ -1,4 +1,8 @@
+#include <atomic>
+#include <cmath>
+
 #include "Mesh.h"
+#include "../Engine.h"
 #include "../common/Exception.h"
 #include "../common/types.h"
 #include "../scene/Object3D.h"
@@ -8,10 +12,17 @@
 #include "../math/Math.h"
 #include "../common/Constants.h"
 
+static std::atomic<Core::UInt32> _bounding_box_version;
+
 namespace Core {
 
+    constexpr Real Mesh::VertexWeldTolerance;
+    const UInt32 Mesh::InvalidVertexGroup;
+    const UInt32 Mesh::WeldCellScale;
+    const UInt32 Mesh::VertexGroupBatchSize;
+
     Mesh::Mesh(WeakPointer<Graphics> graphics, UInt32 vertexCount, UInt32 indexCount): graphics(graphics), vertexCount(vertexCount), indexCount(indexCount) {
-        this->vertexCrossMap = nullptr;
+        this->vertexCrossMapBuilt = false;
         this->initialized = false;
         this->indexed = indexCount > 0 ? true : false;
         this->enabledAttributes = StandardAttributes::createAttributeSet();
@@ -19,14 +30,25 @@ namespace Core {
         this->shoudCalculateNormals = false;
         this->shoudCalculateTangents = false;
         this->shouldCalculateBoundingBox = false;
+        this->boundingBoxCalculated = false;
+        this->boundingBoxVersion = 0;
+        this->interleaved = false;
+        this->interleavedStride = 0;
+        for (UInt32 i = 0; i < (UInt32)StandardAttribute::_Count; i++) {
+            this->interleavedOffsets[i] = -1;
+        }
         initAttributes();
     }
 
     Mesh::~Mesh() {
         this->destroyVertexCrossMap();
+        this->invalidateVertexArrays();
         if (this->indexBuffer.isValid()) {
             Engine::safeReleaseObject(this->indexBuffer);
         }
+        if (this->interleavedGPUStorage.isValid()) {
+            Engine::safeReleaseObject(this->interleavedGPUStorage);
+        }
     }
 
     void Mesh::init() {
@@ -56,6 +78,7 @@ namespace Core {
         else if (attribute == StandardAttribute::AveragedNormal) {
             StandardAttributes::addAttribute(&this->enabledAttributes, StandardAttribute::Normal);
         }
+        this->invalidateVertexArrays();
     }
 
     void Mesh::disableAttribute(StandardAttribute attribute) {
@@ -66,6 +89,7 @@ namespace Core {
         else if (attribute == StandardAttribute::AveragedNormal) {
             StandardAttributes::removeAttribute(&this->enabledAttributes, StandardAttribute::Normal);
         }
+        this->invalidateVertexArrays();
     }
 
     Bool Mesh::isAttributeEnabled(StandardAttribute attribute) {
@@ -100,12 +124,57 @@ namespace Core {
 
         this->boundingBox.setMin(min);
         this->boundingBox.setMax(max);
+        this->boundingBoxCalculated = true;
+        this->boundingBoxVersion = ++_bounding_box_version;
     }
 
     const Box3& Mesh::getBoundingBox() const {
         return this->boundingBox;
     }
 
+    Bool Mesh::hasBoundingBox() const {
+        return this->boundingBoxCalculated;
+    }
+
+    /*
+     * Changes whenever the bounding box is recalculated. Versions are unique across meshes, so callers that cache
+     * data derived from the bounds of a set of meshes can also tell when one mesh is swapped for another.
+     */
+    UInt32 Mesh::getBoundingBoxVersion() const {
+        return this->boundingBoxVersion;
+    }
+
+    /*
+     * The triangle hierarchy used for ray queries against this mesh, which is built from the current vertex positions
+     * the first time it is needed after a call to update(). Safe to call from several threads at once.
+     */
+    const MeshBVH& Mesh::getBVH() {
+        std::lock_guard<std::mutex> guard(this->bvhLock);
+        if (!this->bvh) {
+            this->bvh = std::unique_ptr<MeshBVH>(new MeshBVH());
+            if (this->vertexPositions) {
+                const Point3rs * vertices = this->vertexPositions->getAttributes();
+                if (this->indexed) {
+                    std::vector<UInt32> indices(this->indexBuffer->getSize());
+                    for (UInt32 i = 0; i < indices.size(); i++) indices[i] = this->indexBuffer->getIndex(i);
+                    this->bvh->build(vertices, indices.data(), (UInt32)indices.size() / 3);
+                }
+                else {
+                    this->bvh->build(vertices, nullptr, this->vertexPositions->getAttributeCount() / 3);
+                }
+            }
+        }
+        return *this->bvh;
+    }
+
+    /*
+     * Discard the triangle hierarchy, e.g. after the vertex positions have been modified. update() does this.
+     */
+    void Mesh::invalidateBVH() {
+        std::lock_guard<std::mutex> guard(this->bvhLock);
+        this->bvh.reset();
+    }
+
     WeakPointer<AttributeArray<Point3rs>> Mesh::getVertexPositions() {
         return this->vertexPositions;
     }
@@ -179,14 +248,16 @@ namespace Core {
     }
 
     void Mesh::update() {
+        this->invalidateBVH();
         if (this->shouldCalculateBoundingBox) this->calculateBoundingBox();
         if (this->shoudCalculateNormals){
-            this->calculateNormals((Real)this->normalsSmoothingThreshold);
+            this->computeNormals((Real)this->normalsSmoothingThreshold);
         }
         if (this->shoudCalculateTangents){
-            this->calculateTangents((Real)this->normalsSmoothingThreshold);
+            this->computeTangents((Real)this->normalsSmoothingThreshold);
         }
         //if (buildFaces)BuildFaces();
+        this->updateInterleavedBuffer();
 
     }
 
@@ -247,6 +318,120 @@ namespace Core {
         }
     }
 
+    /*
+     * Switches between one GPU buffer per vertex attribute and a single buffer holding all enabled
+     * attributes of a vertex next to each other. The per-attribute buffers are released while the
+     * mesh is interleaved, so after writing to an attribute array directly (e.g. via store()) the
+     * shared buffer must be refreshed with update() or updateInterleavedBuffer().
+     */
+    void Mesh::setInterleaved(Bool interleaved) {
+        if (this->interleaved == interleaved) return;
+        this->interleaved = interleaved;
+        this->setAttributeGPUStorageEnabled(!interleaved);
+        if (interleaved) {
+            this->updateInterleavedBuffer();
+        }
+        else {
+            if (this->interleavedGPUStorage.isValid()) {
+                Engine::safeReleaseObject(this->interleavedGPUStorage);
+            }
+            this->interleavedGPUStorage = WeakPointer<AttributeArrayGPUStorage>();
+            this->interleavedStride = 0;
+            for (UInt32 i = 0; i < (UInt32)StandardAttribute::_Count; i++) {
+                this->interleavedOffsets[i] = -1;
+            }
+            this->interleavedData.clear();
+            this->interleavedData.shrink_to_fit();
+        }
+        this->invalidateVertexArrays();
+    }
+
+    Bool Mesh::isInterleaved() const {
+        return this->interleaved;
+    }
+
+    /*
+     * Lays out all enabled vertex attributes in a single vertex of [interleavedStride] bytes and
+     * uploads them to the shared GPU buffer. Does nothing when the mesh is not interleaved.
+     */
+    void Mesh::updateInterleavedBuffer() {
+        if (!this->interleaved) return;
+
+        UInt32 previousStride = this->interleavedStride;
+        Int32 previousOffsets[(UInt32)StandardAttribute::_Count];
+        memcpy(previousOffsets, this->interleavedOffsets, sizeof(previousOffsets));
+        this->interleavedStride = 0;
+        this->layoutInterleavedAttribute(this->vertexPositions, StandardAttribute::Position);
+        this->layoutInterleavedAttribute(this->vertexNormals, StandardAttribute::Normal);
+        this->layoutInterleavedAttribute(this->vertexAveragedNormals, StandardAttribute::AveragedNormal);
+        this->layoutInterleavedAttribute(this->vertexFaceNormals, StandardAttribute::FaceNormal);
+        this->layoutInterleavedAttribute(this->vertexTangents, StandardAttribute::Tangent);
+        this->layoutInterleavedAttribute(this->vertexColors, StandardAttribute::Color);
+        this->layoutInterleavedAttribute(this->vertexAlbedoUVs, StandardAttribute::AlbedoUV);
+        this->layoutInterleavedAttribute(this->vertexNormalUVs, StandardAttribute::NormalUV);
+        if (this->interleavedStride == 0) return;
+
+        UInt32 size = this->interleavedStride * this->vertexCount;
+        this->interleavedData.resize(size);
+        this->packInterleavedAttribute(this->vertexPositions, StandardAttribute::Position);
+        this->packInterleavedAttribute(this->vertexNormals, StandardAttribute::Normal);
+        this->packInterleavedAttribute(this->vertexAveragedNormals, StandardAttribute::AveragedNormal);
+        this->packInterleavedAttribute(this->vertexFaceNormals, StandardAttribute::FaceNormal);
+        this->packInterleavedAttribute(this->vertexTangents, StandardAttribute::Tangent);
+        this->packInterleavedAttribute(this->vertexColors, StandardAttribute::Color);
+        this->packInterleavedAttribute(this->vertexAlbedoUVs, StandardAttribute::AlbedoUV);
+        this->packInterleavedAttribute(this->vertexNormalUVs, StandardAttribute::NormalUV);
+
+        // the GPU buffer is sized at creation, so a new stride needs a new buffer
+        if (!this->interleavedGPUStorage.isValid() || this->interleavedStride != previousStride) {
+            if (this->interleavedGPUStorage.isValid()) {
+                Engine::safeReleaseObject(this->interleavedGPUStorage);
+            }
+            this->interleavedGPUStorage = Engine::instance()->createGPUStorage(size, this->interleavedStride / sizeof(Real),
+                                                                               AttributeType::Float, false);
+            this->invalidateVertexArrays();
+        }
+        else if (memcmp(previousOffsets, this->interleavedOffsets, sizeof(previousOffsets)) != 0) {
+            this->invalidateVertexArrays();
+        }
+        this->interleavedGPUStorage->updateBufferData(this->interleavedData.data());
+    }
+
+    WeakPointer<AttributeArrayGPUStorage> Mesh::getInterleavedGPUStorage() {
+        return this->interleavedGPUStorage;
+    }
+
+    UInt32 Mesh::getInterleavedStride() const {
+        return this->interleavedStride;
+    }
+
+    /*
+     * Byte offset of [attribute] within an interleaved vertex, or -1 if it is not part of the layout.
+     */
+    Int32 Mesh::getInterleavedOffset(StandardAttribute attribute) const {
+        return this->interleavedOffsets[(UInt32)attribute];
+    }
+
+    void Mesh::setAttributeGPUStorageEnabled(Bool enabled) {
+        this->setAttributeGPUStorageEnabled(this->vertexPositions, enabled);
+        this->setAttributeGPUStorageEnabled(this->vertexNormals, enabled);
+        this->setAttributeGPUStorageEnabled(this->vertexAveragedNormals, enabled);
+        this->setAttributeGPUStorageEnabled(this->vertexFaceNormals, enabled);
+        this->setAttributeGPUStorageEnabled(this->vertexTangents, enabled);
+        this->setAttributeGPUStorageEnabled(this->vertexColors, enabled);
+        this->setAttributeGPUStorageEnabled(this->vertexAlbedoUVs, enabled);
+        this->setAttributeGPUStorageEnabled(this->vertexNormalUVs, enabled);
+    }
+
+    /*
+     * Drops the vertex array objects recorded for this mesh, they reference its buffers and layout.
+     */
+    void Mesh::invalidateVertexArrays() {
+        if (this->graphics.isValid()) {
+            this->graphics->releaseVertexArrays(this->getObjectID());
+        }
+    }
+
     void Mesh::setCalculateNormals(Bool calculateNormals) {
         this->shoudCalculateNormals = calculateNormals;
     }
@@ -263,210 +448,171 @@ namespace Core {
         this->normalsSmoothingThreshold = threshold;
     }
 
+    /*
+    * Calculate vertex normals with computeNormals() and refresh the interleaved buffer.
+    */
+    void Mesh::calculateNormals(Real smoothingThreshhold) {
+        this->computeNormals(smoothingThreshhold);
+        this->updateInterleavedBuffer();
+    }
+
     /*
     * Calculate vertex normals using the two incident edges to calculate the
     * cross product. For all triangles that share a given vertex,the method will
     * calculate the average normal for that vertex as long as the angle between
     * the un-averaged normals is less than [smoothingThreshhold]. [smoothingThreshhold]
     * is specified in radians.
+    *
+    * Equal vertices are found through the vertex cross map, and each group of equal
+    * vertices is averaged independently, so the groups are spread over the engine's
+    * job system.
     */
-    void Mesh::calculateNormals(Real smoothingThreshhold) {
+    void Mesh::computeNormals(Real smoothingThreshhold) {
         if (!StandardAttributes::hasAttribute(this->enabledAttributes, StandardAttribute::Normal))return;
 
-        if (this->vertexCrossMap == nullptr) {
+        if (!this->vertexCrossMapBuilt) {
             this->buildVertexCrossMap();
         }
 
         UInt32 realVertexCount = this->vertexCount;
-        WeakPointer<IndexBuffer> indices;
+        IndexBuffer * indices = nullptr;
         if (this->indexed) {
-            indices = this->getIndexBuffer();
+            indices = this->getIndexBuffer().get();
             realVertexCount = this->indexCount;
         }
+        if (realVertexCount < 3) return;
+
+        // the cross map has already checked every index against the vertex count, so the
+        // attributes can be accessed directly from the jobs below
+        const Point3rs * positions = this->vertexPositions->getAttributes();
+        Vector3rs * vertexNormals = this->vertexNormals->getAttributes();
+        Vector3rs * vertexAveragedNormals = this->vertexAveragedNormals->getAttributes();
+        Vector3rs * vertexFaceNormals = this->vertexFaceNormals->getAttributes();
+        WeakPointer<JobSystem> jobSystem = Engine::instance()->getJobSystem();
+
+        // loop through each triangle in this mesh's vertices and calculate normals for each.
+        // a vertex of an indexed mesh can be shared by several triangles, in which case the
+        // last one wins, so only unindexed meshes are done in parallel.
+        UInt32 triangleCount = realVertexCount / 3;
+        auto calculateFaceNormals = [positions, vertexFaceNormals, indices](UInt32 start, UInt32 end) {
+            for (UInt32 t = start; t < end; t++) {
+                UInt32 mappedIndex1 = t * 3;
+                UInt32 mappedIndex2 = t * 3 + 1;
+                UInt32 mappedIndex3 = t * 3 + 2;
+                if (indices != nullptr) {
+                    mappedIndex1 = indices->getIndex(mappedIndex1);
+                    mappedIndex2 = indices->getIndex(mappedIndex2);
+                    mappedIndex3 = indices->getIndex(mappedIndex3);
+                }
 
-        WeakPointer<AttributeArray<Vector3rs>> vertexNormals = this->vertexNormals;
-        WeakPointer<AttributeArray<Vector3rs>> vertexAveragedNormals = this->vertexAveragedNormals;
-        WeakPointer<AttributeArray<Vector3rs>> vertexFaceNormals = this->vertexFaceNormals;
-     
-        // loop through each triangle in this mesh's vertices
-        // and calculate normals for each
-        for (UInt32 v = 0; v < realVertexCount - 2; v += 3) {
-            Vector3r normal;
-            this->calculateFaceNormal(v, normal);
-
-            UInt32 mappedIndex1 = v;
-            UInt32 mappedIndex2 = v + 1;
-            UInt32 mappedIndex3 = v + 2;
-            if (this->indexed) {
-                mappedIndex1 = indices->getIndex(mappedIndex1);
-                mappedIndex2 = indices->getIndex(mappedIndex2);
-                mappedIndex3 = indices->getIndex(mappedIndex3);
+                Vector3r normal;
+                calculateFaceNormal(positions, mappedIndex1, mappedIndex2, mappedIndex3, normal);
+                vertexFaceNormals[mappedIndex1].copy(normal);
+                vertexFaceNormals[mappedIndex2].copy(normal);
+                vertexFaceNormals[mappedIndex3].copy(normal);
             }
-
-            vertexNormals->getAttribute(mappedIndex1).copy(normal);
-            vertexNormals->getAttribute(mappedIndex2).copy(normal);
-            vertexNormals->getAttribute(mappedIndex3).copy(normal);
-
-            this->vertexAveragedNormals->getAttribute(mappedIndex1).copy(normal);
-            this->vertexAveragedNormals->getAttribute(mappedIndex2).copy(normal);
-            this->vertexAveragedNormals->getAttribute(mappedIndex3).copy(normal);
-
-            vertexFaceNormals->getAttribute(mappedIndex1).copy(normal);
-            vertexFaceNormals->getAttribute(mappedIndex2).copy(normal);
-            vertexFaceNormals->getAttribute(mappedIndex3).copy(normal);
-        }
-
-        // This vector is used to store the calculated average normal for all equal vertices
-        // whose normals differ by an angle that is less than 'smoothingThreshhold'
-        std::vector<Vector3r> averageNormals;
-
-        // This vector is used to store the calculated average normal for all equal vertices
-        std::vector<Vector3r> fullAverageNormals;
+        };
+        if (this->indexed) calculateFaceNormals(0, triangleCount);
+        else jobSystem->parallelFor("Mesh::calculateFaceNormals", triangleCount, VertexGroupBatchSize, calculateFaceNormals);
 
         // compute the cosine of the smoothing threshhold angle
         Real cosSmoothingThreshhold = (Math::cos(smoothingThreshhold));
 
-        // loop through each vertex and lookup the associated list of
-        // normals associated with that vertex, and then calculate the
-        // average normal from that list.
-        for (UInt32 v = 0; v < realVertexCount; v++) {
-
-            UInt32 mappedIndex = v;
-            if (this->indexed) {
-                mappedIndex = indices->getIndex(mappedIndex);
-            }
-
-            // get existing normal for this vertex
-            Vector3r oNormal;
-            oNormal = vertexFaceNormals->getAttribute(mappedIndex);
-            oNormal.normalize();
-
-            // retrieve the list of equal vertices for vertex [v]
-            std::vector<UInt32>* listPtr = vertexCrossMap[v];
-            if (listPtr == nullptr) {
-                throw Exception("Mesh::calculateNormals -> Null pointer to vertex group list.");
-            }
-
-            Vector3r avg(0, 0, 0);
-            Real divisor = 0;
-            Vector3r fullAvg(0, 0, 0);
-            Real fullDivisor = 0;
-
-            std::vector<UInt32>& list = *listPtr;
-
-            for (UInt32 i = 0; i < list.size(); i++) {
-                UInt32 vIndex = list[i];
-
-                UInt32 mappedSubIndex = vIndex;
-                if (this->indexed) {
-                    mappedSubIndex = indices->getIndex(mappedSubIndex);
+        const UInt32 * groupStarts = this->vertexGroupStarts.data();
+        const UInt32 * groupMembers = this->vertexGroupMembers.data();
+        UInt32 groupCount = (UInt32)this->vertexGroupStarts.size() - 1;
+
+        // for each group of equal vertices, set the normal of each vertex to the average of the normals in the group
+        // that differ from its own by an angle less than 'smoothingThreshhold', and its averaged normal to the average
+        // of all of them. every vertex an index refers to belongs to exactly one group, so no two jobs write the same one.
+        jobSystem->parallelFor("Mesh::calculateNormals", groupCount, VertexGroupBatchSize, [=](UInt32 start, UInt32 end) {
+            // the normalized face normal of each vertex in the current group
+            std::vector<Vector3r> groupNormals;
+
+            for (UInt32 g = start; g < end; g++) {
+                UInt32 groupStart = groupStarts[g];
+                UInt32 groupSize = groupStarts[g + 1] - groupStart;
+                groupNormals.resize(groupSize);
+
+                Vector3r fullAvg(0, 0, 0);
+                Real fullDivisor = 0;
+                for (UInt32 i = 0; i < groupSize; i++) {
+                    UInt32 mappedIndex = groupMembers[groupStart + i];
+                    if (indices != nullptr) mappedIndex = indices->getIndex(mappedIndex);
+
+                    Vector3r& current = groupNormals[i];
+                    current.copy(vertexFaceNormals[mappedIndex]);
+                    current.normalize();
+                    fullAvg.x += current.x;
+                    fullAvg.y += current.y;
+                    fullAvg.z += current.z;
+                    fullDivisor++;
                 }
-
-                Vector3r current = vertexFaceNormals->getAttribute(mappedSubIndex);
-                current.normalize();
-
-                // calculate angle between the normal that exists for this vertex,
-                // and the current normal in the list.
-                Real dot = Vector3r::dot(current, oNormal);
-
-                if (dot > cosSmoothingThreshhold) {
-                    avg.x += current.x;
-                    avg.y += current.y;
-                    avg.z += current.z;
-                    divisor++;
+                if (fullDivisor > 1) {
+                    Real scaleFactor = (Real)1.0 / fullDivisor;
+                    fullAvg.scale(scaleFactor);
                 }
-                fullAvg.x += current.x;
-                fullAvg.y += current.y;
-                fullAvg.z += current.z;
-                fullDivisor++;
-            }
 
-            // if divisor <= 1, then no valid normals were found to include in the average,
-            // so just use the existing one
-            if (divisor <= 1) {
-                avg.x = oNormal.x;
-                avg.y = oNormal.y;
-                avg.z = oNormal.z;
-            }
-            else {
-                Real scaleFactor = (Real)1.0 / divisor;
-                avg.scale(scaleFactor);
-            }
-            averageNormals.push_back(avg);
-
-            // if fullDivisor <= 1, then no valid normals were found to include in the average,
-            // so just use the existing one
-            if (fullDivisor <= 1) {
-                fullAvg.x = oNormal.x;
-                fullAvg.y = oNormal.y;
-                fullAvg.z = oNormal.z;
-            }
-            else {
-                Real scaleFactor = (Real)1.0 / fullDivisor;
-                fullAvg.scale(scaleFactor);
-            }
-
-            fullAverageNormals.push_back(fullAvg);
-        }
-
-        // loop through each vertex and assign the average normal
-        // calculated for that vertex
-        for (UInt32 v = 0; v < realVertexCount; v++) {
-            Vector3r avg = averageNormals[v];
-            avg.normalize();
-            Vector3r fullAvg = fullAverageNormals[v];
-            fullAvg.normalize();
-            
-            UInt32 mappedIndex = v;
-            if (this->indexed) {
-                mappedIndex = indices->getIndex(mappedIndex);
+                // members are in ascending order, so when several refer to the same vertex the last one wins
+                for (UInt32 j = 0; j < groupSize; j++) {
+                    UInt32 mappedIndex = groupMembers[groupStart + j];
+                    if (indices != nullptr) mappedIndex = indices->getIndex(mappedIndex);
+                    const Vector3r& oNormal = groupNormals[j];
+
+                    Vector3r avg(0, 0, 0);
+                    Real divisor = 0;
+                    for (UInt32 i = 0; i < groupSize; i++) {
+                        const Vector3r& current = groupNormals[i];
+
+                        // calculate angle between the normal that exists for this vertex,
+                        // and the current normal in the list.
+                        Real dot = Vector3r::dot(current, oNormal);
+                        if (dot > cosSmoothingThreshhold) {
+                            avg.x += current.x;
+                            avg.y += current.y;
+                            avg.z += current.z;
+                            divisor++;
+                        }
+                    }
+
+                    // if divisor <= 1, then no valid normals were found to include in the average,
+                    // so just use the existing one
+                    if (divisor <= 1) {
+                        avg = oNormal;
+                    }
+                    else {
+                        Real scaleFactor = (Real)1.0 / divisor;
+                        avg.scale(scaleFactor);
+                    }
+                    avg.normalize();
+
+                    // likewise for the average of the whole group
+                    Vector3r memberFullAvg = fullDivisor <= 1 ? oNormal : fullAvg;
+                    memberFullAvg.normalize();
+
+                    vertexNormals[mappedIndex].copy(avg);
+                    vertexAveragedNormals[mappedIndex].copy(memberFullAvg);
+                }
             }
-
-            // set the normal for this vertex to the averaged normal
-            vertexNormals->getAttribute(mappedIndex).copy(avg);
-            vertexAveragedNormals->getAttribute(mappedIndex).copy(fullAvg);
-        }
+        });
 
         //if (invertNormals)InvertNormals(); 
 
-        vertexNormals->updateGPUStorageData();
-        vertexAveragedNormals->updateGPUStorageData();
-        vertexFaceNormals->updateGPUStorageData();
+        this->vertexNormals->updateGPUStorageData();
+        this->vertexAveragedNormals->updateGPUStorageData();
+        this->vertexFaceNormals->updateGPUStorageData();
     }
 
     /*
-     * For a given face in the sub-mesh specified by [faceVertexIndex], calculate the face's
-     * normal and store the result in [result]. [faceVertexIndex] will be the index of the
-     * face's first vertex in [vertexPositions], the next two will be at [faceVertexIndex] + 1,
-     * and [faceVertexIndex] + 2.
+     * Calculate the normal of the face formed by the vertices at [index1], [index2], and [index3] in
+     * [positions], and store the result in [result].
      */
-    void Mesh::calculateFaceNormal(UInt32 faceVertexIndex, Vector3r& result) {
-        UInt32 realVertexCount = this->vertexCount;
-        WeakPointer<IndexBuffer> indices;
-        if (this->indexed) {
-            indices = this->getIndexBuffer();
-            realVertexCount = this->indexCount;
-        }
-        if (faceVertexIndex >= realVertexCount - 2) {
-            throw Exception("Mesh::calculateFaceNormal -> 'faceIndex' is out range.");
-        }
-
-        UInt32 mappedFaceIndex1 = faceVertexIndex;
-        UInt32 mappedFaceIndex2 = faceVertexIndex + 1;
-        UInt32 mappedFaceIndex3 = faceVertexIndex + 2;
-        if (this->indexed) {
-            mappedFaceIndex1 = indices->getIndex(mappedFaceIndex1);
-            mappedFaceIndex2 = indices->getIndex(mappedFaceIndex2);
-            mappedFaceIndex3 = indices->getIndex(mappedFaceIndex3);
-        }
-     
+    void Mesh::calculateFaceNormal(const Point3rs * positions, UInt32 index1, UInt32 index2, UInt32 index3, Vector3r& result) {
         Vector3r a, b;
 
-        WeakPointer<AttributeArray<Point3rs>> positions = this->vertexPositions;
-       
-        Point3r p1 = positions->getAttribute(mappedFaceIndex1);
-        Point3r p2 = positions->getAttribute(mappedFaceIndex2);
-        Point3r p3 = positions->getAttribute(mappedFaceIndex3);
+        Point3r p1 = positions[index1];
+        Point3r p2 = positions[index2];
+        Point3r p3 = positions[index3];
 
         // form 2 vectors based on triangle's vertices
         a = p3 - p1;
@@ -477,110 +623,139 @@ namespace Core {
         result.normalize();
     }
 
+    /*
+    * Calculate vertex tangents with computeTangents() and refresh the interleaved buffer.
+    */
+    void Mesh::calculateTangents(Real smoothingThreshhold) {
+        this->computeTangents(smoothingThreshhold);
+        this->updateInterleavedBuffer();
+    }
+
      /*
     * Calculate vertex tangents using the two incident edges of a given vertex.
     * For all triangles that share a given vertex,the method will
     * calculate the average tangent for that vertex as long as the angle between
     * the un-averaged normals for the same vertices is less than [smoothingThreshhold].
     * [smoothingThreshhold is specified in degrees.
+    *
+    * Tangents are calculated for the unindexed vertices, so vertices in the cross map
+    * beyond the vertex count of an indexed mesh are ignored.
     */
-    void Mesh::calculateTangents(Real smoothingThreshhold) {
+    void Mesh::computeTangents(Real smoothingThreshhold) {
         if (!StandardAttributes::hasAttribute(this->enabledAttributes, StandardAttribute::Tangent)) return;
 
-        WeakPointer<AttributeArray<Vector3rs>> tangents = this->getVertexTangents();
-        WeakPointer<AttributeArray<Vector3rs>> faceNormals = this->getVertexFaceNormals();
-
-        // loop through each triangle in this mesh's vertices
-        // and calculate tangents for each
-        for (UInt32 v = 0; v < this->vertexCount - 2; v += 3) {
-            Vector3r t0, t1, t2;
-
-            this->calculateTangent(v, v + 2, v + 1, t0);
-            this->calculateTangent(v + 1, v, v + 2, t1);
-            this->calculateTangent(v + 2, v + 1, v, t2);
-
-            tangents->getAttribute(v).copy(t0);
-            tangents->getAttribute(v + 1).copy(t1);
-            tangents->getAttribute(v + 2).copy(t2);
+        if (!this->vertexCrossMapBuilt) {
+            this->buildVertexCrossMap();
         }
+        if (this->vertexCount < 3) return;
 
-        // This vector is used to store the calculated average tangent for all equal vertices
-        std::vector<Vector3r> averageTangents;
-
-        // loop through each vertex and lookup the associated list of
-        // tangents associated with that vertex, and then calculate the
-        // average tangents from that list.
-        for (UInt32 v = 0; v < this->vertexCount; v++) {
-            // get existing normal for this vertex
-            Vector3r oNormal;
-            oNormal = faceNormals->getAttribute(v);
-            oNormal.normalize();
-
-            Vector3r oTangent;
-            oTangent = vertexTangents->getAttribute(v);
-            oTangent.normalize();
-
-            // retrieve the list of equal vertices for vertex [v]
-            std::vector<UInt32>* listPtr = vertexCrossMap[v];
-            if (listPtr == nullptr) {
-                throw Exception("Mesh::calculateTangents -> Null pointer to vertex group list.");
-            }
-
-            Vector3r avg(0, 0, 0);
-            Real divisor = 0;
-
-            std::vector<UInt32>& list = *listPtr;
-
-            // compute the cosine of the smoothing threshhold angle
-            Real cosSmoothingThreshhold = (Math::cos(Math::DegreesToRads * smoothingThreshhold));
-
-            for (UInt32 i = 0; i < list.size(); i++) {
-                UInt32 vIndex = list[i];
-                Vector3rs& current = faceNormals->getAttribute(vIndex);
-                current.normalize();
+        // if the mesh doesn't have UVs dedicated for normal mapping, use the albedo UVs as a backup
+        WeakPointer<AttributeArray<Vector2rs>> sourceUVs = this->getVertexNormalUVs();
+        if (!sourceUVs) sourceUVs = this->getVertexAlbedoUVs();
 
-                // calculate angle between the normal that exists for this vertex,
-                // and the current normal in the list.
-                Real dot = Vector3r::dot(current, oNormal);
+        const Vector2rs * uvs = sourceUVs->getAttributes();
+        const Point3rs * positions = this->vertexPositions->getAttributes();
+        const Vector3rs * faceNormals = this->vertexFaceNormals->getAttributes();
+        Vector3rs * tangents = this->vertexTangents->getAttributes();
+        WeakPointer<JobSystem> jobSystem = Engine::instance()->getJobSystem();
 
-                if (dot > cosSmoothingThreshhold) {
-                    Vector3rs& tangent = tangents->getAttribute(vIndex);
-                    avg.x += tangent.x;
-                    avg.y += tangent.y;
-                    avg.z += tangent.z;
-                    divisor++;
-                }
+        // loop through each triangle in this mesh's vertices
+        // and calculate tangents for each
+        UInt32 triangleCount = this->vertexCount / 3;
+        jobSystem->parallelFor("Mesh::calculateVertexTangents", triangleCount, VertexGroupBatchSize, [positions, uvs, tangents](UInt32 start, UInt32 end) {
+            for (UInt32 t = start; t < end; t++) {
+                UInt32 v = t * 3;
+                Vector3r t0, t1, t2;
+
+                calculateTangent(positions, uvs, v, v + 2, v + 1, t0);
+                calculateTangent(positions, uvs, v + 1, v, v + 2, t1);
+                calculateTangent(positions, uvs, v + 2, v + 1, v, t2);
+
+                tangents[v].copy(t0);
+                tangents[v + 1].copy(t1);
+                tangents[v + 2].copy(t2);
             }
+        });
 
-            // if divisor < 1, then no extra tangents were found to include in the average,
-            // so just use the original one
+        // compute the cosine of the smoothing threshhold angle
+        Real cosSmoothingThreshhold = (Math::cos(Math::DegreesToRads * smoothingThreshhold));
+
+        const UInt32 * groupStarts = this->vertexGroupStarts.data();
+        const UInt32 * groupMembers = this->vertexGroupMembers.data();
+        UInt32 groupCount = (UInt32)this->vertexGroupStarts.size() - 1;
+        UInt32 vertexCount = this->vertexCount;
+
+        // for each group of equal vertices, set the tangent of each vertex to the average of the tangents in the group
+        // whose face normals differ from its own by an angle less than 'smoothingThreshhold'. the averages read the
+        // tangents of the whole group, so they are only written back once all of them are known.
+        jobSystem->parallelFor("Mesh::calculateTangents", groupCount, VertexGroupBatchSize, [=](UInt32 start, UInt32 end) {
+            // the averaged tangent of each vertex in the current group
+            std::vector<Vector3r> averageTangents;
+
+            for (UInt32 g = start; g < end; g++) {
+                UInt32 groupStart = groupStarts[g];
+                UInt32 groupEnd = groupStarts[g + 1];
+                while (groupEnd > groupStart && groupMembers[groupEnd - 1] >= vertexCount) groupEnd--;
+                UInt32 groupSize = groupEnd - groupStart;
+                averageTangents.resize(groupSize);
+
+                for (UInt32 j = 0; j < groupSize; j++) {
+                    UInt32 v = groupMembers[groupStart + j];
+
+                    // get existing normal for this vertex
+                    Vector3r oNormal;
+                    oNormal = faceNormals[v];
+                    oNormal.normalize();
+
+                    Vector3r oTangent;
+                    oTangent = tangents[v];
+                    oTangent.normalize();
+
+                    Vector3r& avg = averageTangents[j];
+                    avg.set(0, 0, 0);
+                    Real divisor = 0;
+
+                    for (UInt32 i = 0; i < groupSize; i++) {
+                        UInt32 vIndex = groupMembers[groupStart + i];
+                        Vector3r current = faceNormals[vIndex];
+                        current.normalize();
+
+                        // calculate angle between the normal that exists for this vertex,
+                        // and the current normal in the list.
+                        Real dot = Vector3r::dot(current, oNormal);
+
+                        if (dot > cosSmoothingThreshhold) {
+                            const Vector3rs& tangent = tangents[vIndex];
+                            avg.x += tangent.x;
+                            avg.y += tangent.y;
+                            avg.z += tangent.z;
+                            divisor++;
+                        }
+                    }
+
+                    // if divisor < 1, then no extra tangents were found to include in the average,
+                    // so just use the original one
+                    if (divisor <= 1) {
+                        avg = oTangent;
+                    }
+                    else {
+                        Real scaleFactor = (Real)1.0 / divisor;
+                        avg.scale(scaleFactor);
+                    }
+                }
 
-            if (divisor <= 1) {
-                avg.x = oTangent.x;
-                avg.y = oTangent.y;
-                avg.z = oTangent.z;
-            }
-            else {
-                Real scaleFactor = (Real)1.0 / divisor;
-                avg.scale(scaleFactor);
-                //avg.Normalize();
+                for (UInt32 j = 0; j < groupSize; j++) {
+                    Vector3r avg = averageTangents[j];
+                    avg.normalize();
+                    // set the tangent for this vertex to the averaged tangent
+                    tangents[groupMembers[groupStart + j]].set(avg.x, avg.y, avg.z);
+                }
             }
-
-            averageTangents.push_back(avg);
-        }
-
-        // loop through each vertex and assign the average tangent
-        // calculated for that vertex
-        for (UInt32 v = 0; v < this->vertexCount; v++) {
-            Vector3r avg = averageTangents[v];
-            avg.normalize();
-            // set the tangent for this vertex to the averaged tangent
-            tangents->getAttribute(v).set(avg.x, avg.y, avg.z);
-        }
+        });
 
         //if (invertTangents)InvertTangents();
 
-        tangents->updateGPUStorageData();
+        this->vertexTangents->updateGPUStorageData();
     }
 
     void Mesh::setName(const std::string& name) {
@@ -592,7 +767,8 @@ namespace Core {
     }
 
     /*
-    * Calculate the tangent for the vertex at [vertexIndex] in member [positions].
+    * Calculate the tangent for the vertex at [vertexIndex] in [positions], using the texture
+    * coordinates in [uvs].
     *
     * The two edges used in the calculation (e1 and e2) are formed from the three vertices: v0, v1, v2.
     *
@@ -600,18 +776,14 @@ namespace Core {
     * v2 is the vertex at [rightIndex] in [positions].
     * v1 is the vertex at [leftIndex] in [positions].
     */
-    void Mesh::calculateTangent(UInt32 vertexIndex, UInt32 rightIndex, UInt32 leftIndex, Vector3r& result) {
-        // if the mesh doesn't have UVs dedicated for normal mapping, use the albedo UVs as a backup
-        WeakPointer<AttributeArray<Vector2rs>> sourceUVs = this->getVertexNormalUVs();
-        if (!sourceUVs) sourceUVs = this->getVertexAlbedoUVs();
-        Vector2r uv0 = sourceUVs->getAttribute(vertexIndex);
-        Vector2r uv2 = sourceUVs->getAttribute(rightIndex);
-        Vector2r uv1 = sourceUVs->getAttribute(leftIndex);
+    void Mesh::calculateTangent(const Point3rs * positions, const Vector2rs * uvs, UInt32 vertexIndex, UInt32 rightIndex, UInt32 leftIndex, Vector3r& result) {
+        Vector2r uv0 = uvs[vertexIndex];
+        Vector2r uv2 = uvs[rightIndex];
+        Vector2r uv1 = uvs[leftIndex];
 
-        WeakPointer<AttributeArray<Point3rs>> sourcePositions = this->getVertexPositions();
-        Point3r p0 = sourcePositions->getAttribute(vertexIndex);
-        Point3r p2 = sourcePositions->getAttribute(rightIndex);
-        Point3r p1 = sourcePositions->getAttribute(leftIndex);
+        Point3r p0 = positions[vertexIndex];
+        Point3r p2 = positions[rightIndex];
+        Point3r p1 = positions[leftIndex];
 
         Vector3r e1 = p1 - p0;
         Vector3r e2 = p2 - p0;
@@ -643,76 +815,165 @@ namespace Core {
     }
 
     /*
-     * Deallocate and destroy [vertexCrossMap].
+     * Destroy the vertex cross map and release its memory.
      */
     void Mesh::destroyVertexCrossMap() {
-        if (this->vertexCrossMap != nullptr) {
-            UInt32 realVertexCount = this->vertexCount;
-            if (this->indexed) {
-                realVertexCount = this->indexCount;
-            }
-
-            std::unordered_map<std::vector<UInt32>*, Bool> deleted;
-            for (UInt32 i = 0; i < realVertexCount; i++) {
-                std::vector<UInt32>* list = this->vertexCrossMap[i];
-                if (list != nullptr && !deleted[list]) {
-                    delete list;
-                    deleted[list] = true;
-                }
-            }
-
-            delete[] this->vertexCrossMap;
-            this->vertexCrossMap = nullptr;
-        }
+        std::vector<UInt32>().swap(this->vertexGroups);
+        std::vector<UInt32>().swap(this->vertexGroupStarts);
+        std::vector<UInt32>().swap(this->vertexGroupMembers);
+        this->vertexCrossMapBuilt = false;
     }
 
     /*
-     * Construct [vertexCrossMap]. The vertex cross map is used to group all vertices that are equal.
-     * For a given combination of x,y,z, a corresponding list exists in [vertexCrossMap] with all the indices
-     * of vertices in [vertexPositions] which have a matching value for x,y, and z.
+     * Construct the vertex cross map. The vertex cross map is used to group all vertices that are equal,
+     * meaning their positions are within VertexWeldTolerance of each other on every axis. Group g holds
+     * the vertices at [vertexGroupStarts[g], vertexGroupStarts[g + 1]) in [vertexGroupMembers], in ascending
+     * order, and [vertexGroups] holds the group of each vertex. For indexed meshes the vertices are the
+     * entries of the index buffer.
+     *
+     * Positions are welded through a hash grid whose cells are several times VertexWeldTolerance wide, so
+     * each one is only compared against the groups in its own cell and, near the edges of that cell, the
+     * few cells next to it.
      */
     Bool Mesh::buildVertexCrossMap() {
         // destroy existing cross map (if there is one).
         this->destroyVertexCrossMap();
 
-        // This map is used to link all equal vertices. Many triangles in a mesh can potentially have equal
-        // vertices, so this structure is used to store indices in [vertexPositions] for those vertices.
-        std::unordered_map<Point3r, std::vector<UInt32>*, Vector3Base<Real>::Hasher, Vector3Base<Real>::Eq> vertexGroups;
-
         UInt32 realVertexCount = this->vertexCount;
-        WeakPointer<IndexBuffer> indices;
+        IndexBuffer * indices = nullptr;
         if (this->indexed) {
-            indices = this->getIndexBuffer();
+            indices = this->getIndexBuffer().get();
             realVertexCount = this->indexCount;
         }
 
-        vertexCrossMap = new(std::nothrow) std::vector<UInt32>*[realVertexCount];
-        if (vertexCrossMap == nullptr) {
-            throw AllocationException("Mesh::buildVertexCrossMap -> Could not allocate vertexCrossMap.");
+        class WeldCell {
+        public:
+            Int32 x, y, z;
+            // most recently created group in this cell, or InvalidVertexGroup for an empty cell
+            UInt32 lastGroup;
+        };
+
+        // keep the grid at most half full
+        UInt32 cellCapacity = 16;
+        while (cellCapacity < this->vertexCount * 2) cellCapacity *= 2;
+        UInt32 cellMask = cellCapacity - 1;
+        WeldCell emptyCell = {0, 0, 0, InvalidVertexGroup};
+        std::vector<WeldCell> cells(cellCapacity, emptyCell);
+
+        // the position each group was created for, which later positions are compared against, and
+        // the group created before it in the same cell
+        std::vector<UInt32> groupPositions;
+        std::vector<UInt32> previousGroups;
+        // the group of each position. every vertex that refers to the same position belongs to the same group.
+        std::vector<UInt32> positionGroups(this->vertexCount);
+
+        const Point3rs * positions = this->vertexPositions->getAttributes();
+
+        // find the earliest-created group in the cell at [x, y, z] whose position equals [point]
+        auto findGroup = [&](const Point3rs& point, Int32 x, Int32 y, Int32 z) {
+            UInt32 slot = hashWeldCell(x, y, z) & cellMask;
+            while (cells[slot].lastGroup != InvalidVertexGroup && (cells[slot].x != x || cells[slot].y != y || cells[slot].z != z)) {
+                slot = (slot + 1) & cellMask;
+            }
+
+            UInt32 found = InvalidVertexGroup;
+            for (UInt32 g = cells[slot].lastGroup; g != InvalidVertexGroup; g = previousGroups[g]) {
+                const Point3rs& groupPoint = positions[groupPositions[g]];
+                if (Math::abs(point.x - groupPoint.x) < VertexWeldTolerance &&
+                    Math::abs(point.y - groupPoint.y) < VertexWeldTolerance &&
+                    Math::abs(point.z - groupPoint.z) < VertexWeldTolerance) {
+                    found = g;
+                }
+            }
+            return found;
+        };
+
+        for (UInt32 p = 0; p < this->vertexCount; p++) {
+            const Point3rs& point = positions[p];
+            Int32 cellX = getWeldCell(point.x);
+            Int32 cellY = getWeldCell(point.y);
+            Int32 cellZ = getWeldCell(point.z);
+
+            // look in the point's own cell first, where exact duplicates are, then in the cells around it
+            // that are within the weld tolerance of it
+            UInt32 group = findGroup(point, cellX, cellY, cellZ);
+            if (group == InvalidVertexGroup) {
+                Int32 minX = getWeldCell(point.x - VertexWeldTolerance), maxX = getWeldCell(point.x + VertexWeldTolerance);
+                Int32 minY = getWeldCell(point.y - VertexWeldTolerance), maxY = getWeldCell(point.y + VertexWeldTolerance);
+                Int32 minZ = getWeldCell(point.z - VertexWeldTolerance), maxZ = getWeldCell(point.z + VertexWeldTolerance);
+                for (Int32 z = minZ; z <= maxZ && group == InvalidVertexGroup; z++) {
+                    for (Int32 y = minY; y <= maxY && group == InvalidVertexGroup; y++) {
+                        for (Int32 x = minX; x <= maxX && group == InvalidVertexGroup; x++) {
+                            if (x != cellX || y != cellY || z != cellZ) group = findGroup(point, x, y, z);
+                        }
+                    }
+                }
+            }
+
+            if (group == InvalidVertexGroup) {
+                group = (UInt32)groupPositions.size();
+                UInt32 slot = hashWeldCell(cellX, cellY, cellZ) & cellMask;
+                while (cells[slot].lastGroup != InvalidVertexGroup && (cells[slot].x != cellX || cells[slot].y != cellY || cells[slot].z != cellZ)) {
+                    slot = (slot + 1) & cellMask;
+                }
+                WeldCell& cell = cells[slot];
+                groupPositions.push_back(p);
+                previousGroups.push_back(cell.lastGroup);
+                cell.x = cellX;
+                cell.y = cellY;
+                cell.z = cellZ;
+                cell.lastGroup = group;
+            }
+            positionGroups[p] = group;
         }
-        
-        // loop through each vertex in the mesh and add the index in [vertexPositions] for that vertex to the
-        // appropriate vertex group.
+
+        // assign each vertex to the group of its position, then lay the groups out one after another
+        // with a counting sort, which keeps the vertices of each group in ascending order
+        UInt32 groupCount = (UInt32)groupPositions.size();
+        this->vertexGroups.resize(realVertexCount);
+        this->vertexGroupStarts.assign(groupCount + 1, 0);
         for (UInt32 v = 0; v < realVertexCount; v++) {
             UInt32 mappedIndex = v;
-            if (this->indexed) {
+            if (indices != nullptr) {
                 mappedIndex = indices->getIndex(mappedIndex);
+                if (mappedIndex >= this->vertexCount) {
+                    this->destroyVertexCrossMap();
+                    throw OutOfRangeException("Mesh::buildVertexCrossMap -> Index is out of range.");
+                }
             }
 
-            Point3r point = this->vertexPositions->getAttribute(mappedIndex);
-
-            std::vector<UInt32>*& list = vertexGroups[point];
-
-            if (list == nullptr)list = new(std::nothrow) std::vector<UInt32>();
-            if (list == nullptr) {
-                throw AllocationException("Mesh::buildVertexCrossMap -> Could not allocate sub list.");
-            }
+            UInt32 group = positionGroups[mappedIndex];
+            this->vertexGroups[v] = group;
+            this->vertexGroupStarts[group + 1]++;
+        }
+        for (UInt32 g = 0; g < groupCount; g++) {
+            this->vertexGroupStarts[g + 1] += this->vertexGroupStarts[g];
+        }
 
-            // add the normal at index [v] to the vertex group linked to [point]
-            list->push_back(v);
-            vertexCrossMap[v] = list;
+        // reuse [positionGroups] as the next free slot of each group
+        positionGroups.assign(this->vertexGroupStarts.begin(), this->vertexGroupStarts.end() - 1);
+        this->vertexGroupMembers.resize(realVertexCount);
+        for (UInt32 v = 0; v < realVertexCount; v++) {
+            this->vertexGroupMembers[positionGroups[this->vertexGroups[v]]++] = v;
         }
 
+        this->vertexCrossMapBuilt = true;
         return true;
     }
+
+    /*
+     * Find the cell of the vertex welding grid that holds [value] along one axis. Values too large for
+     * the grid (or NaN) are clamped to its edges, where they are still compared exactly.
+     */
+    Int32 Mesh::getWeldCell(Real value) {
+        static const Real limit = (Real)(1 << 30);
+        Real cell = (Real)std::floor((double)value / ((double)VertexWeldTolerance * WeldCellScale));
+        if (!(cell > -limit)) return -(1 << 30);
+        if (!(cell < limit)) return 1 << 30;
+        return (Int32)cell;
+    }
+
+    UInt32 Mesh::hashWeldCell(Int32 x, Int32 y, Int32 z) {
+        return ((UInt32)x * 73856093u) ^ ((UInt32)y * 19349663u) ^ ((UInt32)z * 83492791u);
+    }
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <new>
+#include <cstring>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -15,6 +17,7 @@
 #include "Vector2.h"
 #include "Vector3.h"
 #include "Box3.h"
+#include "MeshBVH.h"
 
 namespace Core {
 
@@ -58,6 +61,10 @@ namespace Core {
 
         void calculateBoundingBox();
         const Box3& getBoundingBox() const;
+        Bool hasBoundingBox() const;
+        UInt32 getBoundingBoxVersion() const;
+        const MeshBVH& getBVH();
+        void invalidateBVH();
 
         void setNormalsSmoothingThreshold(Real threshold);
         void setCalculateNormals(Bool calculateNormals);
@@ -72,14 +79,35 @@ namespace Core {
         void update();
         void reverseVertexAttributeWindingOrder();
 
+        void setInterleaved(Bool interleaved);
+        Bool isInterleaved() const;
+        void updateInterleavedBuffer();
+        WeakPointer<AttributeArrayGPUStorage> getInterleavedGPUStorage();
+        UInt32 getInterleavedStride() const;
+        Int32 getInterleavedOffset(StandardAttribute attribute) const;
+
     protected:
+        // vertices whose positions are closer than this on every axis are treated as equal
+        static constexpr Real VertexWeldTolerance = 0.005f;
+        static const UInt32 InvalidVertexGroup = 0xFFFFFFFF;
+        // width of the cells of the vertex welding grid, in multiples of VertexWeldTolerance
+        static const UInt32 WeldCellScale = 4;
+        // number of triangles or vertex groups handled by each job when calculating normals and tangents
+        static const UInt32 VertexGroupBatchSize = 1024;
+
         Mesh(WeakPointer<Graphics> graphics, UInt32 vertexCount, UInt32 indexCount);
         void initAttributes();
         Bool initIndices();
-        void calculateFaceNormal(UInt32 faceIndex, Vector3r& result);
-        void calculateTangent(UInt32 vertexIndex, UInt32 rightIndex, UInt32 leftIndex, Vector3r& result);
+        void computeNormals(Real smoothingThreshold);
+        void computeTangents(Real smoothingThreshhold);
+        static void calculateFaceNormal(const Point3rs * positions, UInt32 index1, UInt32 index2, UInt32 index3, Vector3r& result);
+        static void calculateTangent(const Point3rs * positions, const Vector2rs * uvs, UInt32 vertexIndex, UInt32 rightIndex, UInt32 leftIndex, Vector3r& result);
         void destroyVertexCrossMap();
         Bool buildVertexCrossMap();
+        static Int32 getWeldCell(Real value);
+        static UInt32 hashWeldCell(Int32 x, Int32 y, Int32 z);
+        void setAttributeGPUStorageEnabled(Bool enabled);
+        void invalidateVertexArrays();
 
         template <typename T>
         Bool initVertexAttributes(std::shared_ptr<AttributeArray<T>>* attributes, UInt32 vertexCount) {          
@@ -90,12 +118,52 @@ namespace Core {
                 throw AllocationException("MeshGL::initVertexAttributes() -> Unable to allocate array.");
             }
 
-            WeakPointer<AttributeArrayGPUStorage> gpuStorage =
-                Engine::instance()->createGPUStorage((*attributes)->getSize(), T::ComponentCount, AttributeType::Float, false);
-            (*attributes)->setGPUStorage(gpuStorage);
+            // interleaved meshes only get GPU storage for the shared buffer, see updateInterleavedBuffer()
+            if (!this->interleaved) {
+                this->initAttributeGPUStorage(attributes->get());
+            }
+            this->invalidateVertexArrays();
             return true;
         }
 
+        template <typename T>
+        void initAttributeGPUStorage(AttributeArray<T>* attributes) {
+            WeakPointer<AttributeArrayGPUStorage> gpuStorage =
+                Engine::instance()->createGPUStorage(attributes->getSize(), T::ComponentCount, AttributeType::Float, false);
+            attributes->setGPUStorage(gpuStorage);
+        }
+
+        template <typename T>
+        void layoutInterleavedAttribute(std::shared_ptr<AttributeArray<T>>& attributes, StandardAttribute attribute) {
+            Int32& offset = this->interleavedOffsets[(UInt32)attribute];
+            offset = -1;
+            if (attributes && this->isAttributeEnabled(attribute)) {
+                offset = this->interleavedStride;
+                this->interleavedStride += T::ComponentCount * sizeof(typename T::ComponentType);
+            }
+        }
+
+        template <typename T>
+        void packInterleavedAttribute(std::shared_ptr<AttributeArray<T>>& attributes, StandardAttribute attribute) {
+            Int32 offset = this->interleavedOffsets[(UInt32)attribute];
+            if (offset < 0) return;
+            const typename T::ComponentType* source = attributes->getStorage();
+            const UInt32 attributeSize = T::ComponentCount * sizeof(typename T::ComponentType);
+            Byte* destination = this->interleavedData.data() + offset;
+            for (UInt32 v = 0; v < this->vertexCount; v++) {
+                memcpy(destination, source, attributeSize);
+                source += T::ComponentCount;
+                destination += this->interleavedStride;
+            }
+        }
+
+        template <typename T>
+        void setAttributeGPUStorageEnabled(std::shared_ptr<AttributeArray<T>>& attributes, Bool enabled) {
+            if (!attributes) return;
+            if (enabled) this->initAttributeGPUStorage(attributes.get());
+            else attributes->setGPUStorage(WeakPointer<AttributeArrayGPUStorage>());
+        }
+
         std::string name;
         PersistentWeakPointer<Graphics> graphics;
         Bool initialized;
@@ -104,6 +172,12 @@ namespace Core {
         Bool indexed;
         UInt32 indexCount;
         Box3 boundingBox;
+        Bool boundingBoxCalculated;
+        // 0 until the bounding box is first calculated, see getBoundingBoxVersion()
+        UInt32 boundingBoxVersion;
+        // triangle hierarchy for ray queries, built on first use by getBVH() and dropped by update()
+        std::unique_ptr<MeshBVH> bvh;
+        std::mutex bvhLock;
 
         std::shared_ptr<AttributeArray<Point3rs>> vertexPositions;
         std::shared_ptr<AttributeArray<Vector3rs>> vertexNormals;
@@ -116,12 +190,23 @@ namespace Core {
 
         PersistentWeakPointer<IndexBuffer> indexBuffer;
 
-        // maps vertices to other equal vertices
-        std::vector<UInt32>** vertexCrossMap;
+        // groups of equal vertices, see buildVertexCrossMap()
+        std::vector<UInt32> vertexGroups;
+        std::vector<UInt32> vertexGroupStarts;
+        std::vector<UInt32> vertexGroupMembers;
+        Bool vertexCrossMapBuilt;
         Bool shoudCalculateNormals;
         Bool shoudCalculateTangents;
         Bool shouldCalculateBoundingBox;
         Real normalsSmoothingThreshold;
 
+        // when [interleaved] is set, all enabled vertex attributes live in [interleavedGPUStorage],
+        // [interleavedOffsets] holds the byte offset of each (or -1 when not present)
+        Bool interleaved;
+        PersistentWeakPointer<AttributeArrayGPUStorage> interleavedGPUStorage;
+        UInt32 interleavedStride;
+        Int32 interleavedOffsets[(UInt32)StandardAttribute::_Count];
+        std::vector<Byte> interleavedData;
+
     };
 }
@@ -0,0 +1,532 @@
+#include <algorithm>
+#include <limits>
+
+#include "MeshBVH.h"
+#include "Ray.h"
+#include "../math/Math.h"
+#include "../math/SIMD.h"
+
+namespace Core {
+
+    const UInt32 MeshBVH::PacketSize;
+    const UInt32 MeshBVH::MaxLeafSize;
+    const UInt32 MeshBVH::BinCount;
+    const UInt32 MeshBVH::MaxDepth;
+
+    static Real surfaceArea(const Real * min, const Real * max) {
+        Real dx = max[0] - min[0];
+        Real dy = max[1] - min[1];
+        Real dz = max[2] - min[2];
+        return 2.0f * (dx * dy + dy * dz + dz * dx);
+    }
+
+    MeshBVH::MeshBVH(): triangleCount(0) {
+    }
+
+    /*
+     * Build the hierarchy over [triangleCount] triangles, replacing any previous one. Triangle t has the vertices at
+     * [indices][3t, 3t + 2] in [vertices], or at [3t, 3t + 2] themselves when [indices] is null.
+     */
+    void MeshBVH::build(const Point3rs * vertices, const UInt32 * indices, UInt32 triangleCount) {
+        this->nodes.clear();
+        this->packets.clear();
+        this->triangleCount = 0;
+        if (triangleCount == 0) return;
+
+        std::vector<UInt32> sourceVertices(triangleCount * 3);
+        std::vector<BuildTriangle> triangles(triangleCount);
+        for (UInt32 t = 0; t < triangleCount; t++) {
+            BuildTriangle& triangle = triangles[t];
+            triangle.index = t;
+            for (UInt32 k = 0; k < 3; k++) {
+                UInt32 vertex = indices != nullptr ? indices[t * 3 + k] : t * 3 + k;
+                sourceVertices[t * 3 + k] = vertex;
+                const Point3rs& p = vertices[vertex];
+                Real coords[] = {p.x, p.y, p.z};
+                for (UInt32 a = 0; a < 3; a++) {
+                    if (k == 0 || coords[a] < triangle.min[a]) triangle.min[a] = coords[a];
+                    if (k == 0 || coords[a] > triangle.max[a]) triangle.max[a] = coords[a];
+                }
+            }
+            for (UInt32 a = 0; a < 3; a++) {
+                triangle.centroid[a] = (triangle.min[a] + triangle.max[a]) * 0.5f;
+            }
+        }
+
+        // a binary tree with at least one triangle per leaf never has more than 2n - 1 nodes
+        this->nodes.reserve(triangleCount * 2);
+        this->nodes.push_back(Node());
+        this->subdivide(0, triangles, 0, triangleCount, 0);
+        this->triangleCount = triangleCount;
+
+        // replace the triangle range of each leaf with its packets
+        this->packets.reserve((triangleCount + PacketSize - 1) / PacketSize + this->nodes.size() / 2);
+        for (Node& node : this->nodes) {
+            if (node.triangleCount == 0) continue;
+            UInt32 first = node.firstIndex;
+            node.firstIndex = (UInt32)this->packets.size();
+            for (UInt32 i = 0; i < node.triangleCount; i++) {
+                UInt32 lane = i % PacketSize;
+                if (lane == 0) {
+                    this->packets.push_back(TrianglePacket());
+                    TrianglePacket& packet = this->packets.back();
+                    for (UInt32 a = 0; a < 3; a++) {
+                        for (UInt32 l = 0; l < PacketSize; l++) {
+                            packet.vertex[a][l] = packet.edge1[a][l] = packet.edge2[a][l] = 0.0f;
+                        }
+                    }
+                }
+
+                TrianglePacket& packet = this->packets.back();
+                UInt32 source = triangles[first + i].index * 3;
+                const Point3rs& p0 = vertices[sourceVertices[source]];
+                const Point3rs& p1 = vertices[sourceVertices[source + 1]];
+                const Point3rs& p2 = vertices[sourceVertices[source + 2]];
+                Real v0[] = {p0.x, p0.y, p0.z};
+                Real v1[] = {p1.x, p1.y, p1.z};
+                Real v2[] = {p2.x, p2.y, p2.z};
+                for (UInt32 a = 0; a < 3; a++) {
+                    packet.vertex[a][lane] = v0[a];
+                    packet.edge1[a][lane] = v1[a] - v0[a];
+                    packet.edge2[a][lane] = v2[a] - v0[a];
+                }
+            }
+        }
+    }
+
+    UInt32 MeshBVH::getNodeCount() const {
+        return (UInt32)this->nodes.size();
+    }
+
+    UInt32 MeshBVH::getTriangleCount() const {
+        return this->triangleCount;
+    }
+
+    /*
+     * Fit the node at [nodeIndex] around triangles [first, first + count) and split it at the cheapest of the bin
+     * boundaries along each axis, as estimated by the surface area heuristic.
+     */
+    void MeshBVH::subdivide(UInt32 nodeIndex, std::vector<BuildTriangle>& triangles, UInt32 first, UInt32 count, UInt32 depth) {
+        Real nodeMin[3], nodeMax[3], centroidMin[3], centroidMax[3];
+        for (UInt32 a = 0; a < 3; a++) {
+            nodeMin[a] = centroidMin[a] = std::numeric_limits<Real>::max();
+            nodeMax[a] = centroidMax[a] = -std::numeric_limits<Real>::max();
+        }
+        for (UInt32 i = first; i < first + count; i++) {
+            const BuildTriangle& triangle = triangles[i];
+            for (UInt32 a = 0; a < 3; a++) {
+                nodeMin[a] = std::min(nodeMin[a], triangle.min[a]);
+                nodeMax[a] = std::max(nodeMax[a], triangle.max[a]);
+                centroidMin[a] = std::min(centroidMin[a], triangle.centroid[a]);
+                centroidMax[a] = std::max(centroidMax[a], triangle.centroid[a]);
+            }
+        }
+
+        Node& node = this->nodes[nodeIndex];
+        for (UInt32 a = 0; a < 3; a++) {
+            node.min[a] = nodeMin[a];
+            node.max[a] = nodeMax[a];
+        }
+        node.firstIndex = first;
+        node.triangleCount = count;
+        if (count <= MaxLeafSize || depth >= MaxDepth) return;
+
+        Int32 bestAxis = -1;
+        UInt32 bestSplit = 0;
+        Real bestCost = std::numeric_limits<Real>::max();
+        for (UInt32 a = 0; a < 3; a++) {
+            Real extent = centroidMax[a] - centroidMin[a];
+            if (extent <= 0) continue;
+
+            UInt32 binCounts[BinCount] = {0};
+            Real binMin[BinCount][3], binMax[BinCount][3];
+            for (UInt32 b = 0; b < BinCount; b++) {
+                for (UInt32 c = 0; c < 3; c++) {
+                    binMin[b][c] = std::numeric_limits<Real>::max();
+                    binMax[b][c] = -std::numeric_limits<Real>::max();
+                }
+            }
+
+            Real binScale = (Real)BinCount / extent;
+            for (UInt32 i = first; i < first + count; i++) {
+                const BuildTriangle& triangle = triangles[i];
+                UInt32 bin = std::min((UInt32)((triangle.centroid[a] - centroidMin[a]) * binScale), BinCount - 1);
+                binCounts[bin]++;
+                for (UInt32 c = 0; c < 3; c++) {
+                    binMin[bin][c] = std::min(binMin[bin][c], triangle.min[c]);
+                    binMax[bin][c] = std::max(binMax[bin][c], triangle.max[c]);
+                }
+            }
+
+            // sweep from the right to find the cost of everything above each split, then from the left
+            Real rightCosts[BinCount];
+            Real sweepMin[3], sweepMax[3];
+            UInt32 sweepCount = 0;
+            for (UInt32 c = 0; c < 3; c++) {
+                sweepMin[c] = std::numeric_limits<Real>::max();
+                sweepMax[c] = -std::numeric_limits<Real>::max();
+            }
+            for (UInt32 b = BinCount - 1; b > 0; b--) {
+                sweepCount += binCounts[b];
+                for (UInt32 c = 0; c < 3; c++) {
+                    sweepMin[c] = std::min(sweepMin[c], binMin[b][c]);
+                    sweepMax[c] = std::max(sweepMax[c], binMax[b][c]);
+                }
+                rightCosts[b] = sweepCount > 0 ? sweepCount * surfaceArea(sweepMin, sweepMax) : -1;
+            }
+
+            sweepCount = 0;
+            for (UInt32 c = 0; c < 3; c++) {
+                sweepMin[c] = std::numeric_limits<Real>::max();
+                sweepMax[c] = -std::numeric_limits<Real>::max();
+            }
+            for (UInt32 split = 1; split < BinCount; split++) {
+                UInt32 b = split - 1;
+                sweepCount += binCounts[b];
+                for (UInt32 c = 0; c < 3; c++) {
+                    sweepMin[c] = std::min(sweepMin[c], binMin[b][c]);
+                    sweepMax[c] = std::max(sweepMax[c], binMax[b][c]);
+                }
+                if (sweepCount == 0 || rightCosts[split] < 0) continue;
+                Real cost = sweepCount * surfaceArea(sweepMin, sweepMax) + rightCosts[split];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = (Int32)a;
+                    bestSplit = split;
+                }
+            }
+        }
+
+        // every centroid is in the same place, so there is nothing to split
+        if (bestAxis < 0) return;
+
+        Real splitMin = centroidMin[bestAxis];
+        Real binScale = (Real)BinCount / (centroidMax[bestAxis] - splitMin);
+        std::vector<BuildTriangle>::iterator middle = std::partition(triangles.begin() + first, triangles.begin() + first + count,
+            [bestAxis, bestSplit, splitMin, binScale](const BuildTriangle& triangle) {
+                UInt32 bin = std::min((UInt32)((triangle.centroid[bestAxis] - splitMin) * binScale), BinCount - 1);
+                return bin < bestSplit;
+            });
+        UInt32 leftCount = (UInt32)(middle - (triangles.begin() + first));
+        if (leftCount == 0 || leftCount == count) return;
+
+        UInt32 leftIndex = (UInt32)this->nodes.size();
+        this->nodes.push_back(Node());
+        this->nodes.push_back(Node());
+        this->nodes[nodeIndex].firstIndex = leftIndex;
+        this->nodes[nodeIndex].triangleCount = 0;
+        this->subdivide(leftIndex, triangles, first, leftCount, depth + 1);
+        this->subdivide(leftIndex + 1, triangles, first + leftCount, count - leftCount, depth + 1);
+    }
+
+    /*
+     * Find every triangle hit by [ray] in front of its origin, append them to [hits], and return how many were found.
+     */
+    UInt32 MeshBVH::intersect(const Ray& ray, std::vector<Hit>& hits) const {
+        if (this->nodes.size() == 0) return 0;
+        Real directionLengthSq = Vector3r::dot(ray.Direction, ray.Direction);
+        if (directionLengthSq == 0) return 0;
+
+        Real origin[] = {ray.Origin.x, ray.Origin.y, ray.Origin.z};
+        Real direction[] = {ray.Direction.x, ray.Direction.y, ray.Direction.z};
+        Vector3r inverseDirection(1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z);
+        Real directionLength = Math::squareRoot(directionLengthSq);
+        Real maxT = std::numeric_limits<Real>::max();
+        UInt32 hitCount = 0;
+
+        UInt32 stack[MaxDepth + 2];
+        UInt32 stackSize = 0;
+        Real entryT;
+        if (!intersectNode(this->nodes[0], ray.Origin, inverseDirection, maxT, entryT)) return 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+            const Node& node = this->nodes[stack[--stackSize]];
+            if (node.triangleCount > 0) {
+                UInt32 packetCount = (node.triangleCount + PacketSize - 1) / PacketSize;
+                for (UInt32 p = 0; p < packetCount; p++) {
+                    const TrianglePacket& packet = this->packets[node.firstIndex + p];
+                    Real t[PacketSize];
+                    UInt32 laneMask = intersectPacket(packet, origin, direction, maxT, t);
+                    for (UInt32 lane = 0; laneMask != 0; lane++, laneMask >>= 1) {
+                        if (!(laneMask & 1)) continue;
+                        Hit hit;
+                        getHit(ray, packet, lane, t[lane], directionLength, hit);
+                        hits.push_back(hit);
+                        hitCount++;
+                    }
+                }
+            }
+            else {
+                if (intersectNode(this->nodes[node.firstIndex], ray.Origin, inverseDirection, maxT, entryT)) stack[stackSize++] = node.firstIndex;
+                if (intersectNode(this->nodes[node.firstIndex + 1], ray.Origin, inverseDirection, maxT, entryT)) stack[stackSize++] = node.firstIndex + 1;
+            }
+        }
+
+        return hitCount;
+    }
+
+    /*
+     * Find the triangle hit by [ray] closest to its origin, within [0, maxT] in multiples of the ray's direction.
+     * When one is found, [maxT] is lowered to its ray parameter. Children are visited nearest first, and nodes that
+     * start beyond the closest hit found so far are skipped. If [triangleTests] is given, the number of triangles
+     * tested against the ray is added to it.
+     */
+    Bool MeshBVH::intersectClosest(const Ray& ray, Real& maxT, Hit& hit, UInt32 * triangleTests) const {
+        if (this->nodes.size() == 0) return false;
+        Real directionLengthSq = Vector3r::dot(ray.Direction, ray.Direction);
+        if (directionLengthSq == 0) return false;
+
+        Real origin[] = {ray.Origin.x, ray.Origin.y, ray.Origin.z};
+        Real direction[] = {ray.Direction.x, ray.Direction.y, ray.Direction.z};
+        Vector3r inverseDirection(1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z);
+        Real closestT = maxT;
+        const TrianglePacket * closestPacket = nullptr;
+        UInt32 closestLane = 0;
+
+        UInt32 stack[MaxDepth + 2];
+        Real stackT[MaxDepth + 2];
+        UInt32 stackSize = 0;
+        Real entryT;
+        if (!intersectNode(this->nodes[0], ray.Origin, inverseDirection, closestT, entryT)) return false;
+        stack[stackSize] = 0;
+        stackT[stackSize++] = entryT;
+
+        while (stackSize > 0) {
+            stackSize--;
+            if (stackT[stackSize] > closestT) continue;
+            const Node& node = this->nodes[stack[stackSize]];
+            if (node.triangleCount > 0) {
+                if (triangleTests != nullptr) *triangleTests += node.triangleCount;
+                UInt32 packetCount = (node.triangleCount + PacketSize - 1) / PacketSize;
+                for (UInt32 p = 0; p < packetCount; p++) {
+                    const TrianglePacket& packet = this->packets[node.firstIndex + p];
+                    Real t[PacketSize];
+                    UInt32 laneMask = intersectPacket(packet, origin, direction, closestT, t);
+                    for (UInt32 lane = 0; laneMask != 0; lane++, laneMask >>= 1) {
+                        if ((laneMask & 1) && t[lane] <= closestT) {
+                            closestT = t[lane];
+                            closestPacket = &packet;
+                            closestLane = lane;
+                        }
+                    }
+                }
+            }
+            else {
+                UInt32 near = node.firstIndex;
+                UInt32 far = node.firstIndex + 1;
+                Real nearT, farT;
+                Bool hitNear = intersectNode(this->nodes[near], ray.Origin, inverseDirection, closestT, nearT);
+                Bool hitFar = intersectNode(this->nodes[far], ray.Origin, inverseDirection, closestT, farT);
+                if (hitNear && hitFar && farT < nearT) {
+                    std::swap(near, far);
+                    std::swap(nearT, farT);
+                }
+                if (hitFar) {
+                    stack[stackSize] = far;
+                    stackT[stackSize++] = farT;
+                }
+                if (hitNear) {
+                    stack[stackSize] = near;
+                    stackT[stackSize++] = nearT;
+                }
+            }
+        }
+
+        if (closestPacket == nullptr) return false;
+        getHit(ray, *closestPacket, closestLane, closestT, Math::squareRoot(directionLengthSq), hit);
+        maxT = closestT;
+        return true;
+    }
+
+    /*
+     * Determine whether [ray] hits any triangle within [0, maxT] in multiples of its direction. Traversal stops at
+     * the first hit found, which need not be the closest.
+     */
+    Bool MeshBVH::intersectAny(const Ray& ray, Real maxT) const {
+        if (this->nodes.size() == 0) return false;
+        if (Vector3r::dot(ray.Direction, ray.Direction) == 0) return false;
+
+        Real origin[] = {ray.Origin.x, ray.Origin.y, ray.Origin.z};
+        Real direction[] = {ray.Direction.x, ray.Direction.y, ray.Direction.z};
+        Vector3r inverseDirection(1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z);
+
+        UInt32 stack[MaxDepth + 2];
+        UInt32 stackSize = 0;
+        Real entryT;
+        if (!intersectNode(this->nodes[0], ray.Origin, inverseDirection, maxT, entryT)) return false;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+            const Node& node = this->nodes[stack[--stackSize]];
+            if (node.triangleCount > 0) {
+                UInt32 packetCount = (node.triangleCount + PacketSize - 1) / PacketSize;
+                for (UInt32 p = 0; p < packetCount; p++) {
+                    Real t[PacketSize];
+                    if (intersectPacket(this->packets[node.firstIndex + p], origin, direction, maxT, t) != 0) return true;
+                }
+            }
+            else {
+                if (intersectNode(this->nodes[node.firstIndex], ray.Origin, inverseDirection, maxT, entryT)) stack[stackSize++] = node.firstIndex;
+                if (intersectNode(this->nodes[node.firstIndex + 1], ray.Origin, inverseDirection, maxT, entryT)) stack[stackSize++] = node.firstIndex + 1;
+            }
+        }
+
+        return false;
+    }
+
+    /*
+     * Slab test of the bounds of [node] against the ray over [0, maxT]. [entryT] receives the ray parameter at which
+     * the ray enters the bounds.
+     */
+    Bool MeshBVH::intersectNode(const Node& node, const Point3r& origin, const Vector3r& inverseDirection, Real maxT, Real& entryT) {
+        Real origins[] = {origin.x, origin.y, origin.z};
+        Real inverses[] = {inverseDirection.x, inverseDirection.y, inverseDirection.z};
+        Real tMin = 0;
+        Real tMax = maxT;
+        for (UInt32 a = 0; a < 3; a++) {
+            Real t1 = (node.min[a] - origins[a]) * inverses[a];
+            Real t2 = (node.max[a] - origins[a]) * inverses[a];
+            if (t1 > t2) std::swap(t1, t2);
+            if (t1 > tMin) tMin = t1;
+            if (t2 < tMax) tMax = t2;
+            if (tMin > tMax) return false;
+        }
+        entryT = tMin;
+        return true;
+    }
+
+    /*
+     * Möller-Trumbore test of the ray with [origin] and [direction] against every lane of [packet]. Returns a mask
+     * with bit n set if the triangle in lane n is hit within [0, maxT], with the ray parameter of the hit in [t].
+     * As with Ray::intersectTriangle(), triangles are only hit from their front, i.e. when the ray points against
+     * (p2 - p0) x (p1 - p0), so the determinant of every hit is negative.
+     */
+    UInt32 MeshBVH::intersectPacket(const TrianglePacket& packet, const Real * origin, const Real * direction, Real maxT, Real * t) {
+#if defined(CORE_SIMD_SSE)
+        __m128 dx = _mm_set1_ps(direction[0]);
+        __m128 dy = _mm_set1_ps(direction[1]);
+        __m128 dz = _mm_set1_ps(direction[2]);
+        __m128 e1x = _mm_loadu_ps(packet.edge1[0]);
+        __m128 e1y = _mm_loadu_ps(packet.edge1[1]);
+        __m128 e1z = _mm_loadu_ps(packet.edge1[2]);
+        __m128 e2x = _mm_loadu_ps(packet.edge2[0]);
+        __m128 e2y = _mm_loadu_ps(packet.edge2[1]);
+        __m128 e2z = _mm_loadu_ps(packet.edge2[2]);
+
+        // p = direction x edge2
+        __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+        __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+        __m128 inverseDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+        // s = origin - vertex, q = s x edge1
+        __m128 sx = _mm_sub_ps(_mm_set1_ps(origin[0]), _mm_loadu_ps(packet.vertex[0]));
+        __m128 sy = _mm_sub_ps(_mm_set1_ps(origin[1]), _mm_loadu_ps(packet.vertex[1]));
+        __m128 sz = _mm_sub_ps(_mm_set1_ps(origin[2]), _mm_loadu_ps(packet.vertex[2]));
+        __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDet);
+        __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+        __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+        __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+        __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseDet);
+        __m128 hitT = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDet);
+
+        __m128 zero = _mm_setzero_ps();
+        __m128 mask = _mm_cmplt_ps(det, zero);
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(hitT, zero));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(hitT, _mm_set1_ps(maxT)));
+        _mm_storeu_ps(t, hitT);
+        return (UInt32)_mm_movemask_ps(mask);
+#elif defined(CORE_SIMD_NEON)
+        float32x4_t dx = vdupq_n_f32(direction[0]);
+        float32x4_t dy = vdupq_n_f32(direction[1]);
+        float32x4_t dz = vdupq_n_f32(direction[2]);
+        float32x4_t e1x = vld1q_f32(packet.edge1[0]);
+        float32x4_t e1y = vld1q_f32(packet.edge1[1]);
+        float32x4_t e1z = vld1q_f32(packet.edge1[2]);
+        float32x4_t e2x = vld1q_f32(packet.edge2[0]);
+        float32x4_t e2y = vld1q_f32(packet.edge2[1]);
+        float32x4_t e2z = vld1q_f32(packet.edge2[2]);
+
+        // p = direction x edge2
+        float32x4_t px = vmlsq_f32(vmulq_f32(dy, e2z), dz, e2y);
+        float32x4_t py = vmlsq_f32(vmulq_f32(dz, e2x), dx, e2z);
+        float32x4_t pz = vmlsq_f32(vmulq_f32(dx, e2y), dy, e2x);
+        float32x4_t det = vmlaq_f32(vmlaq_f32(vmulq_f32(e1x, px), e1y, py), e1z, pz);
+
+        // reciprocal estimate refined with two Newton-Raphson steps
+        float32x4_t inverseDet = vrecpeq_f32(det);
+        inverseDet = vmulq_f32(inverseDet, vrecpsq_f32(det, inverseDet));
+        inverseDet = vmulq_f32(inverseDet, vrecpsq_f32(det, inverseDet));
+
+        // s = origin - vertex, q = s x edge1
+        float32x4_t sx = vsubq_f32(vdupq_n_f32(origin[0]), vld1q_f32(packet.vertex[0]));
+        float32x4_t sy = vsubq_f32(vdupq_n_f32(origin[1]), vld1q_f32(packet.vertex[1]));
+        float32x4_t sz = vsubq_f32(vdupq_n_f32(origin[2]), vld1q_f32(packet.vertex[2]));
+        float32x4_t u = vmulq_f32(vmlaq_f32(vmlaq_f32(vmulq_f32(sx, px), sy, py), sz, pz), inverseDet);
+        float32x4_t qx = vmlsq_f32(vmulq_f32(sy, e1z), sz, e1y);
+        float32x4_t qy = vmlsq_f32(vmulq_f32(sz, e1x), sx, e1z);
+        float32x4_t qz = vmlsq_f32(vmulq_f32(sx, e1y), sy, e1x);
+        float32x4_t v = vmulq_f32(vmlaq_f32(vmlaq_f32(vmulq_f32(dx, qx), dy, qy), dz, qz), inverseDet);
+        float32x4_t hitT = vmulq_f32(vmlaq_f32(vmlaq_f32(vmulq_f32(e2x, qx), e2y, qy), e2z, qz), inverseDet);
+
+        float32x4_t zero = vdupq_n_f32(0);
+        uint32x4_t mask = vcltq_f32(det, zero);
+        mask = vandq_u32(mask, vcgeq_f32(u, zero));
+        mask = vandq_u32(mask, vcgeq_f32(v, zero));
+        mask = vandq_u32(mask, vcleq_f32(vaddq_f32(u, v), vdupq_n_f32(1.0f)));
+        mask = vandq_u32(mask, vcgeq_f32(hitT, zero));
+        mask = vandq_u32(mask, vcleq_f32(hitT, vdupq_n_f32(maxT)));
+        vst1q_f32(t, hitT);
+
+        UInt32 lanes[PacketSize];
+        vst1q_u32(lanes, mask);
+        UInt32 laneMask = 0;
+        for (UInt32 lane = 0; lane < PacketSize; lane++) {
+            if (lanes[lane]) laneMask |= 1 << lane;
+        }
+        return laneMask;
+#else
+        UInt32 laneMask = 0;
+        for (UInt32 lane = 0; lane < PacketSize; lane++) {
+            Real e1[] = {packet.edge1[0][lane], packet.edge1[1][lane], packet.edge1[2][lane]};
+            Real e2[] = {packet.edge2[0][lane], packet.edge2[1][lane], packet.edge2[2][lane]};
+            Real p[] = {direction[1] * e2[2] - direction[2] * e2[1],
+                        direction[2] * e2[0] - direction[0] * e2[2],
+                        direction[0] * e2[1] - direction[1] * e2[0]};
+            Real det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+            if (!(det < 0.0f)) continue;
+            Real inverseDet = 1.0f / det;
+
+            Real s[] = {origin[0] - packet.vertex[0][lane], origin[1] - packet.vertex[1][lane], origin[2] - packet.vertex[2][lane]};
+            Real u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverseDet;
+            if (u < 0.0f || u > 1.0f) continue;
+            Real q[] = {s[1] * e1[2] - s[2] * e1[1],
+                        s[2] * e1[0] - s[0] * e1[2],
+                        s[0] * e1[1] - s[1] * e1[0]};
+            Real v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * inverseDet;
+            if (v < 0.0f || u + v > 1.0f) continue;
+            t[lane] = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inverseDet;
+            if (t[lane] >= 0.0f && t[lane] <= maxT) laneMask |= 1 << lane;
+        }
+        return laneMask;
+#endif
+    }
+
+    /*
+     * Fill in [hit] for the triangle in [lane] of [packet], hit by [ray] at [t]. The normal is not normalized, to
+     * match Ray::intersectTriangle().
+     */
+    void MeshBVH::getHit(const Ray& ray, const TrianglePacket& packet, UInt32 lane, Real t, Real directionLength, Hit& hit) {
+        Vector3r edge1(packet.edge1[0][lane], packet.edge1[1][lane], packet.edge1[2][lane]);
+        Vector3r edge2(packet.edge2[0][lane], packet.edge2[1][lane], packet.edge2[2][lane]);
+        hit.Origin.set(ray.Origin.x + ray.Direction.x * t, ray.Origin.y + ray.Direction.y * t, ray.Origin.z + ray.Direction.z * t);
+        hit.Normal = edge2.cross(edge1);
+        hit.Distance = t * directionLength;
+    }
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+
+#include "../common/types.h"
+#include "Vector3.h"
+#include "Hit.h"
+
+namespace Core {
+
+    // forward declarations
+    class Ray;
+
+    /*
+     * Bounding volume hierarchy over the triangles of a Mesh, built with binned SAH splits. Nodes are 32 bytes and
+     * stored in a single array, with the two children of an interior node next to each other. The triangles of each
+     * leaf are copied into packets of PacketSize triangles, stored one component per lane, so traversal never touches
+     * the mesh's vertices or index buffer and a whole packet is tested against a ray at once.
+     */
+    class MeshBVH {
+    public:
+
+        MeshBVH();
+
+        void build(const Point3rs * vertices, const UInt32 * indices, UInt32 triangleCount);
+        UInt32 getNodeCount() const;
+        UInt32 getTriangleCount() const;
+
+        UInt32 intersect(const Ray& ray, std::vector<Hit>& hits) const;
+        Bool intersectClosest(const Ray& ray, Real& maxT, Hit& hit, UInt32 * triangleTests = nullptr) const;
+        Bool intersectAny(const Ray& ray, Real maxT) const;
+
+    private:
+
+        // number of triangles tested together by the SIMD kernel
+        static const UInt32 PacketSize = 4;
+        // leaves hold at most this many triangles unless they cannot be split
+        static const UInt32 MaxLeafSize = PacketSize;
+        static const UInt32 BinCount = 12;
+        // traversal uses a fixed-size stack, so the tree is never built deeper than this
+        static const UInt32 MaxDepth = 60;
+
+        class Node {
+        public:
+            Real min[3];
+            // index of the first child for interior nodes, or of the first triangle packet for leaves
+            UInt32 firstIndex;
+            Real max[3];
+            // zero for interior nodes
+            UInt32 triangleCount;
+        };
+
+        class BuildTriangle {
+        public:
+            Real min[3];
+            Real max[3];
+            Real centroid[3];
+            UInt32 index;
+        };
+
+        // vertex 0 of each triangle and the two edges leaving it. unused lanes are zero, which no ray can hit.
+        class TrianglePacket {
+        public:
+            Real vertex[3][PacketSize];
+            Real edge1[3][PacketSize];
+            Real edge2[3][PacketSize];
+        };
+
+        void subdivide(UInt32 nodeIndex, std::vector<BuildTriangle>& triangles, UInt32 first, UInt32 count, UInt32 depth);
+        static Bool intersectNode(const Node& node, const Point3r& origin, const Vector3r& inverseDirection, Real maxT, Real& entryT);
+        static UInt32 intersectPacket(const TrianglePacket& packet, const Real * origin, const Real * direction, Real maxT, Real * t);
+        static void getHit(const Ray& ray, const TrianglePacket& packet, UInt32 lane, Real t, Real directionLength, Hit& hit);
+
+        std::vector<Node> nodes;
+        // the triangles of each leaf, in as many packets as they need
+        std::vector<TrianglePacket> packets;
+        UInt32 triangleCount;
+    };
+
+}
@@ -1,5 +1,8 @@
+#include <limits>
+
 #include "Ray.h"
 #include "Mesh.h"
+#include "MeshBVH.h"
 #include "AttributeArray.h"
 #include "IndexBuffer.h"
 #include "Vector4.h"
@@ -7,33 +10,36 @@
 
 namespace Core {
 
+    /*
+     * Append every front-facing triangle of [mesh] hit by this ray in front of its origin to [hits]. The triangles
+     * are found by traversing the mesh's bounding volume hierarchy.
+     */
     Bool Ray::intersectMesh(WeakPointer<Mesh> mesh, std::vector<Hit>& hits) const {
-        WeakPointer<AttributeArray<Point3rs>> vertexArray = mesh->getVertexPositions();
-        Point3rs * vertices = vertexArray->getAttributes();
-
-        UInt32 tCount = vertexArray->getAttributeCount();
-        WeakPointer<IndexBuffer> indices;
-        if (mesh->isIndexed()) {
-            indices = mesh->getIndexBuffer();
-            tCount = indices->getSize();
-        }
+        const MeshBVH& bvh = mesh->getBVH();
+        if (bvh.getTriangleCount() == 0) return hits.size() > 0;
 
-        Hit hit;
-        for (UInt32 i = 0; i < tCount; i+=3) {
-            Bool wasHit = false;
-            Point3r a = mesh->isIndexed() ? *(vertices + indices->getIndex(i)) : *(vertices + i);
-            Point3r b = mesh->isIndexed() ? *(vertices + indices->getIndex(i + 1)) : *(vertices + i + 1);
-            Point3r c = mesh->isIndexed() ? *(vertices + indices->getIndex(i + 2)) : *(vertices + i + 2);
-            wasHit = this->intersectTriangle(a, b, c, hit);
-            if (wasHit) {
-                hit.Object = mesh;
-                hits.push_back(hit);
-            }
+        UInt32 startIndex = (UInt32)hits.size();
+        bvh.intersect(*this, hits);
+        for (UInt32 i = startIndex; i < hits.size(); i++) {
+            hits[i].Object = mesh;
         }
 
         return hits.size() > 0;
     }
 
+    /*
+     * Find the front-facing triangle of [mesh] hit closest to the origin of this ray.
+     */
+    Bool Ray::intersectMesh(WeakPointer<Mesh> mesh, Hit& hit) const {
+        const MeshBVH& bvh = mesh->getBVH();
+        if (bvh.getTriangleCount() == 0) return false;
+
+        Real maxT = std::numeric_limits<Real>::max();
+        if (!bvh.intersectClosest(*this, maxT, hit)) return false;
+        hit.Object = mesh;
+        return true;
+    }
+
     Bool Ray::intersectBox(const Box3& box, Hit& hit) const {
 
         Real _origin[] = {this->Origin.x, this->Origin.y, this->Origin.z};
@@ -66,42 +72,29 @@ namespace Core {
         return false;
     }
 
+    /*
+     * Möller-Trumbore intersection of the line through this ray with the triangle [p0, p1, p2]. Only the front of
+     * the triangle is hit, which faces along (p2 - p0) x (p1 - p0); that (unnormalized) vector is the normal of the hit.
+     */
     Bool Ray::intersectTriangle(const Point3r& p0, const Point3r& p1,
                                 const Point3r& p2, Hit& hit) const {
-        Vector3r q1 = p2 - p0;
-        Vector3r q2 = p1 - p0;
-        Vector3r normal = q1.cross(q2);
-
-        if (Vector3r::dot(normal, this->Direction) >= 0) return false;
-
-        Real d = -Vector3r::dot(p0, normal);
-        Vector4r planeEq(normal.x, normal.y, normal.z, d);
-        
-        Hit planeHit;
-        Bool intersectsPlane = this->intersectPlane(planeEq, planeHit);
-        if (!intersectsPlane) return false;
-
-        Vector3r r = planeHit.Origin - p0;
-        Real rDotQ1 = Vector3r::dot(r, q1);
-        Real rDotQ2 = Vector3r::dot(r, q2);
-
-        Real q1Sq = Vector3r::dot(q1, q1);
-        Real q2Sq = Vector3r::dot(q2, q2);
-        Real q1Dotq2 = Vector3r::dot(q1, q2);
-
-        Real qF = -q1Dotq2 / q2Sq;
-        Real w1 = (qF * rDotQ2 + rDotQ1) / (qF * q1Dotq2 + q1Sq);
-        Real w2 = (rDotQ2 - (w1 * q1Dotq2)) / q2Sq;
-        
-        Real w0 = 1.0 - w2 - w1;
-
-        if (w0 < 0 || w1 < 0 || w2 < 0 || w0 > 1.0 || w1 > 1.0 || w2 > 1.0) {
-            return false;
-        }
-
-        hit.Origin = planeHit.Origin;
-        hit.Normal = normal;
-
+        Vector3r edge1 = p1 - p0;
+        Vector3r edge2 = p2 - p0;
+        Vector3r p = this->Direction.cross(edge2);
+        Real det = Vector3r::dot(edge1, p);
+        if (!(det < 0.0f)) return false;
+        Real inverseDet = 1.0f / det;
+
+        Vector3r s = this->Origin - p0;
+        Real u = Vector3r::dot(s, p) * inverseDet;
+        if (u < 0.0f || u > 1.0f) return false;
+        Vector3r q = s.cross(edge1);
+        Real v = Vector3r::dot(this->Direction, q) * inverseDet;
+        if (v < 0.0f || u + v > 1.0f) return false;
+        Real t = Vector3r::dot(edge2, q) * inverseDet;
+
+        hit.Origin = this->Origin + this->Direction * t;
+        hit.Normal = edge2.cross(edge1);
         return true;
     }
 
@@ -22,6 +22,7 @@ namespace Core {
             this->Direction.set(direction.x, direction.y, direction.z);
         }
         Bool intersectMesh(WeakPointer<Mesh> mesh, std::vector<Hit>& hits) const;
+        Bool intersectMesh(WeakPointer<Mesh> mesh, Hit& hit) const;
         Bool intersectBox(const Box3& box, Hit& hit) const;
         
         Bool intersectTriangle(const Point3r& p0, const Point3r& p1,
@@ -30,6 +30,12 @@ namespace Core {
         this->lightShadowSoftnessLocation = -1;
         this->lightNearPlaneLocation = -1;
         this->lightCountLocation = -1;
+        this->lightClusterGridLocation = -1;
+        this->lightClusterLightIndicesLocation = -1;
+        this->lightClusterLightDataLocation = -1;
+        this->lightClusterDimensionsLocation = -1;
+        this->lightClusterDepthParamsLocation = -1;
+        this->lightClusterEnabledLocation = -1;
     }
 
     BaseLitMaterial::~BaseLitMaterial(){
@@ -90,6 +96,18 @@ namespace Core {
                 return this->lightNearPlaneLocation;
             case StandardUniform::LightCount:
                 return this->lightCountLocation;
+            case StandardUniform::LightClusterGrid:
+                return this->lightClusterGridLocation;
+            case StandardUniform::LightClusterLightIndices:
+                return this->lightClusterLightIndicesLocation;
+            case StandardUniform::LightClusterLightData:
+                return this->lightClusterLightDataLocation;
+            case StandardUniform::LightClusterDimensions:
+                return this->lightClusterDimensionsLocation;
+            case StandardUniform::LightClusterDepthParams:
+                return this->lightClusterDepthParamsLocation;
+            case StandardUniform::LightClusterEnabled:
+                return this->lightClusterEnabledLocation;
             default:
                 return -1;
         }
@@ -122,6 +140,12 @@ namespace Core {
             baseMaterial->lightShadowSoftnessLocation = this->lightShadowSoftnessLocation;
             baseMaterial->lightNearPlaneLocation = this->lightNearPlaneLocation;
             baseMaterial->lightCountLocation = this->lightCountLocation;
+            baseMaterial->lightClusterGridLocation = this->lightClusterGridLocation;
+            baseMaterial->lightClusterLightIndicesLocation = this->lightClusterLightIndicesLocation;
+            baseMaterial->lightClusterLightDataLocation = this->lightClusterLightDataLocation;
+            baseMaterial->lightClusterDimensionsLocation = this->lightClusterDimensionsLocation;
+            baseMaterial->lightClusterDepthParamsLocation = this->lightClusterDepthParamsLocation;
+            baseMaterial->lightClusterEnabledLocation = this->lightClusterEnabledLocation;
         } else {
             throw InvalidArgumentException("BaseLitMaterial::copyTo() -> 'target must be same material.");
         }
@@ -152,5 +176,11 @@ namespace Core {
         this->lightShadowSoftnessLocation = this->shader->getUniformLocation(StandardUniform::LightShadowSoftness);
         this->lightNearPlaneLocation = this->shader->getUniformLocation(StandardUniform::LightNearPlane);
         this->lightCountLocation = this->shader->getUniformLocation(StandardUniform::LightCount);
+        this->lightClusterGridLocation = this->shader->getUniformLocation(StandardUniform::LightClusterGrid);
+        this->lightClusterLightIndicesLocation = this->shader->getUniformLocation(StandardUniform::LightClusterLightIndices);
+        this->lightClusterLightDataLocation = this->shader->getUniformLocation(StandardUniform::LightClusterLightData);
+        this->lightClusterDimensionsLocation = this->shader->getUniformLocation(StandardUniform::LightClusterDimensions);
+        this->lightClusterDepthParamsLocation = this->shader->getUniformLocation(StandardUniform::LightClusterDepthParams);
+        this->lightClusterEnabledLocation = this->shader->getUniformLocation(StandardUniform::LightClusterEnabled);
     }
 }
\ No newline at end of file
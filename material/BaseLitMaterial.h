@@ -43,5 +43,11 @@ namespace Core {
         Int32 lightShadowSoftnessLocation;
         Int32 lightNearPlaneLocation;
         Int32 lightCountLocation;
+        Int32 lightClusterGridLocation;
+        Int32 lightClusterLightIndicesLocation;
+        Int32 lightClusterLightDataLocation;
+        Int32 lightClusterDimensionsLocation;
+        Int32 lightClusterDepthParamsLocation;
+        Int32 lightClusterEnabledLocation;
     };
 }
@@ -23,9 +23,15 @@ namespace Core {
         this->cameraPositionLocation = -1;
 
         this->skinningEnabledLocation = -1;
-        for (UInt32 i = 0; i < Constants::MaxBones; i++) this->bonesLocation[i] = -1;
+        this->skinningPaletteLocation = -1;
+        this->skinningRootInverseMatrixLocation = -1;
+        this->skinningModeLocation = -1;
         this->boneIndexLocation = -1;
         this->boneWeightLocation = -1;
+
+        this->instancingEnabledLocation = -1;
+        this->instanceModelMatrixLocation = -1;
+        this->instanceModelInverseTransposeMatrixLocation = -1;
     }
 
     BaseMaterial::~BaseMaterial() {
@@ -49,6 +55,10 @@ namespace Core {
                 return this->boneIndexLocation;
             case StandardAttribute::BoneWeight:
                 return this->boneWeightLocation;
+            case StandardAttribute::InstanceModelMatrix:
+                return this->instanceModelMatrixLocation;
+            case StandardAttribute::InstanceModelInverseTransposeMatrix:
+                return this->instanceModelInverseTransposeMatrixLocation;
             default:
                 return -1;
         }
@@ -68,8 +78,14 @@ namespace Core {
                 return this->cameraPositionLocation;
             case StandardUniform::SkinningEnabled:
                 return this->skinningEnabledLocation;
-            case StandardUniform::Bones:
-                return this->bonesLocation[offset];
+            case StandardUniform::SkinningPalette:
+                return this->skinningPaletteLocation;
+            case StandardUniform::SkinningRootInverseMatrix:
+                return this->skinningRootInverseMatrixLocation;
+            case StandardUniform::SkinningMode:
+                return this->skinningModeLocation;
+            case StandardUniform::InstancingEnabled:
+                return this->instancingEnabledLocation;
             default:
                 return -1;
         }
@@ -93,9 +109,12 @@ namespace Core {
             baseMaterial->boneIndexLocation = this->boneIndexLocation;
             baseMaterial->boneWeightLocation = this->boneWeightLocation;
             baseMaterial->skinningEnabledLocation = this->skinningEnabledLocation;
-            for (UInt32 i = 0; i < Constants::MaxBones; i++) {
-                baseMaterial->bonesLocation[i] = this->bonesLocation[i];
-            }
+            baseMaterial->skinningPaletteLocation = this->skinningPaletteLocation;
+            baseMaterial->skinningRootInverseMatrixLocation = this->skinningRootInverseMatrixLocation;
+            baseMaterial->skinningModeLocation = this->skinningModeLocation;
+            baseMaterial->instancingEnabledLocation = this->instancingEnabledLocation;
+            baseMaterial->instanceModelMatrixLocation = this->instanceModelMatrixLocation;
+            baseMaterial->instanceModelInverseTransposeMatrixLocation = this->instanceModelInverseTransposeMatrixLocation;
         } else {
             throw InvalidArgumentException("BaseMaterial::copyTo() -> 'target must be same material.");
         }
@@ -116,8 +135,11 @@ namespace Core {
         this->boneIndexLocation = this->shader->getAttributeLocation(StandardAttribute::BoneIndex);
         this->boneWeightLocation = this->shader->getAttributeLocation(StandardAttribute::BoneWeight);
         this->skinningEnabledLocation = this->shader->getUniformLocation(StandardUniform::SkinningEnabled);
-        for (UInt32 i = 0; i < Constants::MaxBones; i++) {
-          this->bonesLocation[i] = this->shader->getUniformLocation(StandardUniform::Bones, i);
-        }
+        this->skinningPaletteLocation = this->shader->getUniformLocation(StandardUniform::SkinningPalette);
+        this->skinningRootInverseMatrixLocation = this->shader->getUniformLocation(StandardUniform::SkinningRootInverseMatrix);
+        this->skinningModeLocation = this->shader->getUniformLocation(StandardUniform::SkinningMode);
+        this->instancingEnabledLocation = this->shader->getUniformLocation(StandardUniform::InstancingEnabled);
+        this->instanceModelMatrixLocation = this->shader->getAttributeLocation(StandardAttribute::InstanceModelMatrix);
+        this->instanceModelInverseTransposeMatrixLocation = this->shader->getAttributeLocation(StandardAttribute::InstanceModelInverseTransposeMatrix);
     }
 }
\ No newline at end of file
@@ -37,8 +37,14 @@ namespace Core {
         Int32 cameraPositionLocation;
 
         Int32 skinningEnabledLocation;
-        Int32 bonesLocation[Constants::MaxBones];
+        Int32 skinningPaletteLocation;
+        Int32 skinningRootInverseMatrixLocation;
+        Int32 skinningModeLocation;
         Int32 boneIndexLocation;
         Int32 boneWeightLocation;
+
+        Int32 instancingEnabledLocation;
+        Int32 instanceModelMatrixLocation;
+        Int32 instanceModelInverseTransposeMatrixLocation;
     };
 }
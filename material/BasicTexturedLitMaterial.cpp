@@ -119,4 +119,8 @@ namespace Core {
     UInt32 BasicTexturedLitMaterial::textureCount() {
         return 1;
     }
+
+    WeakPointer<Texture> BasicTexturedLitMaterial::getPrimaryTexture() {
+        return this->albedoMapEnabled ? this->albedoMap : WeakPointer<Texture>::nullPtr();
+    }
 }
\ No newline at end of file
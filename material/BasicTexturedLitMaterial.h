@@ -23,6 +23,7 @@ namespace Core {
         virtual WeakPointer<Material> clone() override;
         virtual void bindShaderVarLocations() override;
         virtual UInt32 textureCount() override;
+        virtual WeakPointer<Texture> getPrimaryTexture() override;
 
         void setAlbedoMapEnabled(Bool enabled);
         void setAlbedoMap(WeakPointer<Texture> albedoMap);
@@ -20,6 +20,10 @@ namespace Core {
         this->texture = texture;
     }
 
+    WeakPointer<Texture> BasicTexturedMaterial::getPrimaryTexture() {
+        return this->texture;
+    }
+
     Bool BasicTexturedMaterial::build() {
         WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
         ShaderManager& shaderManager = graphics->getShaderManager();
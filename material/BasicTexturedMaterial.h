@@ -20,6 +20,7 @@ namespace Core {
         virtual void copyTo(WeakPointer<Material> target) override;
         virtual WeakPointer<Material> clone() override;
         virtual void bindShaderVarLocations() override;
+        virtual WeakPointer<Texture> getPrimaryTexture() override;
 
         void setTexture(WeakPointer<Texture> texture);
 
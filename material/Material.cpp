@@ -4,6 +4,8 @@
 #include "Shader.h"
 #include "../Graphics.h"
 #include "../common/debug.h"
+#include "../common/Constants.h"
+#include "../common/Exception.h"
 
 namespace Core {
 
@@ -17,7 +19,10 @@ namespace Core {
         this->transparent = false;
         this->lit = false;
         this->physical = false;
+        this->lightsPerPass = 1;
+        this->renderLayer = 0;
         this->skinningEnabled = false;
+        this->skinningMode = SkinningMode::Linear;
         
         this->depthWriteEnabled = true;
         this->depthTestEnabled = true;
@@ -43,6 +48,14 @@ namespace Core {
         return 0;
     }
 
+    /*
+     * The texture that best identifies the material's bound texture state, used to group
+     * draws that share textures when sorting the render queue.
+     */
+    WeakPointer<Texture> Material::getPrimaryTexture() {
+        return WeakPointer<Texture>::nullPtr();
+    }
+
     void Material::sendCustomUniformsToShader() {
 
     }
@@ -111,6 +124,35 @@ namespace Core {
         this->physical = physical;
     }
 
+    UInt32 Material::getLightsPerPass() const {
+        return this->lightsPerPass;
+    }
+
+    /*
+     * Maximum number of lights the material's shader can accumulate in a single draw. Anything
+     * greater than 1 requires a shader built on the multi-light lighting headers.
+     */
+    void Material::setLightsPerPass(UInt32 lightsPerPass) {
+        if (lightsPerPass == 0 || lightsPerPass > Constants::MaxShaderLights) {
+            throw InvalidArgumentException("Material::setLightsPerPass() -> invalid light count.");
+        }
+        this->lightsPerPass = lightsPerPass;
+    }
+
+    UInt32 Material::getRenderLayer() const {
+        return this->renderLayer;
+    }
+
+    /*
+     * Render layers are drawn in ascending order, before any other sorting is applied.
+     */
+    void Material::setRenderLayer(UInt32 layer) {
+        if (layer >= Constants::MaxRenderLayers) {
+            throw InvalidArgumentException("Material::setRenderLayer() -> invalid layer.");
+        }
+        this->renderLayer = layer;
+    }
+
     void Material::setSkinningEnabled(Bool enabled) {
         this->skinningEnabled = enabled;
     }
@@ -119,6 +161,18 @@ namespace Core {
         return this->skinningEnabled;
     }
 
+    SkinningMode Material::getSkinningMode() const {
+        return this->skinningMode;
+    }
+
+    /*
+     * Select how bone transforms are blended for skinned meshes drawn with this material. Takes effect without
+     * rebuilding the shader.
+     */
+    void Material::setSkinningMode(SkinningMode mode) {
+        this->skinningMode = mode;
+    }
+
     Bool Material::getDepthWriteEnabled() const {
         return this->depthWriteEnabled;
     }
@@ -241,7 +295,10 @@ namespace Core {
         target->transparent = this->transparent;
         target->lit = this->lit;
         target->physical = this->physical;
+        target->lightsPerPass = this->lightsPerPass;
+        target->renderLayer = this->renderLayer;
         target->skinningEnabled = this->skinningEnabled;
+        target->skinningMode = this->skinningMode;
 
         target->stencilTestEnabled = this->stencilTestEnabled;
         target->stencilRef = this->stencilRef;
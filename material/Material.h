@@ -8,12 +8,14 @@
 #include "StandardUniforms.h"
 #include "../render/RenderStyle.h"
 #include "../render/RenderState.h"
+#include "../animation/SkinningMode.h"
 
 namespace Core {
 
     // forward declarations
     class Shader;
     class Graphics;
+    class Texture;
 
     class Material : public CoreObject {
     public:
@@ -27,6 +29,7 @@ namespace Core {
         virtual void sendCustomUniformsToShader();
         virtual WeakPointer<Material> clone() = 0;
         virtual UInt32 textureCount();
+        virtual WeakPointer<Texture> getPrimaryTexture();
 
         Bool getColorWriteEnabled() const;
         void setColorWriteEnabled(Bool enabled);
@@ -44,8 +47,14 @@ namespace Core {
         void setLit(Bool lit);
         Bool isPhysical() const;
         void setPhysical(Bool physical);
+        UInt32 getLightsPerPass() const;
+        void setLightsPerPass(UInt32 lightsPerPass);
+        UInt32 getRenderLayer() const;
+        void setRenderLayer(UInt32 layer);
         Bool isSkinningEnabled() const;
         void setSkinningEnabled(Bool enabled);
+        SkinningMode getSkinningMode() const;
+        void setSkinningMode(SkinningMode mode);
         
         Bool getDepthWriteEnabled() const;
         void setDepthWriteEnabled(Bool enabled);
@@ -95,7 +104,10 @@ namespace Core {
         Bool transparent;
         Bool lit;
         Bool physical;
+        UInt32 lightsPerPass;
+        UInt32 renderLayer;
         Bool skinningEnabled;
+        SkinningMode skinningMode;
 
         Bool stencilTestEnabled;
         Byte stencilRef;
@@ -55,6 +55,10 @@ namespace Core {
         virtual void setUniform4f(UInt32 location, Real x, Real y, Real z, Real w) = 0;
         virtual void setUniformMatrix4(UInt32 location, const Real * data) = 0;
         virtual void setUniformMatrix4(UInt32 location, const Matrix4x4& data) = 0;
+        virtual void setUniform1iv(UInt32 location, UInt32 count, const Int32 * vals) = 0;
+        virtual void setUniform1fv(UInt32 location, UInt32 count, const Real * vals) = 0;
+        virtual void setUniform4fv(UInt32 location, UInt32 count, const Real * vals) = 0;
+        virtual void setUniformMatrix4v(UInt32 location, UInt32 count, const Real * data) = 0;
 
     protected:
         Bool ready;
@@ -17,7 +17,9 @@ namespace Core {
             "TANGENT",
             "FACE_NORMAL",
             "BONE_INDEX",
-            "BONE_WEIGHT"
+            "BONE_WEIGHT",
+            "INSTANCE_MODEL_MATRIX",
+            "INSTANCE_MODEL_INVERSE_TRANSPOSE_MATRIX"
         };
 
         nameToAttribute =
@@ -31,7 +33,9 @@ namespace Core {
             {attributeNames[(UInt16)StandardAttribute::Tangent],StandardAttribute::Tangent},
             {attributeNames[(UInt16)StandardAttribute::FaceNormal],StandardAttribute::FaceNormal},
             {attributeNames[(UInt16)StandardAttribute::BoneIndex],StandardAttribute::BoneIndex},
-            {attributeNames[(UInt16)StandardAttribute::BoneWeight],StandardAttribute::BoneWeight}
+            {attributeNames[(UInt16)StandardAttribute::BoneWeight],StandardAttribute::BoneWeight},
+            {attributeNames[(UInt16)StandardAttribute::InstanceModelMatrix],StandardAttribute::InstanceModelMatrix},
+            {attributeNames[(UInt16)StandardAttribute::InstanceModelInverseTransposeMatrix],StandardAttribute::InstanceModelInverseTransposeMatrix}
             
         };
     }
@@ -41,10 +45,24 @@ namespace Core {
         return instance->_getAttributeName(attribute);
     }
 
+    StandardAttribute StandardAttributes::getAttributeForName(const std::string& name) {
+        checkAndInitInstance();
+        return instance->_getAttributeForName(name);
+    }
+
     const std::string& StandardAttributes::_getAttributeName(StandardAttribute attribute) {
         return attributeNames[(UInt16)attribute];
     }
 
+    StandardAttribute StandardAttributes::_getAttributeForName(const std::string& name) {
+        auto result = nameToAttribute.find(name);
+        if (result == nameToAttribute.end()) {
+            return StandardAttribute::_None;
+        }
+
+        return (*result).second;
+    }
+
     StandardAttributeSet StandardAttributes::createAttributeSet() {
         return (StandardAttributeSet)IntMaskUtil::createMask();
     }
@@ -62,6 +80,8 @@ namespace Core {
     }
 
     void StandardAttributes::checkAndInitInstance() {
+        if (instance) return;
+
         StandardAttributes* attributesPtr = new(std::nothrow) StandardAttributes();
         if (attributesPtr == nullptr) {
             throw AllocationException("StandardAttributes::checkAndInitInstance -> Unable to allocate StandardAttributes.");
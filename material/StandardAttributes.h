@@ -20,8 +20,10 @@ namespace Core {
         FaceNormal = 7,
         BoneIndex = 8,
         BoneWeight = 9,
-        _Count = 10,  // Must always be last in the list ( before _None);
-        _None = 11,
+        InstanceModelMatrix = 10,
+        InstanceModelInverseTransposeMatrix = 11,
+        _Count = 12,  // Must always be last in the list ( before _None);
+        _None = 13,
     };
 
     typedef IntMask StandardAttributeSet;
@@ -30,6 +32,7 @@ namespace Core {
 
     public:
         static const std::string& getAttributeName(StandardAttribute attribute);
+        static StandardAttribute getAttributeForName(const std::string& name);
         static StandardAttributeSet createAttributeSet();
         static void addAttribute(StandardAttributeSet* set, StandardAttribute attr);
         static void removeAttribute(StandardAttributeSet* set, StandardAttribute attr);
@@ -42,6 +45,7 @@ namespace Core {
         static void checkAndInitInstance();
 
         const std::string& _getAttributeName(StandardAttribute attribute);
+        StandardAttribute _getAttributeForName(const std::string& name);
         
         std::vector<std::string> attributeNames;
         std::unordered_map<std::string, StandardAttribute> nameToAttribute;
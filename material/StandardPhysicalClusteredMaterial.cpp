@@ -0,0 +1,15 @@
+#include "StandardPhysicalClusteredMaterial.h"
+#include "../Engine.h"
+
+namespace Core {
+
+    StandardPhysicalClusteredMaterial::StandardPhysicalClusteredMaterial(WeakPointer<Graphics> graphics):
+        StandardPhysicalMaterial("StandardPhysicalClustered", graphics) {
+    }
+
+    WeakPointer<Material> StandardPhysicalClusteredMaterial::clone() {
+        WeakPointer<StandardPhysicalClusteredMaterial> newMaterial = Engine::instance()->createMaterial<StandardPhysicalClusteredMaterial>(false);
+        this->copyTo(newMaterial);
+        return newMaterial;
+    }
+}
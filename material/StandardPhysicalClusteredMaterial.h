@@ -0,0 +1,24 @@
+#pragma once
+
+#include "../util/WeakPointer.h"
+#include "StandardPhysicalMaterial.h"
+
+namespace Core {
+
+    // forward declarations
+    class Engine;
+
+    /*
+     * Variant of StandardPhysicalMaterial that additionally shades every unshadowed point light
+     * binned into the renderer's LightClusterGrid, in the first of its lighting passes.
+     */
+    class StandardPhysicalClusteredMaterial : public StandardPhysicalMaterial {
+        friend class Engine;
+
+    public:
+        virtual WeakPointer<Material> clone() override;
+
+    protected:
+        StandardPhysicalClusteredMaterial(WeakPointer<Graphics> graphics);
+    };
+}
@@ -259,6 +259,10 @@ namespace Core {
         return 4;
     }
 
+    WeakPointer<Texture> StandardPhysicalMaterial::getPrimaryTexture() {
+        return this->albedoMapEnabled ? this->albedoMap : WeakPointer<Texture>::nullPtr();
+    }
+
     UInt32 StandardPhysicalMaterial::getEnabledMapMask() {
         UInt32 mask = 0;
         if (this->albedoMapEnabled) mask = mask | ALBEDO_MAP_MASK;
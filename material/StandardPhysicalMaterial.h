@@ -25,6 +25,7 @@ namespace Core {
         virtual void copyTo(WeakPointer<Material> targetMaterial) override;
         virtual void bindShaderVarLocations() override;
         virtual UInt32 textureCount() override;
+        virtual WeakPointer<Texture> getPrimaryTexture() override;
 
         void setMetallic(Real metallic);
         void setRoughness(Real roughness);
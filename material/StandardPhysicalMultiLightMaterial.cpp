@@ -0,0 +1,37 @@
+#include "StandardPhysicalMultiLightMaterial.h"
+#include "../Engine.h"
+#include "../Graphics.h"
+
+namespace Core {
+
+    StandardPhysicalMultiLightMaterial::StandardPhysicalMultiLightMaterial(WeakPointer<Graphics> graphics):
+        StandardPhysicalMaterial("StandardPhysicalMultiLight", graphics) {
+    }
+
+    /*
+     * Builds the variant of the shader with as many lights as fit in the texture units the driver allows a
+     * fragment shader, after the material's own maps and the skinning palette, falling back to a single light.
+     */
+    Bool StandardPhysicalMultiLightMaterial::build() {
+        UInt32 lightsPerPass = this->getMaxLightsPerPass();
+        this->builtInShaderName = "StandardPhysicalMultiLight" + std::to_string(lightsPerPass);
+        StandardPhysicalMaterial::build();
+        this->setLightsPerPass(lightsPerPass);
+        return true;
+    }
+
+    WeakPointer<Material> StandardPhysicalMultiLightMaterial::clone() {
+        WeakPointer<StandardPhysicalMultiLightMaterial> newMaterial = Engine::instance()->createMaterial<StandardPhysicalMultiLightMaterial>(false);
+        this->copyTo(newMaterial);
+        return newMaterial;
+    }
+
+    UInt32 StandardPhysicalMultiLightMaterial::getMaxLightsPerPass() {
+        UInt32 textureUnits = this->graphics->getMaxFragmentTextureUnits();
+        UInt32 reservedUnits = this->textureCount() + SkinningPaletteUnits;
+        if (textureUnits <= reservedUnits + TextureUnitsPerLight) return 1;
+        UInt32 lightsPerPass = (textureUnits - reservedUnits) / TextureUnitsPerLight;
+        if (lightsPerPass > Constants::MaxShaderLights) lightsPerPass = Constants::MaxShaderLights;
+        return lightsPerPass;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../util/WeakPointer.h"
+#include "StandardPhysicalMaterial.h"
+#include "../common/Constants.h"
+
+namespace Core {
+
+    // forward declarations
+    class Engine;
+
+    /*
+     * Variant of StandardPhysicalMaterial that shades up to Constants::MaxShaderLights lights
+     * in a single draw call instead of one additive pass per light. Fewer lights are shaded per
+     * draw when the driver can't bind the samplers of that many lights at once.
+     */
+    class StandardPhysicalMultiLightMaterial : public StandardPhysicalMaterial {
+        friend class Engine;
+
+    public:
+        virtual Bool build() override;
+        virtual WeakPointer<Material> clone() override;
+
+    protected:
+        // irradiance, pre-filtered and BRDF maps, point shadow cube map and one shadow map per cascade
+        static const UInt32 TextureUnitsPerLight = 4 + Constants::MaxDirectionalCascades;
+        static const UInt32 SkinningPaletteUnits = 1;
+
+        StandardPhysicalMultiLightMaterial(WeakPointer<Graphics> graphics);
+        UInt32 getMaxLightsPerPass();
+    };
+}
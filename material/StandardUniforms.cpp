@@ -51,7 +51,16 @@ namespace Core {
             "TEXTURE0",
             "DEPTH_TEXTURE",
             "SKINNING_ENABLED",
-            "BONES"
+            "SKINNING_PALETTE",
+            "LIGHT_CLUSTER_GRID",
+            "LIGHT_CLUSTER_LIGHT_INDICES",
+            "LIGHT_CLUSTER_LIGHT_DATA",
+            "LIGHT_CLUSTER_DIMENSIONS",
+            "LIGHT_CLUSTER_DEPTH_PARAMS",
+            "LIGHT_CLUSTER_ENABLED",
+            "INSTANCING_ENABLED",
+            "SKINNING_ROOT_INVERSE_MATRIX",
+            "SKINNING_MODE"
         };
 
         nameToUniform =
@@ -96,7 +105,16 @@ namespace Core {
             {uniformNames[(UInt16)StandardUniform::Texture0], StandardUniform::Texture0},
             {uniformNames[(UInt16)StandardUniform::DepthTexture], StandardUniform::DepthTexture},
             {uniformNames[(UInt16)StandardUniform::SkinningEnabled], StandardUniform::SkinningEnabled},
-            {uniformNames[(UInt16)StandardUniform::Bones], StandardUniform::Bones}
+            {uniformNames[(UInt16)StandardUniform::SkinningPalette], StandardUniform::SkinningPalette},
+            {uniformNames[(UInt16)StandardUniform::LightClusterGrid], StandardUniform::LightClusterGrid},
+            {uniformNames[(UInt16)StandardUniform::LightClusterLightIndices], StandardUniform::LightClusterLightIndices},
+            {uniformNames[(UInt16)StandardUniform::LightClusterLightData], StandardUniform::LightClusterLightData},
+            {uniformNames[(UInt16)StandardUniform::LightClusterDimensions], StandardUniform::LightClusterDimensions},
+            {uniformNames[(UInt16)StandardUniform::LightClusterDepthParams], StandardUniform::LightClusterDepthParams},
+            {uniformNames[(UInt16)StandardUniform::LightClusterEnabled], StandardUniform::LightClusterEnabled},
+            {uniformNames[(UInt16)StandardUniform::InstancingEnabled], StandardUniform::InstancingEnabled},
+            {uniformNames[(UInt16)StandardUniform::SkinningRootInverseMatrix], StandardUniform::SkinningRootInverseMatrix},
+            {uniformNames[(UInt16)StandardUniform::SkinningMode], StandardUniform::SkinningMode}
         };
     }
 
@@ -124,6 +142,8 @@ namespace Core {
     }
 
     void StandardUniforms::checkAndInitInstance() {
+        if (instance) return;
+
         StandardUniforms* uniformsPtr = new(std::nothrow) StandardUniforms();
         if (uniformsPtr == nullptr) {
             throw AllocationException("StandardUniforms::checkAndInitInstance -> Unable to allocate StandardUniforms.");
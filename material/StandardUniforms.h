@@ -49,9 +49,18 @@ namespace Core {
         Texture0 = 37,
         DepthTexture = 38,
         SkinningEnabled = 39,
-        Bones = 40,
-        _Count = 41,  // Must always be last in the list (before _None)
-        _None = 42,
+        SkinningPalette = 40,
+        LightClusterGrid = 41,
+        LightClusterLightIndices = 42,
+        LightClusterLightData = 43,
+        LightClusterDimensions = 44,
+        LightClusterDepthParams = 45,
+        LightClusterEnabled = 46,
+        InstancingEnabled = 47,
+        SkinningRootInverseMatrix = 48,
+        SkinningMode = 49,
+        _Count = 50,  // Must always be last in the list (before _None)
+        _None = 51,
     };
 
     class StandardUniforms {
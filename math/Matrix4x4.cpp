@@ -1,4 +1,5 @@
 #include "Matrix4x4.h"
+#include "SIMD.h"
 #include <string.h>
 #include "../common/Exception.h"
 #include "../common/debug.h"
@@ -8,6 +9,62 @@ namespace Core {
 
 #define I(_i, _j) ((_j) + ROWSIZE_MATRIX_4X4 * (_i))
 
+#if defined(CORE_SIMD_SSE)
+    static inline __m128 sseCross(__m128 a, __m128 b) {
+        __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+        return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+
+    static inline Real sseDot(__m128 a, __m128 b) {
+        __m128 m = _mm_mul_ps(a, b);
+        __m128 s = _mm_add_ps(m, _mm_movehl_ps(m, m));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(s);
+    }
+
+    // out = lhs x rhs, with the columns of lhs already loaded; all of a column of rhs is read before
+    // the matching column of out is written, so [out] may alias [rhs]
+    static inline void sseMultiplyMM(__m128 l0, __m128 l1, __m128 l2, __m128 l3, const Real *rhs, Real *out) {
+        for (UInt32 i = 0; i < ROWSIZE_MATRIX_4X4; i++) {
+            const Real *column = rhs + i * ROWSIZE_MATRIX_4X4;
+            __m128 r = _mm_mul_ps(l0, _mm_set1_ps(column[0]));
+            r = _mm_add_ps(r, _mm_mul_ps(l1, _mm_set1_ps(column[1])));
+            r = _mm_add_ps(r, _mm_mul_ps(l2, _mm_set1_ps(column[2])));
+            r = _mm_add_ps(r, _mm_mul_ps(l3, _mm_set1_ps(column[3])));
+            _mm_storeu_ps(out + i * ROWSIZE_MATRIX_4X4, r);
+        }
+    }
+
+    static inline void sseMultiplyMV(__m128 l0, __m128 l1, __m128 l2, __m128 l3, const Real *vector, Real *out) {
+        __m128 r = _mm_mul_ps(l0, _mm_set1_ps(vector[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(l1, _mm_set1_ps(vector[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(l2, _mm_set1_ps(vector[2])));
+        r = _mm_add_ps(r, _mm_mul_ps(l3, _mm_set1_ps(vector[3])));
+        _mm_storeu_ps(out, r);
+    }
+#elif defined(CORE_SIMD_NEON)
+    static inline void neonMultiplyMM(float32x4_t l0, float32x4_t l1, float32x4_t l2, float32x4_t l3, const Real *rhs, Real *out) {
+        for (UInt32 i = 0; i < ROWSIZE_MATRIX_4X4; i++) {
+            const Real *column = rhs + i * ROWSIZE_MATRIX_4X4;
+            float32x4_t r = vmulq_n_f32(l0, column[0]);
+            r = vmlaq_n_f32(r, l1, column[1]);
+            r = vmlaq_n_f32(r, l2, column[2]);
+            r = vmlaq_n_f32(r, l3, column[3]);
+            vst1q_f32(out + i * ROWSIZE_MATRIX_4X4, r);
+        }
+    }
+
+    static inline void neonMultiplyMV(float32x4_t l0, float32x4_t l1, float32x4_t l2, float32x4_t l3, const Real *vector, Real *out) {
+        float32x4_t r = vmulq_n_f32(l0, vector[0]);
+        r = vmlaq_n_f32(r, l1, vector[1]);
+        r = vmlaq_n_f32(r, l2, vector[2]);
+        r = vmlaq_n_f32(r, l3, vector[3]);
+        vst1q_f32(out, r);
+    }
+#endif
+
     /*********************************************
      *
      * Matrix math utilities. These methods operate on OpenGL ES format matrices and
@@ -40,13 +97,6 @@ namespace Core {
         }
     }
 
-    Matrix4x4::Matrix4x4(const Matrix4x4 &source) {
-        this->copy(source);
-    }
-
-    Matrix4x4::~Matrix4x4() {
-    }
-
     Real *Matrix4x4::getData() {
         return this->data;
     }
@@ -71,15 +121,6 @@ namespace Core {
         }
     }
 
-    /*
-     * Overloaded assignment operator
-     */
-    Matrix4x4 &Matrix4x4::operator=(const Matrix4x4 &source) {
-        if (this == &source) return *this;
-        this->copy(source);
-        return *this;
-    }
-
     /*
      * Copy data from existing matrix to this one
      */
@@ -150,15 +191,31 @@ namespace Core {
      * Returns false if the matrix cannot be inverted
      */
     Bool Matrix4x4::invert(const Real *source, Real *dest) {
+        if (source == nullptr) throw NullPointerException("Matrix4x4::invert -> 'source' is null.");
+        if (dest == nullptr) throw NullPointerException("Matrix4x4::invert -> 'dest' is null.");
+
+        // object transforms are nearly always affine, which allows a much cheaper inverse
+        if (Matrix4x4::isAffine(source)) {
+            return Matrix4x4::invertAffine(source, dest);
+        }
+        return Matrix4x4::invertGeneral(source, dest);
+    }
+
+    /*
+     * Invert the 4x4 matrix pointed to by [source] using its full adjoint and store the result in [dest].
+     *
+     * Returns false if the matrix cannot be inverted
+     */
+    Bool Matrix4x4::invertGeneral(const Real *source, Real *dest) {
+        if (source == nullptr) throw NullPointerException("Matrix4x4::invertGeneral -> 'source' is null.");
+        if (dest == nullptr) throw NullPointerException("Matrix4x4::invertGeneral -> 'dest' is null.");
+
         // we need to know if the matrix is affine so that we can make it affine
         // once again after the inversion. the inversion process can introduce very small
         // precision errors that accumulate over time and eventually
         // result in a non-affine matrix
         Bool isAffine = Matrix4x4::isAffine(source);
 
-        if (source == nullptr) throw NullPointerException("Matrix4x4::invert -> 'source' is null.");
-        if (dest == nullptr) throw NullPointerException("Matrix4x4::invert -> 'dest' is null.");
-
         Real adjoin[SIZE_MATRIX_4X4];
         Real det = Matrix4x4::calculateDeterminant(source, adjoin);
 
@@ -182,6 +239,87 @@ namespace Core {
         return true;
     }
 
+    /*
+     * Invert the affine 4x4 matrix pointed to by [source] and store the result in [dest]. The upper 3x3
+     * block is inverted from the cross products of its columns and the translation is transformed by
+     * that inverse, which is far cheaper than the full adjoint. [source] and [dest] may be the same.
+     *
+     * Returns false if the matrix cannot be inverted
+     */
+    Bool Matrix4x4::invertAffine(const Real *source, Real *dest) {
+#if defined(CORE_SIMD_SSE)
+        __m128 c0 = _mm_loadu_ps(source);
+        __m128 c1 = _mm_loadu_ps(source + 4);
+        __m128 c2 = _mm_loadu_ps(source + 8);
+        __m128 t = _mm_loadu_ps(source + 12);
+
+        // rows of the adjugate of the 3x3 block; the w components of the columns are zero, so are theirs
+        __m128 r0 = sseCross(c1, c2);
+        __m128 r1 = sseCross(c2, c0);
+        __m128 r2 = sseCross(c0, c1);
+
+        Real det = sseDot(c0, r0);
+        if (det == 0.0f) {
+            return false;
+        }
+        __m128 invDet = _mm_set1_ps(1.0f / det);
+        r0 = _mm_mul_ps(r0, invDet);
+        r1 = _mm_mul_ps(r1, invDet);
+        r2 = _mm_mul_ps(r2, invDet);
+        __m128 r3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+        __m128 translation = _mm_mul_ps(r0, _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0)));
+        translation = _mm_add_ps(translation, _mm_mul_ps(r1, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+        translation = _mm_add_ps(translation, _mm_mul_ps(r2, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2))));
+        translation = _mm_sub_ps(_mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f), translation);
+
+        _mm_storeu_ps(dest, r0);
+        _mm_storeu_ps(dest + 4, r1);
+        _mm_storeu_ps(dest + 8, r2);
+        _mm_storeu_ps(dest + 12, translation);
+        return true;
+#else
+        return Matrix4x4::invertAffineScalar(source, dest);
+#endif
+    }
+
+    /*
+     * Scalar reference implementation of invertAffine().
+     */
+    Bool Matrix4x4::invertAffineScalar(const Real *source, Real *dest) {
+        const Real *c0 = source;
+        const Real *c1 = source + 4;
+        const Real *c2 = source + 8;
+        const Real *t = source + 12;
+
+        // rows of the adjugate of the 3x3 block
+        Real r0[3] = {c1[1] * c2[2] - c1[2] * c2[1], c1[2] * c2[0] - c1[0] * c2[2], c1[0] * c2[1] - c1[1] * c2[0]};
+        Real r1[3] = {c2[1] * c0[2] - c2[2] * c0[1], c2[2] * c0[0] - c2[0] * c0[2], c2[0] * c0[1] - c2[1] * c0[0]};
+        Real r2[3] = {c0[1] * c1[2] - c0[2] * c1[1], c0[2] * c1[0] - c0[0] * c1[2], c0[0] * c1[1] - c0[1] * c1[0]};
+
+        Real det = c0[0] * r0[0] + c0[1] * r0[1] + c0[2] * r0[2];
+        if (det == 0.0f) {
+            return false;
+        }
+        Real invDet = 1 / det;
+
+        Real result[SIZE_MATRIX_4X4];
+        for (UInt32 j = 0; j < 3; j++) {
+            result[j * ROWSIZE_MATRIX_4X4] = r0[j] * invDet;
+            result[j * ROWSIZE_MATRIX_4X4 + 1] = r1[j] * invDet;
+            result[j * ROWSIZE_MATRIX_4X4 + 2] = r2[j] * invDet;
+            result[j * ROWSIZE_MATRIX_4X4 + 3] = 0;
+        }
+        for (UInt32 i = 0; i < 3; i++) {
+            result[12 + i] = -(result[i] * t[0] + result[4 + i] * t[1] + result[8 + i] * t[2]);
+        }
+        result[15] = 1;
+
+        memcpy(dest, result, sizeof(Real) * SIZE_MATRIX_4X4);
+        return true;
+    }
+
     /*
      * Build matrix from components [translation], [scale], and [rotation]
      */
@@ -189,23 +327,23 @@ namespace Core {
         Matrix4x4 rotMatrix = rotation.rotationMatrix();
 
         // Build the final matrix, with translation, scale, and rotation
-        A0 = scale.x * rotMatrix.A0;
-        A1 = scale.y * rotMatrix.A1;
-        A2 = scale.z * rotMatrix.A2;
-        A3 = translation.x;
-        B0 = scale.x * rotMatrix.B0;
-        B1 = scale.y * rotMatrix.B1;
-        B2 = scale.z * rotMatrix.B2;
-        B3 = translation.y;
-        C0 = scale.x * rotMatrix.C0;
-        C1 = scale.y * rotMatrix.C1;
-        C2 = scale.z * rotMatrix.C2;
-        C3 = translation.z;
-
-        D0 = 0;
-        D1 = 0;
-        D2 = 0;
-        D3 = 1;
+        A0() = scale.x * rotMatrix.A0();
+        A1() = scale.y * rotMatrix.A1();
+        A2() = scale.z * rotMatrix.A2();
+        A3() = translation.x;
+        B0() = scale.x * rotMatrix.B0();
+        B1() = scale.y * rotMatrix.B1();
+        B2() = scale.z * rotMatrix.B2();
+        B3() = translation.y;
+        C0() = scale.x * rotMatrix.C0();
+        C1() = scale.y * rotMatrix.C1();
+        C2() = scale.z * rotMatrix.C2();
+        C3() = translation.z;
+
+        D0() = 0;
+        D1() = 0;
+        D2() = 0;
+        D3() = 1;
     }
 
     void Matrix4x4::decompose(Vector3Components<Real> &translation, Quaternion &rotation, Vector3Components<Real> &scale) const {
@@ -214,41 +352,41 @@ namespace Core {
         Matrix4x4 rotMatrix;
 
         // build orthogonal matrix [rotMatrix]
-        Real fInvLength = Math::inverseSquareRoot(A0 * A0 + B0 * B0 + C0 * C0);
+        Real fInvLength = Math::inverseSquareRoot(A0() * A0() + B0() * B0() + C0() * C0());
 
-        rotMatrix.A0 = A0 * fInvLength;
-        rotMatrix.B0 = B0 * fInvLength;
-        rotMatrix.C0 = C0 * fInvLength;
+        rotMatrix.A0() = A0() * fInvLength;
+        rotMatrix.B0() = B0() * fInvLength;
+        rotMatrix.C0() = C0() * fInvLength;
 
-        Real fDot = rotMatrix.A0 * A1 + rotMatrix.B0 * B1 + rotMatrix.C0 * C1;
-        rotMatrix.A1 = A1 - fDot * rotMatrix.A0;
-        rotMatrix.B1 = B1 - fDot * rotMatrix.B0;
-        rotMatrix.C1 = C1 - fDot * rotMatrix.C0;
-        fInvLength = Math::inverseSquareRoot(rotMatrix.A1 * rotMatrix.A1 + rotMatrix.B1 * rotMatrix.B1 + rotMatrix.C1 * rotMatrix.C1);
+        Real fDot = rotMatrix.A0() * A1() + rotMatrix.B0() * B1() + rotMatrix.C0() * C1();
+        rotMatrix.A1() = A1() - fDot * rotMatrix.A0();
+        rotMatrix.B1() = B1() - fDot * rotMatrix.B0();
+        rotMatrix.C1() = C1() - fDot * rotMatrix.C0();
+        fInvLength = Math::inverseSquareRoot(rotMatrix.A1() * rotMatrix.A1() + rotMatrix.B1() * rotMatrix.B1() + rotMatrix.C1() * rotMatrix.C1());
 
-        rotMatrix.A1 *= fInvLength;
-        rotMatrix.B1 *= fInvLength;
-        rotMatrix.C1 *= fInvLength;
+        rotMatrix.A1() *= fInvLength;
+        rotMatrix.B1() *= fInvLength;
+        rotMatrix.C1() *= fInvLength;
 
-        fDot = rotMatrix.A0 * A2 + rotMatrix.B0 * B2 + rotMatrix.C0 * C2;
-        rotMatrix.A2 = A2 - fDot * rotMatrix.A0;
-        rotMatrix.B2 = B2 - fDot * rotMatrix.B0;
-        rotMatrix.C2 = C2 - fDot * rotMatrix.C0;
+        fDot = rotMatrix.A0() * A2() + rotMatrix.B0() * B2() + rotMatrix.C0() * C2();
+        rotMatrix.A2() = A2() - fDot * rotMatrix.A0();
+        rotMatrix.B2() = B2() - fDot * rotMatrix.B0();
+        rotMatrix.C2() = C2() - fDot * rotMatrix.C0();
 
-        fDot = rotMatrix.A1 * A2 + rotMatrix.B1 * B2 + rotMatrix.C1 * C2;
-        rotMatrix.A2 -= fDot * rotMatrix.A1;
-        rotMatrix.B2 -= fDot * rotMatrix.B1;
-        rotMatrix.C2 -= fDot * rotMatrix.C1;
+        fDot = rotMatrix.A1() * A2() + rotMatrix.B1() * B2() + rotMatrix.C1() * C2();
+        rotMatrix.A2() -= fDot * rotMatrix.A1();
+        rotMatrix.B2() -= fDot * rotMatrix.B1();
+        rotMatrix.C2() -= fDot * rotMatrix.C1();
 
-        fInvLength = Math::inverseSquareRoot(rotMatrix.A2 * rotMatrix.A2 + rotMatrix.B2 * rotMatrix.B2 + rotMatrix.C2 * rotMatrix.C2);
+        fInvLength = Math::inverseSquareRoot(rotMatrix.A2() * rotMatrix.A2() + rotMatrix.B2() * rotMatrix.B2() + rotMatrix.C2() * rotMatrix.C2());
 
-        rotMatrix.A2 *= fInvLength;
-        rotMatrix.B2 *= fInvLength;
-        rotMatrix.C2 *= fInvLength;
+        rotMatrix.A2() *= fInvLength;
+        rotMatrix.B2() *= fInvLength;
+        rotMatrix.C2() *= fInvLength;
 
         // guarantee that orthogonal matrix has determinant 1 (no reflections)
-        Real fDet = rotMatrix.A0 * rotMatrix.B1 * rotMatrix.C2 + rotMatrix.A1 * rotMatrix.B2 * rotMatrix.C0 + rotMatrix.A2 * rotMatrix.B0 * rotMatrix.C1 -
-                    rotMatrix.A2 * rotMatrix.B1 * rotMatrix.C0 - rotMatrix.A1 * rotMatrix.B0 * rotMatrix.C2 - rotMatrix.A0 * rotMatrix.B2 * rotMatrix.C1;
+        Real fDet = rotMatrix.A0() * rotMatrix.B1() * rotMatrix.C2() + rotMatrix.A1() * rotMatrix.B2() * rotMatrix.C0() + rotMatrix.A2() * rotMatrix.B0() * rotMatrix.C1() -
+                    rotMatrix.A2() * rotMatrix.B1() * rotMatrix.C0() - rotMatrix.A1() * rotMatrix.B0() * rotMatrix.C2() - rotMatrix.A0() * rotMatrix.B2() * rotMatrix.C1();
 
         if (fDet < 0.0) {
             for (size_t iRow = 0; iRow < 3; iRow++)
@@ -257,32 +395,32 @@ namespace Core {
 
         // build "right" matrix [rightMatrix]
         Matrix4x4 rightMatrix;
-        rightMatrix.A0 = rotMatrix.A0 * A0 + rotMatrix.B0 * B0 + rotMatrix.C0 * C0;
-        rightMatrix.A1 = rotMatrix.A0 * A1 + rotMatrix.B0 * B1 + rotMatrix.C0 * C1;
-        rightMatrix.B1 = rotMatrix.A1 * A1 + rotMatrix.B1 * B1 + rotMatrix.C1 * C1;
-        rightMatrix.A2 = rotMatrix.A0 * A2 + rotMatrix.B0 * B2 + rotMatrix.C0 * C2;
-        rightMatrix.B2 = rotMatrix.A1 * A2 + rotMatrix.B1 * B2 + rotMatrix.C1 * C2;
-        rightMatrix.C2 = rotMatrix.A2 * A2 + rotMatrix.B2 * B2 + rotMatrix.C2 * C2;
+        rightMatrix.A0() = rotMatrix.A0() * A0() + rotMatrix.B0() * B0() + rotMatrix.C0() * C0();
+        rightMatrix.A1() = rotMatrix.A0() * A1() + rotMatrix.B0() * B1() + rotMatrix.C0() * C1();
+        rightMatrix.B1() = rotMatrix.A1() * A1() + rotMatrix.B1() * B1() + rotMatrix.C1() * C1();
+        rightMatrix.A2() = rotMatrix.A0() * A2() + rotMatrix.B0() * B2() + rotMatrix.C0() * C2();
+        rightMatrix.B2() = rotMatrix.A1() * A2() + rotMatrix.B1() * B2() + rotMatrix.C1() * C2();
+        rightMatrix.C2() = rotMatrix.A2() * A2() + rotMatrix.B2() * B2() + rotMatrix.C2() * C2();
 
         // the scaling component
-        scale.x = rightMatrix.A0;
-        scale.y = rightMatrix.B1;
-        scale.z = rightMatrix.C2;
+        scale.x = rightMatrix.A0();
+        scale.y = rightMatrix.B1();
+        scale.z = rightMatrix.C2();
 
         Vector3r shear;
 
         // the shear component
         Real fInvD0 = 1.0f / scale.x;
-        shear.x = rightMatrix.A1 * fInvD0;
-        shear.y = rightMatrix.A2 * fInvD0;
-        shear.z = rightMatrix.B2 / scale.y;
+        shear.x = rightMatrix.A1() * fInvD0;
+        shear.y = rightMatrix.A2() * fInvD0;
+        shear.z = rightMatrix.B2() / scale.y;
 
         rotation.fromMatrix(rotMatrix);
-        translation.set(A3, B3, C3);
+        translation.set(A3(), B3(), C3());
     }
 
     Bool Matrix4x4::isAffine(void) const {
-        return D0 == 0 && D1 == 0 && D2 == 0 && D3 == 1;
+        return D0() == 0 && D1() == 0 && D2() == 0 && D3() == 1;
     }
 
     Bool Matrix4x4::isAffine(const Real *data) {
@@ -492,6 +630,19 @@ namespace Core {
         if (lhsMat == nullptr) throw NullPointerException("Matrix4x4::multiplyMV -> 'lhsMat' is null.");
         if (rhsVec == nullptr) throw NullPointerException("Matrix4x4::multiplyMV -> 'rhsVec' is null.");
         if (out == nullptr) throw NullPointerException("Matrix4x4::multiplyMV -> 'out' is null.");
+#if defined(CORE_SIMD_SSE)
+        sseMultiplyMV(_mm_loadu_ps(lhsMat), _mm_loadu_ps(lhsMat + 4), _mm_loadu_ps(lhsMat + 8), _mm_loadu_ps(lhsMat + 12), rhsVec, out);
+#elif defined(CORE_SIMD_NEON)
+        neonMultiplyMV(vld1q_f32(lhsMat), vld1q_f32(lhsMat + 4), vld1q_f32(lhsMat + 8), vld1q_f32(lhsMat + 12), rhsVec, out);
+#else
+        Matrix4x4::mx4transform(rhsVec[0], rhsVec[1], rhsVec[2], rhsVec[3], lhsMat, out);
+#endif
+    }
+
+    /*
+     * Scalar reference implementation of multiplyMV().
+     */
+    void Matrix4x4::multiplyMVScalar(const Real *lhsMat, const Real *rhsVec, Real *out) {
         Matrix4x4::mx4transform(rhsVec[0], rhsVec[1], rhsVec[2], rhsVec[3], lhsMat, out);
     }
 
@@ -527,6 +678,19 @@ namespace Core {
      *
      *********************************************************/
     void Matrix4x4::multiplyMM(const Real *lhs, const Real *rhs, Real *out) {
+#if defined(CORE_SIMD_SSE)
+        sseMultiplyMM(_mm_loadu_ps(lhs), _mm_loadu_ps(lhs + 4), _mm_loadu_ps(lhs + 8), _mm_loadu_ps(lhs + 12), rhs, out);
+#elif defined(CORE_SIMD_NEON)
+        neonMultiplyMM(vld1q_f32(lhs), vld1q_f32(lhs + 4), vld1q_f32(lhs + 8), vld1q_f32(lhs + 12), rhs, out);
+#else
+        Matrix4x4::multiplyMMScalar(lhs, rhs, out);
+#endif
+    }
+
+    /*
+     * Scalar reference implementation of multiplyMM().
+     */
+    void Matrix4x4::multiplyMMScalar(const Real *lhs, const Real *rhs, Real *out) {
         for (Int32 i = 0; i < ROWSIZE_MATRIX_4X4; i++) {
             const Real rhs_i0 = rhs[I(i, 0)];
             Real ri0 = lhs[I(0, 0)] * rhs_i0;
@@ -547,6 +711,64 @@ namespace Core {
         }
     }
 
+    /*
+     * Multiply [count] pairs of matrices, storing [lhs][i] x [rhs][i] in [out][i].
+     */
+    void Matrix4x4::multiplyBatch(const Matrix4x4 *lhs, const Matrix4x4 *rhs, Matrix4x4 *out, UInt32 count) {
+        for (UInt32 i = 0; i < count; i++) {
+            Matrix4x4::multiplyMM(lhs[i].data, rhs[i].data, out[i].data);
+        }
+    }
+
+    /*
+     * Multiply each of the [count] matrices in [rhs] by [lhs], storing [lhs] x [rhs][i] in [out][i].
+     * [lhs] is only loaded once for the whole batch.
+     */
+    void Matrix4x4::multiplyBatch(const Matrix4x4 &lhs, const Matrix4x4 *rhs, Matrix4x4 *out, UInt32 count) {
+#if defined(CORE_SIMD_SSE)
+        __m128 l0 = _mm_load_ps(lhs.data), l1 = _mm_load_ps(lhs.data + 4), l2 = _mm_load_ps(lhs.data + 8), l3 = _mm_load_ps(lhs.data + 12);
+        for (UInt32 i = 0; i < count; i++) {
+            sseMultiplyMM(l0, l1, l2, l3, rhs[i].data, out[i].data);
+        }
+#elif defined(CORE_SIMD_NEON)
+        float32x4_t l0 = vld1q_f32(lhs.data), l1 = vld1q_f32(lhs.data + 4), l2 = vld1q_f32(lhs.data + 8), l3 = vld1q_f32(lhs.data + 12);
+        for (UInt32 i = 0; i < count; i++) {
+            neonMultiplyMM(l0, l1, l2, l3, rhs[i].data, out[i].data);
+        }
+#else
+        for (UInt32 i = 0; i < count; i++) {
+            Matrix4x4::multiplyMMScalar(lhs.data, rhs[i].data, out[i].data);
+        }
+#endif
+    }
+
+    /*
+     * Transform [count] homogeneous 4-component vectors stored contiguously in [vectors4f] by this matrix,
+     * and store the results in [out], which may be the same array.
+     */
+    void Matrix4x4::transformBatch(const Real *vectors4f, Real *out, UInt32 count) const {
+        if (vectors4f == nullptr) throw NullPointerException("Matrix4x4::transformBatch -> 'vectors4f' is null.");
+        if (out == nullptr) throw NullPointerException("Matrix4x4::transformBatch -> 'out' is null.");
+#if defined(CORE_SIMD_SSE)
+        __m128 l0 = _mm_load_ps(this->data), l1 = _mm_load_ps(this->data + 4), l2 = _mm_load_ps(this->data + 8), l3 = _mm_load_ps(this->data + 12);
+        for (UInt32 i = 0; i < count; i++) {
+            sseMultiplyMV(l0, l1, l2, l3, vectors4f + i * ROWSIZE_MATRIX_4X4, out + i * ROWSIZE_MATRIX_4X4);
+        }
+#elif defined(CORE_SIMD_NEON)
+        float32x4_t l0 = vld1q_f32(this->data), l1 = vld1q_f32(this->data + 4), l2 = vld1q_f32(this->data + 8), l3 = vld1q_f32(this->data + 12);
+        for (UInt32 i = 0; i < count; i++) {
+            neonMultiplyMV(l0, l1, l2, l3, vectors4f + i * ROWSIZE_MATRIX_4X4, out + i * ROWSIZE_MATRIX_4X4);
+        }
+#else
+        Real temp[ROWSIZE_MATRIX_4X4];
+        for (UInt32 i = 0; i < count; i++) {
+            const Real *vector = vectors4f + i * ROWSIZE_MATRIX_4X4;
+            Matrix4x4::mx4transform(vector[0], vector[1], vector[2], vector[3], this->data, temp);
+            memcpy(out + i * ROWSIZE_MATRIX_4X4, temp, sizeof(Real) * ROWSIZE_MATRIX_4X4);
+        }
+#endif
+    }
+
     /*
      * Translate this matrix by [vector]
      *
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <type_traits>
+
 #include "../base/BaseVector.h"
 #include "../common/types.h"
 #include "../geometry/Vector3.h"
@@ -13,36 +15,53 @@ namespace Core {
 #define SIZE_MATRIX_4X4 16
 #define ROWSIZE_MATRIX_4X4 4
 
+    /*
+     * Trivially copyable and free of per-instance overhead, so arrays of matrices can be
+     * copied with memcpy and handed to SIMD code as packed, 16-byte aligned blocks of Reals.
+     */
     class Matrix4x4 {
     public:
         Matrix4x4();
         explicit Matrix4x4(const Real* sourceData);
-        Matrix4x4(const Matrix4x4& source);
-        virtual ~Matrix4x4();
-
-        Real& A0 = data[0];
-        Real& A1 = data[4];
-        Real& A2 = data[8];
-        Real& A3 = data[12];
-        Real& B0 = data[1];
-        Real& B1 = data[5];
-        Real& B2 = data[9];
-        Real& B3 = data[13];
-        Real& C0 = data[2];
-        Real& C1 = data[6];
-        Real& C2 = data[10];
-        Real& C3 = data[14];
-        Real& D0 = data[3];
-        Real& D1 = data[7];
-        Real& D2 = data[11];
-        Real& D3 = data[15];
+
+        Real& A0() { return data[0]; }
+        Real& A1() { return data[4]; }
+        Real& A2() { return data[8]; }
+        Real& A3() { return data[12]; }
+        Real& B0() { return data[1]; }
+        Real& B1() { return data[5]; }
+        Real& B2() { return data[9]; }
+        Real& B3() { return data[13]; }
+        Real& C0() { return data[2]; }
+        Real& C1() { return data[6]; }
+        Real& C2() { return data[10]; }
+        Real& C3() { return data[14]; }
+        Real& D0() { return data[3]; }
+        Real& D1() { return data[7]; }
+        Real& D2() { return data[11]; }
+        Real& D3() { return data[15]; }
+        Real A0() const { return data[0]; }
+        Real A1() const { return data[4]; }
+        Real A2() const { return data[8]; }
+        Real A3() const { return data[12]; }
+        Real B0() const { return data[1]; }
+        Real B1() const { return data[5]; }
+        Real B2() const { return data[9]; }
+        Real B3() const { return data[13]; }
+        Real C0() const { return data[2]; }
+        Real C1() const { return data[6]; }
+        Real C2() const { return data[10]; }
+        Real C3() const { return data[14]; }
+        Real D0() const { return data[3]; }
+        Real D1() const { return data[7]; }
+        Real D2() const { return data[11]; }
+        Real D3() const { return data[15]; }
 
         Real* getData();
         const Real* getConstData() const;
         void setIdentity();
         void setIdentity(Real* target);
 
-        Matrix4x4& operator=(const Matrix4x4& source);
         void copy(const Matrix4x4& src);
         void copy(const Real* sourceData);
 
@@ -51,6 +70,9 @@ namespace Core {
         Bool invert();
         Bool invert(Matrix4x4& out);
         static Bool invert(const Real* source, Real* dest);
+        static Bool invertAffine(const Real* source, Real* dest);
+        static Bool invertGeneral(const Real* source, Real* dest);
+        static Bool invertAffineScalar(const Real* source, Real* dest);
 
         void buildFromComponents(const Vector3Components<Real>& translation, const Quaternion& rotation, const Vector3Components<Real>& scale);
         void decompose(Vector3Components<Real>& translation, Quaternion& rotation, Vector3Components<Real>& scale) const;
@@ -74,6 +96,11 @@ namespace Core {
         static void multiplyMV(const Real* lhsMat, const Real* rhsVec, Real* out);
         static inline void mx4transform(Real x, Real y, Real z, Real w, const Real* matrix, Real* pDest);
         static void multiplyMM(const Real* lhs, const Real* rhs, Real* out);
+        static void multiplyMMScalar(const Real* lhs, const Real* rhs, Real* out);
+        static void multiplyMVScalar(const Real* lhsMat, const Real* rhsVec, Real* out);
+        static void multiplyBatch(const Matrix4x4* lhs, const Matrix4x4* rhs, Matrix4x4* out, UInt32 count);
+        static void multiplyBatch(const Matrix4x4& lhs, const Matrix4x4* rhs, Matrix4x4* out, UInt32 count);
+        void transformBatch(const Real* vectors4f, Real* out, UInt32 count) const;
 
         void translate(const Vector3Components<Real>& vector);
         void translate(Real x, Real y, Real z);
@@ -104,6 +131,9 @@ namespace Core {
         void lookAt(const Vector3Components<Real>& src, const Vector3Components<Real>& target, const Vector3Components<Real>& up);
 
     private:
-        Real data[SIZE_MATRIX_4X4];
+        alignas(16) Real data[SIZE_MATRIX_4X4];
     };
+
+    static_assert(std::is_trivially_copyable<Matrix4x4>::value, "Matrix4x4 must be trivially copyable.");
+    static_assert(sizeof(Matrix4x4) == sizeof(Real) * SIZE_MATRIX_4X4, "Matrix4x4 must not carry data beyond its elements.");
 }
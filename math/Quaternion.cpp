@@ -317,7 +317,7 @@ namespace Core {
      * Based off the function Quaternion::fromRotationMatrix in the Ogre open source engine.
      */
     void Quaternion::fromMatrix(const Matrix4x4& matrix) {
-        Real trace = matrix.A0 + matrix.B1 + matrix.C2;
+        Real trace = matrix.A0() + matrix.B1() + matrix.C2();
         Real root;
 
         const Real* data = matrix.getConstData();
@@ -326,14 +326,14 @@ namespace Core {
             root = Math::squareRoot(trace + 1.0f);
             mData[3] = 0.5f * root;
             root = 0.5f / root;
-            mData[0] = (matrix.C1 - matrix.B2) * root;
-            mData[1] = (matrix.A2 - matrix.C0) * root;
-            mData[2] = (matrix.B0 - matrix.A1) * root;
+            mData[0] = (matrix.C1() - matrix.B2()) * root;
+            mData[1] = (matrix.A2() - matrix.C0()) * root;
+            mData[2] = (matrix.B0() - matrix.A1()) * root;
         } else {
             static UInt32 iNext[3] = {1, 2, 0};
             UInt32 i = 0;
-            if (matrix.B1 > matrix.A0) i = 1;
-            if (matrix.C2 > data[i * 4 + i]) i = 2;
+            if (matrix.B1() > matrix.A0()) i = 1;
+            if (matrix.C2() > data[i * 4 + i]) i = 2;
             UInt32 j = iNext[i];
             UInt32 k = iNext[j];
 
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "../common/types.h"
+
+/*
+ * Compile-time selection of the SIMD instruction set used by the math kernels. SSE and NEON
+ * are part of the baseline of x86-64 and AArch64 respectively, so no runtime dispatch is needed.
+ * The kernels work on single precision values only; defining CORE_NO_SIMD forces the scalar
+ * paths, e.g. to verify results against them.
+ */
+#if !defined(_Real_DoublePrecision_) && !defined(CORE_NO_SIMD)
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define CORE_SIMD_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CORE_SIMD_NEON 1
+#endif
+#endif
@@ -7,6 +7,36 @@ namespace Core {
         return false;
     }
 
+    /*
+     * Adds one item per renderable to [renderQueue]. Renderers that return false are drawn
+     * immediately via forwardRender() instead of through the queue.
+     */
+    Bool BaseObjectRenderer::enqueueForwardRender(const ViewDescriptor& viewDescriptor, MaterialGroupedRenderQueue& renderQueue) {
+        return false;
+    }
+
+    /*
+     * Draws a single renderable previously queued by enqueueForwardRender(). The shader activation and
+     * material state upload may be skipped when [bindShader] or [bindMaterial] are false, because the
+     * previous queued draw already left them in place.
+     */
+    Bool BaseObjectRenderer::forwardRenderQueued(const ViewDescriptor& viewDescriptor, UInt32 renderableIndex, const std::vector<WeakPointer<Light>>& lights,
+                                                 Bool matchPhysicalPropertiesWithLighting, Bool bindShader, Bool bindMaterial) {
+        return false;
+    }
+
+    /*
+     * Draws the queued renderable at [renderableIndex] once for each of the [instanceCount] matrices in
+     * [worldMatrices], in place of the owner's world matrix. Used for queued items marked instanceable
+     * that share a material and instance key; returning false makes the renderer fall back to
+     * forwardRenderQueued() for each item.
+     */
+    Bool BaseObjectRenderer::forwardRenderQueuedInstanced(const ViewDescriptor& viewDescriptor, UInt32 renderableIndex, const Matrix4x4* worldMatrices,
+                                                          UInt32 instanceCount, const std::vector<WeakPointer<Light>>& lights,
+                                                          Bool matchPhysicalPropertiesWithLighting, Bool bindShader, Bool bindMaterial) {
+        return false;
+    }
+
     Bool BaseObjectRenderer::supportsRenderPath(RenderPath renderPath) {
         return false;
     }
@@ -14,12 +14,20 @@ namespace Core {
     class Object3D;
     class Camera;
     class Light;
+    class MaterialGroupedRenderQueue;
+    class Matrix4x4;
 
     class BaseObjectRenderer : public Object3DComponent {
     public:
         BaseObjectRenderer(WeakPointer<Object3D> owner) : Object3DComponent(owner), castShadows(true) {}
         virtual Bool forwardRender(const ViewDescriptor& viewDescriptor, const std::vector<WeakPointer<Light>>& lights,
                                    Bool matchPhysicalPropertiesWithLighting);
+        virtual Bool enqueueForwardRender(const ViewDescriptor& viewDescriptor, MaterialGroupedRenderQueue& renderQueue);
+        virtual Bool forwardRenderQueued(const ViewDescriptor& viewDescriptor, UInt32 renderableIndex, const std::vector<WeakPointer<Light>>& lights,
+                                         Bool matchPhysicalPropertiesWithLighting, Bool bindShader, Bool bindMaterial);
+        virtual Bool forwardRenderQueuedInstanced(const ViewDescriptor& viewDescriptor, UInt32 renderableIndex, const Matrix4x4* worldMatrices,
+                                                  UInt32 instanceCount, const std::vector<WeakPointer<Light>>& lights,
+                                                  Bool matchPhysicalPropertiesWithLighting, Bool bindShader, Bool bindMaterial);
         virtual Bool supportsRenderPath(RenderPath renderPath);
         Bool castsShadows();
         void setCastShadows(Bool castShadows);
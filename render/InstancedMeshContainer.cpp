@@ -0,0 +1,59 @@
+#include "InstancedMeshContainer.h"
+#include "../common/Exception.h"
+
+namespace Core {
+
+    InstancedMeshContainer::~InstancedMeshContainer() {
+
+    }
+
+    UInt32 InstancedMeshContainer::addInstance(const Matrix4x4& transform) {
+        this->instanceTransforms.push_back(transform);
+        return (UInt32)this->instanceTransforms.size() - 1;
+    }
+
+    void InstancedMeshContainer::setInstanceTransform(UInt32 index, const Matrix4x4& transform) {
+        if (index >= this->instanceTransforms.size()) {
+            throw OutOfRangeException("InstancedMeshContainer::setInstanceTransform() -> 'index' is out of range.");
+        }
+        this->instanceTransforms[index].copy(transform);
+    }
+
+    const Matrix4x4& InstancedMeshContainer::getInstanceTransform(UInt32 index) const {
+        if (index >= this->instanceTransforms.size()) {
+            throw OutOfRangeException("InstancedMeshContainer::getInstanceTransform() -> 'index' is out of range.");
+        }
+        return this->instanceTransforms[index];
+    }
+
+    /*
+    * Removes the instance at [index] by moving the last instance into its place, so
+    * the index of the last instance changes.
+    */
+    void InstancedMeshContainer::removeInstance(UInt32 index) {
+        if (index >= this->instanceTransforms.size()) {
+            throw OutOfRangeException("InstancedMeshContainer::removeInstance() -> 'index' is out of range.");
+        }
+        if (index != this->instanceTransforms.size() - 1) {
+            this->instanceTransforms[index].copy(this->instanceTransforms.back());
+        }
+        this->instanceTransforms.pop_back();
+    }
+
+    void InstancedMeshContainer::clearInstances() {
+        this->instanceTransforms.clear();
+    }
+
+    void InstancedMeshContainer::reserveInstances(UInt32 count) {
+        this->instanceTransforms.reserve(count);
+    }
+
+    UInt32 InstancedMeshContainer::getInstanceCount() const {
+        return (UInt32)this->instanceTransforms.size();
+    }
+
+    const std::vector<Matrix4x4>& InstancedMeshContainer::getInstanceTransforms() const {
+        return this->instanceTransforms;
+    }
+
+}
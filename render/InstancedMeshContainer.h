@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+#include "../common/types.h"
+#include "../math/Matrix4x4.h"
+#include "MeshContainer.h"
+
+namespace Core {
+
+    /*
+    * Mesh container that draws each of its meshes once per instance transform in a single
+    * instanced draw call. Instance transforms are relative to the container's own transform.
+    * The container is never frustum culled as a whole and its meshes are only drawn instanced
+    * with materials whose shaders read the per-instance model matrix.
+    */
+    class InstancedMeshContainer : public MeshContainer {
+
+    public:
+
+        virtual ~InstancedMeshContainer();
+
+        UInt32 addInstance(const Matrix4x4& transform);
+        void setInstanceTransform(UInt32 index, const Matrix4x4& transform);
+        const Matrix4x4& getInstanceTransform(UInt32 index) const;
+        void removeInstance(UInt32 index);
+        void clearInstances();
+        void reserveInstances(UInt32 count);
+        UInt32 getInstanceCount() const;
+        const std::vector<Matrix4x4>& getInstanceTransforms() const;
+
+    private:
+
+        std::vector<Matrix4x4> instanceTransforms;
+    };
+
+}
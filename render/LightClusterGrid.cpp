@@ -0,0 +1,325 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "LightClusterGrid.h"
+#include "ViewDescriptor.h"
+#include "../Engine.h"
+#include "../Graphics.h"
+#include "../math/Math.h"
+#include "../image/Texture2D.h"
+#include "../image/TextureAttr.h"
+#include "../light/Light.h"
+#include "../light/PointLight.h"
+#include "../scene/Object3D.h"
+#include "../common/debug.h"
+
+namespace Core {
+
+    LightClusterGrid::LightClusterGrid() {
+        this->clusterBoundsValid = false;
+        this->nearPlane = 0.0f;
+        this->farPlane = 0.0f;
+        this->depthScale = 0.0f;
+        this->depthBias = 0.0f;
+        this->lightCount = 0;
+        this->lightIndexCount = 0;
+        this->overflowReported = false;
+
+        this->clusterMinX.resize(ClusterCount);
+        this->clusterMinY.resize(ClusterCount);
+        this->clusterMinZ.resize(ClusterCount);
+        this->clusterMaxX.resize(ClusterCount);
+        this->clusterMaxY.resize(ClusterCount);
+        this->clusterMaxZ.resize(ClusterCount);
+        this->clusterHits.resize(ClusterCount);
+        this->clusterLightCounts.resize(ClusterCount);
+        this->clusterData.resize(ClusterCount * 4);
+        this->lightData.resize(MaxLights * 2 * 4);
+    }
+
+    LightClusterGrid::~LightClusterGrid() {
+        if (this->clusterTexture.isValid()) Graphics::safeReleaseObject(this->clusterTexture);
+        if (this->lightIndexTexture.isValid()) Graphics::safeReleaseObject(this->lightIndexTexture);
+        if (this->lightDataTexture.isValid()) Graphics::safeReleaseObject(this->lightDataTexture);
+    }
+
+    /*
+     * Point lights without shadows are handled by the cluster grid, shadowed point lights
+     * still go through the regular per-pass lighting path.
+     */
+    Bool LightClusterGrid::isClusteredLight(WeakPointer<Light> light) {
+        if (light->getType() != LightType::Point) return false;
+        WeakPointer<PointLight> pointLight = WeakPointer<Light>::dynamicPointerCast<PointLight>(light);
+        return pointLight.isValid() && !pointLight->getShadowsEnabled();
+    }
+
+    /*
+     * Assign the clustered lights in [lights] to the clusters of the view described by [viewDescriptor].
+     * Returns false if there is nothing to shade with the grid, either because there are no clustered
+     * lights or because the view does not use a perspective projection.
+     *
+     * Lights are binned in order until MaxLights lights or MaxLightIndices (cluster, light) pairs are used up,
+     * so the binned lights are always the first getLightCount() clustered lights in [lights]. The remaining
+     * ones are left to the per-pass lighting path and the overflow is reported once.
+     */
+    Bool LightClusterGrid::build(const ViewDescriptor& viewDescriptor, const std::vector<WeakPointer<Light>>& lights) {
+        this->lightCount = 0;
+        this->lightIndexCount = 0;
+        this->clusterLightPairs.resize(0);
+
+        if (!this->updateClusterBounds(viewDescriptor.projectionMatrix)) return false;
+
+        Bool overflow = false;
+        const Matrix4x4& viewMatrix = viewDescriptor.viewInverseMatrix;
+        for (auto light : lights) {
+            if (!isClusteredLight(light)) continue;
+            if (this->lightCount >= MaxLights) {
+                overflow = true;
+                break;
+            }
+
+            WeakPointer<PointLight> pointLight = WeakPointer<Light>::dynamicPointerCast<PointLight>(light);
+            Point3r worldPos;
+            pointLight->getOwner()->getTransform().applyTransformationTo(worldPos);
+            Real viewPos[] = {worldPos.x, worldPos.y, worldPos.z, 1.0f};
+            viewMatrix.transform(viewPos);
+
+            Real radius = pointLight->getRadius();
+            Color color = pointLight->getColor();
+            Real intensity = pointLight->getIntensity();
+            Real* data = this->lightData.data();
+            UInt32 rowSize = MaxLights * 4;
+            data[this->lightCount * 4] = worldPos.x;
+            data[this->lightCount * 4 + 1] = worldPos.y;
+            data[this->lightCount * 4 + 2] = worldPos.z;
+            data[this->lightCount * 4 + 3] = radius;
+            data[rowSize + this->lightCount * 4] = color.r * intensity;
+            data[rowSize + this->lightCount * 4 + 1] = color.g * intensity;
+            data[rowSize + this->lightCount * 4 + 2] = color.b * intensity;
+            data[rowSize + this->lightCount * 4 + 3] = 1.0f;
+
+            if (!this->assignLight(this->lightCount, Vector3r(viewPos[0], viewPos[1], viewPos[2]), radius)) {
+                overflow = true;
+                break;
+            }
+            this->lightCount++;
+        }
+
+        if (overflow && !this->overflowReported) {
+            Debug::PrintError("LightClusterGrid::build -> Too many clustered lights, only %u are binned, the rest use per-pass lighting.\n",
+                              this->lightCount);
+        }
+        this->overflowReported = overflow;
+
+        if (this->lightCount == 0) return false;
+
+        this->upload();
+        return true;
+    }
+
+    /*
+     * Recompute the view-space bounds of every cluster if [projection] has changed since the last build.
+     * Each bound is the box enclosing the corners of the tile's sub-frustum between its near & far slice.
+     */
+    Bool LightClusterGrid::updateClusterBounds(const Matrix4x4& projection) {
+        const Real* proj = projection.getConstData();
+
+        // only perspective projections (w = -z) can be sliced logarithmically in depth
+        if (proj[11] != -1.0f || proj[15] != 0.0f) return false;
+
+        if (this->clusterBoundsValid && memcmp(proj, this->clusterProjection.getConstData(), sizeof(Real) * 16) == 0) {
+            return true;
+        }
+
+        this->nearPlane = proj[14] / (proj[10] - 1.0f);
+        this->farPlane = proj[14] / (proj[10] + 1.0f);
+        if (this->nearPlane <= 0.0f || this->farPlane <= this->nearPlane) return false;
+
+        Real logDepthRange = std::log(this->farPlane / this->nearPlane);
+        this->depthScale = (Real)Slices / logDepthRange;
+        this->depthBias = -(Real)Slices * std::log(this->nearPlane) / logDepthRange;
+
+        for (UInt32 z = 0; z < Slices; z++) {
+            Real sliceNear = this->nearPlane * std::pow(this->farPlane / this->nearPlane, (Real)z / (Real)Slices);
+            Real sliceFar = this->nearPlane * std::pow(this->farPlane / this->nearPlane, (Real)(z + 1) / (Real)Slices);
+            for (UInt32 y = 0; y < TilesY; y++) {
+                Real ndcMinY = -1.0f + 2.0f * (Real)y / (Real)TilesY;
+                Real ndcMaxY = -1.0f + 2.0f * (Real)(y + 1) / (Real)TilesY;
+                for (UInt32 x = 0; x < TilesX; x++) {
+                    Real ndcMinX = -1.0f + 2.0f * (Real)x / (Real)TilesX;
+                    Real ndcMaxX = -1.0f + 2.0f * (Real)(x + 1) / (Real)TilesX;
+
+                    // view-space x & y of a point at depth d that projects to ndc n: d * (n + offset) / scale
+                    Real nearMinX = sliceNear * (ndcMinX + proj[8]) / proj[0];
+                    Real nearMaxX = sliceNear * (ndcMaxX + proj[8]) / proj[0];
+                    Real farMinX = sliceFar * (ndcMinX + proj[8]) / proj[0];
+                    Real farMaxX = sliceFar * (ndcMaxX + proj[8]) / proj[0];
+                    Real nearMinY = sliceNear * (ndcMinY + proj[9]) / proj[5];
+                    Real nearMaxY = sliceNear * (ndcMaxY + proj[9]) / proj[5];
+                    Real farMinY = sliceFar * (ndcMinY + proj[9]) / proj[5];
+                    Real farMaxY = sliceFar * (ndcMaxY + proj[9]) / proj[5];
+
+                    UInt32 cluster = (z * TilesY + y) * TilesX + x;
+                    this->clusterMinX[cluster] = Math::min(nearMinX, farMinX);
+                    this->clusterMaxX[cluster] = Math::max(nearMaxX, farMaxX);
+                    this->clusterMinY[cluster] = Math::min(nearMinY, farMinY);
+                    this->clusterMaxY[cluster] = Math::max(nearMaxY, farMaxY);
+                    this->clusterMinZ[cluster] = -sliceFar;
+                    this->clusterMaxZ[cluster] = -sliceNear;
+                }
+            }
+        }
+
+        this->clusterProjection.copy(projection);
+        this->clusterBoundsValid = true;
+        return true;
+    }
+
+    /*
+     * Test the light's view-space bounding sphere against every cluster in the depth slices it overlaps.
+     * Returns false, without adding any of the light's pairs, if they don't all fit into MaxLightIndices.
+     */
+    Bool LightClusterGrid::assignLight(UInt32 lightIndex, const Vector3r& viewCenter, Real radius) {
+        Real nearDepth = -viewCenter.z - radius;
+        Real farDepth = -viewCenter.z + radius;
+        if (farDepth < this->nearPlane || nearDepth > this->farPlane) return true;
+
+        Int32 firstSlice = 0;
+        if (nearDepth > this->nearPlane) {
+            firstSlice = (Int32)(std::log(nearDepth) * this->depthScale + this->depthBias);
+        }
+        Int32 lastSlice = Slices - 1;
+        if (farDepth < this->farPlane) {
+            lastSlice = (Int32)(std::log(farDepth) * this->depthScale + this->depthBias);
+        }
+        firstSlice = Math::max(firstSlice, 0);
+        lastSlice = Math::min(lastSlice, (Int32)Slices - 1);
+        if (lastSlice < firstSlice) return true;
+
+        const UInt32 tilesPerSlice = TilesX * TilesY;
+        const UInt32 first = (UInt32)firstSlice * tilesPerSlice;
+        const UInt32 last = ((UInt32)lastSlice + 1) * tilesPerSlice;
+
+        const Real cx = viewCenter.x;
+        const Real cy = viewCenter.y;
+        const Real cz = viewCenter.z;
+        const Real radiusSquared = radius * radius;
+        const Real* minX = this->clusterMinX.data();
+        const Real* minY = this->clusterMinY.data();
+        const Real* minZ = this->clusterMinZ.data();
+        const Real* maxX = this->clusterMaxX.data();
+        const Real* maxY = this->clusterMaxY.data();
+        const Real* maxZ = this->clusterMaxZ.data();
+        Byte* hits = this->clusterHits.data();
+
+        // branch-free sphere vs. box test, written so the compiler can vectorize it
+        for (UInt32 c = first; c < last; c++) {
+            Real dx = std::max(std::max(minX[c] - cx, cx - maxX[c]), 0.0f);
+            Real dy = std::max(std::max(minY[c] - cy, cy - maxY[c]), 0.0f);
+            Real dz = std::max(std::max(minZ[c] - cz, cz - maxZ[c]), 0.0f);
+            hits[c] = (Byte)((dx * dx + dy * dy + dz * dz) <= radiusSquared);
+        }
+
+        const size_t firstPair = this->clusterLightPairs.size();
+        for (UInt32 c = first; c < last; c++) {
+            if (hits[c]) {
+                if (this->clusterLightPairs.size() >= MaxLightIndices) {
+                    this->clusterLightPairs.resize(firstPair);
+                    return false;
+                }
+                this->clusterLightPairs.push_back(c * MaxLights + lightIndex);
+            }
+        }
+        return true;
+    }
+
+    /*
+     * Turn the (cluster, light) pairs into per-cluster index lists and copy everything to the GPU.
+     */
+    void LightClusterGrid::upload() {
+        if (!this->clusterTexture.isValid()) {
+            this->initTextures();
+        }
+
+        std::fill(this->clusterLightCounts.begin(), this->clusterLightCounts.end(), 0);
+        for (UInt32 pair : this->clusterLightPairs) {
+            this->clusterLightCounts[pair / MaxLights]++;
+        }
+
+        UInt32 offset = 0;
+        for (UInt32 c = 0; c < ClusterCount; c++) {
+            this->clusterData[c * 4] = (Real)offset;
+            this->clusterData[c * 4 + 1] = (Real)this->clusterLightCounts[c];
+            this->clusterData[c * 4 + 2] = 0.0f;
+            this->clusterData[c * 4 + 3] = 0.0f;
+            offset += this->clusterLightCounts[c];
+            this->clusterLightCounts[c] = 0;
+        }
+
+        this->lightIndexCount = (UInt32)this->clusterLightPairs.size();
+        UInt32 indexRows = (this->lightIndexCount + LightIndexTextureWidth - 1) / LightIndexTextureWidth;
+        this->lightIndexData.resize(indexRows * LightIndexTextureWidth);
+        for (UInt32 pair : this->clusterLightPairs) {
+            UInt32 cluster = pair / MaxLights;
+            UInt32 index = (UInt32)this->clusterData[cluster * 4] + this->clusterLightCounts[cluster];
+            this->lightIndexData[index] = (Real)(pair % MaxLights);
+            this->clusterLightCounts[cluster]++;
+        }
+
+        this->clusterTexture->updateRegion(0, 0, TilesX * TilesY, Slices, (const Byte*)this->clusterData.data());
+        if (indexRows > 0) {
+            this->lightIndexTexture->updateRegion(0, 0, LightIndexTextureWidth, indexRows, (const Byte*)this->lightIndexData.data());
+        }
+        const Real* positionRow = this->lightData.data();
+        const Real* colorRow = positionRow + MaxLights * 4;
+        this->lightDataTexture->updateRegion(0, 0, this->lightCount, 1, (const Byte*)positionRow);
+        this->lightDataTexture->updateRegion(0, 1, this->lightCount, 1, (const Byte*)colorRow);
+    }
+
+    void LightClusterGrid::initTextures() {
+        TextureAttributes attributes;
+        attributes.FilterMode = TextureFilter::Point;
+        attributes.WrapMode = TextureWrap::Clamp;
+        attributes.MipLevels = 0;
+
+        attributes.Format = TextureFormat::RGBA32F;
+        this->clusterTexture = Engine::instance()->createTexture2D(attributes);
+        this->clusterTexture->buildEmpty(TilesX * TilesY, Slices);
+
+        this->lightDataTexture = Engine::instance()->createTexture2D(attributes);
+        this->lightDataTexture->buildEmpty(MaxLights, 2);
+
+        attributes.Format = TextureFormat::R32F;
+        this->lightIndexTexture = Engine::instance()->createTexture2D(attributes);
+        this->lightIndexTexture->buildEmpty(LightIndexTextureWidth, LightIndexTextureWidth);
+    }
+
+    UInt32 LightClusterGrid::getLightCount() const {
+        return this->lightCount;
+    }
+
+    UInt32 LightClusterGrid::getLightIndexCount() const {
+        return this->lightIndexCount;
+    }
+
+    Real LightClusterGrid::getDepthScale() const {
+        return this->depthScale;
+    }
+
+    Real LightClusterGrid::getDepthBias() const {
+        return this->depthBias;
+    }
+
+    WeakPointer<Texture2D> LightClusterGrid::getClusterTexture() {
+        return this->clusterTexture;
+    }
+
+    WeakPointer<Texture2D> LightClusterGrid::getLightIndexTexture() {
+        return this->lightIndexTexture;
+    }
+
+    WeakPointer<Texture2D> LightClusterGrid::getLightDataTexture() {
+        return this->lightDataTexture;
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+
+#include "../common/types.h"
+#include "../util/WeakPointer.h"
+#include "../util/PersistentWeakPointer.h"
+#include "../math/Matrix4x4.h"
+
+namespace Core {
+
+    // forward declarations
+    class Light;
+    class Texture2D;
+    class ViewDescriptor;
+
+    /*
+     * Bins point lights into a grid of view-space clusters (froxels): the screen is split into
+     * TilesX x TilesY tiles and view depth into exponentially distributed Slices. The per-cluster light
+     * lists are uploaded into three textures that the clustered lighting shaders sample:
+     *
+     *   cluster grid:  (TilesX * TilesY) x Slices RGBA32F, texel = (index list offset, light count)
+     *   light indices: LightIndexTextureWidth x LightIndexTextureWidth R32F, indices into the light data
+     *   light data:    MaxLights x 2 RGBA32F, row 0 = (world position, radius), row 1 = (color * intensity)
+     */
+    class LightClusterGrid {
+    public:
+        static const UInt32 TilesX = 16;
+        static const UInt32 TilesY = 9;
+        static const UInt32 Slices = 24;
+        static const UInt32 ClusterCount = TilesX * TilesY * Slices;
+        static const UInt32 MaxLights = 1024;
+        static const UInt32 LightIndexTextureWidth = 256;
+        static const UInt32 MaxLightIndices = LightIndexTextureWidth * LightIndexTextureWidth;
+
+        LightClusterGrid();
+        ~LightClusterGrid();
+
+        Bool build(const ViewDescriptor& viewDescriptor, const std::vector<WeakPointer<Light>>& lights);
+        static Bool isClusteredLight(WeakPointer<Light> light);
+
+        UInt32 getLightCount() const;
+        UInt32 getLightIndexCount() const;
+        Real getDepthScale() const;
+        Real getDepthBias() const;
+        WeakPointer<Texture2D> getClusterTexture();
+        WeakPointer<Texture2D> getLightIndexTexture();
+        WeakPointer<Texture2D> getLightDataTexture();
+
+    private:
+        void initTextures();
+        Bool updateClusterBounds(const Matrix4x4& projection);
+        Bool assignLight(UInt32 lightIndex, const Vector3r& viewCenter, Real radius);
+        void upload();
+
+        Matrix4x4 clusterProjection;
+        Bool clusterBoundsValid;
+        Real nearPlane;
+        Real farPlane;
+        Real depthScale;
+        Real depthBias;
+
+        // view-space cluster bounds, kept as separate arrays so the sphere tests vectorize
+        std::vector<Real> clusterMinX;
+        std::vector<Real> clusterMinY;
+        std::vector<Real> clusterMinZ;
+        std::vector<Real> clusterMaxX;
+        std::vector<Real> clusterMaxY;
+        std::vector<Real> clusterMaxZ;
+        std::vector<Byte> clusterHits;
+
+        UInt32 lightCount;
+        UInt32 lightIndexCount;
+        Bool overflowReported;
+        std::vector<UInt32> clusterLightPairs;
+        std::vector<UInt32> clusterLightCounts;
+        std::vector<Real> clusterData;
+        std::vector<Real> lightIndexData;
+        std::vector<Real> lightData;
+
+        PersistentWeakPointer<Texture2D> clusterTexture;
+        PersistentWeakPointer<Texture2D> lightIndexTexture;
+        PersistentWeakPointer<Texture2D> lightDataTexture;
+    };
+}
@@ -1,4 +1,7 @@
 #include "MaterialGroupedRenderQueue.h"
+#include "../material/Material.h"
+#include "../material/Shader.h"
+#include "../image/Texture.h"
 
 namespace Core {
 
@@ -6,4 +9,34 @@ namespace Core {
 
     }
 
-}
\ No newline at end of file
+    void MaterialGroupedRenderQueue::clear() {
+        RenderQueue::clear();
+        this->shaderIDs.clear();
+        this->textureIDs.clear();
+        this->materialIDs.clear();
+    }
+
+    RenderQueue::RenderItem& MaterialGroupedRenderQueue::addRenderable(BaseObjectRenderer* renderer, UInt32 renderableIndex,
+                                                                      WeakPointer<Material> material, Real viewDepth) {
+        // ID 0 is reserved for materials without a primary texture
+        WeakPointer<Texture> texture = material->getPrimaryTexture();
+        UInt32 textureID = texture.isValid() ? getGroupID(this->textureIDs, (UInt64)texture->getTextureID()) + 1 : 0;
+        UInt32 shaderID = getGroupID(this->shaderIDs, material->getShader()->getProgram());
+        UInt32 materialID = getGroupID(this->materialIDs, material->getObjectID());
+
+        RenderItem& item = this->addItem(material->getRenderLayer(), material->isTransparent(), shaderID, textureID, materialID, viewDepth);
+        item.renderer = renderer;
+        item.renderableIndex = renderableIndex;
+        item.material = material;
+        return item;
+    }
+
+    UInt32 MaterialGroupedRenderQueue::getGroupID(std::unordered_map<UInt64, UInt32>& groupIDs, UInt64 key) {
+        auto result = groupIDs.find(key);
+        if (result != groupIDs.end()) return result->second;
+        UInt32 id = (UInt32)groupIDs.size();
+        groupIDs[key] = id;
+        return id;
+    }
+
+}
@@ -1,15 +1,31 @@
 #pragma once
 
+#include <unordered_map>
+
 #include "../common/types.h"
 #include "RenderQueue.h"
 
 namespace Core {
 
-    class MaterialGroupedRenderQueue : public RenderQueue{
+    /*
+     * Render queue that derives each item's sort key from its material: the shader program, the
+     * material's primary texture and the material itself are each mapped to a small per-frame ID
+     * (in order of first appearance) so that draws sharing state end up adjacent after sorting.
+     */
+    class MaterialGroupedRenderQueue : public RenderQueue {
     public:
 
         MaterialGroupedRenderQueue(UInt32 initialCapacity);
         void clear();
+        RenderItem& addRenderable(BaseObjectRenderer* renderer, UInt32 renderableIndex,
+                                  WeakPointer<Material> material, Real viewDepth);
+
+    private:
+        static UInt32 getGroupID(std::unordered_map<UInt64, UInt32>& groupIDs, UInt64 key);
+
+        std::unordered_map<UInt64, UInt32> shaderIDs;
+        std::unordered_map<UInt64, UInt32> textureIDs;
+        std::unordered_map<UInt64, UInt32> materialIDs;
     };
 
-}
\ No newline at end of file
+}
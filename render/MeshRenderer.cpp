@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include "MeshRenderer.h"
 #include "../Engine.h"
 #include "../geometry/AttributeArray.h"
@@ -13,10 +15,16 @@
 #include "../render/Camera.h"
 #include "../render/RenderTarget.h"
 #include "MeshContainer.h"
+#include "InstancedMeshContainer.h"
+#include "LightClusterGrid.h"
+#include "MaterialGroupedRenderQueue.h"
 #include "../animation/VertexBoneMap.h"
 #include "../animation/Bone.h"
 #include "../animation/Object3DSkeletonNode.h"
+#include "../animation/Skeleton.h"
+#include "Renderer.h"
 #include "RenderException.h"
+#include "../common/Constants.h"
 
 namespace Core {
 
@@ -30,90 +38,541 @@ namespace Core {
         }
     }
 
-    void MeshRenderer::setSkinningVars(WeakPointer<Mesh> mesh, WeakPointer<Material> material, WeakPointer<Shader> shader) {
+    /*
+     * Binds the bone attributes of [mesh] and the skinning palette of its skeleton for the material's skinning mode. The palette
+     * is computed at most once per frame and shared by every mesh and pass that uses that skeleton, so the only per-draw data
+     * is the matrix that maps the palette's reference space into the space of the owner. Returns the first texture unit that
+     * is still free.
+     */
+    UInt32 MeshRenderer::setSkinningVars(WeakPointer<Mesh> mesh, WeakPointer<Material> material, WeakPointer<Shader> shader, UInt32 firstTextureSlot) {
         Int32 skinningEnabledLocation = material->getShaderLocation(StandardUniform::SkinningEnabled);
-        if (skinningEnabledLocation >= 0) shader->setUniform1i(skinningEnabledLocation, 0.0);
+        Int32 skinningPaletteLocation = material->getShaderLocation(StandardUniform::SkinningPalette);
+        Int32 skinningRootInverseMatrixLocation = material->getShaderLocation(StandardUniform::SkinningRootInverseMatrix);
+        Int32 skinningModeLocation = material->getShaderLocation(StandardUniform::SkinningMode);
+        SkinningMode skinningMode = material->getSkinningMode();
+        UInt32 paletteTextureID = this->graphics->getPlaceHolderTexture2D()->getTextureID();
+        Bool skinned = false;
+
         if (material->isSkinningEnabled()) {
             std::shared_ptr<MeshContainer> thisContainer = std::dynamic_pointer_cast<MeshContainer>(this->owner.lock());
             if (thisContainer && thisContainer->hasVertexBoneMap(mesh->getObjectID())) {
-                if (skinningEnabledLocation >= 0) shader->setUniform1i(skinningEnabledLocation, 1.0);
                 WeakPointer<VertexBoneMap> vertexBoneMap = thisContainer->getVertexBoneMap(mesh->getObjectID());
                 this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::BoneIndex, StandardAttribute::BoneIndex, vertexBoneMap->getIndices(), true);
                 this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::BoneWeight, StandardAttribute::BoneWeight, vertexBoneMap->getWeights(), true);
 
-                Matrix4x4 rootTransformInverse = this->owner->getTransform().getWorldMatrix();
-                rootTransformInverse.invert();
-
-                Matrix4x4 temp;
                 WeakPointer<Skeleton> skeleton = thisContainer->getSkeleton();
-                for(UInt32 i = 0; i < skeleton->getNodeCount(); i++) {
-                    Skeleton::SkeletonNode * node = skeleton->getNodeFromList(i);
-                    if (node->BoneIndex >= 0) {
-                        Int32 bonesLocation = material->getShaderLocation(StandardUniform::Bones, node->BoneIndex);
-                        if (bonesLocation >= 0) {
-                            temp.copy(skeleton->getBone(node->BoneIndex)->OffsetMatrix);
-                            temp.preMultiply(node->getFullTransform());
-                            temp.preMultiply(rootTransformInverse);
-                            shader->setUniformMatrix4(bonesLocation, temp);
-                        }
+                if (skeleton.isValid()) {
+                    Transform& ownerTransform = this->owner->getTransform();
+                    skeleton->updateSkinningPalette(skinningMode, this->graphics->getRenderer()->getFrameIndex(), ownerTransform);
+                    paletteTextureID = skeleton->getSkinningPaletteTexture(skinningMode)->getTextureID();
+                    if (skinningRootInverseMatrixLocation >= 0) {
+                        Matrix4x4 rootInverse;
+                        Matrix4x4::multiply(ownerTransform.getConstInverseWorldMatrix(), skeleton->getSkinningPaletteReference(skinningMode), rootInverse);
+                        shader->setUniformMatrix4(skinningRootInverseMatrixLocation, rootInverse);
                     }
+                    if (skinningModeLocation >= 0) shader->setUniform1i(skinningModeLocation, (Int32)skinningMode);
+                    skinned = true;
                 }
             }
         }
+
+        if (skinningEnabledLocation >= 0) shader->setUniform1i(skinningEnabledLocation, skinned ? 1 : 0);
+        // the sampler is bound even when skinning is off so it never shares a unit with a texture of another type
+        if (skinningPaletteLocation >= 0) {
+            shader->setTexture2D(firstTextureSlot, skinningPaletteLocation, paletteTextureID);
+            firstTextureSlot++;
+        }
+        return firstTextureSlot;
+    }
+
+    /*
+     * Uploads the parameters of [lightCount] lights as arrays indexed by light (and by light * MaxDirectionalCascades + cascade
+     * for cascade data), so the same code serves both single-light and multi-light shaders. Every sampler slot up to the
+     * material's lights-per-pass limit gets its own texture unit, unused ones are filled with placeholders and
+     * disabled. Returns the first texture unit that is still free.
+     */
+    UInt32 MeshRenderer::setLightingVars(WeakPointer<Material> material, WeakPointer<Shader> shader, WeakPointer<Light>* lights, UInt32 lightCount,
+                                         UInt32 firstTextureSlot) {
+        static const UInt32 maxLights = Constants::MaxShaderLights;
+        static const UInt32 maxCascades = Constants::MaxDirectionalCascades;
+
+        Real colors[maxLights * 4] = {0};
+        Real intensities[maxLights] = {0};
+        Int32 types[maxLights] = {0};
+        Int32 enabled[maxLights] = {0};
+        Int32 shadowsEnabled[maxLights] = {0};
+        Real matrices[maxLights * 16] = {0};
+        Real angularShadowBiases[maxLights] = {0};
+        Real constantShadowBiases[maxLights] = {0};
+        Real shadowMapSizes[maxLights] = {0};
+        Int32 shadowSoftnesses[maxLights] = {0};
+        Real ranges[maxLights] = {0};
+        Real nearPlanes[maxLights] = {0};
+        Real positions[maxLights * 4] = {0};
+        Real directions[maxLights * 4] = {0};
+        Int32 cascadeCounts[maxLights] = {0};
+        Real viewProjections[maxLights * maxCascades * 16] = {0};
+        Real cascadeEnds[maxLights * maxCascades] = {0};
+        Real shadowMapAspects[maxLights * maxCascades] = {0};
+
+        Int32 irradianceMapUnits[maxLights];
+        Int32 specularIBLPreFilteredMapUnits[maxLights];
+        Int32 specularIBLBRDFMapUnits[maxLights];
+        Int32 shadowCubeMapUnits[maxLights];
+        Int32 shadowMapUnits[maxLights * maxCascades];
+
+        Int32 irradianceMapLoc = material->getShaderLocation(StandardUniform::LightIrradianceMap);
+        Int32 specularIBLPreFilteredMapLoc = material->getShaderLocation(StandardUniform::LightSpecularIBLPreFilteredMap);
+        Int32 specularIBLBRDFMapLoc = material->getShaderLocation(StandardUniform::LightSpecularIBLBRDFMap);
+        Int32 lightShadowCubeMapLoc = material->getShaderLocation(StandardUniform::LightShadowCubeMap);
+        Int32 shadowMapLoc = material->getShaderLocation(StandardUniform::LightShadowMap, 0);
+
+        UInt32 placeHolderCubeTextureID = this->graphics->getPlaceHolderCubeTexture()->getTextureID();
+        UInt32 placeHolderTexture2DID = this->graphics->getPlaceHolderTexture2D()->getTextureID();
+
+        UInt32 lightsPerPass = material->getLightsPerPass();
+        UInt32 currentTextureSlot = firstTextureSlot;
+        for (UInt32 i = 0; i < lightsPerPass; i++) {
+            WeakPointer<Light> light;
+            if (i < lightCount) light = lights[i];
+            LightType lightType = light.isValid() ? light->getType() : LightType::Ambient;
+
+            if (light.isValid()) {
+                Color color = light->getColor();
+                colors[i * 4] = color.r;
+                colors[i * 4 + 1] = color.g;
+                colors[i * 4 + 2] = color.b;
+                colors[i * 4 + 3] = color.a;
+                intensities[i] = light->getIntensity();
+                types[i] = (Int32)lightType;
+                enabled[i] = 1;
+                memcpy(matrices + i * 16, light->getOwner()->getTransform().getConstInverseWorldMatrix().getConstData(), sizeof(Real) * 16);
+            }
+
+            WeakPointer<AmbientIBLLight> ambientIBLLight;
+            if (lightType == LightType::AmbientIBL) {
+                ambientIBLLight = WeakPointer<Light>::dynamicPointerCast<AmbientIBLLight>(light);
+            }
+
+            if (irradianceMapLoc >= 0) {
+                shader->setTextureCube(currentTextureSlot, ambientIBLLight.isValid() ?
+                                       ambientIBLLight->getIrradianceMap()->getTextureID() : placeHolderCubeTextureID);
+                irradianceMapUnits[i] = currentTextureSlot;
+                currentTextureSlot++;
+            }
+
+            if (specularIBLPreFilteredMapLoc >= 0) {
+                shader->setTextureCube(currentTextureSlot, ambientIBLLight.isValid() ?
+                                       ambientIBLLight->getSpecularIBLPreFilteredMap()->getTextureID() : placeHolderCubeTextureID);
+                specularIBLPreFilteredMapUnits[i] = currentTextureSlot;
+                currentTextureSlot++;
+            }
+
+            if (specularIBLBRDFMapLoc >= 0) {
+                shader->setTexture2D(currentTextureSlot, ambientIBLLight.isValid() ?
+                                     ambientIBLLight->getSpecularIBLBRDFMap()->getTextureID() : placeHolderTexture2DID);
+                specularIBLBRDFMapUnits[i] = currentTextureSlot;
+                currentTextureSlot++;
+            }
+
+            if (lightType == LightType::Point || lightType == LightType::Directional) {
+                WeakPointer<ShadowLight> shadowLight = WeakPointer<Light>::dynamicPointerCast<ShadowLight>(light);
+                angularShadowBiases[i] = shadowLight->getAngularShadowBias();
+                constantShadowBiases[i] = shadowLight->getConstantShadowBias();
+                shadowMapSizes[i] = shadowLight->getShadowMapSize();
+                shadowSoftnesses[i] = (Int32)shadowLight->getShadowSoftness();
+                shadowsEnabled[i] = shadowLight->getShadowsEnabled() ? 1 : 0;
+            }
+
+            UInt32 shadowCubeTextureID = placeHolderCubeTextureID;
+            if (lightType == LightType::Point) {
+                WeakPointer<PointLight> pointLight = WeakPointer<Light>::dynamicPointerCast<PointLight>(light);
+                ranges[i] = pointLight->getRadius();
+                nearPlanes[i] = PointLight::NearPlane;
+
+                Point3r pos;
+                pointLight->getOwner()->getTransform().applyTransformationTo(pos);
+                positions[i * 4] = pos.x;
+                positions[i * 4 + 1] = pos.y;
+                positions[i * 4 + 2] = pos.z;
+                positions[i * 4 + 3] = 1.0f;
+
+                if (pointLight->getShadowsEnabled()) {
+                    shadowCubeTextureID = pointLight->getShadowMap()->getColorTexture()->getTextureID();
+                }
+            }
+
+            if (lightShadowCubeMapLoc >= 0) {
+                shader->setTextureCube(currentTextureSlot, shadowCubeTextureID);
+                shadowCubeMapUnits[i] = currentTextureSlot;
+                currentTextureSlot++;
+            }
+
+            UInt32 cascadeCount = 0;
+            WeakPointer<DirectionalLight> directionalLight;
+            if (lightType == LightType::Directional) {
+                directionalLight = WeakPointer<Light>::dynamicPointerCast<DirectionalLight>(light);
+
+                Vector3r dir = Vector3r::Forward;
+                directionalLight->getOwner()->getTransform().applyTransformationTo(dir);
+                directions[i * 4] = dir.x;
+                directions[i * 4 + 1] = dir.y;
+                directions[i * 4 + 2] = dir.z;
+                directions[i * 4 + 3] = 0.0f;
+
+                cascadeCount = directionalLight->getCascadeCount();
+                cascadeCounts[i] = cascadeCount;
+            }
+
+            for (UInt32 l = 0; l < maxCascades; l++) {
+                UInt32 cascadeOffset = i * maxCascades + l;
+                UInt32 shadowMapTextureID = placeHolderTexture2DID;
+                if (l < cascadeCount) {
+                    if (directionalLight->getShadowsEnabled()) {
+                        shadowMapTextureID = directionalLight->getShadowMap(l)->getDepthTexture()->getTextureID();
+                    }
+
+                    memcpy(viewProjections + cascadeOffset * 16, directionalLight->getViewProjectionMatrix(l).getConstData(), sizeof(Real) * 16);
+                    cascadeEnds[cascadeOffset] = directionalLight->getCascadeBoundary(l + 1);
+
+                    DirectionalLight::OrthoProjection& proj = directionalLight->getProjection(l);
+                    shadowMapAspects[cascadeOffset] = Math::abs((proj.right - proj.left) / (proj.top - proj.bottom));
+                }
+
+                if (shadowMapLoc >= 0) {
+                    shader->setTexture2D(currentTextureSlot, shadowMapTextureID);
+                    shadowMapUnits[cascadeOffset] = currentTextureSlot;
+                    currentTextureSlot++;
+                }
+            }
+        }
+
+        Int32 lightCountLoc = material->getShaderLocation(StandardUniform::LightCount);
+        if (lightCountLoc >= 0) shader->setUniform1i(lightCountLoc, lightCount);
+
+        Int32 lightColorLoc = material->getShaderLocation(StandardUniform::LightColor);
+        if (lightColorLoc >= 0) shader->setUniform4fv(lightColorLoc, lightsPerPass, colors);
+
+        Int32 lightIntensityLoc = material->getShaderLocation(StandardUniform::LightIntensity);
+        if (lightIntensityLoc >= 0) shader->setUniform1fv(lightIntensityLoc, lightsPerPass, intensities);
+
+        Int32 lightTypeLoc = material->getShaderLocation(StandardUniform::LightType);
+        if (lightTypeLoc >= 0) shader->setUniform1iv(lightTypeLoc, lightsPerPass, types);
+
+        Int32 lightEnabledLoc = material->getShaderLocation(StandardUniform::LightEnabled);
+        if (lightEnabledLoc >= 0) shader->setUniform1iv(lightEnabledLoc, lightsPerPass, enabled);
+
+        Int32 lightShadowsEnabledLoc = material->getShaderLocation(StandardUniform::LightShadowsEnabled);
+        if (lightShadowsEnabledLoc >= 0) shader->setUniform1iv(lightShadowsEnabledLoc, lightsPerPass, shadowsEnabled);
+
+        Int32 lightMatrixLoc = material->getShaderLocation(StandardUniform::LightMatrix);
+        if (lightMatrixLoc >= 0) shader->setUniformMatrix4v(lightMatrixLoc, lightsPerPass, matrices);
+
+        Int32 lightAngularShadowBiasLoc = material->getShaderLocation(StandardUniform::LightAngularShadowBias);
+        if (lightAngularShadowBiasLoc >= 0) shader->setUniform1fv(lightAngularShadowBiasLoc, lightsPerPass, angularShadowBiases);
+
+        Int32 lightConstantShadowBiasLoc = material->getShaderLocation(StandardUniform::LightConstantShadowBias);
+        if (lightConstantShadowBiasLoc >= 0) shader->setUniform1fv(lightConstantShadowBiasLoc, lightsPerPass, constantShadowBiases);
+
+        Int32 lightShadowMapSizeLoc = material->getShaderLocation(StandardUniform::LightShadowMapSize);
+        if (lightShadowMapSizeLoc >= 0) shader->setUniform1fv(lightShadowMapSizeLoc, lightsPerPass, shadowMapSizes);
+
+        Int32 lightShadowSoftnessLoc = material->getShaderLocation(StandardUniform::LightShadowSoftness);
+        if (lightShadowSoftnessLoc >= 0) shader->setUniform1iv(lightShadowSoftnessLoc, lightsPerPass, shadowSoftnesses);
+
+        Int32 lightRangeLoc = material->getShaderLocation(StandardUniform::LightRange);
+        if (lightRangeLoc >= 0) shader->setUniform1fv(lightRangeLoc, lightsPerPass, ranges);
+
+        Int32 lightNearPlaneLoc = material->getShaderLocation(StandardUniform::LightNearPlane);
+        if (lightNearPlaneLoc >= 0) shader->setUniform1fv(lightNearPlaneLoc, lightsPerPass, nearPlanes);
+
+        Int32 lightPositionLoc = material->getShaderLocation(StandardUniform::LightPosition);
+        if (lightPositionLoc >= 0) shader->setUniform4fv(lightPositionLoc, lightsPerPass, positions);
+
+        Int32 lightDirectionLoc = material->getShaderLocation(StandardUniform::LightDirection);
+        if (lightDirectionLoc >= 0) shader->setUniform4fv(lightDirectionLoc, lightsPerPass, directions);
+
+        Int32 cascadeCountLoc = material->getShaderLocation(StandardUniform::LightCascadeCount);
+        if (cascadeCountLoc >= 0) shader->setUniform1iv(cascadeCountLoc, lightsPerPass, cascadeCounts);
+
+        Int32 viewProjectionLoc = material->getShaderLocation(StandardUniform::LightViewProjection, 0);
+        if (viewProjectionLoc >= 0) shader->setUniformMatrix4v(viewProjectionLoc, lightsPerPass * maxCascades, viewProjections);
+
+        Int32 cascadeEndLoc = material->getShaderLocation(StandardUniform::LightCascadeEnd, 0);
+        if (cascadeEndLoc >= 0) shader->setUniform1fv(cascadeEndLoc, lightsPerPass * maxCascades, cascadeEnds);
+
+        Int32 lightShadowMapAspectLoc = material->getShaderLocation(StandardUniform::LightShadowMapAspect, 0);
+        if (lightShadowMapAspectLoc >= 0) shader->setUniform1fv(lightShadowMapAspectLoc, lightsPerPass * maxCascades, shadowMapAspects);
+
+        if (irradianceMapLoc >= 0) shader->setUniform1iv(irradianceMapLoc, lightsPerPass, irradianceMapUnits);
+        if (specularIBLPreFilteredMapLoc >= 0) shader->setUniform1iv(specularIBLPreFilteredMapLoc, lightsPerPass, specularIBLPreFilteredMapUnits);
+        if (specularIBLBRDFMapLoc >= 0) shader->setUniform1iv(specularIBLBRDFMapLoc, lightsPerPass, specularIBLBRDFMapUnits);
+        if (lightShadowCubeMapLoc >= 0) shader->setUniform1iv(lightShadowCubeMapLoc, lightsPerPass, shadowCubeMapUnits);
+        if (shadowMapLoc >= 0) shader->setUniform1iv(shadowMapLoc, lightsPerPass * maxCascades, shadowMapUnits);
+
+        return currentTextureSlot;
+    }
+
+    /*
+     * Binds the cluster grid textures starting at [textureSlot]. Clustered lights are only
+     * accumulated when [enabled] is set so that they contribute once across additive passes.
+     */
+    void MeshRenderer::setClusteredLightingVars(WeakPointer<Material> material, WeakPointer<Shader> shader, LightClusterGrid* lightClusterGrid,
+                                                UInt32 textureSlot, Bool enabled) {
+        Int32 clusterEnabledLoc = material->getShaderLocation(StandardUniform::LightClusterEnabled);
+        Int32 clusterGridLoc = material->getShaderLocation(StandardUniform::LightClusterGrid);
+        Int32 clusterLightIndicesLoc = material->getShaderLocation(StandardUniform::LightClusterLightIndices);
+        Int32 clusterLightDataLoc = material->getShaderLocation(StandardUniform::LightClusterLightData);
+        Int32 clusterDimensionsLoc = material->getShaderLocation(StandardUniform::LightClusterDimensions);
+        Int32 clusterDepthParamsLoc = material->getShaderLocation(StandardUniform::LightClusterDepthParams);
+
+        enabled = enabled && lightClusterGrid != nullptr;
+        if (clusterEnabledLoc >= 0) {
+            shader->setUniform1i(clusterEnabledLoc, enabled ? 1 : 0);
+        }
+
+        UInt32 placeHolderTexture2DID = this->graphics->getPlaceHolderTexture2D()->getTextureID();
+        if (clusterGridLoc >= 0) {
+            shader->setTexture2D(textureSlot, clusterGridLoc, enabled ? lightClusterGrid->getClusterTexture()->getTextureID() : placeHolderTexture2DID);
+            textureSlot++;
+        }
+        if (clusterLightIndicesLoc >= 0) {
+            shader->setTexture2D(textureSlot, clusterLightIndicesLoc, enabled ? lightClusterGrid->getLightIndexTexture()->getTextureID() : placeHolderTexture2DID);
+            textureSlot++;
+        }
+        if (clusterLightDataLoc >= 0) {
+            shader->setTexture2D(textureSlot, clusterLightDataLoc, enabled ? lightClusterGrid->getLightDataTexture()->getTextureID() : placeHolderTexture2DID);
+            textureSlot++;
+        }
+
+        if (enabled) {
+            if (clusterDimensionsLoc >= 0) {
+                shader->setUniform4f(clusterDimensionsLoc, (Real)LightClusterGrid::TilesX, (Real)LightClusterGrid::TilesY,
+                                     (Real)LightClusterGrid::Slices, (Real)LightClusterGrid::LightIndexTextureWidth);
+            }
+            if (clusterDepthParamsLoc >= 0) {
+                shader->setUniform4f(clusterDepthParamsLoc, lightClusterGrid->getDepthScale(), lightClusterGrid->getDepthBias(), 0.0f, 0.0f);
+            }
+        }
     }
 
     Bool MeshRenderer::forwardRenderObject(const ViewDescriptor& viewDescriptor, WeakPointer<Mesh> mesh, const std::vector<WeakPointer<Light>>& lights,
                                            Bool matchPhysicalPropertiesWithLighting) {
-        WeakPointer<Material> material;
+        this->renderContainerMesh(viewDescriptor, mesh, lights, matchPhysicalPropertiesWithLighting, true, true);
+        return true;
+    }
+
+    /*
+     * Opaque, unskinned meshes drawn with a material that supports instancing are marked instanceable,
+     * keyed by mesh, so that the renderer can merge copies of the same mesh under different containers
+     * into one instanced draw. Instanced mesh containers are queued as a single item per mesh.
+     */
+    Bool MeshRenderer::enqueueForwardRender(const ViewDescriptor& viewDescriptor, MaterialGroupedRenderQueue& renderQueue) {
+        std::shared_ptr<MeshContainer> thisContainer = std::dynamic_pointer_cast<MeshContainer>(this->owner.lock());
+        if (!thisContainer) return true;
+
+        std::shared_ptr<InstancedMeshContainer> instancedContainer = std::dynamic_pointer_cast<InstancedMeshContainer>(thisContainer);
+        if (instancedContainer && instancedContainer->getInstanceCount() == 0) return true;
+
+        WeakPointer<Material> material = this->getRenderMaterial(viewDescriptor);
+        Bool instanceable = !instancedContainer && !material->isTransparent() && supportsInstancing(material);
+        const Matrix4x4& worldMatrix = this->owner->getTransform().getWorldMatrix();
+        const std::vector<PersistentWeakPointer<Mesh>>& renderables = thisContainer->getRenderables();
+        for (UInt32 i = 0; i < renderables.size(); i++) {
+            WeakPointer<Mesh> mesh = renderables[i];
+            Point3r center;
+            if (mesh->hasBoundingBox()) {
+                const Box3& box = mesh->getBoundingBox();
+                center.set((box.getMin().x + box.getMax().x) * 0.5f, (box.getMin().y + box.getMax().y) * 0.5f,
+                           (box.getMin().z + box.getMax().z) * 0.5f);
+            }
+            worldMatrix.transform(center);
+            viewDescriptor.viewInverseMatrix.transform(center);
+
+            // the camera looks down -Z, so distance in front of it is -z
+            RenderQueue::RenderItem& item = renderQueue.addRenderable(this, i, material, -center.z);
+            item.instanceable = instanceable && !(material->isSkinningEnabled() && thisContainer->hasVertexBoneMap(mesh->getObjectID()));
+            item.instanceKey = mesh->getObjectID();
+        }
+        return true;
+    }
+
+    Bool MeshRenderer::forwardRenderQueued(const ViewDescriptor& viewDescriptor, UInt32 renderableIndex, const std::vector<WeakPointer<Light>>& lights,
+                                           Bool matchPhysicalPropertiesWithLighting, Bool bindShader, Bool bindMaterial) {
+        std::shared_ptr<MeshContainer> thisContainer = std::dynamic_pointer_cast<MeshContainer>(this->owner.lock());
+        if (!thisContainer) return false;
+
+        const std::vector<PersistentWeakPointer<Mesh>>& renderables = thisContainer->getRenderables();
+        if (renderableIndex >= renderables.size()) return false;
+        this->renderContainerMesh(viewDescriptor, renderables[renderableIndex], lights, matchPhysicalPropertiesWithLighting, bindShader, bindMaterial);
+        return true;
+    }
+
+    Bool MeshRenderer::forwardRenderQueuedInstanced(const ViewDescriptor& viewDescriptor, UInt32 renderableIndex, const Matrix4x4* worldMatrices,
+                                                    UInt32 instanceCount, const std::vector<WeakPointer<Light>>& lights,
+                                                    Bool matchPhysicalPropertiesWithLighting, Bool bindShader, Bool bindMaterial) {
+        std::shared_ptr<MeshContainer> thisContainer = std::dynamic_pointer_cast<MeshContainer>(this->owner.lock());
+        if (!thisContainer || instanceCount == 0) return false;
+
+        const std::vector<PersistentWeakPointer<Mesh>>& renderables = thisContainer->getRenderables();
+        if (renderableIndex >= renderables.size()) return false;
+        this->renderMeshInstances(viewDescriptor, renderables[renderableIndex], nullptr, worldMatrices, instanceCount, lights,
+                                  matchPhysicalPropertiesWithLighting, bindShader, bindMaterial);
+        return true;
+    }
+
+    WeakPointer<Material> MeshRenderer::getRenderMaterial(const ViewDescriptor& viewDescriptor) {
         if (viewDescriptor.overrideMaterial.isValid()) {
-            material = viewDescriptor.overrideMaterial;
-        } else {
-            material = this->material;
+            return viewDescriptor.overrideMaterial;
+        }
+        return this->material;
+    }
+
+    /*
+     * Draws [mesh] with the owner's world matrix, or once per instance transform when the
+     * owner is an InstancedMeshContainer.
+     */
+    void MeshRenderer::renderContainerMesh(const ViewDescriptor& viewDescriptor, WeakPointer<Mesh> mesh, const std::vector<WeakPointer<Light>>& lights,
+                                           Bool matchPhysicalPropertiesWithLighting, Bool bindShader, Bool bindMaterial) {
+        const Matrix4x4& worldMatrix = this->owner->getTransform().getWorldMatrix();
+        std::shared_ptr<InstancedMeshContainer> instancedContainer = std::dynamic_pointer_cast<InstancedMeshContainer>(this->owner.lock());
+        if (instancedContainer) {
+            const std::vector<Matrix4x4>& instanceTransforms = instancedContainer->getInstanceTransforms();
+            if (instanceTransforms.size() > 0) {
+                this->renderMeshInstances(viewDescriptor, mesh, &worldMatrix, instanceTransforms.data(), (UInt32)instanceTransforms.size(),
+                                          lights, matchPhysicalPropertiesWithLighting, bindShader, bindMaterial);
+            }
+            return;
         }
+        this->renderMesh(viewDescriptor, mesh, worldMatrix, lights, matchPhysicalPropertiesWithLighting, bindShader, bindMaterial);
+    }
 
-        WeakPointer<Shader> shader = material->getShader();
-        this->graphics->activateShader(shader);
+    /*
+     * Draws [mesh] once for each of [matrices], pre-multiplied by [parentMatrix] if it is not null. Materials
+     * whose shaders read the per-instance model matrix get a single instanced draw per light pass, any other
+     * material falls back to one regular draw per instance.
+     */
+    void MeshRenderer::renderMeshInstances(const ViewDescriptor& viewDescriptor, WeakPointer<Mesh> mesh, const Matrix4x4* parentMatrix,
+                                           const Matrix4x4* matrices, UInt32 instanceCount, const std::vector<WeakPointer<Light>>& lights,
+                                           Bool matchPhysicalPropertiesWithLighting, Bool bindShader, Bool bindMaterial) {
+        WeakPointer<Material> material = this->getRenderMaterial(viewDescriptor);
+        if (supportsInstancing(material)) {
+            this->packInstanceTransforms(parentMatrix, matrices, instanceCount);
+            this->renderMesh(viewDescriptor, mesh, matrices[0], lights, matchPhysicalPropertiesWithLighting, bindShader, bindMaterial,
+                             this->instanceTransformData.data(), instanceCount);
+            return;
+        }
 
-        this->graphics->setColorWriteEnabled(material->getColorWriteEnabled());
-        this->graphics->setRenderStyle(material->getRenderStyle());
-        if (material->getBlendingMode() == RenderState::BlendingMode::Custom) {
-            graphics->setBlendingEnabled(true);
-            graphics->setBlendingFunction(material->getSourceBlendingMethod(), material->getDestBlendingMethod());
+        Matrix4x4 worldMatrix;
+        for (UInt32 i = 0; i < instanceCount; i++) {
+            if (parentMatrix != nullptr) Matrix4x4::multiply(*parentMatrix, matrices[i], worldMatrix);
+            else worldMatrix.copy(matrices[i]);
+            this->renderMesh(viewDescriptor, mesh, worldMatrix, lights, matchPhysicalPropertiesWithLighting,
+                             bindShader && i == 0, bindMaterial && i == 0);
         }
-        else {
-            graphics->setBlendingEnabled(false);
+    }
+
+    /*
+     * Fills [instanceTransformData] with the world matrix and the upper 3x3 of the world inverse-transpose
+     * matrix of each instance, in the layout described by Graphics::InstanceTransformSize.
+     */
+    void MeshRenderer::packInstanceTransforms(const Matrix4x4* parentMatrix, const Matrix4x4* matrices, UInt32 instanceCount) {
+        static const UInt32 stride = Graphics::InstanceTransformSize;
+        this->instanceTransformData.resize(instanceCount * stride);
+
+        Real* dest = this->instanceTransformData.data();
+        Real inverse[16];
+        for (UInt32 i = 0; i < instanceCount; i++, dest += stride) {
+            if (parentMatrix != nullptr) Matrix4x4::multiplyMM(parentMatrix->getConstData(), matrices[i].getConstData(), dest);
+            else memcpy(dest, matrices[i].getConstData(), sizeof(Real) * 16);
+
+            Matrix4x4::invert(dest, inverse);
+            for (UInt32 c = 0; c < 3; c++) {
+                for (UInt32 r = 0; r < 3; r++) {
+                    dest[16 + c * 3 + r] = inverse[r * 4 + c];
+                }
+            }
         }
-        
-        graphics->setDepthWriteEnabled(material->getDepthWriteEnabled());
-        graphics->setDepthTestEnabled(material->getDepthTestEnabled());
-        graphics->setDepthFunction(material->getDepthFunction());
+    }
+
+    Bool MeshRenderer::supportsInstancing(WeakPointer<Material> material) {
+        return material->getShaderLocation(StandardUniform::InstancingEnabled) >= 0 &&
+               material->getShaderLocation(StandardAttribute::InstanceModelMatrix) >= 0;
+    }
 
-        graphics->setFaceCullingEnabled(material->getFaceCullingEnabled());
-        graphics->setCullFace(material->getCullFace());
+    /*
+     * [bindShader] and [bindMaterial] can be false when the previous draw used the same shader
+     * or material, in which case the shader activation and the material's render state, custom
+     * uniforms and textures are assumed to still be in place. When [instanceTransforms] is set the
+     * mesh is drawn [instanceCount] times using those packed transforms and [worldMatrix] is ignored.
+     */
+    void MeshRenderer::renderMesh(const ViewDescriptor& viewDescriptor, WeakPointer<Mesh> mesh, const Matrix4x4& worldMatrix,
+                                  const std::vector<WeakPointer<Light>>& lights, Bool matchPhysicalPropertiesWithLighting,
+                                  Bool bindShader, Bool bindMaterial, const Real* instanceTransforms, UInt32 instanceCount) {
+        WeakPointer<Material> material = this->getRenderMaterial(viewDescriptor);
 
-        graphics->setStencilTestEnabled(material->getStencilTestEnabled());
-        graphics->setStencilWriteMask(material->getStencilWriteMask());
-        if (material->getStencilTestEnabled()) {
-            graphics->setStencilFunction(material->getStencilComparisonFunction(), material->getStencilRef(), material->getStencilReadMask());
-            graphics->setStencilOperation(material->getStencilFailActionStencil(), material->getStencilFailActionDepth(), material->getStencilAllPassAction());
+        WeakPointer<Shader> shader = material->getShader();
+        if (bindShader) {
+            this->graphics->activateShader(shader);
         }
 
-        // send custom uniforms first so that the renderer can override if necessary.
-        material->sendCustomUniformsToShader();
+        if (bindMaterial) {
+            this->graphics->setColorWriteEnabled(material->getColorWriteEnabled());
+            this->graphics->setRenderStyle(material->getRenderStyle());
+            if (material->getBlendingMode() == RenderState::BlendingMode::Custom) {
+                graphics->setBlendingEnabled(true);
+                graphics->setBlendingFunction(material->getSourceBlendingMethod(), material->getDestBlendingMethod());
+            }
+            else {
+                graphics->setBlendingEnabled(false);
+            }
+
+            graphics->setDepthWriteEnabled(material->getDepthWriteEnabled());
+            graphics->setDepthTestEnabled(material->getDepthTestEnabled());
+            graphics->setDepthFunction(material->getDepthFunction());
+
+            graphics->setFaceCullingEnabled(material->getFaceCullingEnabled());
+            graphics->setCullFace(material->getCullFace());
 
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::Position, StandardAttribute::Position, mesh->getVertexPositions());
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::Normal, StandardAttribute::Normal, mesh->getVertexNormals());
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::AveragedNormal, StandardAttribute::AveragedNormal, mesh->getVertexAveragedNormals());
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::FaceNormal, StandardAttribute::FaceNormal, mesh->getVertexFaceNormals());
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::Tangent, StandardAttribute::Tangent, mesh->getVertexTangents());
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::Color, StandardAttribute::Color, mesh->getVertexColors());
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::AlbedoUV, StandardAttribute::AlbedoUV, mesh->getVertexAlbedoUVs());
-        if (mesh->getVertexNormalUVs())
-            this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::NormalUV, StandardAttribute::NormalUV, mesh->getVertexNormalUVs());
-        else
-            this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::AlbedoUV, StandardAttribute::NormalUV, mesh->getVertexAlbedoUVs());
+            graphics->setStencilTestEnabled(material->getStencilTestEnabled());
+            graphics->setStencilWriteMask(material->getStencilWriteMask());
+            if (material->getStencilTestEnabled()) {
+                graphics->setStencilFunction(material->getStencilComparisonFunction(), material->getStencilRef(), material->getStencilReadMask());
+                graphics->setStencilOperation(material->getStencilFailActionStencil(), material->getStencilFailActionDepth(), material->getStencilAllPassAction());
+            }
+
+            // send custom uniforms first so that the renderer can override if necessary.
+            material->sendCustomUniformsToShader();
+        }
 
-        this->setSkinningVars(mesh, material, shader);
+        // the mesh's attribute setup is recorded in a vertex array the first time it is drawn with [shader]
+        if (!this->graphics->activateVertexArray(mesh->getObjectID(), shader->getObjectID())) {
+            this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::Position, StandardAttribute::Position, mesh->getVertexPositions());
+            this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::Normal, StandardAttribute::Normal, mesh->getVertexNormals());
+            this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::AveragedNormal, StandardAttribute::AveragedNormal, mesh->getVertexAveragedNormals());
+            this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::FaceNormal, StandardAttribute::FaceNormal, mesh->getVertexFaceNormals());
+            this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::Tangent, StandardAttribute::Tangent, mesh->getVertexTangents());
+            this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::Color, StandardAttribute::Color, mesh->getVertexColors());
+            this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::AlbedoUV, StandardAttribute::AlbedoUV, mesh->getVertexAlbedoUVs());
+            if (mesh->getVertexNormalUVs())
+                this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::NormalUV, StandardAttribute::NormalUV, mesh->getVertexNormalUVs());
+            else
+                this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::AlbedoUV, StandardAttribute::NormalUV, mesh->getVertexAlbedoUVs());
+        }
+
+        UInt32 firstLightingTextureSlot = this->setSkinningVars(mesh, material, shader, material->textureCount());
+
+        Bool instanced = instanceTransforms != nullptr && instanceCount > 0;
+        Int32 instancingEnabledLoc = material->getShaderLocation(StandardUniform::InstancingEnabled);
+        Int32 instanceModelMatrixLoc = material->getShaderLocation(StandardAttribute::InstanceModelMatrix);
+        Int32 instanceModelInverseTransposeMatrixLoc = material->getShaderLocation(StandardAttribute::InstanceModelInverseTransposeMatrix);
+        if (instancingEnabledLoc >= 0) {
+            shader->setUniform1i(instancingEnabledLoc, instanced ? 1 : 0);
+        }
+        if (instanced) {
+            this->graphics->bindInstanceTransforms(instanceTransforms, instanceCount, instanceModelMatrixLoc, instanceModelInverseTransposeMatrixLoc);
+        }
+        UInt32 drawInstanceCount = instanced ? instanceCount : 0;
 
         Int32 cameraPositionLoc = material->getShaderLocation(StandardUniform::CameraPosition);
         Int32 projectionLoc = material->getShaderLocation(StandardUniform::ProjectionMatrix);
@@ -137,13 +596,12 @@ namespace Core {
             shader->setUniformMatrix4(viewMatrixLoc, viewMatrix);
         }
 
-        if (modelMatrixLoc >= 0) {
-            const Matrix4x4& modelmatrix = this->owner->getTransform().getWorldMatrix();
-            shader->setUniformMatrix4(modelMatrixLoc, modelmatrix);
+        if (modelMatrixLoc >= 0 && !instanced) {
+            shader->setUniformMatrix4(modelMatrixLoc, worldMatrix);
         }
 
-        if (modelInverseTransposeMatrixLoc >= 0) {
-            Matrix4x4 modelInverseTransposeMatrix = this->owner->getTransform().getWorldMatrix();
+        if (modelInverseTransposeMatrixLoc >= 0 && !instanced) {
+            Matrix4x4 modelInverseTransposeMatrix = worldMatrix;
             modelInverseTransposeMatrix.invert();
             modelInverseTransposeMatrix.transpose();
             shader->setUniformMatrix4(modelInverseTransposeMatrixLoc, modelInverseTransposeMatrix);
@@ -154,26 +612,43 @@ namespace Core {
             shader->setUniformMatrix4(viewInverseTransposeMatrixLoc, viewInverseTransposeMatrix);
         }
 
-        UInt32 currentTextureSlot = material->textureCount();
-
         Int32 lightEnabledLoc = material->getShaderLocation(StandardUniform::LightEnabled);
-        Int32 lightShadowsEnabledLoc = material->getShaderLocation(StandardUniform::LightShadowsEnabled);
 
         if (lights.size() > 0 && material->isLit()) {
 
-            if (lightEnabledLoc >= 0) {
-                shader->setUniform1i(lightEnabledLoc, 1);
-            }
-
+            // lights are gathered into batches of up to [lightsPerPass], each batch
+            // is rendered in a single draw call and additively blended with the previous ones.
+            WeakPointer<Light> passLights[Constants::MaxShaderLights];
+            UInt32 lightsPerPass = material->getLightsPerPass();
             UInt32 renderedCount = 0;
-            for (UInt32 i = 0; i < lights.size(); i++) {
-
-                WeakPointer<Light> light = lights[i];
-                LightType lightType = light->getType();
-                if (lightType == LightType::AmbientIBL && !material->isPhysical()) continue;
-                if (matchPhysicalPropertiesWithLighting) {
-                    if (lightType == LightType::Ambient && material->isPhysical()) continue;
+            UInt32 lightIndex = 0;
+
+            // lights binned into the cluster grid are shaded in the first pass by materials that support it
+            Bool clusteredLighting = material->getShaderLocation(StandardUniform::LightClusterEnabled) >= 0;
+            LightClusterGrid* lightClusterGrid = clusteredLighting ? viewDescriptor.lightClusterGrid : nullptr;
+            UInt32 clusteredLightIndex = 0;
+            do {
+
+                UInt32 passLightCount = 0;
+                while (lightIndex < lights.size() && passLightCount < lightsPerPass) {
+                    WeakPointer<Light> light = lights[lightIndex];
+                    lightIndex++;
+
+                    LightType lightType = light->getType();
+                    if (lightType == LightType::AmbientIBL && !material->isPhysical()) continue;
+                    if (matchPhysicalPropertiesWithLighting) {
+                        if (lightType == LightType::Ambient && material->isPhysical()) continue;
+                    }
+                    // the grid holds the first getLightCount() clustered lights, any beyond that use the regular passes
+                    if (lightClusterGrid != nullptr && LightClusterGrid::isClusteredLight(light) &&
+                        clusteredLightIndex < lightClusterGrid->getLightCount()) {
+                        clusteredLightIndex++;
+                        continue;
+                    }
+                    passLights[passLightCount] = light;
+                    passLightCount++;
                 }
+                if (passLightCount == 0 && (renderedCount > 0 || lightClusterGrid == nullptr)) break;
 
                 if (material->getBlendingMode() == RenderState::BlendingMode::Additive) {
                     if (renderedCount == 0) {
@@ -184,205 +659,13 @@ namespace Core {
                     }
                 }
 
-                Int32 lightRangeLoc = material->getShaderLocation(StandardUniform::LightRange, 0);
-                Int32 lightTypeLoc = material->getShaderLocation(StandardUniform::LightType, 0);
-                Int32 lightIntensityLoc = material->getShaderLocation(StandardUniform::LightIntensity, 0);
-                Int32 lightColorLoc = material->getShaderLocation(StandardUniform::LightColor, 0);
-                Int32 lightMatrixLoc = material->getShaderLocation(StandardUniform::LightMatrix, 0);
-                Int32 lightAngularShadowBiasLoc = material->getShaderLocation(StandardUniform::LightAngularShadowBias, 0);
-                Int32 lightConstantShadowBiasLoc = material->getShaderLocation(StandardUniform::LightConstantShadowBias, 0);
-                Int32 lightShadowMapSizeLoc = material->getShaderLocation(StandardUniform::LightShadowMapSize, 0);
-                Int32 lightShadowSoftnessLoc = material->getShaderLocation(StandardUniform::LightShadowSoftness, 0);
-                Int32 lightNearPlaneLoc = material->getShaderLocation(StandardUniform::LightNearPlane, 0);
-                Int32 lightCountLoc = material->getShaderLocation(StandardUniform::LightCount, 0);
-
-                if (lightCountLoc >= 0) {
-                    shader->setUniform1i(lightCountLoc, 1);
-                }
-
-                if (lightColorLoc >= 0) {
-                    Color color = light->getColor();
-                    shader->setUniform4f(lightColorLoc, color.r, color.g, color.b, color.a);
-                }
-
-                if (lightTypeLoc >= 0) {
-                    shader->setUniform1i(lightTypeLoc, (Int32)lightType);
-                }
-
-                if (lightIntensityLoc >= 0) {
-                    shader->setUniform1f(lightIntensityLoc, light->getIntensity());
-                }
-
-                if (lightMatrixLoc >= 0) {
-                    shader->setUniformMatrix4(lightMatrixLoc, light->getOwner()->getTransform().getConstInverseWorldMatrix());
-                }
-
-                Int32 irradianceMapLoc = material->getShaderLocation(StandardUniform::LightIrradianceMap);
-                Int32 specularIBLPreFilteredMapLoc = material->getShaderLocation(StandardUniform::LightSpecularIBLPreFilteredMap);
-                Int32 specularIBLBRDFMapLoc = material->getShaderLocation(StandardUniform::LightSpecularIBLBRDFMap);
-
-                if (lightType == LightType::AmbientIBL) {
-                    WeakPointer<AmbientIBLLight> ambientIBLLight = WeakPointer<Light>::dynamicPointerCast<AmbientIBLLight>(light);
-
-                    if (irradianceMapLoc >= 0) {
-                        shader->setTextureCube(currentTextureSlot, irradianceMapLoc, ambientIBLLight->getIrradianceMap()->getTextureID());
-                        currentTextureSlot++;
-                    }
-                    
-                    if (specularIBLPreFilteredMapLoc >= 0) {
-                        shader->setTextureCube(currentTextureSlot, specularIBLPreFilteredMapLoc, ambientIBLLight->getSpecularIBLPreFilteredMap()->getTextureID());
-                        currentTextureSlot++;
-                    }
-                    
-                    if (specularIBLBRDFMapLoc >= 0) {
-                        shader->setTexture2D(currentTextureSlot, specularIBLBRDFMapLoc, ambientIBLLight->getSpecularIBLBRDFMap()->getTextureID());
-                        currentTextureSlot++;
-                    }
-                } else {
-                    if (irradianceMapLoc >= 0) {
-                        shader->setTextureCube(currentTextureSlot, irradianceMapLoc, this->graphics->getPlaceHolderCubeTexture()->getTextureID());
-                        currentTextureSlot++;
-                    }
-                    
-                    if (specularIBLPreFilteredMapLoc >= 0) {
-                        shader->setTextureCube(currentTextureSlot, specularIBLPreFilteredMapLoc, this->graphics->getPlaceHolderCubeTexture()->getTextureID());
-                        currentTextureSlot++;
-                    }
-                    
-                    if (specularIBLBRDFMapLoc >= 0) {
-                        shader->setTexture2D(currentTextureSlot, specularIBLBRDFMapLoc, this->graphics->getPlaceHolderTexture2D()->getTextureID());
-                        currentTextureSlot++;
-                    }
-                }
-
-                if (lightType == LightType::Point || lightType == LightType::Directional) {
-                    WeakPointer<ShadowLight> shadowLight = WeakPointer<Light>::dynamicPointerCast<ShadowLight>(light);
-
-                    if (lightAngularShadowBiasLoc >= 0) {
-                        shader->setUniform1f(lightAngularShadowBiasLoc, shadowLight->getAngularShadowBias());
-                    }
-
-                    if (lightShadowMapSizeLoc >= 0) {
-                        shader->setUniform1f(lightShadowMapSizeLoc, shadowLight->getShadowMapSize());
-                    }
-
-                    if (lightConstantShadowBiasLoc >= 0) {
-                        shader->setUniform1f(lightConstantShadowBiasLoc, shadowLight->getConstantShadowBias());
-                    }
-
-                    if (lightShadowSoftnessLoc >= 0) {
-                        shader->setUniform1i(lightShadowSoftnessLoc, (UInt32)shadowLight->getShadowSoftness());
-                    }
-                }
-
-                Int32 lightShadowCubeMapLoc = material->getShaderLocation(StandardUniform::LightShadowCubeMap);
-                if (lightType == LightType::Point) {
-
-                    WeakPointer<PointLight> pointLight = WeakPointer<Light>::dynamicPointerCast<PointLight>(light);
-
-                    if (lightRangeLoc >= 0) {
-                        shader->setUniform1f(lightRangeLoc, pointLight->getRadius());
-                    }
-
-                    if (lightNearPlaneLoc >= 0) {
-                        shader->setUniform1f(lightNearPlaneLoc, PointLight::NearPlane);
-                    }
-
-                    Int32 lightPositionLoc = material->getShaderLocation(StandardUniform::LightPosition);
-                    if (lightPositionLoc >= 0) {
-                        Point3r pos;
-                        pointLight->getOwner()->getTransform().applyTransformationTo(pos);
-                        shader->setUniform4f(lightPositionLoc, pos.x, pos.y, pos.z, 1.0f);
-                    }
-
-                    if (lightShadowsEnabledLoc >= 0) {
-                        shader->setUniform1i(lightShadowsEnabledLoc, pointLight->getShadowsEnabled() ? 1.0 : 0.0);
-                    } 
-
-                    if (lightShadowCubeMapLoc >= 0) {
-                        if (pointLight->getShadowsEnabled())
-                            shader->setTextureCube(currentTextureSlot, lightShadowCubeMapLoc, pointLight->getShadowMap()->getColorTexture()->getTextureID());
-                        else
-                            shader->setTextureCube(currentTextureSlot, lightShadowCubeMapLoc, this->graphics->getPlaceHolderCubeTexture()->getTextureID());
-                        currentTextureSlot++;
-                    }
-                } else {
-                    if (lightShadowCubeMapLoc >= 0) {
-                        shader->setTextureCube(currentTextureSlot, lightShadowCubeMapLoc, this->graphics->getPlaceHolderCubeTexture()->getTextureID());
-                        currentTextureSlot++;
-                    }
-                }
-                
-                
-                if (lightType == LightType::Directional) {
-                    WeakPointer<DirectionalLight> directionalLight = WeakPointer<Light>::dynamicPointerCast<DirectionalLight>(light);
-
-                    Int32 lightDirectionLoc = material->getShaderLocation(StandardUniform::LightDirection);
-                    if (lightDirectionLoc >= 0) {
-                        Vector3r dir = Vector3r::Forward;
-                        directionalLight->getOwner()->getTransform().applyTransformationTo(dir);
-                        shader->setUniform4f(lightDirectionLoc, dir.x, dir.y, dir.z, 0.0f);
-                    }
-
-                    UInt32 cascadeCount = directionalLight->getCascadeCount();
-
-                    Int32 cascadeCountLoc = material->getShaderLocation(StandardUniform::LightCascadeCount);
-                    if (cascadeCountLoc >= 0) {
-                        shader->setUniform1i(cascadeCountLoc, cascadeCount);
-                    }
-
-                    if (lightShadowsEnabledLoc >= 0) {
-                        shader->setUniform1i(lightShadowsEnabledLoc, directionalLight->getShadowsEnabled() ? 1.0 : 0.0);
-                    } 
-
-                    for (UInt32 l = 0; l < cascadeCount; l++) {
-                        Int32 shadowMapLoc = material->getShaderLocation(StandardUniform::LightShadowMap, l);
-                        if (shadowMapLoc >= 0) {
-                            if (directionalLight->getShadowsEnabled()) {
-                                shader->setTexture2D(currentTextureSlot, shadowMapLoc, directionalLight->getShadowMap(l)->getDepthTexture()->getTextureID());
-                            } else {
-                                shader->setTexture2D(currentTextureSlot, shadowMapLoc, this->graphics->getPlaceHolderTexture2D()->getTextureID());
-                            }
-                            currentTextureSlot++;
-                        } 
-
-                        Int32 viewProjectionLoc = material->getShaderLocation(StandardUniform::LightViewProjection, l);
-                        if (viewProjectionLoc >= 0) {
-                            shader->setUniformMatrix4(viewProjectionLoc, directionalLight->getViewProjectionMatrix(l));
-                        }
-
-                        Int32 cascadeEndLoc = material->getShaderLocation(StandardUniform::LightCascadeEnd, l);
-                        if (cascadeEndLoc >= 0) {
-                            shader->setUniform1f(cascadeEndLoc, directionalLight->getCascadeBoundary(l + 1));
-                        }
-
-                        Int32 lightShadowMapAspectLoc = material->getShaderLocation(StandardUniform::LightShadowMapAspect, l);
-                        if (lightShadowMapAspectLoc >= 0) {
-                            DirectionalLight::OrthoProjection& proj = directionalLight->getProjection(l);
-                            Real aspect = Math::abs((proj.right - proj.left) / (proj.top - proj.bottom));
-                            shader->setUniform1f(lightShadowMapAspectLoc, aspect);
-                        }
-                    }
-
-                    for (UInt32 l = cascadeCount; l < Constants::MaxDirectionalCascades; l++) {
-                        Int32 shadowMapLoc = material->getShaderLocation(StandardUniform::LightShadowMap, l);
-                        if (shadowMapLoc >= 0) {
-                            shader->setTexture2D(currentTextureSlot, shadowMapLoc, this->graphics->getPlaceHolderTexture2D()->getTextureID());
-                            currentTextureSlot++;
-                        }
-                    }
-                } else {
-                    for (UInt32 l = 0; l < Constants::MaxDirectionalCascades; l++) {
-                        Int32 shadowMapLoc = material->getShaderLocation(StandardUniform::LightShadowMap, l);
-                        if (shadowMapLoc >= 0) {
-                            shader->setTexture2D(currentTextureSlot, shadowMapLoc, this->graphics->getPlaceHolderTexture2D()->getTextureID());
-                            currentTextureSlot++;
-                        }
-                    }
+                UInt32 textureSlot = this->setLightingVars(material, shader, passLights, passLightCount, firstLightingTextureSlot);
+                if (clusteredLighting) {
+                    this->setClusteredLightingVars(material, shader, lightClusterGrid, textureSlot, renderedCount == 0);
                 }
                 renderedCount++;
-                this->drawMesh(mesh);
-            }
+                this->drawMesh(mesh, drawInstanceCount);
+            } while (lightIndex < lights.size());
 
         } else {
             if (material->isLit()) {
@@ -392,18 +675,14 @@ namespace Core {
             if (lightEnabledLoc >= 0) {
                 shader->setUniform1i(lightEnabledLoc, 0);
             }
-            this->drawMesh(mesh);
+            this->drawMesh(mesh, drawInstanceCount);
         }
 
-        this->disableShaderAttribute(mesh, material, StandardAttribute::Position, mesh->getVertexPositions());
-        this->disableShaderAttribute(mesh, material, StandardAttribute::Normal, mesh->getVertexNormals());
-        this->disableShaderAttribute(mesh, material, StandardAttribute::AveragedNormal, mesh->getVertexAveragedNormals());
-        this->disableShaderAttribute(mesh, material, StandardAttribute::FaceNormal, mesh->getVertexFaceNormals());
-        this->disableShaderAttribute(mesh, material, StandardAttribute::Tangent, mesh->getVertexTangents());
-        this->disableShaderAttribute(mesh, material, StandardAttribute::Color, mesh->getVertexColors());
-        this->disableShaderAttribute(mesh, material, StandardAttribute::AlbedoUV, mesh->getVertexAlbedoUVs());
-        this->disableShaderAttribute(mesh, material, StandardAttribute::NormalUV, mesh->getVertexNormalUVs());
+        if (instanced) {
+            this->graphics->unbindInstanceTransforms(instanceModelMatrixLoc, instanceModelInverseTransposeMatrixLoc);
+        }
 
+        // bone attributes depend on the container rather than the mesh, so they are not kept in its vertex array
          if (material->isSkinningEnabled()) {
             std::shared_ptr<MeshContainer> thisContainer = std::dynamic_pointer_cast<MeshContainer>(this->owner.lock());
             if (thisContainer) {
@@ -414,8 +693,6 @@ namespace Core {
                 }
             }
         }
-
-        return true;
     }
 
     Bool MeshRenderer::forwardRender(const ViewDescriptor& viewDescriptor, const std::vector<WeakPointer<Light>>& lights,
@@ -451,6 +728,13 @@ namespace Core {
             if (array->getGPUStorage()) {
                 array->getGPUStorage()->sendToShader(shaderLocation);
             }
+            else if (mesh->isInterleaved() && shaderLocation >= 0) {
+                Int32 offset = mesh->getInterleavedOffset(checkAttribute);
+                if (offset >= 0) {
+                    mesh->getInterleavedGPUStorage()->sendToShader(shaderLocation, array->getComponentCount(),
+                                                                   mesh->getInterleavedStride(), offset);
+                }
+            }
         }
     }
 
@@ -464,7 +748,18 @@ namespace Core {
         }
     }
 
-    void MeshRenderer::drawMesh(WeakPointer<Mesh> mesh) {
+    /*
+     * An [instanceCount] of 0 issues a regular, non-instanced draw.
+     */
+    void MeshRenderer::drawMesh(WeakPointer<Mesh> mesh, UInt32 instanceCount) {
+        if (instanceCount > 0) {
+            if (mesh->isIndexed()) {
+                this->graphics->drawBoundVertexBufferInstanced(mesh->getIndexCount(), mesh->getIndexBuffer(), instanceCount);
+            } else {
+                this->graphics->drawBoundVertexBufferInstanced(mesh->getVertexCount(), instanceCount);
+            }
+            return;
+        }
         if (mesh->isIndexed()) {
             this->graphics->drawBoundVertexBuffer(mesh->getIndexCount(), mesh->getIndexBuffer());
         } else {
@@ -17,6 +17,9 @@ namespace Core {
     class Shader;
     class AttributeArrayBase;
     class Mesh;
+    class LightClusterGrid;
+    class MaterialGroupedRenderQueue;
+    class Matrix4x4;
     
     class MeshRenderer : public ObjectRenderer<Mesh> {
         friend class Engine;
@@ -27,19 +30,41 @@ namespace Core {
                                    Bool matchPhysicalPropertiesWithLighting) override;
         virtual Bool forwardRenderObject(const ViewDescriptor& viewDescriptor, WeakPointer<Mesh> mesh,
                                          const std::vector<WeakPointer<Light>>& lights, Bool matchPhysicalPropertiesWithLighting) override;
+        virtual Bool enqueueForwardRender(const ViewDescriptor& viewDescriptor, MaterialGroupedRenderQueue& renderQueue) override;
+        virtual Bool forwardRenderQueued(const ViewDescriptor& viewDescriptor, UInt32 renderableIndex, const std::vector<WeakPointer<Light>>& lights,
+                                         Bool matchPhysicalPropertiesWithLighting, Bool bindShader, Bool bindMaterial) override;
+        virtual Bool forwardRenderQueuedInstanced(const ViewDescriptor& viewDescriptor, UInt32 renderableIndex, const Matrix4x4* worldMatrices,
+                                                  UInt32 instanceCount, const std::vector<WeakPointer<Light>>& lights,
+                                                  Bool matchPhysicalPropertiesWithLighting, Bool bindShader, Bool bindMaterial) override;
         virtual Bool supportsRenderPath(RenderPath renderPath) override;
         void setMaterial(WeakPointer<Material> material);
         WeakPointer<Material> getMaterial();
 
     private:
         MeshRenderer(WeakPointer<Graphics> graphics, WeakPointer<Material> material, WeakPointer<Object3D> owner);
+        WeakPointer<Material> getRenderMaterial(const ViewDescriptor& viewDescriptor);
+        void renderMesh(const ViewDescriptor& viewDescriptor, WeakPointer<Mesh> mesh, const Matrix4x4& worldMatrix,
+                        const std::vector<WeakPointer<Light>>& lights, Bool matchPhysicalPropertiesWithLighting,
+                        Bool bindShader, Bool bindMaterial, const Real* instanceTransforms = nullptr, UInt32 instanceCount = 0);
+        void renderMeshInstances(const ViewDescriptor& viewDescriptor, WeakPointer<Mesh> mesh, const Matrix4x4* parentMatrix,
+                                 const Matrix4x4* matrices, UInt32 instanceCount, const std::vector<WeakPointer<Light>>& lights,
+                                 Bool matchPhysicalPropertiesWithLighting, Bool bindShader, Bool bindMaterial);
+        void renderContainerMesh(const ViewDescriptor& viewDescriptor, WeakPointer<Mesh> mesh, const std::vector<WeakPointer<Light>>& lights,
+                                 Bool matchPhysicalPropertiesWithLighting, Bool bindShader, Bool bindMaterial);
+        void packInstanceTransforms(const Matrix4x4* parentMatrix, const Matrix4x4* matrices, UInt32 instanceCount);
+        static Bool supportsInstancing(WeakPointer<Material> material);
         void checkAndSetShaderAttribute(WeakPointer<Mesh> mesh, WeakPointer<Material> material, StandardAttribute checkAttribute,
                                         StandardAttribute setAttribute, WeakPointer<AttributeArrayBase> array, Bool force = false);
         void disableShaderAttribute(WeakPointer<Mesh> mesh, WeakPointer<Material> material, StandardAttribute attribute,
                                     WeakPointer<AttributeArrayBase> array);
-        void setSkinningVars(WeakPointer<Mesh> mesh, WeakPointer<Material> material, WeakPointer<Shader> shader);
-        void drawMesh(WeakPointer<Mesh> mesh);
+        UInt32 setSkinningVars(WeakPointer<Mesh> mesh, WeakPointer<Material> material, WeakPointer<Shader> shader, UInt32 firstTextureSlot);
+        UInt32 setLightingVars(WeakPointer<Material> material, WeakPointer<Shader> shader, WeakPointer<Light>* lights, UInt32 lightCount,
+                               UInt32 firstTextureSlot);
+        void setClusteredLightingVars(WeakPointer<Material> material, WeakPointer<Shader> shader, LightClusterGrid* lightClusterGrid,
+                                      UInt32 textureSlot, Bool enabled);
+        void drawMesh(WeakPointer<Mesh> mesh, UInt32 instanceCount);
 
         PersistentWeakPointer<Material> material;
+        std::vector<Real> instanceTransformData;
     };
 }
@@ -1,13 +1,150 @@
+#include <cstring>
+
 #include "RenderQueue.h"
+#include "../common/Exception.h"
 
 namespace Core {
 
-    RenderQueue::RenderQueue(UInt32 initialCapacity): renderItems(initialCapacity) {
-
+    RenderQueue::RenderQueue(UInt32 initialCapacity): itemCount(0) {
+        this->renderItems.resize(initialCapacity);
+        this->sortKeys.reserve(initialCapacity);
+        this->sortKeysScratch.reserve(initialCapacity);
+        this->sortedIndices.reserve(initialCapacity);
+        this->sortedIndicesScratch.reserve(initialCapacity);
     }
 
+    /*
+     * Items are recycled between frames, so clearing only resets the count.
+     */
     void RenderQueue::clear() {
-        this->renderItems.returnAll();
+        this->itemCount = 0;
+        this->sortedIndices.resize(0);
+    }
+
+    RenderQueue::RenderItem& RenderQueue::addItem(UInt32 layer, Bool transparent, UInt32 shaderID, UInt32 textureID,
+                                                  UInt32 materialID, Real viewDepth) {
+        if (this->itemCount >= this->renderItems.size()) {
+            this->renderItems.resize(this->renderItems.size() > 0 ? this->renderItems.size() * 2 : 32);
+        }
+        RenderItem& item = this->renderItems[this->itemCount];
+        this->itemCount++;
+        item.sortKey = buildSortKey(layer, transparent, shaderID, textureID, materialID);
+        item.viewDepth = viewDepth;
+        item.renderer = nullptr;
+        item.renderableIndex = 0;
+        item.instanceable = false;
+        item.instanceKey = 0;
+        return item;
+    }
+
+    UInt32 RenderQueue::getItemCount() const {
+        return this->itemCount;
+    }
+
+    /*
+     * Returns the item at [index] in sorted order; only valid after sort().
+     */
+    RenderQueue::RenderItem& RenderQueue::getItem(UInt32 index) {
+        if (index >= this->sortedIndices.size()) {
+            throw OutOfRangeException("RenderQueue::getItem() -> 'index' is out of range.");
+        }
+        return this->renderItems[this->sortedIndices[index]];
+    }
+
+    UInt64 RenderQueue::buildSortKey(UInt32 layer, Bool transparent, UInt32 shaderID, UInt32 textureID, UInt32 materialID) {
+        UInt64 key = (UInt64)(layer & ((1 << LayerBits) - 1)) << (64 - LayerBits);
+        UInt64 shader = shaderID & ((1 << ShaderBits) - 1);
+        UInt64 texture = textureID & ((1 << TextureBits) - 1);
+        UInt64 material = materialID & ((1 << MaterialBits) - 1);
+        UInt64 state = (shader << (TextureBits + MaterialBits)) | (texture << MaterialBits) | material;
+        if (transparent) {
+            key |= (UInt64)1 << (63 - LayerBits);
+            key |= state;
+        }
+        else {
+            key |= state << DepthBits;
+        }
+        return key;
+    }
+
+    /*
+     * Quantizes each item's view depth over the depth range of the whole queue, merges it into
+     * the item's key (inverted for transparent items so they draw back-to-front) and sorts.
+     */
+    void RenderQueue::sort() {
+        this->sortKeys.resize(this->itemCount);
+        this->sortedIndices.resize(this->itemCount);
+        if (this->itemCount == 0) return;
+
+        Real minDepth = this->renderItems[0].viewDepth;
+        Real maxDepth = minDepth;
+        for (UInt32 i = 1; i < this->itemCount; i++) {
+            Real depth = this->renderItems[i].viewDepth;
+            if (depth < minDepth) minDepth = depth;
+            if (depth > maxDepth) maxDepth = depth;
+        }
+
+        const UInt64 maxDepthValue = ((UInt64)1 << DepthBits) - 1;
+        const UInt64 transparentBit = (UInt64)1 << (63 - LayerBits);
+        const UInt32 transparentDepthShift = ShaderBits + TextureBits + MaterialBits;
+        Real depthScale = maxDepth > minDepth ? (Real)maxDepthValue / (maxDepth - minDepth) : 0.0f;
+        for (UInt32 i = 0; i < this->itemCount; i++) {
+            const RenderItem& item = this->renderItems[i];
+            UInt64 depth = (UInt64)((item.viewDepth - minDepth) * depthScale);
+            if (depth > maxDepthValue) depth = maxDepthValue;
+            if (item.sortKey & transparentBit) {
+                this->sortKeys[i] = item.sortKey | ((maxDepthValue - depth) << transparentDepthShift);
+            }
+            else {
+                this->sortKeys[i] = item.sortKey | depth;
+            }
+            this->sortedIndices[i] = i;
+        }
+
+        this->radixSort();
+    }
+
+    /*
+     * Stable LSD radix sort of [sortKeys] (and [sortedIndices] along with them), one byte per pass.
+     * All eight histograms are gathered in a single sweep and passes in which every key shares the
+     * same byte are skipped, which is common for the layer and state bytes.
+     */
+    void RenderQueue::radixSort() {
+        static const UInt32 DigitCount = 8;
+        static const UInt32 BucketCount = 256;
+        UInt32 histograms[DigitCount][BucketCount];
+        memset(histograms, 0, sizeof(histograms));
+
+        for (UInt32 i = 0; i < this->itemCount; i++) {
+            UInt64 key = this->sortKeys[i];
+            for (UInt32 d = 0; d < DigitCount; d++) {
+                histograms[d][(key >> (d * 8)) & 0xFF]++;
+            }
+        }
+
+        this->sortKeysScratch.resize(this->itemCount);
+        this->sortedIndicesScratch.resize(this->itemCount);
+        for (UInt32 d = 0; d < DigitCount; d++) {
+            UInt32* histogram = histograms[d];
+            UInt32 shift = d * 8;
+            if (histogram[(this->sortKeys[0] >> shift) & 0xFF] == this->itemCount) continue;
+
+            UInt32 offset = 0;
+            for (UInt32 b = 0; b < BucketCount; b++) {
+                UInt32 count = histogram[b];
+                histogram[b] = offset;
+                offset += count;
+            }
+
+            for (UInt32 i = 0; i < this->itemCount; i++) {
+                UInt64 key = this->sortKeys[i];
+                UInt32 destination = histogram[(key >> shift) & 0xFF]++;
+                this->sortKeysScratch[destination] = key;
+                this->sortedIndicesScratch[destination] = this->sortedIndices[i];
+            }
+            this->sortKeys.swap(this->sortKeysScratch);
+            this->sortedIndices.swap(this->sortedIndicesScratch);
+        }
     }
 
-}
\ No newline at end of file
+}
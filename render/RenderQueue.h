@@ -1,25 +1,66 @@
 #pragma once
 
+#include <vector>
+
 #include "../common/types.h"
-#include "../util/ObjectPool.h"
+#include "../util/WeakPointer.h"
 
 namespace Core {
 
+    // forward declarations
+    class BaseObjectRenderer;
+    class Material;
+
+    /*
+     * Collects the draws for a single view and orders them by a 64-bit sort key. From the most
+     * significant bit down the key is laid out as:
+     *
+     *   opaque:       layer (4) | 0 | shader (12) | texture (10) | material (12) | depth, front-to-back (25)
+     *   transparent:  layer (4) | 1 | depth, back-to-front (25) | shader (12) | texture (10) | material (12)
+     *
+     * Depth bits are only filled in by sort(), once the depth range of all queued items is known.
+     */
     class RenderQueue {
     public:
 
         class RenderItem {
         public:
-            
+            UInt64 sortKey;
+            Real viewDepth;
+            BaseObjectRenderer* renderer;
+            UInt32 renderableIndex;
+            WeakPointer<Material> material;
+            // items with the same material and [instanceKey] may be merged into one instanced draw
+            Bool instanceable;
+            UInt64 instanceKey;
         };
 
+        static const UInt32 LayerBits = 4;
+        static const UInt32 ShaderBits = 12;
+        static const UInt32 TextureBits = 10;
+        static const UInt32 MaterialBits = 12;
+        static const UInt32 DepthBits = 25;
+
         RenderQueue(UInt32 initialCapacity);
         void clear();
+        RenderItem& addItem(UInt32 layer, Bool transparent, UInt32 shaderID, UInt32 textureID, UInt32 materialID, Real viewDepth);
+        void sort();
+        UInt32 getItemCount() const;
+        RenderItem& getItem(UInt32 index);
+
+        static UInt64 buildSortKey(UInt32 layer, Bool transparent, UInt32 shaderID, UInt32 textureID, UInt32 materialID);
 
     protected:
-        ObjectPool<RenderItem> renderItems;
+        std::vector<RenderItem> renderItems;
+        UInt32 itemCount;
 
     private:
+        void radixSort();
+
+        std::vector<UInt64> sortKeys;
+        std::vector<UInt64> sortKeysScratch;
+        std::vector<UInt32> sortedIndices;
+        std::vector<UInt32> sortedIndicesScratch;
     };
 
-}
\ No newline at end of file
+}
@@ -10,12 +10,15 @@
 #include "../math/Matrix4x4.h"
 #include "../render/BaseRenderableContainer.h"
 #include "../render/MeshRenderer.h"
+#include "../render/MeshContainer.h"
+#include "../render/InstancedMeshContainer.h"
 #include "../render/RenderableContainer.h"
 #include "../scene/Scene.h"
 #include "../scene/Skybox.h"
 #include "../image/TextureAttr.h"
 #include "../image/Texture.h"
 #include "../image/Texture2D.h"
+#include "../material/Shader.h"
 #include "../material/DepthOnlyMaterial.h"
 #include "../material/BasicColoredMaterial.h"
 #include "../material/DistanceOnlyMaterial.h"
@@ -25,16 +28,23 @@
 #include "../material/SpecularIBLBRDFRendererMaterial.h"
 #include "../math/Matrix4x4.h"
 #include "../math/Quaternion.h"
+#include "../math/Math.h"
 #include "../light/PointLight.h"
 #include "../light/AmbientIBLLight.h"
 #include "../geometry/Mesh.h"
+#include "../geometry/Frustum.h"
 #include "ReflectionProbe.h"
 
 
 namespace Core {
 
-    Renderer::Renderer() {
-        
+    Renderer::Renderer(): renderQueue(256) {
+        this->frameIndex = 0;
+        this->frustumCullingEnabled = true;
+        this->visibleObjectCount = 0;
+        this->culledObjectCount = 0;
+        this->clusteredLightingEnabled = true;
+        this->instancingEnabled = true;
     }
 
     Renderer::~Renderer() {
@@ -75,8 +85,12 @@ namespace Core {
         lightList.resize(0);
         nonIBLLightList.resize(0);
         reflectionProbeList.resize(0);
+        this->visibleObjectCount = 0;
+        this->culledObjectCount = 0;
+        this->frameIndex++;
 
         WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        Engine::instance()->getTransformHierarchy().updateWorldMatrices(*Engine::instance()->getJobSystem().get());
         this->processScene(rootObject, objectList);
 
         for (WeakPointer<Object3D> object : objectList) {
@@ -148,10 +162,8 @@ namespace Core {
         static std::vector<WeakPointer<Object3D>> objectList;
         objectList.resize(0);
 
-        Matrix4x4 baseTransformation;
-        rootObject->getTransform().getAncestorWorldMatrix(baseTransformation);
-
-        this->processScene(rootObject, objectList, baseTransformation);
+        Engine::instance()->getTransformHierarchy().updateWorldMatrices(*Engine::instance()->getJobSystem().get());
+        this->processScene(rootObject, objectList);
         this->render(camera, objectList, overrideMaterial, matchPhysicalPropertiesWithLighting);
     }
 
@@ -242,10 +254,47 @@ namespace Core {
         this->clearActiveRenderTarget(viewDescriptor);
 
         this->renderSkybox(viewDescriptor);
-        for (auto object : objectList) {
-            this->renderObjectDirect(object, viewDescriptor, lightList, matchPhysicalPropertiesWithLighting);
+
+        if (this->frustumCullingEnabled) {
+            Frustum frustum;
+            frustum.setFromViewProjection(viewDescriptor.projectionMatrix, viewDescriptor.viewInverseMatrix);
+            this->findVisibleObjects(objectList, frustum);
+        }
+        // only views whose materials read the clusters get a grid; shadow map and shadow cube views
+        // render everything with an override material that doesn't, so binning lights for them is wasted work
+        viewDescriptor.lightClusterGrid = nullptr;
+        Bool viewUsesClusters = !viewDescriptor.overrideMaterial.isValid() ||
+                                viewDescriptor.overrideMaterial->getShaderLocation(StandardUniform::LightClusterEnabled) >= 0;
+        if (this->clusteredLightingEnabled && viewUsesClusters && this->lightClusterGrid.build(viewDescriptor, lightList)) {
+            viewDescriptor.lightClusterGrid = &this->lightClusterGrid;
         }
 
+        // visible objects are queued and sorted by state and depth, renderers that don't
+        // support the queue are drawn right away
+        this->renderQueue.clear();
+        viewDescriptor.visibleObjectCount = 0;
+        viewDescriptor.culledObjectCount = 0;
+        for (UInt32 i = 0; i < objectList.size(); i++) {
+            WeakPointer<Object3D> object = objectList[i];
+            if (this->frustumCullingEnabled && !this->objectVisibility[i]) {
+                viewDescriptor.culledObjectCount++;
+                continue;
+            }
+            viewDescriptor.visibleObjectCount++;
+            std::shared_ptr<BaseRenderableContainer> containerPtr = std::dynamic_pointer_cast<BaseRenderableContainer>(object.lock());
+            if (containerPtr) {
+                WeakPointer<BaseObjectRenderer> objectRenderer = containerPtr->getBaseRenderer();
+                if (objectRenderer && !objectRenderer->enqueueForwardRender(viewDescriptor, this->renderQueue)) {
+                    objectRenderer->forwardRender(viewDescriptor, lightList, matchPhysicalPropertiesWithLighting);
+                }
+            }
+        }
+
+        this->renderQueue.sort();
+        this->submitRenderQueue(viewDescriptor, lightList, matchPhysicalPropertiesWithLighting);
+        this->visibleObjectCount += viewDescriptor.visibleObjectCount;
+        this->culledObjectCount += viewDescriptor.culledObjectCount;
+
         if (viewDescriptor.indirectHDREnabled) {
             this->tonemapMaterial->setToneMapType(viewDescriptor.hdrToneMapType);
             this->tonemapMaterial->setExposure(viewDescriptor.hdrExposure);
@@ -257,6 +306,283 @@ namespace Core {
         this->setViewportAndMipLevelForRenderTarget(currentRenderTarget, -1);
     }
 
+    /*
+    * Draws the sorted render queue. Items sharing a material are adjacent in the queue; within each
+    * such run, instanceable items with the same instance key are merged into one instanced draw when
+    * there are at least [MinInstanceCount] of them. All other items are drawn one by one in queue order.
+    */
+    void Renderer::submitRenderQueue(const ViewDescriptor& viewDescriptor, std::vector<WeakPointer<Light>>& lightList,
+                                     Bool matchPhysicalPropertiesWithLighting) {
+        Shader* lastShader = nullptr;
+        Material* lastMaterial = nullptr;
+        UInt32 itemCount = this->renderQueue.getItemCount();
+        UInt32 runStart = 0;
+        while (runStart < itemCount) {
+            Material* material = this->renderQueue.getItem(runStart).material.get();
+            Shader* shader = material->getShader().get();
+
+            Bool hasInstanceable = false;
+            UInt32 runEnd = runStart;
+            this->instanceGroupOrder.clear();
+            while (runEnd < itemCount) {
+                RenderQueue::RenderItem& item = this->renderQueue.getItem(runEnd);
+                if (item.material.get() != material) break;
+                hasInstanceable = hasInstanceable || item.instanceable;
+                this->instanceGroupOrder.push_back(runEnd);
+                runEnd++;
+            }
+
+            // gather instanceable items by key after the others, which keep their sorted order
+            Bool instancing = this->instancingEnabled && hasInstanceable && runEnd - runStart >= MinInstanceCount;
+            if (instancing) {
+                std::stable_sort(this->instanceGroupOrder.begin(), this->instanceGroupOrder.end(), [this](UInt32 a, UInt32 b) {
+                    RenderQueue::RenderItem& itemA = this->renderQueue.getItem(a);
+                    RenderQueue::RenderItem& itemB = this->renderQueue.getItem(b);
+                    if (itemA.instanceable != itemB.instanceable) return !itemA.instanceable;
+                    return itemA.instanceable && itemA.instanceKey < itemB.instanceKey;
+                });
+            }
+
+            UInt32 orderCount = (UInt32)this->instanceGroupOrder.size();
+            UInt32 groupStart = 0;
+            while (groupStart < orderCount) {
+                RenderQueue::RenderItem& item = this->renderQueue.getItem(this->instanceGroupOrder[groupStart]);
+                UInt32 groupEnd = groupStart + 1;
+                if (instancing && item.instanceable) {
+                    while (groupEnd < orderCount) {
+                        RenderQueue::RenderItem& next = this->renderQueue.getItem(this->instanceGroupOrder[groupEnd]);
+                        if (!next.instanceable || next.instanceKey != item.instanceKey) break;
+                        groupEnd++;
+                    }
+                }
+
+                Bool bindShader = shader != lastShader;
+                Bool bindMaterial = bindShader || material != lastMaterial;
+                Bool rendered = false;
+                UInt32 groupSize = groupEnd - groupStart;
+                if (groupSize >= MinInstanceCount) {
+                    this->instanceWorldMatrices.resize(groupSize);
+                    for (UInt32 g = 0; g < groupSize; g++) {
+                        RenderQueue::RenderItem& groupItem = this->renderQueue.getItem(this->instanceGroupOrder[groupStart + g]);
+                        this->instanceWorldMatrices[g].copy(groupItem.renderer->getOwner()->getTransform().getWorldMatrix());
+                    }
+                    rendered = item.renderer->forwardRenderQueuedInstanced(viewDescriptor, item.renderableIndex, this->instanceWorldMatrices.data(),
+                                                                           groupSize, lightList, matchPhysicalPropertiesWithLighting,
+                                                                           bindShader, bindMaterial);
+                }
+                if (!rendered) {
+                    for (UInt32 g = groupStart; g < groupEnd; g++) {
+                        RenderQueue::RenderItem& groupItem = this->renderQueue.getItem(this->instanceGroupOrder[g]);
+                        groupItem.renderer->forwardRenderQueued(viewDescriptor, groupItem.renderableIndex, lightList,
+                                                                matchPhysicalPropertiesWithLighting, bindShader, bindMaterial);
+                        bindShader = false;
+                        bindMaterial = false;
+                    }
+                }
+                lastShader = shader;
+                lastMaterial = material;
+                groupStart = groupEnd;
+            }
+            runStart = runEnd;
+        }
+    }
+
+    /*
+    * Flag the objects in [objectList] that may be visible in [frustum] in [objectVisibility]. Objects
+    * without culling bounds are always flagged.
+    */
+    void Renderer::findVisibleObjects(std::vector<WeakPointer<Object3D>>& objectList, const Frustum& frustum) {
+        this->updateCullingBounds(objectList);
+
+        UInt32 objectCount = (UInt32)objectList.size();
+        this->objectVisibility.resize(objectCount);
+        for (UInt32 i = 0; i < objectCount; i++) {
+            this->objectVisibility[i] = this->objectCullingProxies[i] == SceneBVH::InvalidProxy ? 1 : 0;
+        }
+
+        // the tree also holds objects from other lists, whose user data refers to a slot in those lists
+        this->cullingQueryResults.resize(0);
+        this->cullingBounds.queryFrustum(frustum, this->cullingQueryResults);
+        for (UInt32 proxy : this->cullingQueryResults) {
+            UInt32 index = this->cullingBounds.getUserData(proxy);
+            if (index < objectCount && this->objectCullingProxies[index] == proxy) this->objectVisibility[index] = 1;
+        }
+    }
+
+    /*
+    * Make sure every object in [objectList] has an entry in [cullingEntries], and a proxy in [cullingBounds]
+    * if it can be culled. Bounds are only recomputed when the object's world matrix, its meshes or their
+    * bounding boxes, or whether it is skinned has changed since they were last computed. The user data of
+    * each proxy is set to the index of its object in [objectList].
+    */
+    void Renderer::updateCullingBounds(std::vector<WeakPointer<Object3D>>& objectList) {
+        this->releaseStaleCullingBounds();
+
+        UInt32 objectCount = (UInt32)objectList.size();
+        this->objectCullingProxies.resize(objectCount);
+        for (UInt32 i = 0; i < objectCount; i++) {
+            WeakPointer<Object3D> object = objectList[i];
+            auto result = this->cullingEntries.emplace(object->getID(), CullingEntry());
+            CullingEntry& entry = result.first->second;
+            Bool newEntry = result.second;
+            if (newEntry) {
+                std::shared_ptr<MeshContainer> meshContainer = std::dynamic_pointer_cast<MeshContainer>(object.lock());
+                if (meshContainer && !std::dynamic_pointer_cast<InstancedMeshContainer>(meshContainer)) {
+                    entry.meshContainer = WeakPointer<MeshContainer>(meshContainer);
+                }
+                entry.object = object;
+                entry.proxy = SceneBVH::InvalidProxy;
+            }
+
+            UInt32 transformVersion = object->getTransform().getWorldMatrixVersion();
+            Bool skinned = false;
+            Bool meshesChanged = false;
+            if (entry.meshContainer.isValid()) {
+                skinned = entry.meshContainer->getSkeleton().isValid();
+                meshesChanged = updateMeshBoundsVersions(entry.meshContainer, entry.meshBoundsVersions);
+            }
+            else if (entry.meshBoundsVersions.size() > 0) {
+                entry.meshBoundsVersions.resize(0);
+                meshesChanged = true;
+            }
+
+            if (newEntry || meshesChanged || transformVersion != entry.transformVersion || skinned != entry.skinned) {
+                Box3 bounds;
+                if (entry.meshContainer.isValid() && getCullingBounds(entry.meshContainer, bounds)) {
+                    if (entry.proxy == SceneBVH::InvalidProxy) entry.proxy = this->cullingBounds.addProxy(bounds, i);
+                    else this->cullingBounds.moveProxy(entry.proxy, bounds);
+                }
+                else if (entry.proxy != SceneBVH::InvalidProxy) {
+                    this->cullingBounds.removeProxy(entry.proxy);
+                    entry.proxy = SceneBVH::InvalidProxy;
+                }
+                entry.transformVersion = transformVersion;
+                entry.skinned = skinned;
+            }
+
+            if (entry.proxy != SceneBVH::InvalidProxy) this->cullingBounds.setUserData(entry.proxy, i);
+            this->objectCullingProxies[i] = entry.proxy;
+        }
+    }
+
+    /*
+    * Store the bounding box version of each mesh of [meshContainer] in [versions], and return whether any
+    * of them differs from what [versions] held before.
+    */
+    Bool Renderer::updateMeshBoundsVersions(WeakPointer<MeshContainer> meshContainer, std::vector<UInt32>& versions) {
+        const std::vector<PersistentWeakPointer<Mesh>>& meshes = meshContainer->getRenderables();
+        Bool changed = false;
+        if (versions.size() != meshes.size()) {
+            versions.resize(meshes.size());
+            changed = true;
+        }
+        for (UInt32 m = 0; m < meshes.size(); m++) {
+            UInt32 version = meshes[m].isValid() ? meshes[m]->getBoundingBoxVersion() : 0;
+            if (version != versions[m]) {
+                versions[m] = version;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    /*
+    * Drop the culling entries of objects that have been destroyed. Object IDs are never reused, so an
+    * entry can't be picked up by a different object in the meantime.
+    */
+    void Renderer::releaseStaleCullingBounds() {
+        for (auto itr = this->cullingEntries.begin(); itr != this->cullingEntries.end();) {
+            CullingEntry& entry = itr->second;
+            if (!entry.object.isValid()) {
+                if (entry.proxy != SceneBVH::InvalidProxy) this->cullingBounds.removeProxy(entry.proxy);
+                itr = this->cullingEntries.erase(itr);
+            }
+            else {
+                ++itr;
+            }
+        }
+    }
+
+    /*
+    * An object can be culled only when it is a mesh container whose meshes all have a computed
+    * bounding box, in which case [bounds] receives the world-space box enclosing all of them.
+    * Skinned containers are never culled since their bind-pose bounds don't enclose the animated
+    * mesh, and neither are instanced containers since their bounds depend on every instance.
+    */
+    Bool Renderer::getCullingBounds(WeakPointer<MeshContainer> meshContainer, Box3& bounds) {
+        if (meshContainer->getSkeleton().isValid()) return false;
+
+        const std::vector<PersistentWeakPointer<Mesh>>& meshes = meshContainer->getRenderables();
+        if (meshes.size() == 0) return false;
+
+        const Matrix4x4& worldMatrix = meshContainer->getTransform().getWorldMatrix();
+        Bool first = true;
+        for (auto mesh : meshes) {
+            if (!mesh->hasBoundingBox()) return false;
+            Box3 meshBounds;
+            Frustum::transformBox(mesh->getBoundingBox(), worldMatrix, meshBounds);
+            const Vector3r& meshMin = meshBounds.getMin();
+            const Vector3r& meshMax = meshBounds.getMax();
+            if (first) {
+                bounds.setMin(meshMin);
+                bounds.setMax(meshMax);
+                first = false;
+            }
+            else {
+                const Vector3r& min = bounds.getMin();
+                const Vector3r& max = bounds.getMax();
+                bounds.setMin(Math::min(min.x, meshMin.x), Math::min(min.y, meshMin.y), Math::min(min.z, meshMin.z));
+                bounds.setMax(Math::max(max.x, meshMax.x), Math::max(max.y, meshMax.y), Math::max(max.z, meshMax.z));
+            }
+        }
+        return true;
+    }
+
+    void Renderer::setFrustumCullingEnabled(Bool enabled) {
+        this->frustumCullingEnabled = enabled;
+    }
+
+    Bool Renderer::isFrustumCullingEnabled() const {
+        return this->frustumCullingEnabled;
+    }
+
+    UInt32 Renderer::getVisibleObjectCount() const {
+        return this->visibleObjectCount;
+    }
+
+    UInt32 Renderer::getCulledObjectCount() const {
+        return this->culledObjectCount;
+    }
+
+    /*
+    * When enabled, unshadowed point lights are binned into [lightClusterGrid] once per camera view and
+    * materials with clustered lighting support shade all of them in their first pass. Lights that don't
+    * fit into the grid are shaded by the regular per-pass path.
+    */
+    void Renderer::setClusteredLightingEnabled(Bool enabled) {
+        this->clusteredLightingEnabled = enabled;
+    }
+
+    Bool Renderer::isClusteredLightingEnabled() const {
+        return this->clusteredLightingEnabled;
+    }
+
+    void Renderer::setInstancingEnabled(Bool enabled) {
+        this->instancingEnabled = enabled;
+    }
+
+    Bool Renderer::isInstancingEnabled() const {
+        return this->instancingEnabled;
+    }
+
+    /*
+     * Index of the frame being rendered. It advances with each call to renderScene(); renderObjectBasic() and
+     * renderObjectDirect() draw as part of the current frame.
+     */
+    UInt32 Renderer::getFrameIndex() const {
+        return this->frameIndex;
+    }
+
     void Renderer::clearActiveRenderTarget(ViewDescriptor& viewDescriptor) {
         WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
         Bool clearColorBuffer = IntMaskUtil::isBitSetForMask(viewDescriptor.clearRenderBuffers, (UInt32)RenderBufferType::Color);
@@ -357,7 +683,9 @@ namespace Core {
                             WeakPointer<RenderTarget> shadowMapRenderTarget = pointLight->getShadowMap();
                             WeakPointer<Object3D> lightObject = light->getOwner();
                             Matrix4x4 lightTransform = lightObject->getTransform().getWorldMatrix();
-                            this->perspectiveShadowMapCameraObject->getTransform().getWorldMatrix().copy(lightTransform);
+                            Transform& shadowCameraTransform = this->perspectiveShadowMapCameraObject->getTransform();
+                            shadowCameraTransform.setLocalMatrix(lightTransform);
+                            shadowCameraTransform.updateWorldMatrix();
                             Vector4u renderTargetDimensions = shadowMapRenderTarget->getViewport();
                             this->perspectiveShadowMapCamera->setRenderTarget(shadowMapRenderTarget);  
                             this->perspectiveShadowMapCamera->setAspectRatioFromDimensions(renderTargetDimensions.z, renderTargetDimensions.w);                     
@@ -443,26 +771,18 @@ namespace Core {
         processScene(scene->getRoot(), outObjects);
     }
 
+    /*
+     * Gathers the active objects under [object] into [outObjects]. World matrices are not touched here; callers
+     * bring them up to date beforehand with a single pass over the TransformHierarchy.
+     */
     void Renderer::processScene(WeakPointer<Object3D> object, std::vector<WeakPointer<Object3D>>& outObjects) {
-        Matrix4x4 rootTransform;
-        processScene(object, outObjects, rootTransform);
-    }
-
-    void Renderer::processScene(WeakPointer<Object3D> object, std::vector<WeakPointer<Object3D>>& outObjects, const Matrix4x4& curTransform) {
 
         if (!object->isActive()) return;
-        Matrix4x4 nextTransform = curTransform;
-        Transform& objTransform = object->getTransform();
-        nextTransform.multiply(objTransform.getLocalMatrix());
-        objTransform.getWorldMatrix().copy(nextTransform);
-        Matrix4x4& inverseWorld = objTransform.getInverseWorldMatrix();
-        inverseWorld.copy(nextTransform);
-        inverseWorld.invert();
         outObjects.push_back(object);
 
         for (SceneObjectIterator<Object3D> itr = object->beginIterateChildren(); itr != object->endIterateChildren(); ++itr) {
             WeakPointer<Object3D> obj = *itr;
-            this->processScene(obj, outObjects, nextTransform);
+            this->processScene(obj, outObjects);
         }
     }
 
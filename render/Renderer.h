@@ -1,5 +1,7 @@
 #pragma once
 
+#include <unordered_map>
+
 #include "../common/complextypes.h"
 #include "../common/debug.h"
 #include "../base/CoreObject.h"
@@ -11,6 +13,9 @@
 #include "../util/WeakPointer.h"
 #include "../light/LightType.h"
 #include "../base/BitMask.h"
+#include "LightClusterGrid.h"
+#include "MaterialGroupedRenderQueue.h"
+#include "../scene/SceneBVH.h"
 
 namespace Core {
 
@@ -28,6 +33,8 @@ namespace Core {
     class RenderTarget2D;
     class ReflectionProbe;
     class Skybox;
+    class Frustum;
+    class MeshContainer;
 
     class Renderer : public CoreObject {
     public:
@@ -45,6 +52,16 @@ namespace Core {
                                 WeakPointer<Material> overrideMaterial = WeakPointer<Material>::nullPtr(),
                                 Bool matchPhysicalPropertiesWithLighting = true);
 
+        void setFrustumCullingEnabled(Bool enabled);
+        Bool isFrustumCullingEnabled() const;
+        UInt32 getVisibleObjectCount() const;
+        UInt32 getCulledObjectCount() const;
+        void setClusteredLightingEnabled(Bool enabled);
+        Bool isClusteredLightingEnabled() const;
+        void setInstancingEnabled(Bool enabled);
+        Bool isInstancingEnabled() const;
+        UInt32 getFrameIndex() const;
+
     protected:
         Renderer();
         void renderStandard(WeakPointer<Camera> camera, std::vector<WeakPointer<Object3D>>& objects, 
@@ -62,6 +79,8 @@ namespace Core {
         void render(ViewDescriptor& viewDescriptor, std::vector<WeakPointer<Object3D>>& objectList, 
                     std::vector<WeakPointer<Light>>& lightList,
                     Bool matchPhysicalPropertiesWithLighting);
+        void submitRenderQueue(const ViewDescriptor& viewDescriptor, std::vector<WeakPointer<Light>>& lightList,
+                               Bool matchPhysicalPropertiesWithLighting);
         void setViewportAndMipLevelForRenderTarget(WeakPointer<RenderTarget> renderTarget, Int16 cubeFace);
         void clearActiveRenderTarget(ViewDescriptor& viewDescriptor);
         void renderSkybox(ViewDescriptor& viewDescriptor);
@@ -74,7 +93,11 @@ namespace Core {
                                IntMask clearBuffers, ViewDescriptor& viewDescriptor);
         void processScene(WeakPointer<Scene> scene, std::vector<WeakPointer<Object3D>>& outObjects);
         void processScene(WeakPointer<Object3D> object, std::vector<WeakPointer<Object3D>>& outObjects);
-        void processScene(WeakPointer<Object3D> object, std::vector<WeakPointer<Object3D>>& outObjects, const Matrix4x4& curTransform);
+        void findVisibleObjects(std::vector<WeakPointer<Object3D>>& objectList, const Frustum& frustum);
+        void updateCullingBounds(std::vector<WeakPointer<Object3D>>& objectList);
+        void releaseStaleCullingBounds();
+        static Bool getCullingBounds(WeakPointer<MeshContainer> meshContainer, Box3& bounds);
+        static Bool updateMeshBoundsVersions(WeakPointer<MeshContainer> meshContainer, std::vector<UInt32>& versions);
         void renderReflectionProbe(WeakPointer<ReflectionProbe> reflectionProbe, Bool specularOnly,
                                    std::vector<WeakPointer<Object3D>>& renderObjects, std::vector<WeakPointer<Light>>& renderLights);
         
@@ -90,5 +113,46 @@ namespace Core {
         PersistentWeakPointer<Object3D> perspectiveShadowMapCameraObject;
         PersistentWeakPointer<Camera> orthoShadowMapCamera;
         PersistentWeakPointer<Object3D> orthoShadowMapCameraObject;
+
+        // incremented for every scene render, used to compute per-frame data such as skinning palettes only once
+        UInt32 frameIndex;
+
+        Bool frustumCullingEnabled;
+        UInt32 visibleObjectCount;
+        UInt32 culledObjectCount;
+
+        class CullingEntry {
+        public:
+            PersistentWeakPointer<Object3D> object;
+            // InvalidProxy when the object can't be culled
+            UInt32 proxy;
+            // null unless the object is a non-instanced mesh container
+            PersistentWeakPointer<MeshContainer> meshContainer;
+            // state the bounds were computed for
+            UInt32 transformVersion;
+            // bounding box version of each mesh, see Mesh::getBoundingBoxVersion()
+            std::vector<UInt32> meshBoundsVersions;
+            Bool skinned;
+        };
+
+        // world-space bounds of every live object that has been rendered, keyed by object ID. frustum culling
+        // is a query against [cullingBounds] instead of a test of every object.
+        SceneBVH cullingBounds;
+        std::unordered_map<UInt64, CullingEntry> cullingEntries;
+        // proxy of each object in the list being rendered, and whether it was found in the view frustum
+        std::vector<UInt32> objectCullingProxies;
+        std::vector<UInt8> objectVisibility;
+        std::vector<UInt32> cullingQueryResults;
+
+        Bool clusteredLightingEnabled;
+        LightClusterGrid lightClusterGrid;
+
+        MaterialGroupedRenderQueue renderQueue;
+
+        // smallest group of matching queued items that is drawn instanced
+        static const UInt32 MinInstanceCount = 2;
+        Bool instancingEnabled;
+        std::vector<UInt32> instanceGroupOrder;
+        std::vector<Matrix4x4> instanceWorldMatrices;
     };
 }
@@ -12,6 +12,7 @@ namespace Core {
     class RenderTarget;
     class RenderTarget2D;
     class Skybox;
+    class LightClusterGrid;
 
     class ViewDescriptor {
     public:
@@ -28,10 +29,13 @@ namespace Core {
         Int32 mipLevel = 0;
         IntMask clearRenderBuffers;
         Skybox* skybox = nullptr;
+        LightClusterGrid* lightClusterGrid = nullptr;
         Bool indirectHDREnabled = false;
         ToneMapType hdrToneMapType = ToneMapType::Reinhard;
         Real hdrExposure = 1.0f;
         Real hdrGamma = 2.2f;
+        UInt32 visibleObjectCount = 0;
+        UInt32 culledObjectCount = 0;
     };
 
 }
\ No newline at end of file
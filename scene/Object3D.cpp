@@ -10,7 +10,7 @@ namespace Core {
 
     UInt64 Object3D::_nextID = 0;
 
-    Object3D::Object3D() : transform(*this), active(true) {
+    Object3D::Object3D() : transform(*this), active(true), objStatic(false) {
         this->id = Object3D::getNextID();
     }
 
@@ -72,13 +72,12 @@ namespace Core {
 
         Transform& worldTransform = this->getTransform();
         worldTransform.updateWorldMatrix();
-        Matrix4x4 worldInverse = worldTransform.getWorldMatrix();
-        worldInverse.invert();
 
-        object->getTransform().getLocalMatrix().preMultiply(worldInverse);
+        object->getTransform().getLocalMatrix().preMultiply(worldTransform.getConstInverseWorldMatrix());
 
         this->children.push_back(object);
         object->parent = this->_self;
+        object->transform.setParent(&this->transform);
     }
 
     void Object3D::removeChild(WeakPointer<Object3D> object) {
@@ -96,6 +95,7 @@ namespace Core {
             transform.getLocalMatrix().copy(transform.getWorldMatrix());
             this->children.erase(result.getSrc());
             object->parent = PersistentWeakPointer<Object3D>::nullPtr();
+            transform.setParent(nullptr);
         }
     }
 
@@ -124,8 +124,15 @@ namespace Core {
         return this->active;
     }
 
+    /*
+     * Static objects are skipped by the renderer's world matrix update once their world matrices
+     * have been computed, so changes to a static object's transform (or to those of its ancestors)
+     * are not picked up until it is made non-static again, at which point the object and all of its
+     * descendants have their world matrices recomputed.
+     */
     void Object3D::setStatic(Bool objStatic) {
         this->objStatic = objStatic;
+        this->transform.setStatic(objStatic);
     }
 
     Bool Object3D::isStatic() const {
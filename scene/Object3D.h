@@ -24,6 +24,7 @@ namespace Core {
     class Object3D: public CoreObject {
 
         friend class Engine;
+        friend class Transform;
 
     public:
         virtual ~Object3D();
@@ -1,37 +1,68 @@
 #include <algorithm>
 #include <functional>
+#include <limits>
 
 #include "RayCaster.h"
 #include "../geometry/Mesh.h"
+#include "../geometry/Frustum.h"
+#include "../geometry/MeshBVH.h"
+#include "../util/JobSystem.h"
 
 namespace Core {
 
+    const UInt32 RayCaster::RayBatchSize;
+
+    /*
+     * Transform the normal [normal] by the inverse transpose of a world matrix, given its inverse [inverseWorld].
+     */
+    static void transformNormal(const Matrix4x4& inverseWorld, Vector3r& normal) {
+        const Real * m = inverseWorld.getConstData();
+        Real x = m[0] * normal.x + m[1] * normal.y + m[2] * normal.z;
+        Real y = m[4] * normal.x + m[5] * normal.y + m[6] * normal.z;
+        Real z = m[8] * normal.x + m[9] * normal.y + m[10] * normal.z;
+        normal.set(x, y, z);
+    }
+
     UInt32 RayCaster::addObject(WeakPointer<Object3D> sceneObject, WeakPointer<Mesh> mesh) {
         UInt32 id = this->objects.size();
         this->objects.push_back(sceneObject);
         this->meshes.push_back(mesh);
+        this->proxies.push_back(SceneBVH::InvalidProxy);
+        this->transformVersions.push_back(0);
+        this->meshBoundsVersions.push_back(0);
+        this->updateObjectBounds(id);
         return id;
     }
 
+    /*
+     * Refit the bounds of the objects whose world matrix or mesh bounding box has changed since the last call,
+     * and drop the objects that no longer exist. Queries only walk the bounds as of the last update(), so it is
+     * meant to be called once per frame after the scene has moved, rather than paying for it on every query.
+     */
+    void RayCaster::update() {
+        for (UInt32 i = 0; i < this->objects.size(); i++) {
+            this->updateObjectBounds(i);
+        }
+    }
+
     Bool RayCaster::castRay(const Ray& ray, std::vector<Hit>& hits) {
         if (this->objects.size() != this->meshes.size()) {
             throw Exception("RayCaster::castRay() -> 'meshes' and 'objects' have different sizes.");
         }
 
         Bool hitFound = false;
-        for (UInt32 i = 0; i < this->objects.size(); i++) {
-            WeakPointer<Object3D> object = this->objects[i];
-            if (object->isActive()) {
-                WeakPointer<Mesh> mesh = this->meshes[i];
-                Transform objTransform = object->getTransform();
-                objTransform.updateWorldMatrix();
-                Matrix4x4& transform = objTransform.getWorldMatrix();
-                hitFound = this->castRay(ray, mesh, transform, hits, i) || hitFound;
+        this->bounds.queryRay(ray, std::numeric_limits<Real>::max(), [this, &ray, &hits, &hitFound](UInt32 proxy, Real entryT) {
+            UInt32 id = this->bounds.getUserData(proxy);
+            WeakPointer<Object3D> object = this->objects[id];
+            if (object.isValid() && this->meshes[id].isValid() && object->isActive()) {
+                const Matrix4x4& transform = object->getTransform().getConstWorldMatrix();
+                hitFound = this->castRay(ray, this->meshes[id], transform, hits, id) || hitFound;
             }
-        }
+            return std::numeric_limits<Real>::max();
+        });
 
         std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b){
-            return a.Distance <= b.Distance;
+            return a.Distance < b.Distance;
         });
 
         return hitFound;
@@ -47,12 +78,9 @@ namespace Core {
         inverse.transform(localRay.Origin);
         inverse.transform(localRay.Direction);
 
-        Hit bbHit;
-        Bool bbIntersect = localRay.intersectBox(mesh->getBoundingBox(), bbHit);
+        // the root of the mesh's hierarchy bounds the whole mesh, so it also serves as the bounding box test
         UInt32 startIndex = hits.size();
-        if (bbIntersect) {
-            localRay.intersectMesh(mesh, hits);
-        }
+        localRay.intersectMesh(mesh, hits);
 
         for(UInt32 i = startIndex; i < hits.size(); i++) {
             Hit& hit = hits[i];
@@ -65,4 +93,366 @@ namespace Core {
 
         return hits.size() > 0;
     }
-}
\ No newline at end of file
+
+    /*
+     * Find the hit of [ray] closest to its origin, no further than [maxDistance] from it. Unlike castRay(), hits
+     * beyond the closest one found so far are never collected, and objects whose bounds the ray enters beyond
+     * it are never searched.
+     */
+    Bool RayCaster::castRayClosest(const Ray& ray, Hit& hit, Real maxDistance) {
+        return this->findClosestHit(ray, getMaxT(ray, maxDistance), hit, false);
+    }
+
+    /*
+     * Determine whether [ray] hits anything no further than [maxDistance] from its origin, e.g. for occlusion
+     * tests. The query ends at the first hit found, which need not be the closest.
+     */
+    Bool RayCaster::castRayAny(const Ray& ray, Real maxDistance) {
+        return this->findAnyHit(ray, getMaxT(ray, maxDistance), false);
+    }
+
+    /*
+     * Find the closest hit for each of the [rayCount] rays in [rays]. [hits] is resized to [rayCount], and
+     * the hit for a ray that doesn't hit anything has an ID of -1. Returns the number of rays that hit something.
+     */
+    UInt32 RayCaster::castRaysClosest(const Ray * rays, UInt32 rayCount, std::vector<Hit>& hits) {
+        this->updateTargets();
+        hits.resize(rayCount);
+        this->findClosestHits(rays, 0, rayCount, hits.data());
+
+        UInt32 hitRayCount = 0;
+        for (const Hit& hit : hits) {
+            if (hit.ID >= 0) hitRayCount++;
+        }
+        return hitRayCount;
+    }
+
+    /*
+     * Same as castRaysClosest(), but the rays are split into batches cast by the threads of [jobSystem].
+     * Objects must not be created or destroyed while the rays are being cast.
+     */
+    UInt32 RayCaster::castRaysClosest(const Ray * rays, UInt32 rayCount, std::vector<Hit>& hits, JobSystem& jobSystem) {
+        this->updateTargets();
+        hits.resize(rayCount);
+        Hit * results = hits.data();
+        jobSystem.parallelFor("RayCaster::castRaysClosest", rayCount, RayBatchSize, [this, rays, results](UInt32 start, UInt32 end) {
+            this->findClosestHits(rays, start, end, results);
+        });
+
+        UInt32 hitRayCount = 0;
+        for (const Hit& hit : hits) {
+            if (hit.ID >= 0) hitRayCount++;
+        }
+        return hitRayCount;
+    }
+
+    /*
+     * Find every hit of each of the [rayCount] rays in [rays]. [hits] receives the hits of every ray, each
+     * ray's sorted by distance, and those of ray n are [hitOffsets[n], hitOffsets[n + 1]). Both vectors are
+     * resized as needed, so reusing them across calls avoids allocating. Returns the total number of hits.
+     */
+    UInt32 RayCaster::castRays(const Ray * rays, UInt32 rayCount, std::vector<Hit>& hits, std::vector<UInt32>& hitOffsets) {
+        this->updateTargets();
+        hitOffsets.resize(rayCount + 1);
+        UInt32 batchCount = (rayCount + RayBatchSize - 1) / RayBatchSize;
+        if (this->batchHits.size() < batchCount) this->batchHits.resize(batchCount);
+        this->findBatchHits(rays, 0, rayCount, hitOffsets.data());
+        return this->mergeBatchHits(rayCount, hits, hitOffsets);
+    }
+
+    /*
+     * Same as castRays(), but the rays are split into batches cast by the threads of [jobSystem]. Objects
+     * must not be created or destroyed while the rays are being cast.
+     */
+    UInt32 RayCaster::castRays(const Ray * rays, UInt32 rayCount, std::vector<Hit>& hits, std::vector<UInt32>& hitOffsets, JobSystem& jobSystem) {
+        this->updateTargets();
+        hitOffsets.resize(rayCount + 1);
+        UInt32 batchCount = (rayCount + RayBatchSize - 1) / RayBatchSize;
+        if (this->batchHits.size() < batchCount) this->batchHits.resize(batchCount);
+        UInt32 * hitCounts = hitOffsets.data();
+        // parallelFor() hands out ranges aligned to RayBatchSize, but runs the whole range in one call when
+        // it doesn't split it, so each call still fills one hit buffer per batch
+        jobSystem.parallelFor("RayCaster::castRays", rayCount, RayBatchSize, [this, rays, hitCounts](UInt32 start, UInt32 end) {
+            this->findBatchHits(rays, start, end, hitCounts);
+        });
+        return this->mergeBatchHits(rayCount, hits, hitOffsets);
+    }
+
+    /*
+     * Find the IDs of the objects whose world-space bounds (enlarged by the margin of the underlying
+     * SceneBVH) overlap [box]. Inactive objects are skipped.
+     */
+    void RayCaster::queryBox(const Box3& box, std::vector<UInt32>& ids) {
+        this->queryResults.resize(0);
+        this->bounds.queryBox(box, this->queryResults);
+        this->gatherQueryResults(ids);
+    }
+
+    /*
+     * Find the IDs of the objects whose world-space bounds (enlarged by the margin of the underlying
+     * SceneBVH) overlap the sphere at [center] with [radius]. Inactive objects are skipped.
+     */
+    void RayCaster::querySphere(const Point3r& center, Real radius, std::vector<UInt32>& ids) {
+        this->queryResults.resize(0);
+        this->bounds.querySphere(center, radius, this->queryResults);
+        this->gatherQueryResults(ids);
+    }
+
+    /*
+     * Bring the proxy of object [id] up to date. Its bounds are only transformed again if its world matrix or
+     * mesh bounding box has been recomputed since its proxy was last moved, and the tree only changes if it
+     * moved out of its enlarged bounds. An object that no longer exists is dropped from the tree.
+     */
+    void RayCaster::updateObjectBounds(UInt32 id) {
+        UInt32& proxy = this->proxies[id];
+        WeakPointer<Object3D> object = this->objects[id];
+        WeakPointer<Mesh> mesh = this->meshes[id];
+        if (!object.isValid() || !mesh.isValid()) {
+            if (proxy != SceneBVH::InvalidProxy) {
+                this->bounds.removeProxy(proxy);
+                proxy = SceneBVH::InvalidProxy;
+            }
+            return;
+        }
+
+        Transform& transform = object->getTransform();
+        transform.updateWorldMatrix();
+        if (!mesh->hasBoundingBox()) mesh->calculateBoundingBox();
+        UInt32 version = transform.getWorldMatrixVersion();
+        UInt32 meshBoundsVersion = mesh->getBoundingBoxVersion();
+        if (proxy != SceneBVH::InvalidProxy && version == this->transformVersions[id] &&
+            meshBoundsVersion == this->meshBoundsVersions[id]) return;
+
+        Box3 worldBounds;
+        Frustum::transformBox(mesh->getBoundingBox(), transform.getConstWorldMatrix(), worldBounds);
+        if (proxy == SceneBVH::InvalidProxy) proxy = this->bounds.addProxy(worldBounds, id);
+        else this->bounds.moveProxy(proxy, worldBounds);
+        this->transformVersions[id] = version;
+        this->meshBoundsVersions[id] = meshBoundsVersion;
+    }
+
+    /*
+     * Gather what casting a batch of rays needs from every object up front, so the rays can be cast
+     * from several threads.
+     */
+    void RayCaster::updateTargets() {
+        this->targets.resize(this->objects.size());
+        for (UInt32 i = 0; i < this->objects.size(); i++) {
+            this->fetchTarget(i, this->targets[i]);
+        }
+    }
+
+    /*
+     * Fill [target] with what casting a ray against object [id] needs. Its [bvh] is null if the
+     * object is inactive or no longer exists.
+     */
+    void RayCaster::fetchTarget(UInt32 id, RayTarget& target) const {
+        WeakPointer<Object3D> object = this->objects[id];
+        WeakPointer<Mesh> mesh = this->meshes[id];
+        if (!object.isValid() || !mesh.isValid() || !object->isActive()) {
+            target.bvh = nullptr;
+            return;
+        }
+        Transform& transform = object->getTransform();
+        target.bvh = &mesh->getBVH();
+        target.worldMatrix = &transform.getConstWorldMatrix();
+        target.inverseWorldMatrix = &transform.getConstInverseWorldMatrix();
+        target.mesh = mesh;
+    }
+
+    /*
+     * The target of object [id], taken from [targets] during a batch or else fetched into [fetched], so
+     * that single rays only look up the objects whose bounds they actually reach.
+     */
+    const RayCaster::RayTarget& RayCaster::getTarget(UInt32 id, Bool useTargets, RayTarget& fetched) const {
+        if (useTargets) return this->targets[id];
+        this->fetchTarget(id, fetched);
+        return fetched;
+    }
+
+    /*
+     * Find the hit of [ray] closest to its origin, within [0, maxT] in multiples of its direction. Each mesh is
+     * searched in the object's local space, where the ray parameter of a point is the same as in world space, so
+     * the closest hit so far limits both the objects visited and the search within each of them. The objects are
+     * taken from [targets] when [useTargets] is set, see getTarget().
+     */
+    Bool RayCaster::findClosestHit(const Ray& ray, Real maxT, Hit& hit, Bool useTargets) const {
+        class ClosestHitQuery {
+        public:
+            const Ray * ray;
+            Real closestT;
+            Int32 closestID;
+            Hit localHit;
+        };
+
+        ClosestHitQuery query;
+        query.ray = &ray;
+        query.closestT = maxT;
+        query.closestID = -1;
+        this->bounds.queryRay(ray, query.closestT, [this, &query, useTargets](UInt32 proxy, Real entryT) {
+            if (entryT > query.closestT) return query.closestT;
+            UInt32 id = this->bounds.getUserData(proxy);
+            RayTarget fetched;
+            const RayTarget& target = this->getTarget(id, useTargets, fetched);
+            if (target.bvh == nullptr) return query.closestT;
+
+            Ray localRay(query.ray->Origin, query.ray->Direction);
+            target.inverseWorldMatrix->transform(localRay.Origin);
+            target.inverseWorldMatrix->transform(localRay.Direction);
+            if (target.bvh->intersectClosest(localRay, query.closestT, query.localHit)) query.closestID = (Int32)id;
+            return query.closestT;
+        });
+
+        if (query.closestID < 0) return false;
+        RayTarget fetched;
+        const RayTarget& target = this->getTarget(query.closestID, useTargets, fetched);
+        Real t = query.closestT;
+        hit.Origin.set(ray.Origin.x + ray.Direction.x * t, ray.Origin.y + ray.Direction.y * t, ray.Origin.z + ray.Direction.z * t);
+        hit.Normal = query.localHit.Normal;
+        transformNormal(*target.inverseWorldMatrix, hit.Normal);
+        hit.Distance = t * ray.Direction.magnitude();
+        hit.Object = target.mesh;
+        hit.ID = query.closestID;
+        return true;
+    }
+
+    /*
+     * Determine whether [ray] hits any object within [0, maxT] in multiples of its direction. The objects
+     * are taken from [targets] when [useTargets] is set, see getTarget().
+     */
+    Bool RayCaster::findAnyHit(const Ray& ray, Real maxT, Bool useTargets) const {
+        class AnyHitQuery {
+        public:
+            const Ray * ray;
+            Real maxT;
+            Bool hitFound;
+        };
+
+        AnyHitQuery query;
+        query.ray = &ray;
+        query.maxT = maxT;
+        query.hitFound = false;
+        this->bounds.queryRay(ray, maxT, [this, &query, useTargets](UInt32 proxy, Real entryT) {
+            UInt32 id = this->bounds.getUserData(proxy);
+            RayTarget fetched;
+            const RayTarget& target = this->getTarget(id, useTargets, fetched);
+            if (target.bvh == nullptr) return query.maxT;
+
+            Ray localRay(query.ray->Origin, query.ray->Direction);
+            target.inverseWorldMatrix->transform(localRay.Origin);
+            target.inverseWorldMatrix->transform(localRay.Direction);
+            query.hitFound = target.bvh->intersectAny(localRay, query.maxT);
+            // a negative maximum ends the query
+            return query.hitFound ? -1.0f : query.maxT;
+        });
+        return query.hitFound;
+    }
+
+    /*
+     * Convert [maxDistance] from the origin of [ray] to a ray parameter.
+     */
+    Real RayCaster::getMaxT(const Ray& ray, Real maxDistance) {
+        Real directionLength = ray.Direction.magnitude();
+        if (maxDistance == std::numeric_limits<Real>::max() || directionLength == 0) return std::numeric_limits<Real>::max();
+        return maxDistance / directionLength;
+    }
+
+    /*
+     * Append every hit of [ray] among the objects in [targets] to [hits], sorted by distance, and return
+     * how many were found.
+     */
+    UInt32 RayCaster::findHits(const Ray& ray, std::vector<Hit>& hits) const {
+        UInt32 startIndex = (UInt32)hits.size();
+        this->bounds.queryRay(ray, std::numeric_limits<Real>::max(), [this, &ray, &hits](UInt32 proxy, Real entryT) {
+            UInt32 id = this->bounds.getUserData(proxy);
+            const RayTarget& target = this->targets[id];
+            if (target.bvh == nullptr) return std::numeric_limits<Real>::max();
+
+            Ray localRay(ray.Origin, ray.Direction);
+            target.inverseWorldMatrix->transform(localRay.Origin);
+            target.inverseWorldMatrix->transform(localRay.Direction);
+            UInt32 objectStart = (UInt32)hits.size();
+            target.bvh->intersect(localRay, hits);
+            for (UInt32 i = objectStart; i < hits.size(); i++) {
+                Hit& hit = hits[i];
+                target.worldMatrix->transform(hit.Origin);
+                transformNormal(*target.inverseWorldMatrix, hit.Normal);
+                Vector3r distanceVec = hit.Origin - ray.Origin;
+                hit.Distance = distanceVec.magnitude();
+                hit.Object = target.mesh;
+                hit.ID = (Int32)id;
+            }
+            return std::numeric_limits<Real>::max();
+        });
+
+        std::sort(hits.begin() + startIndex, hits.end(), [](const Hit& a, const Hit& b) {
+            return a.Distance < b.Distance;
+        });
+        return (UInt32)hits.size() - startIndex;
+    }
+
+    void RayCaster::findClosestHits(const Ray * rays, UInt32 start, UInt32 end, Hit * hits) const {
+        for (UInt32 r = start; r < end; r++) {
+            Hit& hit = hits[r];
+            if (!this->findClosestHit(rays[r], std::numeric_limits<Real>::max(), hit, true)) {
+                hit.Distance = std::numeric_limits<Real>::max();
+                hit.Object = PersistentWeakPointer<Mesh>::nullPtr();
+                hit.ID = -1;
+            }
+        }
+    }
+
+    /*
+     * Cast rays [start, end) into [hits], storing the number of hits of ray n in [hitCounts[n]].
+     */
+    void RayCaster::findHits(const Ray * rays, UInt32 start, UInt32 end, std::vector<Hit>& hits, UInt32 * hitCounts) const {
+        hits.resize(0);
+        for (UInt32 r = start; r < end; r++) {
+            hitCounts[r] = this->findHits(rays[r], hits);
+        }
+    }
+
+    /*
+     * Cast rays [start, end), where [start] is a multiple of RayBatchSize, storing the hits of each batch of
+     * RayBatchSize rays in its own buffer in [batchHits].
+     */
+    void RayCaster::findBatchHits(const Ray * rays, UInt32 start, UInt32 end, UInt32 * hitCounts) {
+        for (UInt32 batchStart = start; batchStart < end; batchStart += RayBatchSize) {
+            UInt32 batchEnd = Math::min(batchStart + RayBatchSize, end);
+            this->findHits(rays, batchStart, batchEnd, this->batchHits[batchStart / RayBatchSize], hitCounts);
+        }
+    }
+
+    /*
+     * Concatenate the hits of every batch, in ray order, into [hits], and turn the hit counts in [hitOffsets]
+     * into offsets. Returns the total number of hits.
+     */
+    UInt32 RayCaster::mergeBatchHits(UInt32 rayCount, std::vector<Hit>& hits, std::vector<UInt32>& hitOffsets) {
+        UInt32 offset = 0;
+        for (UInt32 r = 0; r < rayCount; r++) {
+            UInt32 count = hitOffsets[r];
+            hitOffsets[r] = offset;
+            offset += count;
+        }
+        hitOffsets[rayCount] = offset;
+
+        hits.resize(offset);
+        UInt32 batchCount = (rayCount + RayBatchSize - 1) / RayBatchSize;
+        UInt32 hitIndex = 0;
+        for (UInt32 b = 0; b < batchCount && hitIndex < offset; b++) {
+            const std::vector<Hit>& batch = this->batchHits[b];
+            for (UInt32 i = 0; i < batch.size() && hitIndex < offset; i++) {
+                hits[hitIndex++] = batch[i];
+            }
+        }
+        return offset;
+    }
+
+    void RayCaster::gatherQueryResults(std::vector<UInt32>& ids) {
+        for (UInt32 proxy : this->queryResults) {
+            UInt32 id = this->bounds.getUserData(proxy);
+            WeakPointer<Object3D> object = this->objects[id];
+            if (object.isValid() && object->isActive()) ids.push_back(id);
+        }
+    }
+}
@@ -1,23 +1,77 @@
 #pragma once
 
 #include <vector>
+#include <limits>
 
 #include "../geometry/Ray.h"
 #include "../geometry/Hit.h"
 #include "../scene/Object3D.h"
+#include "../scene/SceneBVH.h"
 #include "../util/PersistentWeakPointer.h"
 #include "../render/RenderableContainer.h"
 
 namespace Core {
 
+    // forward declarations
+    class JobSystem;
+    class MeshBVH;
+
     class RayCaster {
     public:
         UInt32 addObject(WeakPointer<Object3D> sceneObject, WeakPointer<Mesh> mesh);
+        void update();
         Bool castRay(const Ray& ray, std::vector<Hit>& hits);
         Bool castRay(const Ray& ray, WeakPointer<Mesh> mesh, const Matrix4x4& transform, std::vector<Hit>& hits, Int32 hitID = -1);
+        Bool castRayClosest(const Ray& ray, Hit& hit, Real maxDistance = std::numeric_limits<Real>::max());
+        Bool castRayAny(const Ray& ray, Real maxDistance = std::numeric_limits<Real>::max());
+        UInt32 castRaysClosest(const Ray * rays, UInt32 rayCount, std::vector<Hit>& hits);
+        UInt32 castRaysClosest(const Ray * rays, UInt32 rayCount, std::vector<Hit>& hits, JobSystem& jobSystem);
+        UInt32 castRays(const Ray * rays, UInt32 rayCount, std::vector<Hit>& hits, std::vector<UInt32>& hitOffsets);
+        UInt32 castRays(const Ray * rays, UInt32 rayCount, std::vector<Hit>& hits, std::vector<UInt32>& hitOffsets, JobSystem& jobSystem);
+        void queryBox(const Box3& box, std::vector<UInt32>& ids);
+        void querySphere(const Point3r& center, Real radius, std::vector<UInt32>& ids);
 
     private:
+        // number of rays cast by each job of a batch
+        static const UInt32 RayBatchSize = 64;
+
+        // everything the rays of a batch need from an object, gathered on the calling thread so the batch
+        // can be spread over threads without touching weak pointers or building mesh hierarchies
+        class RayTarget {
+        public:
+            // null for objects that are inactive or no longer exist
+            const MeshBVH * bvh;
+            const Matrix4x4 * worldMatrix;
+            const Matrix4x4 * inverseWorldMatrix;
+            PersistentWeakPointer<Mesh> mesh;
+        };
+
+        void updateObjectBounds(UInt32 id);
+        void updateTargets();
+        void fetchTarget(UInt32 id, RayTarget& target) const;
+        const RayTarget& getTarget(UInt32 id, Bool useTargets, RayTarget& fetched) const;
+        void gatherQueryResults(std::vector<UInt32>& ids);
+        Bool findClosestHit(const Ray& ray, Real maxT, Hit& hit, Bool useTargets) const;
+        Bool findAnyHit(const Ray& ray, Real maxT, Bool useTargets) const;
+        UInt32 findHits(const Ray& ray, std::vector<Hit>& hits) const;
+        void findClosestHits(const Ray * rays, UInt32 start, UInt32 end, Hit * hits) const;
+        void findHits(const Ray * rays, UInt32 start, UInt32 end, std::vector<Hit>& hits, UInt32 * hitCounts) const;
+        void findBatchHits(const Ray * rays, UInt32 start, UInt32 end, UInt32 * hitCounts);
+        static Real getMaxT(const Ray& ray, Real maxDistance);
+        UInt32 mergeBatchHits(UInt32 rayCount, std::vector<Hit>& hits, std::vector<UInt32>& hitOffsets);
+
         std::vector<PersistentWeakPointer<Object3D>> objects;
         std::vector<PersistentWeakPointer<Mesh>> meshes;
+        // world-space bounds of every object, with each proxy's user data set to the object's ID
+        SceneBVH bounds;
+        std::vector<UInt32> proxies;
+        // version of each object's world matrix and mesh bounding box when its proxy was last moved
+        std::vector<UInt32> transformVersions;
+        std::vector<UInt32> meshBoundsVersions;
+        std::vector<UInt32> queryResults;
+        // indexed by object ID, valid for the duration of a batch
+        std::vector<RayTarget> targets;
+        // hits found by each job of a batch, before they are merged in ray order
+        std::vector<std::vector<Hit>> batchHits;
     };
 }
\ No newline at end of file
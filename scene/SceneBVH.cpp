@@ -0,0 +1,492 @@
+#include <algorithm>
+#include <limits>
+
+#include "SceneBVH.h"
+#include "../common/Exception.h"
+#include "../geometry/Ray.h"
+#include "../geometry/Frustum.h"
+#include "../math/Math.h"
+
+namespace Core {
+
+    const UInt32 SceneBVH::InvalidProxy;
+    constexpr Real SceneBVH::DefaultMargin;
+    const UInt32 SceneBVH::InvalidNode;
+    const UInt32 SceneBVH::QueryStackSize;
+
+    Bool SceneBVH::Node::isLeaf() const {
+        return this->left == InvalidNode;
+    }
+
+    SceneBVH::SceneBVH(Real margin): margin(margin), root(InvalidNode), freeList(InvalidNode), proxyCount(0) {
+    }
+
+    /*
+     * Insert [bounds] into the tree and return the ID of the new proxy. [userData] is stored with the proxy
+     * and is not used by the tree.
+     */
+    UInt32 SceneBVH::addProxy(const Box3& bounds, UInt32 userData) {
+        UInt32 proxy = this->allocateNode();
+        Node& node = this->nodes[proxy];
+        this->setFatBounds(node, bounds);
+        node.userData = userData;
+        node.height = 0;
+        this->insertLeaf(proxy);
+        this->proxyCount++;
+        return proxy;
+    }
+
+    void SceneBVH::removeProxy(UInt32 proxy) {
+        this->validateProxy(proxy, "SceneBVH::removeProxy()");
+        this->removeLeaf(proxy);
+        this->freeNode(proxy);
+        this->proxyCount--;
+    }
+
+    /*
+     * Update the bounds of [proxy]. The tree is only changed when [bounds] leaves the enlarged bounds of the
+     * proxy, or is so much smaller than them that they would make queries return it needlessly. Returns
+     * true if the proxy was re-inserted.
+     */
+    Bool SceneBVH::moveProxy(UInt32 proxy, const Box3& bounds) {
+        this->validateProxy(proxy, "SceneBVH::moveProxy()");
+        Node& node = this->nodes[proxy];
+
+        const Vector3r& min = bounds.getMin();
+        const Vector3r& max = bounds.getMax();
+        Real tightMin[] = {min.x, min.y, min.z};
+        Real tightMax[] = {max.x, max.y, max.z};
+        if (containsBox(node, tightMin, tightMax)) {
+            Real looseMargin = this->margin * 4.0f;
+            Bool tooLoose = false;
+            for (UInt32 a = 0; a < 3; a++) {
+                if (tightMin[a] - node.min[a] > looseMargin || node.max[a] - tightMax[a] > looseMargin) tooLoose = true;
+            }
+            if (!tooLoose) return false;
+        }
+
+        this->removeLeaf(proxy);
+        this->setFatBounds(this->nodes[proxy], bounds);
+        this->insertLeaf(proxy);
+        return true;
+    }
+
+    void SceneBVH::clear() {
+        this->nodes.clear();
+        this->root = InvalidNode;
+        this->freeList = InvalidNode;
+        this->proxyCount = 0;
+    }
+
+    UInt32 SceneBVH::getUserData(UInt32 proxy) const {
+        this->validateProxy(proxy, "SceneBVH::getUserData()");
+        return this->nodes[proxy].userData;
+    }
+
+    void SceneBVH::setUserData(UInt32 proxy, UInt32 userData) {
+        this->validateProxy(proxy, "SceneBVH::setUserData()");
+        this->nodes[proxy].userData = userData;
+    }
+
+    void SceneBVH::getFatBounds(UInt32 proxy, Box3& bounds) const {
+        this->validateProxy(proxy, "SceneBVH::getFatBounds()");
+        const Node& node = this->nodes[proxy];
+        bounds.setMin(node.min[0], node.min[1], node.min[2]);
+        bounds.setMax(node.max[0], node.max[1], node.max[2]);
+    }
+
+    UInt32 SceneBVH::getProxyCount() const {
+        return this->proxyCount;
+    }
+
+    /*
+     * Number of levels below the root, zero for a tree with a single proxy.
+     */
+    UInt32 SceneBVH::getHeight() const {
+        if (this->root == InvalidNode) return 0;
+        return (UInt32)this->nodes[this->root].height;
+    }
+
+    /*
+     * Append every proxy whose enlarged bounds overlap [box] to [proxies].
+     */
+    void SceneBVH::queryBox(const Box3& box, std::vector<UInt32>& proxies) const {
+        if (this->root == InvalidNode) return;
+        const Vector3r& boxMin = box.getMin();
+        const Vector3r& boxMax = box.getMax();
+        Real min[] = {boxMin.x, boxMin.y, boxMin.z};
+        Real max[] = {boxMax.x, boxMax.y, boxMax.z};
+
+        UInt32 stack[QueryStackSize];
+        UInt32 stackSize = 0;
+        stack[stackSize++] = this->root;
+        while (stackSize > 0) {
+            const Node& node = this->nodes[stack[--stackSize]];
+            Bool overlaps = true;
+            for (UInt32 a = 0; a < 3; a++) {
+                if (node.min[a] > max[a] || node.max[a] < min[a]) overlaps = false;
+            }
+            if (!overlaps) continue;
+
+            if (node.isLeaf()) {
+                proxies.push_back((UInt32)(&node - this->nodes.data()));
+            }
+            else {
+                stack[stackSize++] = node.left;
+                stack[stackSize++] = node.right;
+            }
+        }
+    }
+
+    /*
+     * Append every proxy whose enlarged bounds overlap the sphere at [center] with [radius] to [proxies].
+     */
+    void SceneBVH::querySphere(const Point3r& center, Real radius, std::vector<UInt32>& proxies) const {
+        if (this->root == InvalidNode) return;
+        Real c[] = {center.x, center.y, center.z};
+        Real radiusSq = radius * radius;
+
+        UInt32 stack[QueryStackSize];
+        UInt32 stackSize = 0;
+        stack[stackSize++] = this->root;
+        while (stackSize > 0) {
+            const Node& node = this->nodes[stack[--stackSize]];
+            Real distanceSq = 0.0f;
+            for (UInt32 a = 0; a < 3; a++) {
+                if (c[a] < node.min[a]) distanceSq += (node.min[a] - c[a]) * (node.min[a] - c[a]);
+                else if (c[a] > node.max[a]) distanceSq += (c[a] - node.max[a]) * (c[a] - node.max[a]);
+            }
+            if (distanceSq > radiusSq) continue;
+
+            if (node.isLeaf()) {
+                proxies.push_back((UInt32)(&node - this->nodes.data()));
+            }
+            else {
+                stack[stackSize++] = node.left;
+                stack[stackSize++] = node.right;
+            }
+        }
+    }
+
+    /*
+     * Append every proxy whose enlarged bounds are at least partially inside [frustum] to [proxies]. Once a
+     * node is found to be entirely inside, its leaves are collected without testing them against the planes.
+     */
+    void SceneBVH::queryFrustum(const Frustum& frustum, std::vector<UInt32>& proxies) const {
+        if (this->root == InvalidNode) return;
+
+        UInt32 stack[QueryStackSize];
+        Bool stackInside[QueryStackSize];
+        UInt32 stackSize = 0;
+        stack[stackSize] = this->root;
+        stackInside[stackSize++] = false;
+        while (stackSize > 0) {
+            stackSize--;
+            const Node& node = this->nodes[stack[stackSize]];
+            Bool inside = stackInside[stackSize];
+            if (!inside) {
+                Bool outside = false;
+                inside = true;
+                for (UInt32 i = 0; i < Frustum::PlaneCount && !outside; i++) {
+                    const Vector4r& plane = frustum.getPlane(i);
+                    // the corners furthest along and against the plane normal
+                    Real px = plane.x >= 0.0f ? node.max[0] : node.min[0];
+                    Real py = plane.y >= 0.0f ? node.max[1] : node.min[1];
+                    Real pz = plane.z >= 0.0f ? node.max[2] : node.min[2];
+                    Real nx = plane.x >= 0.0f ? node.min[0] : node.max[0];
+                    Real ny = plane.y >= 0.0f ? node.min[1] : node.max[1];
+                    Real nz = plane.z >= 0.0f ? node.min[2] : node.max[2];
+                    if (plane.x * px + plane.y * py + plane.z * pz + plane.w < 0.0f) outside = true;
+                    else if (plane.x * nx + plane.y * ny + plane.z * nz + plane.w < 0.0f) inside = false;
+                }
+                if (outside) continue;
+            }
+
+            if (node.isLeaf()) {
+                proxies.push_back((UInt32)(&node - this->nodes.data()));
+            }
+            else {
+                stack[stackSize] = node.left;
+                stackInside[stackSize++] = inside;
+                stack[stackSize] = node.right;
+                stackInside[stackSize++] = inside;
+            }
+        }
+    }
+
+    /*
+     * Report every proxy whose enlarged bounds [ray] passes through within [0, maxT] to [callback]. The ray
+     * parameter is measured in multiples of the ray's direction. Nearer children are visited first, and nodes
+     * the ray enters beyond the maximum returned by the callback are skipped, which lets closest-hit queries
+     * end early.
+     */
+    void SceneBVH::queryRay(const Ray& ray, Real maxT, RayQueryCallback callback) const {
+        if (this->root == InvalidNode) return;
+        Real origin[] = {ray.Origin.x, ray.Origin.y, ray.Origin.z};
+        Real inverseDirection[] = {1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z};
+
+        UInt32 stack[QueryStackSize];
+        Real stackT[QueryStackSize];
+        UInt32 stackSize = 0;
+        Real entryT;
+        if (!intersectNode(this->nodes[this->root], origin, inverseDirection, maxT, entryT)) return;
+        stack[stackSize] = this->root;
+        stackT[stackSize++] = entryT;
+
+        while (stackSize > 0) {
+            stackSize--;
+            if (stackT[stackSize] > maxT) continue;
+            UInt32 nodeIndex = stack[stackSize];
+            const Node& node = this->nodes[nodeIndex];
+
+            if (node.isLeaf()) {
+                maxT = callback(nodeIndex, stackT[stackSize]);
+                if (maxT < 0.0f) return;
+            }
+            else {
+                UInt32 near = node.left;
+                UInt32 far = node.right;
+                Real nearT, farT;
+                Bool hitNear = intersectNode(this->nodes[near], origin, inverseDirection, maxT, nearT);
+                Bool hitFar = intersectNode(this->nodes[far], origin, inverseDirection, maxT, farT);
+                if (hitNear && hitFar && farT < nearT) {
+                    std::swap(near, far);
+                    std::swap(nearT, farT);
+                }
+                if (hitFar) {
+                    stack[stackSize] = far;
+                    stackT[stackSize++] = farT;
+                }
+                if (hitNear) {
+                    stack[stackSize] = near;
+                    stackT[stackSize++] = nearT;
+                }
+            }
+        }
+    }
+
+    UInt32 SceneBVH::allocateNode() {
+        UInt32 nodeIndex;
+        if (this->freeList != InvalidNode) {
+            nodeIndex = this->freeList;
+            this->freeList = this->nodes[nodeIndex].parent;
+        }
+        else {
+            nodeIndex = (UInt32)this->nodes.size();
+            this->nodes.push_back(Node());
+        }
+        Node& node = this->nodes[nodeIndex];
+        node.parent = InvalidNode;
+        node.left = InvalidNode;
+        node.right = InvalidNode;
+        node.height = 0;
+        node.userData = 0;
+        return nodeIndex;
+    }
+
+    void SceneBVH::freeNode(UInt32 nodeIndex) {
+        Node& node = this->nodes[nodeIndex];
+        node.parent = this->freeList;
+        node.height = -1;
+        this->freeList = nodeIndex;
+    }
+
+    /*
+     * Pair [leaf] with the node that minimizes the growth in surface area of the tree (the cost of the new
+     * parent plus the growth of every ancestor), then refit and rebalance the path back to the root.
+     */
+    void SceneBVH::insertLeaf(UInt32 leaf) {
+        if (this->root == InvalidNode) {
+            this->root = leaf;
+            this->nodes[leaf].parent = InvalidNode;
+            return;
+        }
+
+        const Node& leafNode = this->nodes[leaf];
+        UInt32 sibling = this->root;
+        while (!this->nodes[sibling].isLeaf()) {
+            const Node& node = this->nodes[sibling];
+            Real nodeArea = area(node);
+            Real mergedArea = combinedArea(node, leafNode);
+            // cost of making [leaf] a sibling of this node, and the growth every descendant would inherit
+            Real cost = 2.0f * mergedArea;
+            Real inheritedCost = 2.0f * (mergedArea - nodeArea);
+
+            Real childCosts[2];
+            UInt32 children[] = {node.left, node.right};
+            for (UInt32 c = 0; c < 2; c++) {
+                const Node& child = this->nodes[children[c]];
+                childCosts[c] = combinedArea(child, leafNode) + inheritedCost;
+                if (!child.isLeaf()) childCosts[c] -= area(child);
+            }
+
+            if (cost < childCosts[0] && cost < childCosts[1]) break;
+            sibling = childCosts[0] < childCosts[1] ? node.left : node.right;
+        }
+
+        UInt32 oldParent = this->nodes[sibling].parent;
+        UInt32 newParent = this->allocateNode();
+        Node& parentNode = this->nodes[newParent];
+        parentNode.parent = oldParent;
+        parentNode.left = sibling;
+        parentNode.right = leaf;
+        this->nodes[sibling].parent = newParent;
+        this->nodes[leaf].parent = newParent;
+        if (oldParent == InvalidNode) this->root = newParent;
+        else this->replaceChild(oldParent, sibling, newParent);
+
+        for (UInt32 nodeIndex = newParent; nodeIndex != InvalidNode; nodeIndex = this->nodes[nodeIndex].parent) {
+            nodeIndex = this->balance(nodeIndex);
+            this->refit(nodeIndex);
+        }
+    }
+
+    /*
+     * Detach [leaf] from the tree, replacing its parent with its sibling, and refit and rebalance the path
+     * back to the root. The leaf node itself is left allocated.
+     */
+    void SceneBVH::removeLeaf(UInt32 leaf) {
+        if (leaf == this->root) {
+            this->root = InvalidNode;
+            return;
+        }
+
+        UInt32 parent = this->nodes[leaf].parent;
+        const Node& parentNode = this->nodes[parent];
+        UInt32 grandParent = parentNode.parent;
+        UInt32 sibling = parentNode.left == leaf ? parentNode.right : parentNode.left;
+
+        this->nodes[sibling].parent = grandParent;
+        this->freeNode(parent);
+        if (grandParent == InvalidNode) {
+            this->root = sibling;
+            return;
+        }
+
+        this->replaceChild(grandParent, parent, sibling);
+        for (UInt32 nodeIndex = grandParent; nodeIndex != InvalidNode; nodeIndex = this->nodes[nodeIndex].parent) {
+            nodeIndex = this->balance(nodeIndex);
+            this->refit(nodeIndex);
+        }
+    }
+
+    /*
+     * If the heights of the children of [nodeIndex] differ by more than one, rotate the taller child into
+     * its place, handing the shorter of the taller child's own children down to [nodeIndex]. Returns the
+     * node that now sits where [nodeIndex] was.
+     */
+    UInt32 SceneBVH::balance(UInt32 nodeIndex) {
+        Node& node = this->nodes[nodeIndex];
+        if (node.isLeaf() || node.height < 2) return nodeIndex;
+
+        Int32 difference = this->nodes[node.right].height - this->nodes[node.left].height;
+        if (difference >= -1 && difference <= 1) return nodeIndex;
+
+        UInt32 shorter = difference > 0 ? node.left : node.right;
+        UInt32 taller = difference > 0 ? node.right : node.left;
+        Node& tallerNode = this->nodes[taller];
+        UInt32 tallerLeft = tallerNode.left;
+        UInt32 tallerRight = tallerNode.right;
+
+        // [taller] takes the place of [nodeIndex], which becomes its left child
+        tallerNode.parent = node.parent;
+        if (node.parent == InvalidNode) this->root = taller;
+        else this->replaceChild(node.parent, nodeIndex, taller);
+        node.parent = taller;
+        tallerNode.left = nodeIndex;
+
+        // the taller grandchild stays with [taller], the other one moves under [nodeIndex]
+        Bool keepLeft = this->nodes[tallerLeft].height > this->nodes[tallerRight].height;
+        UInt32 kept = keepLeft ? tallerLeft : tallerRight;
+        UInt32 moved = keepLeft ? tallerRight : tallerLeft;
+        tallerNode.right = kept;
+        this->nodes[moved].parent = nodeIndex;
+        node.left = shorter;
+        node.right = moved;
+
+        this->refit(nodeIndex);
+        this->refit(taller);
+        return taller;
+    }
+
+    /*
+     * Recompute the bounds and height of the interior node [nodeIndex] from its children.
+     */
+    void SceneBVH::refit(UInt32 nodeIndex) {
+        Node& node = this->nodes[nodeIndex];
+        const Node& left = this->nodes[node.left];
+        const Node& right = this->nodes[node.right];
+        for (UInt32 a = 0; a < 3; a++) {
+            node.min[a] = Math::min(left.min[a], right.min[a]);
+            node.max[a] = Math::max(left.max[a], right.max[a]);
+        }
+        node.height = 1 + Math::max(left.height, right.height);
+    }
+
+    void SceneBVH::replaceChild(UInt32 parent, UInt32 oldChild, UInt32 newChild) {
+        Node& parentNode = this->nodes[parent];
+        if (parentNode.left == oldChild) parentNode.left = newChild;
+        else parentNode.right = newChild;
+    }
+
+    void SceneBVH::validateProxy(UInt32 proxy, const char * function) const {
+        if (proxy >= this->nodes.size() || !this->nodes[proxy].isLeaf() || this->nodes[proxy].height < 0) {
+            throw InvalidArgumentException(std::string(function) + " -> Invalid proxy.");
+        }
+    }
+
+    void SceneBVH::setFatBounds(Node& node, const Box3& bounds) const {
+        const Vector3r& min = bounds.getMin();
+        const Vector3r& max = bounds.getMax();
+        node.min[0] = min.x - this->margin;
+        node.min[1] = min.y - this->margin;
+        node.min[2] = min.z - this->margin;
+        node.max[0] = max.x + this->margin;
+        node.max[1] = max.y + this->margin;
+        node.max[2] = max.z + this->margin;
+    }
+
+    /*
+     * Slab test of the bounds of [node] against a ray over [0, maxT]. [entryT] receives the ray parameter at
+     * which the ray enters the bounds.
+     */
+    Bool SceneBVH::intersectNode(const Node& node, const Real * origin, const Real * inverseDirection, Real maxT, Real& entryT) {
+        Real tMin = 0.0f;
+        Real tMax = maxT;
+        for (UInt32 a = 0; a < 3; a++) {
+            Real t1 = (node.min[a] - origin[a]) * inverseDirection[a];
+            Real t2 = (node.max[a] - origin[a]) * inverseDirection[a];
+            if (t1 > t2) std::swap(t1, t2);
+            if (t1 > tMin) tMin = t1;
+            if (t2 < tMax) tMax = t2;
+            if (tMin > tMax) return false;
+        }
+        entryT = tMin;
+        return true;
+    }
+
+    Bool SceneBVH::containsBox(const Node& node, const Real * min, const Real * max) {
+        for (UInt32 a = 0; a < 3; a++) {
+            if (min[a] < node.min[a] || max[a] > node.max[a]) return false;
+        }
+        return true;
+    }
+
+    /*
+     * Half the surface area of the box enclosing both [a] and [b], which is all the insertion cost needs.
+     */
+    Real SceneBVH::combinedArea(const Node& a, const Node& b) {
+        Real dx = Math::max(a.max[0], b.max[0]) - Math::min(a.min[0], b.min[0]);
+        Real dy = Math::max(a.max[1], b.max[1]) - Math::min(a.min[1], b.min[1]);
+        Real dz = Math::max(a.max[2], b.max[2]) - Math::min(a.min[2], b.min[2]);
+        return dx * dy + dy * dz + dz * dx;
+    }
+
+    Real SceneBVH::area(const Node& node) {
+        Real dx = node.max[0] - node.min[0];
+        Real dy = node.max[1] - node.min[1];
+        Real dz = node.max[2] - node.min[2];
+        return dx * dy + dy * dz + dz * dx;
+    }
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "../common/types.h"
+#include "../geometry/Vector3.h"
+#include "../geometry/Box3.h"
+
+namespace Core {
+
+    // forward declarations
+    class Ray;
+    class Frustum;
+
+    /*
+     * Dynamic bounding volume hierarchy over world-space boxes, e.g. the bounds of the objects in a scene.
+     * Each box is a proxy stored in a leaf, enlarged by a margin so that small movements don't require any
+     * change to the tree. Proxies that move out of their enlarged bounds are removed and re-inserted, and
+     * every insertion and removal rebalances the nodes along its path, so queries stay logarithmic in the
+     * number of proxies no matter the order in which they are added or moved.
+     *
+     * Proxy IDs stay valid until the proxy is removed, after which they can be reused.
+     */
+    class SceneBVH {
+    public:
+
+        // called with the proxy and the ray parameter at which the ray enters its bounds. returns the new
+        // maximum ray parameter to search up to, or a negative value to end the query.
+        using RayQueryCallback = std::function<Real(UInt32 proxy, Real entryT)>;
+
+        static const UInt32 InvalidProxy = 0xFFFFFFFF;
+        static constexpr Real DefaultMargin = 0.1f;
+
+        SceneBVH(Real margin = DefaultMargin);
+
+        UInt32 addProxy(const Box3& bounds, UInt32 userData);
+        void removeProxy(UInt32 proxy);
+        Bool moveProxy(UInt32 proxy, const Box3& bounds);
+        void clear();
+
+        UInt32 getUserData(UInt32 proxy) const;
+        void setUserData(UInt32 proxy, UInt32 userData);
+        void getFatBounds(UInt32 proxy, Box3& bounds) const;
+        UInt32 getProxyCount() const;
+        UInt32 getHeight() const;
+
+        void queryBox(const Box3& box, std::vector<UInt32>& proxies) const;
+        void querySphere(const Point3r& center, Real radius, std::vector<UInt32>& proxies) const;
+        void queryFrustum(const Frustum& frustum, std::vector<UInt32>& proxies) const;
+        void queryRay(const Ray& ray, Real maxT, RayQueryCallback callback) const;
+
+    private:
+
+        static const UInt32 InvalidNode = 0xFFFFFFFF;
+        // queries walk the tree with a fixed-size stack. a balanced tree with 2^32 leaves is less than
+        // 64 levels deep, and the stack never holds more than one node per level plus one.
+        static const UInt32 QueryStackSize = 128;
+
+        class Node {
+        public:
+            Real min[3];
+            Real max[3];
+            // next node on the free list for unused nodes
+            UInt32 parent;
+            // InvalidNode for leaves
+            UInt32 left;
+            UInt32 right;
+            // zero for leaves, -1 for unused nodes
+            Int32 height;
+            UInt32 userData;
+
+            Bool isLeaf() const;
+        };
+
+        UInt32 allocateNode();
+        void freeNode(UInt32 nodeIndex);
+        void insertLeaf(UInt32 leaf);
+        void removeLeaf(UInt32 leaf);
+        UInt32 balance(UInt32 nodeIndex);
+        void refit(UInt32 nodeIndex);
+        void replaceChild(UInt32 parent, UInt32 oldChild, UInt32 newChild);
+        void validateProxy(UInt32 proxy, const char * function) const;
+        void setFatBounds(Node& node, const Box3& bounds) const;
+        static Bool intersectNode(const Node& node, const Real * origin, const Real * inverseDirection, Real maxT, Real& entryT);
+        static Bool containsBox(const Node& node, const Real * min, const Real * max);
+        static Real combinedArea(const Node& a, const Node& b);
+        static Real area(const Node& node);
+
+        Real margin;
+        std::vector<Node> nodes;
+        UInt32 root;
+        UInt32 freeList;
+        UInt32 proxyCount;
+    };
+
+}
@@ -1,94 +1,164 @@
 #include "../util/WeakPointer.h"
 #include "Object3D.h"
+#include "TransformHierarchy.h"
+#include "../Engine.h"
 
 namespace Core {
 
-    Transform::Transform(const Object3D& target) : target(target) {
-        this->localMatrix.setIdentity();
-        this->worldMatrix.setIdentity();
+    Transform::Transform(const Object3D& target) : target(target), hierarchy(Engine::instance()->getTransformHierarchy()) {
+        this->handle = this->hierarchy.allocate();
     }
 
-    Transform::Transform(const Object3D& target, const Matrix4x4& matrix) : target(target) {
-        this->localMatrix.copy(matrix);
+    Transform::Transform(const Object3D& target, const Matrix4x4& matrix) : target(target), hierarchy(Engine::instance()->getTransformHierarchy()) {
+        this->handle = this->hierarchy.allocate();
+        this->hierarchy.getLocalMatrix(this->handle).copy(matrix);
     }
 
     Transform::~Transform() {
+        if (!Engine::isShuttingDown()) {
+            this->hierarchy.release(this->handle);
+        }
     }
 
+    /*
+     * The caller may modify the returned matrix, so the world matrices of this transform and
+     * its descendants are invalidated. Use getConstLocalMatrix() for read-only access.
+     */
     Matrix4x4& Transform::getLocalMatrix() {
-        return this->localMatrix;
+        this->invalidateWorldMatrix();
+        return this->localMatrix();
     }
 
     const Matrix4x4& Transform::getConstLocalMatrix() const {
-        return this->localMatrix;
+        return this->hierarchy.getLocalMatrix(this->handle);
     }
 
     Matrix4x4& Transform::getWorldMatrix() {
-        return this->worldMatrix;
+        return this->worldMatrix();
     }
 
     const Matrix4x4& Transform::getConstWorldMatrix() const {
-        return this->worldMatrix;
+        return this->hierarchy.getWorldMatrix(this->handle);
     }
 
     Matrix4x4& Transform::getInverseWorldMatrix() {
-        return this->inverseWorldMatrix;
+        return this->hierarchy.getInverseWorldMatrix(this->handle);
     }
 
     const Matrix4x4& Transform::getConstInverseWorldMatrix() const {
-        return this->inverseWorldMatrix;
+        return this->hierarchy.getInverseWorldMatrix(this->handle);
     }
 
     /*
      * Copy this Transform object's local matrix into [dest].
      */
     void Transform::copyLocalMatrix(Matrix4x4& dest) const {
-        dest.copy(this->localMatrix);
+        dest.copy(this->getConstLocalMatrix());
     }
 
     /*
      * Copy this Transform object's world matrix into [dest].
      */
     void Transform::copyWorldMatrix(Matrix4x4& dest) const {
-        dest.copy(this->worldMatrix);
+        dest.copy(this->getConstWorldMatrix());
     }
 
     void Transform::setLocalMatrix(const Matrix4x4& mat) {
-        this->localMatrix.copy(mat);
+        this->localMatrix().copy(mat);
+        this->invalidateWorldMatrix();
     }
 
     void Transform::applyTransformationTo(Vector4<Real>& vector) {
         this->updateWorldMatrix();
-        this->worldMatrix.transform(vector);
+        this->worldMatrix().transform(vector);
     }
 
     void Transform::applyTransformationTo(Vector3Base<Real>& vector) {
         this->updateWorldMatrix();
-        this->worldMatrix.transform(vector);
-    }
-
-    void Transform::getWorldMatrix(WeakPointer<Object3D> target, Matrix4x4& result) {
-        result.setIdentity();
-        if (!target.isValid()) return;
-        result.copy(target->getTransform().getLocalMatrix());
-        WeakPointer<Object3D> parent = target->getParent();
-        while (parent.isValid()) {
-            result.preMultiply(parent->getTransform().getLocalMatrix());
-            parent = parent->getParent();
-        }
+        this->worldMatrix().transform(vector);
     }
 
+    /*
+     * Copy the world matrix into [result], recomputing it first only if it is out of date.
+     */
     void Transform::getWorldMatrix(Matrix4x4& result) {
-        this->getAncestorWorldMatrix(result);
-        result.multiply(this->localMatrix);
+        this->updateWorldMatrix();
+        result.copy(this->worldMatrix());
     }
 
     void Transform::getAncestorWorldMatrix(Matrix4x4& result) {
-        Transform::getWorldMatrix(this->target.getParent(), result);
+        WeakPointer<Object3D> parent = this->target.getParent();
+        if (parent.isValid()) {
+            parent->getTransform().getWorldMatrix(result);
+        }
+        else {
+            result.setIdentity();
+        }
     }
 
+    /*
+     * Recompute the world matrix and its inverse if this transform or one of its ancestors changed
+     * since they were last computed. Ancestors are brought up to date first, so for a clean parent
+     * this costs one multiply and one inverse, and nothing at all when this transform is clean.
+     */
     void Transform::updateWorldMatrix() {
-        this->getWorldMatrix(this->worldMatrix);
+        this->hierarchy.updateWorldMatrix(this->handle);
+    }
+
+    /*
+     * Flag the world matrices of this transform and all of its descendants as out of date. A dirty
+     * transform never has a clean descendant, so the walk stops at transforms that are already dirty.
+     */
+    void Transform::invalidateWorldMatrix() {
+        if (!this->hierarchy.setDirty(this->handle)) return;
+        for (WeakPointer<Object3D> child : this->target.children) {
+            if (child.isValid()) child->getTransform().invalidateWorldMatrix();
+        }
+    }
+
+    Bool Transform::isWorldMatrixDirty() const {
+        return this->hierarchy.isDirty(this->handle);
+    }
+
+    Bool Transform::hasWorldMatrix() const {
+        return this->hierarchy.hasWorldMatrix(this->handle);
+    }
+
+    UInt32 Transform::getWorldMatrixVersion() const {
+        return this->hierarchy.getWorldMatrixVersion(this->handle);
+    }
+
+    void Transform::setParent(const Transform* parent) {
+        this->hierarchy.setParent(this->handle, parent != nullptr ? parent->handle : TransformHierarchy::InvalidIndex);
+        this->invalidateWorldMatrix();
+    }
+
+    /*
+     * Static transforms are skipped by updates once computed, and a transform that is already dirty stops
+     * invalidateWorldMatrix(), so when [isStatic] is false every transform in the subtree is flagged dirty
+     * again to pick up any changes made while it was static.
+     */
+    void Transform::setStatic(Bool isStatic) {
+        this->hierarchy.setStatic(this->handle, isStatic);
+        if (!isStatic) this->forceInvalidateWorldMatrix();
+    }
+
+    /*
+     * Same as invalidateWorldMatrix(), but without stopping at transforms that are already dirty.
+     */
+    void Transform::forceInvalidateWorldMatrix() {
+        this->hierarchy.setDirty(this->handle);
+        for (WeakPointer<Object3D> child : this->target.children) {
+            if (child.isValid()) child->getTransform().forceInvalidateWorldMatrix();
+        }
+    }
+
+    Matrix4x4& Transform::localMatrix() {
+        return this->hierarchy.getLocalMatrix(this->handle);
+    }
+
+    Matrix4x4& Transform::worldMatrix() {
+        return this->hierarchy.getWorldMatrix(this->handle);
     }
 
     /*
@@ -146,7 +216,7 @@ namespace Core {
 
         Point3r src;
         this->updateWorldMatrix();
-        this->worldMatrix.transform(src);
+        this->worldMatrix().transform(src);
 
         Matrix4x4 temp;
         temp.lookAt(src, target, up);
@@ -155,26 +225,25 @@ namespace Core {
 
         if (parent.isValid()) {
             parent->getTransform().updateWorldMatrix();
-            Matrix4x4 parentMat = parent->getTransform().getWorldMatrix();
-            parentMat.invert();
-            temp.preMultiply(parentMat);
+            temp.preMultiply(parent->getTransform().getConstInverseWorldMatrix());
         }
 
-        this->getLocalMatrix().copy(temp);
+        this->setLocalMatrix(temp);
     }
 
     void Transform::transformBy(const Matrix4x4& mat, TransformationSpace transformationSpace) {
         if (transformationSpace == TransformationSpace::Local) {
-            this->localMatrix.multiply(mat);
+            this->localMatrix().multiply(mat);
         }
         else if (transformationSpace == TransformationSpace::PreLocal) {
-            this->localMatrix.preMultiply(mat);
+            this->localMatrix().preMultiply(mat);
         }
         else {
             Matrix4x4 localTransformation;
             this->getLocalTransformationFromWorldTransformation(mat, localTransformation);
-            this->localMatrix.multiply(localTransformation); 
+            this->localMatrix().multiply(localTransformation); 
         }
+        this->invalidateWorldMatrix();
     }
 
     void Transform::translate(const Vector3<Real>& dir, TransformationSpace transformationSpace) {
@@ -183,19 +252,20 @@ namespace Core {
 
     void Transform::translate(Real x, Real y, Real z, TransformationSpace transformationSpace) {
         if (transformationSpace == TransformationSpace::Local) {
-            this->localMatrix.translate(x, y, z);
+            this->localMatrix().translate(x, y, z);
         }
         else if (transformationSpace == TransformationSpace::PreLocal) {
-            this->localMatrix.preTranslate(x, y, z);
+            this->localMatrix().preTranslate(x, y, z);
         }
         else {
             Matrix4x4 localTransformation;
             Matrix4x4 worldTransformation;
             worldTransformation.translate(x, y, z);
             this->getLocalTransformationFromWorldTransformation(worldTransformation, localTransformation);
-            this->localMatrix.multiply(localTransformation);
+            this->localMatrix().multiply(localTransformation);
             
         }
+        this->invalidateWorldMatrix();
     }
 
     void Transform::rotate(const Vector3<Real>& axis, Real angle, TransformationSpace transformationSpace) {
@@ -204,18 +274,19 @@ namespace Core {
 
     void Transform::rotate(Real x, Real y, Real z, Real angle, TransformationSpace transformationSpace) {
         if (transformationSpace == TransformationSpace::Local) {
-            this->localMatrix.rotate(x, y, z, angle);
+            this->localMatrix().rotate(x, y, z, angle);
         }
         else if (transformationSpace == TransformationSpace::PreLocal) {
-            this->localMatrix.preRotate(x, y, z, angle);
+            this->localMatrix().preRotate(x, y, z, angle);
         }
         else {
             Matrix4x4 localTransformation;
             Matrix4x4 worldTransformation;
             worldTransformation.rotate(x, y, z, angle);
             this->getLocalTransformationFromWorldTransformation(worldTransformation, localTransformation);
-            this->localMatrix.multiply(localTransformation);
+            this->localMatrix().multiply(localTransformation);
         }
+        this->invalidateWorldMatrix();
     }
 
     void Transform::rotateAround(const Vector3<Real>& axis, const Point3<Real>& pos, Real angle) {
@@ -229,7 +300,8 @@ namespace Core {
         worldTransformation.preRotate(ax, ay, az, angle);
         worldTransformation.preTranslate(px, py, pz);
         this->getLocalTransformationFromWorldTransformation(worldTransformation, localTransformation);
-        this->localMatrix.multiply(localTransformation);
+        this->localMatrix().multiply(localTransformation);
+        this->invalidateWorldMatrix();
     }
 
     void Transform::scale(Real x, Real y, Real z) {
@@ -251,22 +323,21 @@ namespace Core {
         Matrix4x4 fullMatrix;
         this->getAncestorWorldMatrix(ancestorMatrix);
         fullMatrix = ancestorMatrix;
-        fullMatrix.multiply(this->localMatrix);
+        fullMatrix.multiply(this->localMatrix());
         fullMatrix.transform(oldPosition);
         Vector3r toNewPosition(x - oldPosition.x, y - oldPosition.y, z - oldPosition.z);
         Matrix4x4 worldTranslateMatrix;
         worldTranslateMatrix.preTranslate(toNewPosition);
         Matrix4x4 localTranslateMatrix;
         this->getLocalTransformationFromWorldTransformation(worldTranslateMatrix, fullMatrix, localTranslateMatrix);
-        this->localMatrix.multiply(localTranslateMatrix);
-        this->worldMatrix = ancestorMatrix;
-        this->worldMatrix.multiply(this->localMatrix);
+        this->localMatrix().multiply(localTranslateMatrix);
+        this->invalidateWorldMatrix();
     }
 
     Point3r Transform::getWorldPosition() {
         Point3r position;
         this->updateWorldMatrix();
-        this->worldMatrix.transform(position);
+        this->worldMatrix().transform(position);
         return position;
     }
 }
@@ -7,14 +7,24 @@ namespace Core {
 
     // forward declarations
     class Object3D;
+    class TransformHierarchy;
 
+    /*
+     * Handle to an Object3D's entry in the engine's TransformHierarchy, which holds the actual matrices.
+     */
     class Transform {
     public:
 
+        friend class Object3D;
+
         Transform(const Object3D& target);
         explicit Transform(const Object3D& target, const Matrix4x4& matrix);
+        // a Transform owns its TransformHierarchy handle, so a copy would release it a second time
+        Transform(const Transform& other) = delete;
+        Transform& operator=(const Transform& other) = delete;
         virtual ~Transform();
 
+        // these refer to the Object3D's entry in the engine's TransformHierarchy, which stays put for its lifetime
         Matrix4x4& getLocalMatrix();
         const Matrix4x4& getConstLocalMatrix() const;
         Matrix4x4& getWorldMatrix();
@@ -52,16 +62,24 @@ namespace Core {
         void updateWorldMatrix();
         void getAncestorWorldMatrix(Matrix4x4& result);
         void getWorldMatrix(Matrix4x4& result);
+        void invalidateWorldMatrix();
+        Bool isWorldMatrixDirty() const;
+        Bool hasWorldMatrix() const;
+        UInt32 getWorldMatrixVersion() const;
 
     private:
 
-        static void getWorldMatrix(WeakPointer<Object3D> target, Matrix4x4& result);
+        void setParent(const Transform* parent);
+        void setStatic(Bool isStatic);
+        void forceInvalidateWorldMatrix();
+        Matrix4x4& localMatrix();
+        Matrix4x4& worldMatrix();
+
         void getLocalTransformationFromWorldTransformation(const Matrix4x4& newWorldTransformation, Matrix4x4& localTransformation);
         void getLocalTransformationFromWorldTransformation(const Matrix4x4& newWorldTransformation, const Matrix4x4& currentFullTransformation, Matrix4x4& localTransformation);
 
-        Matrix4x4 localMatrix;
-        Matrix4x4 worldMatrix;
-        Matrix4x4 inverseWorldMatrix; 
         const Object3D& target;
+        TransformHierarchy& hierarchy;
+        UInt32 handle;
     };
 }
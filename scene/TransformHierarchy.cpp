@@ -0,0 +1,301 @@
+#include "TransformHierarchy.h"
+#include "../common/Exception.h"
+#include "../util/JobSystem.h"
+
+namespace Core {
+
+    const UInt32 TransformHierarchy::InvalidIndex;
+
+    TransformHierarchy::TransformHierarchy(): releasedSlotCount(0), orderDirty(false), sortedSlotCount(0) {
+    }
+
+    /*
+     * Add a new root transform with identity matrices and return its handle. The new entry goes
+     * at the end of the slot arrays, which can never break the parent-before-child ordering.
+     */
+    UInt32 TransformHierarchy::allocate() {
+        UInt32 handle;
+        if (this->freeHandles.size() > 0) {
+            handle = this->freeHandles.back();
+            this->freeHandles.pop_back();
+        }
+        else {
+            handle = (UInt32)this->handleSlots.size();
+            this->handleSlots.push_back(InvalidIndex);
+            if ((handle >> MatrixPageShift) >= this->matrixPages.size()) {
+                this->matrixPages.push_back(std::unique_ptr<MatrixPage>(new MatrixPage()));
+            }
+        }
+
+        UInt32 index = handle & (MatrixPageSize - 1);
+        MatrixPage& page = this->getMatrixPage(handle);
+        page.localMatrices[index].setIdentity();
+        page.worldMatrices[index].setIdentity();
+        page.inverseWorldMatrices[index].setIdentity();
+
+        UInt32 slot = (UInt32)this->slotHandles.size();
+        this->parentSlots.push_back(InvalidIndex);
+        this->flags.push_back(Dirty);
+        this->worldMatrixVersions.push_back(0);
+        this->slotHandles.push_back(handle);
+        this->handleSlots[handle] = slot;
+        return handle;
+    }
+
+    /*
+     * Free [handle] for reuse. Its slot stays in the arrays until the next rebuild() compacts them.
+     */
+    void TransformHierarchy::release(UInt32 handle) {
+        if (handle >= this->handleSlots.size() || this->handleSlots[handle] == InvalidIndex) {
+            throw InvalidArgumentException("TransformHierarchy::release() -> Invalid handle.");
+        }
+        UInt32 slot = this->handleSlots[handle];
+        this->slotHandles[slot] = InvalidIndex;
+        this->parentSlots[slot] = InvalidIndex;
+        this->flags[slot] = 0;
+        this->handleSlots[handle] = InvalidIndex;
+        this->freeHandles.push_back(handle);
+        this->releasedSlotCount++;
+    }
+
+    /*
+     * Attach the transform for [handle] to [parentHandle], or detach it when [parentHandle] is InvalidIndex.
+     * A sorted transform changes depth, so the levels have to be rebuilt. An unsorted one only needs that
+     * when it ends up ahead of its parent; its descendants still follow it, so checking that one pair is enough.
+     */
+    void TransformHierarchy::setParent(UInt32 handle, UInt32 parentHandle) {
+        UInt32 slot = this->handleSlots[handle];
+        UInt32 parentSlot = parentHandle == InvalidIndex ? InvalidIndex : this->handleSlots[parentHandle];
+        this->parentSlots[slot] = parentSlot;
+        if (slot < this->sortedSlotCount || (parentSlot != InvalidIndex && parentSlot > slot)) {
+            this->orderDirty = true;
+        }
+    }
+
+    UInt32 TransformHierarchy::getCount() const {
+        return (UInt32)this->slotHandles.size() - this->releasedSlotCount;
+    }
+
+    Matrix4x4& TransformHierarchy::getLocalMatrix(UInt32 handle) {
+        return this->getMatrixPage(handle).localMatrices[handle & (MatrixPageSize - 1)];
+    }
+
+    const Matrix4x4& TransformHierarchy::getLocalMatrix(UInt32 handle) const {
+        return this->getMatrixPage(handle).localMatrices[handle & (MatrixPageSize - 1)];
+    }
+
+    Matrix4x4& TransformHierarchy::getWorldMatrix(UInt32 handle) {
+        return this->getMatrixPage(handle).worldMatrices[handle & (MatrixPageSize - 1)];
+    }
+
+    const Matrix4x4& TransformHierarchy::getWorldMatrix(UInt32 handle) const {
+        return this->getMatrixPage(handle).worldMatrices[handle & (MatrixPageSize - 1)];
+    }
+
+    Matrix4x4& TransformHierarchy::getInverseWorldMatrix(UInt32 handle) {
+        return this->getMatrixPage(handle).inverseWorldMatrices[handle & (MatrixPageSize - 1)];
+    }
+
+    const Matrix4x4& TransformHierarchy::getInverseWorldMatrix(UInt32 handle) const {
+        return this->getMatrixPage(handle).inverseWorldMatrices[handle & (MatrixPageSize - 1)];
+    }
+
+    Bool TransformHierarchy::isDirty(UInt32 handle) const {
+        return (this->flags[this->handleSlots[handle]] & Dirty) != 0;
+    }
+
+    /*
+     * Flag the world matrices for [handle] as out of date. Returns false if they already were.
+     */
+    Bool TransformHierarchy::setDirty(UInt32 handle) {
+        UInt8& slotFlags = this->flags[this->handleSlots[handle]];
+        if (slotFlags & Dirty) return false;
+        slotFlags |= Dirty;
+        return true;
+    }
+
+    Bool TransformHierarchy::hasWorldMatrix(UInt32 handle) const {
+        return (this->flags[this->handleSlots[handle]] & Computed) != 0;
+    }
+
+    /*
+     * Changes whenever the world matrices for [handle] are recomputed, so callers that cache data derived
+     * from them (such as world-space bounds) can tell when it is out of date without comparing matrices.
+     */
+    UInt32 TransformHierarchy::getWorldMatrixVersion(UInt32 handle) const {
+        return this->worldMatrixVersions[this->handleSlots[handle]];
+    }
+
+    void TransformHierarchy::setStatic(UInt32 handle, Bool isStatic) {
+        UInt8& slotFlags = this->flags[this->handleSlots[handle]];
+        if (isStatic) slotFlags |= Static;
+        else slotFlags &= ~Static;
+    }
+
+    /*
+     * Bring the world matrices of a single transform up to date, along with those of its ancestors.
+     */
+    void TransformHierarchy::updateWorldMatrix(UInt32 handle) {
+        this->updateSlot(this->handleSlots[handle]);
+    }
+
+    /*
+     * Bring every dirty, non-static transform up to date. Since parents precede their children, each
+     * parent's world matrix is final by the time its children read it, and the pass is a single sweep
+     * over the slot arrays.
+     */
+    void TransformHierarchy::updateWorldMatrices() {
+        if (this->orderDirty || this->releasedSlotCount > 0) {
+            this->rebuild();
+        }
+        this->updateSlots(0, (UInt32)this->flags.size());
+    }
+
+    /*
+     * Same as updateWorldMatrices(), but the transforms of each sufficiently large level are split across
+     * the threads of [jobSystem]. Transforms within a level only read world matrices from the level above.
+     */
+    void TransformHierarchy::updateWorldMatrices(JobSystem& jobSystem) {
+        if (this->orderDirty || this->releasedSlotCount > 0) {
+            this->rebuild();
+        }
+
+        UInt32 levelCount = this->levelOffsets.size() > 0 ? (UInt32)this->levelOffsets.size() - 1 : 0;
+        for (UInt32 level = 0; level < levelCount; level++) {
+            UInt32 levelStart = this->levelOffsets[level];
+            UInt32 levelSize = this->levelOffsets[level + 1] - levelStart;
+            if (levelSize >= ParallelLevelSize && jobSystem.getWorkerCount() > 0) {
+                jobSystem.parallelFor("TransformHierarchy::updateWorldMatrices", levelSize, ParallelBatchSize, [this, levelStart](UInt32 start, UInt32 end) {
+                    this->updateSlots(levelStart + start, levelStart + end);
+                });
+            }
+            else {
+                this->updateSlots(levelStart, levelStart + levelSize);
+            }
+        }
+        this->updateSlots(this->sortedSlotCount, (UInt32)this->flags.size());
+    }
+
+    void TransformHierarchy::updateSlots(UInt32 start, UInt32 end) {
+        const UInt8* slotFlags = this->flags.data();
+        for (UInt32 slot = start; slot < end; slot++) {
+            UInt8 currentFlags = slotFlags[slot];
+            if (!(currentFlags & Dirty)) continue;
+            if ((currentFlags & (Static | Computed)) == (Static | Computed)) continue;
+            this->computeWorldMatrix(slot);
+        }
+    }
+
+    void TransformHierarchy::updateSlot(UInt32 slot) {
+        if (!(this->flags[slot] & Dirty)) return;
+        UInt32 parentSlot = this->parentSlots[slot];
+        if (parentSlot != InvalidIndex) {
+            this->updateSlot(parentSlot);
+        }
+        this->computeWorldMatrix(slot);
+    }
+
+    void TransformHierarchy::computeWorldMatrix(UInt32 slot) {
+        UInt32 handle = this->slotHandles[slot];
+        UInt32 index = handle & (MatrixPageSize - 1);
+        MatrixPage& page = this->getMatrixPage(handle);
+        UInt32 parentSlot = this->parentSlots[slot];
+        Matrix4x4& world = page.worldMatrices[index];
+        if (parentSlot != InvalidIndex) {
+            Matrix4x4::multiply(this->getWorldMatrix(this->slotHandles[parentSlot]), page.localMatrices[index], world);
+        }
+        else {
+            world.copy(page.localMatrices[index]);
+        }
+        Matrix4x4& inverseWorld = page.inverseWorldMatrices[index];
+        inverseWorld.copy(world);
+        inverseWorld.invert();
+        this->flags[slot] = (this->flags[slot] & ~Dirty) | Computed;
+        this->worldMatrixVersions[slot]++;
+    }
+
+    /*
+     * Drop released slots and stable-sort the remaining ones by depth in the hierarchy. The matrices
+     * are indexed by handle, so they stay where they are.
+     */
+    void TransformHierarchy::rebuild() {
+        UInt32 slotCount = (UInt32)this->slotHandles.size();
+
+        // depth of every live slot, with each walk up the parent chain stopping at the first slot
+        // whose depth is already known. transforms whose parent was released become roots.
+        this->slotDepths.assign(slotCount, InvalidIndex);
+        UInt32 maxDepth = 0;
+        for (UInt32 slot = 0; slot < slotCount; slot++) {
+            if (this->slotHandles[slot] == InvalidIndex || this->slotDepths[slot] != InvalidIndex) continue;
+
+            UInt32 top = slot;
+            UInt32 chainLength = 0;
+            while (true) {
+                UInt32 parentSlot = this->parentSlots[top];
+                if (parentSlot != InvalidIndex && this->slotHandles[parentSlot] == InvalidIndex) {
+                    this->parentSlots[top] = InvalidIndex;
+                    this->flags[top] |= Dirty;
+                    parentSlot = InvalidIndex;
+                }
+                if (parentSlot == InvalidIndex || this->slotDepths[parentSlot] != InvalidIndex) break;
+                top = parentSlot;
+                chainLength++;
+            }
+            UInt32 parentSlot = this->parentSlots[top];
+            UInt32 depth = (parentSlot == InvalidIndex ? 0 : this->slotDepths[parentSlot] + 1) + chainLength;
+            if (depth > maxDepth) maxDepth = depth;
+
+            for (UInt32 current = slot; current != top; current = this->parentSlots[current], depth--) {
+                this->slotDepths[current] = depth;
+            }
+            this->slotDepths[top] = depth;
+        }
+
+        this->depthOffsets.assign(maxDepth + 2, 0);
+        for (UInt32 slot = 0; slot < slotCount; slot++) {
+            if (this->slotHandles[slot] != InvalidIndex) this->depthOffsets[this->slotDepths[slot] + 1]++;
+        }
+        for (UInt32 d = 1; d < this->depthOffsets.size(); d++) {
+            this->depthOffsets[d] += this->depthOffsets[d - 1];
+        }
+        this->levelOffsets = this->depthOffsets;
+        this->newSlots.assign(slotCount, InvalidIndex);
+        for (UInt32 slot = 0; slot < slotCount; slot++) {
+            if (this->slotHandles[slot] != InvalidIndex) this->newSlots[slot] = this->depthOffsets[this->slotDepths[slot]]++;
+        }
+
+        UInt32 liveCount = slotCount - this->releasedSlotCount;
+        std::vector<UInt32> sortedParents(liveCount);
+        std::vector<UInt8> sortedFlags(liveCount);
+        std::vector<UInt32> sortedVersions(liveCount);
+        std::vector<UInt32> sortedHandles(liveCount);
+        for (UInt32 slot = 0; slot < slotCount; slot++) {
+            UInt32 handle = this->slotHandles[slot];
+            if (handle == InvalidIndex) continue;
+            UInt32 newSlot = this->newSlots[slot];
+            UInt32 parentSlot = this->parentSlots[slot];
+            sortedParents[newSlot] = parentSlot == InvalidIndex ? InvalidIndex : this->newSlots[parentSlot];
+            sortedFlags[newSlot] = this->flags[slot];
+            sortedVersions[newSlot] = this->worldMatrixVersions[slot];
+            sortedHandles[newSlot] = handle;
+            this->handleSlots[handle] = newSlot;
+        }
+
+        this->parentSlots.swap(sortedParents);
+        this->flags.swap(sortedFlags);
+        this->worldMatrixVersions.swap(sortedVersions);
+        this->slotHandles.swap(sortedHandles);
+        this->sortedSlotCount = liveCount;
+        this->releasedSlotCount = 0;
+        this->orderDirty = false;
+    }
+
+    TransformHierarchy::MatrixPage& TransformHierarchy::getMatrixPage(UInt32 handle) {
+        return *this->matrixPages[handle >> MatrixPageShift];
+    }
+
+    const TransformHierarchy::MatrixPage& TransformHierarchy::getMatrixPage(UInt32 handle) const {
+        return *this->matrixPages[handle >> MatrixPageShift];
+    }
+
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "../common/types.h"
+#include "../math/Matrix4x4.h"
+
+namespace Core {
+
+    // forward declarations
+    class JobSystem;
+
+    /*
+     * Storage for the matrices of every Transform, kept in separate local, world and inverse world arrays
+     * instead of inside each Object3D. Transforms refer to their entry by a handle.
+     *
+     * The hierarchy itself (parent slot, flags, handle) is kept in parallel arrays of slots sorted by depth,
+     * so a parent always precedes its children and updateWorldMatrices() can bring the whole hierarchy up
+     * to date in a single linear pass, or level by level across threads. Transforms allocated since the last
+     * sort are appended past the sorted levels and updated serially. Reparenting a sorted transform and
+     * releasing transforms only flag the arrays; they are re-sorted and compacted at the start of the next pass.
+     *
+     * The matrices are indexed by handle rather than by slot, in fixed-size pages that are never moved or
+     * freed, so references to them stay valid until the handle is released.
+     */
+    class TransformHierarchy {
+    public:
+
+        static const UInt32 InvalidIndex = 0xFFFFFFFF;
+
+        TransformHierarchy();
+
+        UInt32 allocate();
+        void release(UInt32 handle);
+        void setParent(UInt32 handle, UInt32 parentHandle);
+        UInt32 getCount() const;
+
+        Matrix4x4& getLocalMatrix(UInt32 handle);
+        const Matrix4x4& getLocalMatrix(UInt32 handle) const;
+        Matrix4x4& getWorldMatrix(UInt32 handle);
+        const Matrix4x4& getWorldMatrix(UInt32 handle) const;
+        Matrix4x4& getInverseWorldMatrix(UInt32 handle);
+        const Matrix4x4& getInverseWorldMatrix(UInt32 handle) const;
+
+        Bool isDirty(UInt32 handle) const;
+        Bool setDirty(UInt32 handle);
+        Bool hasWorldMatrix(UInt32 handle) const;
+        UInt32 getWorldMatrixVersion(UInt32 handle) const;
+        void setStatic(UInt32 handle, Bool isStatic);
+
+        void updateWorldMatrix(UInt32 handle);
+        void updateWorldMatrices();
+        void updateWorldMatrices(JobSystem& jobSystem);
+
+    private:
+
+        enum Flags : UInt8 {
+            // the world matrices are out of date
+            Dirty = 1,
+            // the world matrices have been computed at least once
+            Computed = 2,
+            // skipped by updateWorldMatrices() once computed
+            Static = 4
+        };
+
+        // levels smaller than this are not worth splitting into jobs
+        static const UInt32 ParallelLevelSize = 1024;
+        static const UInt32 ParallelBatchSize = 256;
+        // number of handles whose matrices share a page, as a power of two
+        static const UInt32 MatrixPageShift = 10;
+        static const UInt32 MatrixPageSize = 1 << MatrixPageShift;
+
+        class MatrixPage {
+        public:
+            Matrix4x4 localMatrices[MatrixPageSize];
+            Matrix4x4 worldMatrices[MatrixPageSize];
+            Matrix4x4 inverseWorldMatrices[MatrixPageSize];
+        };
+
+        void updateSlots(UInt32 start, UInt32 end);
+        void updateSlot(UInt32 slot);
+        void computeWorldMatrix(UInt32 slot);
+        void rebuild();
+        MatrixPage& getMatrixPage(UInt32 handle);
+        const MatrixPage& getMatrixPage(UInt32 handle) const;
+
+        // matrices of handle h are at index (h % MatrixPageSize) in page (h / MatrixPageSize)
+        std::vector<std::unique_ptr<MatrixPage>> matrixPages;
+        std::vector<UInt32> parentSlots;
+        std::vector<UInt8> flags;
+        // incremented every time the world matrices of a slot are recomputed
+        std::vector<UInt32> worldMatrixVersions;
+
+        // handle of the transform stored in each slot, InvalidIndex for released slots
+        std::vector<UInt32> slotHandles;
+        // current slot of each handle
+        std::vector<UInt32> handleSlots;
+        std::vector<UInt32> freeHandles;
+
+        UInt32 releasedSlotCount;
+        Bool orderDirty;
+        // slots [levelOffsets[d], levelOffsets[d + 1]) hold the transforms at depth d, up to [sortedSlotCount]
+        std::vector<UInt32> levelOffsets;
+        UInt32 sortedSlotCount;
+
+        // scratch space for rebuild()
+        std::vector<UInt32> slotDepths;
+        std::vector<UInt32> newSlots;
+        std::vector<UInt32> depthOffsets;
+    };
+
+}
@@ -0,0 +1,280 @@
+#include <chrono>
+
+#include "JobSystem.h"
+#include "../common/Exception.h"
+
+namespace Core {
+
+    thread_local const JobSystem* JobSystem::currentSystem = nullptr;
+    thread_local Int32 JobSystem::currentThreadIndex = -1;
+
+    JobSystem::Job::Job(const char* name, JobFunction function): name(name), function(function), pendingCount(1), finished(false) {
+    }
+
+    Bool JobSystem::Job::isFinished() const {
+        return this->finished.load(std::memory_order_acquire);
+    }
+
+    const char* JobSystem::Job::getName() const {
+        return this->name;
+    }
+
+    JobSystem::JobSystem(UInt32 workerCount): queuedJobCount(0), running(false) {
+        currentSystem = this;
+        currentThreadIndex = 0;
+        this->startWorkers(workerCount);
+    }
+
+    JobSystem::~JobSystem() {
+        this->stopWorkers();
+        if (currentSystem == this) {
+            currentSystem = nullptr;
+            currentThreadIndex = -1;
+        }
+    }
+
+    /*
+     * One worker per hardware thread, leaving one for the owning thread.
+     */
+    UInt32 JobSystem::getDefaultWorkerCount() {
+        UInt32 hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+
+    /*
+     * Restart the scheduler with [workerCount] worker threads; zero selects single-thread mode.
+     * Must not be called while jobs are in flight.
+     */
+    void JobSystem::setWorkerCount(UInt32 workerCount) {
+        if (workerCount == this->workers.size()) return;
+        this->stopWorkers();
+        this->startWorkers(workerCount);
+    }
+
+    UInt32 JobSystem::getWorkerCount() const {
+        return (UInt32)this->workers.size();
+    }
+
+    /*
+     * Number of threads that may run jobs, i.e. the workers plus the owning thread.
+     */
+    UInt32 JobSystem::getThreadCount() const {
+        return (UInt32)this->queues.size();
+    }
+
+    /*
+     * Index of the calling thread within its job system: 0 for the thread that created it, 1 and up
+     * for workers, and -1 for threads unknown to any job system.
+     */
+    Int32 JobSystem::getCurrentThreadIndex() {
+        return currentThreadIndex;
+    }
+
+    JobSystem::JobHandle JobSystem::createJob(const char* name, JobFunction function) {
+        return std::make_shared<Job>(name, function);
+    }
+
+    /*
+     * Prevent [job] from running before [dependency] has finished. Must be called before [job] is scheduled.
+     */
+    void JobSystem::addDependency(JobHandle job, JobHandle dependency) {
+        if (!job || !dependency) {
+            throw NullPointerException("JobSystem::addDependency() -> Invalid job.");
+        }
+        if (job->pendingCount.load() == 0) {
+            throw Exception("JobSystem::addDependency() -> Job has already been scheduled.");
+        }
+        std::lock_guard<std::mutex> guard(dependency->continuationLock);
+        if (dependency->isFinished()) return;
+        job->pendingCount.fetch_add(1);
+        dependency->continuations.push_back(job);
+    }
+
+    /*
+     * Release [job] to run as soon as all of its dependencies have finished.
+     */
+    void JobSystem::schedule(JobHandle job) {
+        if (!job) {
+            throw NullPointerException("JobSystem::schedule() -> Invalid job.");
+        }
+        if (job->pendingCount.fetch_sub(1) == 1) {
+            this->enqueue(job);
+        }
+    }
+
+    JobSystem::JobHandle JobSystem::schedule(const char* name, JobFunction function) {
+        JobHandle job = this->createJob(name, function);
+        this->schedule(job);
+        return job;
+    }
+
+    /*
+     * Block until [job] has finished, running queued jobs on the calling thread in the meantime.
+     */
+    void JobSystem::wait(JobHandle job) {
+        UInt32 threadIndex = this->getQueueIndexForCurrentThread();
+        while (!job->isFinished()) {
+            JobHandle next = this->takeJob(threadIndex);
+            if (next) {
+                this->execute(next, threadIndex);
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    /*
+     * Call [function] over [0, count) in ranges of at most [batchSize], spread over all threads, and
+     * return once every range has been processed.
+     */
+    void JobSystem::parallelFor(const char* name, UInt32 count, UInt32 batchSize, RangeFunction function) {
+        if (count == 0) return;
+        if (batchSize == 0) batchSize = 1;
+        if (count <= batchSize || this->workers.size() == 0) {
+            function(0, count);
+            return;
+        }
+
+        JobHandle group = this->createJob(name, nullptr);
+        std::vector<JobHandle> batches;
+        batches.reserve((count + batchSize - 1) / batchSize);
+        for (UInt32 start = 0; start < count; start += batchSize) {
+            UInt32 end = start + batchSize < count ? start + batchSize : count;
+            JobHandle batch = this->createJob(name, [function, start, end]() {
+                function(start, end);
+            });
+            this->addDependency(group, batch);
+            batches.push_back(batch);
+        }
+        this->schedule(group);
+        for (JobHandle batch : batches) {
+            this->schedule(batch);
+        }
+        this->wait(group);
+    }
+
+    /*
+     * Install a hook that is called after every job with its run time. The hook is called from whichever
+     * thread ran the job, so it must be thread-safe. Timing is skipped when no hook is set.
+     */
+    void JobSystem::setTimingCallback(TimingCallback callback) {
+        this->timingCallback = callback;
+    }
+
+    void JobSystem::startWorkers(UInt32 workerCount) {
+        this->queues.clear();
+        for (UInt32 i = 0; i < workerCount + 1; i++) {
+            this->queues.push_back(std::unique_ptr<JobQueue>(new JobQueue()));
+        }
+        this->running = true;
+        for (UInt32 i = 0; i < workerCount; i++) {
+            this->workers.push_back(std::thread(&JobSystem::workerLoop, this, i + 1));
+        }
+    }
+
+    void JobSystem::stopWorkers() {
+        {
+            std::lock_guard<std::mutex> guard(this->sleepLock);
+            this->running = false;
+        }
+        this->sleepCondition.notify_all();
+        for (std::thread& worker : this->workers) {
+            worker.join();
+        }
+        this->workers.clear();
+    }
+
+    void JobSystem::workerLoop(UInt32 threadIndex) {
+        currentSystem = this;
+        currentThreadIndex = threadIndex;
+        while (this->running) {
+            JobHandle job = this->takeJob(threadIndex);
+            if (job) {
+                this->execute(job, threadIndex);
+            }
+            else {
+                std::unique_lock<std::mutex> guard(this->sleepLock);
+                this->sleepCondition.wait(guard, [this]() {
+                    return !this->running || this->queuedJobCount.load() > 0;
+                });
+            }
+        }
+    }
+
+    void JobSystem::enqueue(JobHandle job) {
+        // count the job before it becomes visible so the count can never drop below the number of queued jobs
+        {
+            std::lock_guard<std::mutex> guard(this->sleepLock);
+            this->queuedJobCount.fetch_add(1);
+        }
+        JobQueue& queue = *this->queues[this->getQueueIndexForCurrentThread()];
+        {
+            std::lock_guard<std::mutex> guard(queue.lock);
+            queue.jobs.push_back(job);
+        }
+        this->sleepCondition.notify_one();
+    }
+
+    /*
+     * Pop the most recently queued job of [threadIndex], or failing that steal the oldest job of another thread.
+     */
+    JobSystem::JobHandle JobSystem::takeJob(UInt32 threadIndex) {
+        if (this->queuedJobCount.load() == 0) return nullptr;
+
+        JobHandle job;
+        UInt32 queueCount = (UInt32)this->queues.size();
+        for (UInt32 i = 0; i < queueCount && !job; i++) {
+            JobQueue& queue = *this->queues[(threadIndex + i) % queueCount];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            if (queue.jobs.size() == 0) continue;
+            if (i == 0) {
+                job = queue.jobs.back();
+                queue.jobs.pop_back();
+            }
+            else {
+                job = queue.jobs.front();
+                queue.jobs.pop_front();
+            }
+        }
+        if (job) this->queuedJobCount.fetch_sub(1);
+        return job;
+    }
+
+    void JobSystem::execute(JobHandle job, UInt32 threadIndex) {
+        if (job->function) {
+            if (this->timingCallback) {
+                std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+                job->function();
+                std::chrono::duration<RealDouble> elapsed = std::chrono::high_resolution_clock::now() - start;
+                this->timingCallback(job->name, threadIndex, (Real)elapsed.count());
+            }
+            else {
+                job->function();
+            }
+        }
+
+        std::vector<JobHandle> continuations;
+        {
+            std::lock_guard<std::mutex> guard(job->continuationLock);
+            job->finished.store(true, std::memory_order_release);
+            continuations.swap(job->continuations);
+        }
+        for (JobHandle continuation : continuations) {
+            if (continuation->pendingCount.fetch_sub(1) == 1) {
+                this->enqueue(continuation);
+            }
+        }
+    }
+
+    /*
+     * Threads that do not belong to this job system (including the owning thread) share queue 0.
+     */
+    UInt32 JobSystem::getQueueIndexForCurrentThread() const {
+        if (currentSystem == this && currentThreadIndex > 0 && (UInt32)currentThreadIndex < this->queues.size()) {
+            return (UInt32)currentThreadIndex;
+        }
+        return 0;
+    }
+
+}
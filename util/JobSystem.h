@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../common/types.h"
+
+namespace Core {
+
+    /*
+     * Work-stealing task scheduler. Each thread (the owning thread at index 0, plus [workerCount] worker
+     * threads) has its own job deque: a thread pushes and pops jobs at the back of its own deque and, when
+     * that is empty, steals from the front of another thread's deque. Threads that wait on a job keep
+     * executing other jobs until it completes, so the owning thread contributes to the work as well.
+     *
+     * Jobs may depend on other jobs; a scheduled job is only queued once every job it depends on has
+     * finished. With a worker count of zero no threads are started and all jobs run on the thread that
+     * waits on them, in a deterministic order.
+     *
+     * Anything that touches the graphics API must stay on the owning thread and must not be put in a job.
+     */
+    class JobSystem {
+    public:
+
+        typedef std::function<void()> JobFunction;
+        typedef std::function<void(UInt32 start, UInt32 end)> RangeFunction;
+        // called after each job with its name, the index of the thread that ran it and its run time in seconds
+        typedef std::function<void(const char* name, UInt32 threadIndex, Real seconds)> TimingCallback;
+
+        class Job {
+        public:
+            friend class JobSystem;
+
+            Job(const char* name, JobFunction function);
+            Bool isFinished() const;
+            const char* getName() const;
+
+        private:
+            const char* name;
+            JobFunction function;
+            // dependencies that have not finished yet, plus one until the job is scheduled
+            std::atomic<UInt32> pendingCount;
+            std::atomic<Bool> finished;
+            std::mutex continuationLock;
+            std::vector<std::shared_ptr<Job>> continuations;
+        };
+
+        typedef std::shared_ptr<Job> JobHandle;
+
+        JobSystem(UInt32 workerCount);
+        ~JobSystem();
+
+        static UInt32 getDefaultWorkerCount();
+
+        void setWorkerCount(UInt32 workerCount);
+        UInt32 getWorkerCount() const;
+        UInt32 getThreadCount() const;
+        static Int32 getCurrentThreadIndex();
+
+        JobHandle createJob(const char* name, JobFunction function);
+        void addDependency(JobHandle job, JobHandle dependency);
+        void schedule(JobHandle job);
+        JobHandle schedule(const char* name, JobFunction function);
+        void wait(JobHandle job);
+
+        void parallelFor(const char* name, UInt32 count, UInt32 batchSize, RangeFunction function);
+
+        void setTimingCallback(TimingCallback callback);
+
+    private:
+
+        class JobQueue {
+        public:
+            std::mutex lock;
+            std::deque<JobHandle> jobs;
+        };
+
+        void startWorkers(UInt32 workerCount);
+        void stopWorkers();
+        void workerLoop(UInt32 threadIndex);
+        void enqueue(JobHandle job);
+        JobHandle takeJob(UInt32 threadIndex);
+        void execute(JobHandle job, UInt32 threadIndex);
+        UInt32 getQueueIndexForCurrentThread() const;
+
+        std::vector<std::unique_ptr<JobQueue>> queues;
+        std::vector<std::thread> workers;
+        std::atomic<UInt32> queuedJobCount;
+        std::atomic<Bool> running;
+        std::mutex sleepLock;
+        std::condition_variable sleepCondition;
+        TimingCallback timingCallback;
+
+        static thread_local const JobSystem* currentSystem;
+        static thread_local Int32 currentThreadIndex;
+    };
+
+}